@@ -0,0 +1,41 @@
+# Compile-time log floors. Every log call below the floor is removed from the binary.
+# Accepted values: TRACE, DEBUG, INFO, WARN, ERROR, CRITICAL, OFF
+# Channel floors left empty follow DEEP_LOG_LEVEL. Channel can only raise the floor, never lower the global one.
+set(DEEP_LOG_LEVEL "TRACE" CACHE STRING "Global compile-time log floor")
+set(DEEP_LOG_LEVEL_ENGINE "" CACHE STRING "Compile-time floor of ENGINE_* logs")
+set(DEEP_LOG_LEVEL_SUBSYSTEM "" CACHE STRING "Compile-time floor of subsystem loggers (TRACE/INFO/... macros)")
+set(DEEP_LOG_LEVEL_RENDERER "" CACHE STRING "Compile-time floor of Renderer subsystem logger")
+set(DEEP_LOG_LEVEL_WINDOW "" CACHE STRING "Compile-time floor of Window subsystem logger")
+set(DEEP_LOG_LEVEL_VULKAN "" CACHE STRING "Compile-time floor of VULKAN_* logs")
+
+# Binary logging stores format ID + raw arguments instead of formatted text.
+# Output (<log name>.dlog) has to be decoded with DeepLogDecoder
+option(DEEP_LOG_BINARY "Record logs in binary deferred-format mode" OFF)
+
+function(deep_log_level_to_number LEVEL_NAME OUTPUT)
+    set(LEVELS TRACE DEBUG INFO WARN ERROR CRITICAL OFF)
+    string(TOUPPER "${LEVEL_NAME}" LEVEL_NAME)
+    list(FIND LEVELS "${LEVEL_NAME}" LEVEL_INDEX)
+
+    if(LEVEL_INDEX EQUAL -1)
+        message(FATAL_ERROR "Unknown log level \"${LEVEL_NAME}\", expected one of: ${LEVELS}")
+    endif()
+
+    set(${OUTPUT} ${LEVEL_INDEX} PARENT_SCOPE)
+endfunction()
+
+function(deep_configure_logging TARGET)
+    deep_log_level_to_number("${DEEP_LOG_LEVEL}" GLOBAL_LEVEL)
+    target_compile_definitions(${TARGET} PRIVATE DEEP_LOG_LEVEL=${GLOBAL_LEVEL})
+
+    foreach(CHANNEL ENGINE SUBSYSTEM RENDERER WINDOW VULKAN)
+        if(NOT "${DEEP_LOG_LEVEL_${CHANNEL}}" STREQUAL "")
+            deep_log_level_to_number("${DEEP_LOG_LEVEL_${CHANNEL}}" CHANNEL_LEVEL)
+            target_compile_definitions(${TARGET} PRIVATE DEEP_LOG_LEVEL_${CHANNEL}=${CHANNEL_LEVEL})
+        endif()
+    endforeach()
+
+    if(DEEP_LOG_BINARY)
+        target_compile_definitions(${TARGET} PRIVATE DEEP_LOG_BINARY)
+    endif()
+endfunction()
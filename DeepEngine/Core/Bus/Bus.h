@@ -20,9 +20,12 @@ namespace DeepEngine::Core::Bus
 			_childBuses.reserve(32);
 		}
 		
+		// Reserved like the root, child buses are stored by value and growing past it moves them (with their subtrees)
 		Bus(Bus<TObject, TListener>* p_parent)
 		{
 			_parentBus = p_parent;
+			_listeners.reserve(32);
+			_childBuses.reserve(32);
 		}
 
 		Bus(const Bus&) = delete;
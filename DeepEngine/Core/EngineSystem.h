@@ -38,6 +38,9 @@ namespace DeepEngine::Core
         virtual void Tick(const Scene::Scene& p_scene) = 0;
 
     protected:
+        // Compile-time floor of TRACE/DEBUG/... macros, subsystems can shadow it with their own channel
+        static constexpr int LogLevelFloor = DEEP_LOG_LEVEL_SUBSYSTEM;
+
         EngineSubsystemsManager* _subsystemsManager;
         std::shared_ptr<Debug::Logger> _subsystemLogger;
         Debug::InitializationMilestone _initializeMilestone;
@@ -94,8 +97,8 @@ namespace DeepEngine::Core
     };
 }
 
-#define TRACE(...) LOG_TRACE(_subsystemLogger, __VA_ARGS__)  
-#define DEBUG(...) LOG_DEBUG(_subsystemLogger, __VA_ARGS__)  
-#define INFO(...) LOG_INFO(_subsystemLogger, __VA_ARGS__)  
-#define WARN(...) LOG_WARN(_subsystemLogger, __VA_ARGS__)  
-#define ERR(...) LOG_ERR(_subsystemLogger, __VA_ARGS__)  
+#define TRACE(...) DEEP_LOG_IF(LogLevelFloor, SPDLOG_LEVEL_TRACE, _subsystemLogger, __VA_ARGS__)
+#define DEBUG(...) DEEP_LOG_IF(LogLevelFloor, SPDLOG_LEVEL_DEBUG, _subsystemLogger, __VA_ARGS__)
+#define INFO(...) DEEP_LOG_IF(LogLevelFloor, SPDLOG_LEVEL_INFO, _subsystemLogger, __VA_ARGS__)
+#define WARN(...) DEEP_LOG_IF(LogLevelFloor, SPDLOG_LEVEL_WARN, _subsystemLogger, __VA_ARGS__)
+#define ERR(...) DEEP_LOG_IF(LogLevelFloor, SPDLOG_LEVEL_ERROR, _subsystemLogger, __VA_ARGS__)
@@ -0,0 +1,132 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace DeepEngine::Core::IO
+{
+    MappedFile::MappedFile(MappedFile&& p_other) noexcept
+    {
+        *this = std::move(p_other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& p_other) noexcept
+    {
+        if (this != &p_other)
+        {
+            Close();
+            _data = std::exchange(p_other._data, nullptr);
+            _size = std::exchange(p_other._size, 0);
+#ifdef _WIN32
+            _mappingHandle = std::exchange(p_other._mappingHandle, nullptr);
+#endif
+        }
+        return *this;
+    }
+
+#ifdef _WIN32
+    bool MappedFile::Open(const std::string& p_filepath)
+    {
+        Close();
+
+        HANDLE file = CreateFileA(p_filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        // Mapping keeps its own reference to the file
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr)
+        {
+            return false;
+        }
+
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (data == nullptr)
+        {
+            CloseHandle(mapping);
+            return false;
+        }
+
+        _data = static_cast<const uint8_t*>(data);
+        _size = static_cast<size_t>(fileSize.QuadPart);
+        _mappingHandle = mapping;
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (_data != nullptr)
+        {
+            UnmapViewOfFile(_data);
+            CloseHandle(_mappingHandle);
+        }
+
+        _data = nullptr;
+        _size = 0;
+        _mappingHandle = nullptr;
+    }
+#else
+    bool MappedFile::Open(const std::string& p_filepath)
+    {
+        Close();
+
+        const int file = open(p_filepath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0)
+        {
+            return false;
+        }
+
+        struct stat fileStat { };
+        if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            close(file);
+            return false;
+        }
+
+        // Mapping stays valid after the descriptor is closed
+        void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        if (data == MAP_FAILED)
+        {
+            return false;
+        }
+
+        _data = static_cast<const uint8_t*>(data);
+        _size = static_cast<size_t>(fileStat.st_size);
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (_data != nullptr)
+        {
+            munmap(const_cast<uint8_t*>(_data), _size);
+        }
+
+        _data = nullptr;
+        _size = 0;
+    }
+#endif
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace DeepEngine::Core::IO
+{
+
+    // Read only view of a whole file mapped into memory. Pages are loaded by the OS on first access, nothing is
+    // copied. Mapping starts at a page boundary, so data is aligned for any type stored at aligned offsets.
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile()
+        { Close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& p_other) noexcept;
+        MappedFile& operator=(MappedFile&& p_other) noexcept;
+
+        // Empty files can not be mapped, opening them fails
+        bool Open(const std::string& p_filepath);
+        void Close();
+
+        bool IsOpen() const
+        { return _data != nullptr; }
+
+        const uint8_t* GetData() const
+        { return _data; }
+
+        size_t GetSize() const
+        { return _size; }
+
+    private:
+        const uint8_t* _data = nullptr;
+        size_t _size = 0;
+#ifdef _WIN32
+        void* _mappingHandle = nullptr;
+#endif
+    };
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 #define GLM_GTX_transform
 #include <any>
+#include <new>
 #include <glm/gtx/hash.hpp>
 
 #include "SceneElement.h"
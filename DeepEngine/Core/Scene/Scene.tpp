@@ -120,13 +120,14 @@ namespace DeepEngine::Core::Scene
 	constexpr T& Scene::CreateSceneElement()
 	{
 		ENGINE_TRACE("Creating object of type \"{}\" in scene at {} offset!", typeid(T).name(), _sceneElementsPtr);
-		T* ptr = (T*)_sceneElementsPtr;
-		memset(ptr, 0, sizeof(T));
-		*ptr = T();
+		memset(_sceneElementsPtr, 0, sizeof(T));
+		// Constructed in place, assignment into zeroed memory would leave it without vtable
+		T* ptr = new (_sceneElementsPtr) T();
 
 		SceneElement* newElement = ptr;
 		newElement->_runtimeID = _elementCounter;
-		newElement->_size = alignof(T);
+		// In 8 byte units (see GetSize), rounded up so next element stays aligned
+		newElement->_size = (sizeof(T) + 7) / 8;
 		newElement->_typeHashCode = typeid(T).hash_code();
 		newElement->_name = ptr->GetTypeName();
 
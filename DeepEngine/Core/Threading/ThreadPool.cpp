@@ -0,0 +1,130 @@
+#include "ThreadPool.h"
+
+#include <memory>
+
+namespace DeepEngine::Core::Threading
+{
+    ThreadPool::ThreadPool(uint32_t p_workersCount)
+    {
+        _workers.reserve(p_workersCount);
+        for (uint32_t i = 0; i < p_workersCount; i++)
+        {
+            _workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard lock(_queueMutex);
+            _isStopping = true;
+        }
+        _queueCondition.notify_all();
+
+        for (std::thread& worker : _workers)
+        {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::Submit(Task p_task)
+    {
+        if (_workers.empty())
+        {
+            p_task(GetWorkersCount());
+            return;
+        }
+
+        {
+            std::lock_guard lock(_queueMutex);
+            _tasks.push(std::move(p_task));
+        }
+        _queueCondition.notify_one();
+    }
+
+    void ThreadPool::ParallelFor(uint32_t p_count, uint32_t p_batchSize, const RangeTask& p_task)
+    {
+        if (p_count == 0)
+        {
+            return;
+        }
+
+        p_batchSize = std::max(p_batchSize, 1u);
+        const uint32_t batchesCount = (p_count + p_batchSize - 1) / p_batchSize;
+        const uint32_t callerIndex = GetWorkersCount();
+
+        if (batchesCount == 1 || _workers.empty())
+        {
+            p_task(0, p_count, callerIndex);
+            return;
+        }
+
+        // Batches are taken dynamically, so a slow batch does not stall the others. Caller waits for processed
+        // batches instead of for helpers - helper queued behind a long task (e.g. pipeline compilation) finds
+        // nothing left to do once it starts, so the state it touches is shared and outlives this call
+        struct SharedState
+        {
+            std::atomic<uint32_t> NextBatch = 0;
+            uint32_t FinishedBatches = 0;
+            std::mutex FinishedMutex;
+            std::condition_variable FinishedCondition;
+        };
+        auto state = std::make_shared<SharedState>();
+
+        auto processBatches = [state, batchesCount, p_count, p_batchSize, &p_task](uint32_t p_threadIndex)
+        {
+            uint32_t processedCount = 0;
+            for (uint32_t batch = state->NextBatch.fetch_add(1); batch < batchesCount; batch = state->NextBatch.fetch_add(1))
+            {
+                const uint32_t begin = batch * p_batchSize;
+                p_task(begin, std::min(begin + p_batchSize, p_count), p_threadIndex);
+                processedCount++;
+            }
+
+            if (processedCount == 0)
+            {
+                return;
+            }
+
+            std::lock_guard lock(state->FinishedMutex);
+            state->FinishedBatches += processedCount;
+            if (state->FinishedBatches == batchesCount)
+            {
+                state->FinishedCondition.notify_one();
+            }
+        };
+
+        const uint32_t helpersCount = std::min(batchesCount - 1, GetWorkersCount());
+        for (uint32_t i = 0; i < helpersCount; i++)
+        {
+            Submit(processBatches);
+        }
+
+        processBatches(callerIndex);
+
+        std::unique_lock lock(state->FinishedMutex);
+        state->FinishedCondition.wait(lock, [&] { return state->FinishedBatches == batchesCount; });
+    }
+
+    void ThreadPool::WorkerLoop(uint32_t p_threadIndex)
+    {
+        while (true)
+        {
+            Task task;
+            {
+                std::unique_lock lock(_queueMutex);
+                _queueCondition.wait(lock, [this] { return _isStopping || !_tasks.empty(); });
+
+                if (_isStopping && _tasks.empty())
+                {
+                    return;
+                }
+
+                task = std::move(_tasks.front());
+                _tasks.pop();
+            }
+
+            task(p_threadIndex);
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace DeepEngine::Core::Threading
+{
+
+    // Fixed set of worker threads fed from a single task queue.
+    // Every task receives index of the thread executing it, so callers can keep per-thread resources
+    // (command pools, scratch buffers) without any locking. Workers have indices [0, GetWorkersCount()),
+    // thread calling ParallelFor takes part in the work with index GetWorkersCount().
+    // Pool without workers runs everything on the calling thread, Submit executes the task before returning.
+    class ThreadPool
+    {
+    public:
+        using Task = std::function<void(uint32_t p_threadIndex)>;
+        // Processes items in range [p_begin, p_end)
+        using RangeTask = std::function<void(uint32_t p_begin, uint32_t p_end, uint32_t p_threadIndex)>;
+
+        explicit ThreadPool(uint32_t p_workersCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void Submit(Task p_task);
+
+        // Splits [0, p_count) into batches of p_batchSize and blocks until all of them are processed
+        void ParallelFor(uint32_t p_count, uint32_t p_batchSize, const RangeTask& p_task);
+
+        uint32_t GetWorkersCount() const
+        { return static_cast<uint32_t>(_workers.size()); }
+
+        // Number of distinct thread indices a task may receive (workers + calling thread)
+        uint32_t GetThreadIndicesCount() const
+        { return GetWorkersCount() + 1; }
+
+        static uint32_t GetDefaultWorkersCount()
+        { return std::max(std::thread::hardware_concurrency(), 2u) - 1; }
+
+    private:
+        void WorkerLoop(uint32_t p_threadIndex);
+
+    private:
+        std::vector<std::thread> _workers;
+
+        std::mutex _queueMutex;
+        std::condition_variable _queueCondition;
+        std::queue<Task> _tasks;
+        bool _isStopping = false;
+    };
+
+}
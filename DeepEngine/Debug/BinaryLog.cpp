@@ -0,0 +1,152 @@
+#include "BinaryLog.h"
+
+#include <filesystem>
+
+namespace DeepEngine::Debug
+{
+    BinaryLog::BinaryLog()
+    {
+        _buffer.reserve(FLUSH_THRESHOLD + FLUSH_THRESHOLD / 4);
+        _writeBuffer.reserve(FLUSH_THRESHOLD + FLUSH_THRESHOLD / 4);
+    }
+
+    BinaryLog::~BinaryLog()
+    {
+        {
+            std::lock_guard lock(_bufferMutex);
+            _isStopping = true;
+        }
+        _flushCondition.notify_one();
+
+        if (_flusherThread.joinable())
+        {
+            _flusherThread.join();
+        }
+        WriteBuffered();
+
+        if (_file != nullptr)
+        {
+            fclose(_file);
+        }
+    }
+
+    void BinaryLog::Open(const std::string& p_filepath)
+    {
+        BinaryLog* instance = GetInstance();
+        {
+            std::lock_guard lock(instance->_fileMutex);
+
+            if (instance->_file != nullptr)
+            {
+                return;
+            }
+
+            const std::filesystem::path path(p_filepath);
+            if (path.has_parent_path())
+            {
+                std::filesystem::create_directories(path.parent_path());
+            }
+
+            instance->_file = fopen(p_filepath.c_str(), "wb");
+            if (instance->_file == nullptr)
+            {
+                return;
+            }
+
+            BinaryLogFormat::FileHeader header { };
+            header.Magic = BinaryLogFormat::MAGIC;
+            header.Version = BinaryLogFormat::VERSION;
+            header.StartTimestamp = std::chrono::steady_clock::now().time_since_epoch() / std::chrono::nanoseconds(1);
+            fwrite(&header, sizeof(header), 1, instance->_file);
+        }
+
+        // Definitions registered before opening are already waiting in the buffer
+        instance->WriteBuffered();
+        instance->_flusherThread = std::thread(&BinaryLog::FlusherLoop, instance);
+    }
+
+    void BinaryLog::Flush()
+    {
+        GetInstance()->WriteBuffered();
+    }
+
+    uint16_t BinaryLog::RegisterChannel(const char* p_name)
+    {
+        BinaryLog* instance = GetInstance();
+        std::lock_guard lock(instance->_bufferMutex);
+
+        const uint16_t id = instance->_channelsCount++;
+        instance->WriteRaw(BinaryLogFormat::RecordType::CHANNEL_DEFINITION);
+        instance->WriteRaw(id);
+        instance->WriteString(p_name);
+        return id;
+    }
+
+    uint32_t BinaryLog::RegisterSite(int p_level, const char* p_file, uint32_t p_line, std::string_view p_format)
+    {
+        BinaryLog* instance = GetInstance();
+        std::lock_guard lock(instance->_bufferMutex);
+
+        const uint32_t id = instance->_sitesCount++;
+        instance->WriteRaw(BinaryLogFormat::RecordType::SITE_DEFINITION);
+        instance->WriteRaw(id);
+        instance->WriteRaw(static_cast<uint8_t>(p_level));
+        instance->WriteRaw(p_line);
+        instance->WriteString(p_file);
+        instance->WriteString(p_format);
+        return id;
+    }
+
+    BinaryLog* BinaryLog::GetInstance()
+    {
+        static BinaryLog instance;
+        return &instance;
+    }
+
+    void BinaryLog::FlusherLoop()
+    {
+        while (true)
+        {
+            {
+                std::unique_lock lock(_bufferMutex);
+                _flushCondition.wait_for(lock, FLUSH_INTERVAL, [this]
+                {
+                    return _isStopping || _buffer.size() >= FLUSH_THRESHOLD;
+                });
+
+                // Destructor writes the rest
+                if (_isStopping)
+                {
+                    return;
+                }
+            }
+
+            WriteBuffered();
+        }
+    }
+
+    void BinaryLog::WriteBuffered()
+    {
+        std::lock_guard fileLock(_fileMutex);
+
+        // Until the file is opened keep everything in memory, otherwise definitions would be lost
+        if (_file == nullptr)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard lock(_bufferMutex);
+            _writeBuffer.swap(_buffer);
+        }
+
+        if (_writeBuffer.empty())
+        {
+            return;
+        }
+
+        fwrite(_writeBuffer.data(), 1, _writeBuffer.size(), _file);
+        fflush(_file);
+        _writeBuffer.clear();
+    }
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <fmt/format.h>
+
+#include "BinaryLogFormat.h"
+
+namespace DeepEngine::Debug
+{
+
+    // Deferred-format log backend. Instead of formatting message on the calling thread it stores format site ID
+    // and raw argument values into a buffer which is streamed to a file. Formatting happens offline in DeepLogDecoder.
+    // Logging threads only append to the buffer under a short lock. Full buffer is swapped for an empty one and
+    // written by the flusher thread, so disk I/O never happens on the logging threads.
+    // Enabled by DEEP_LOG_BINARY build option, see Logger.h
+    class BinaryLog
+    {
+    private:
+        BinaryLog();
+        ~BinaryLog();
+
+    public:
+        BinaryLog(const BinaryLog&) = delete;
+        BinaryLog(BinaryLog&&) = delete;
+
+        // Starts the flusher thread, everything recorded before is kept in memory until then
+        static void Open(const std::string& p_filepath);
+        // Blocks until everything recorded so far is written
+        static void Flush();
+
+        static uint16_t RegisterChannel(const char* p_name);
+        // Format has to be constant for given call site, it is stored only once
+        static uint32_t RegisterSite(int p_level, const char* p_file, uint32_t p_line, std::string_view p_format);
+
+        template <typename... TArgs>
+        static void Record(uint16_t p_channelId, uint32_t p_siteId, const TArgs&... p_args)
+        {
+            BinaryLog* instance = GetInstance();
+            const uint64_t timestamp = std::chrono::steady_clock::now().time_since_epoch() / std::chrono::nanoseconds(1);
+
+            std::lock_guard lock(instance->_bufferMutex);
+
+            instance->WriteRaw(BinaryLogFormat::RecordType::ENTRY);
+            instance->WriteRaw(p_siteId);
+            instance->WriteRaw(p_channelId);
+            instance->WriteRaw(timestamp);
+            instance->WriteRaw(static_cast<uint8_t>(sizeof...(TArgs)));
+            (instance->WriteArgument(p_args), ...);
+
+            if (instance->_buffer.size() >= FLUSH_THRESHOLD)
+            {
+                instance->_flushCondition.notify_one();
+            }
+        }
+
+    private:
+        static BinaryLog* GetInstance();
+
+        void FlusherLoop();
+        // Swaps the buffers and writes the recorded data, buffer mutex must not be held
+        void WriteBuffered();
+
+        template <typename T>
+        void WriteRaw(const T& p_value)
+        {
+            const auto* bytes = reinterpret_cast<const uint8_t*>(&p_value);
+            _buffer.insert(_buffer.end(), bytes, bytes + sizeof(T));
+        }
+
+        void WriteString(std::string_view p_value)
+        {
+            WriteRaw(static_cast<uint32_t>(p_value.size()));
+            _buffer.insert(_buffer.end(), p_value.begin(), p_value.end());
+        }
+
+        template <typename T>
+        void WriteArgument(const T& p_value)
+        {
+            using TValue = std::decay_t<T>;
+            using Tag = BinaryLogFormat::ArgumentTag;
+
+            if constexpr (std::is_same_v<TValue, bool>)
+            {
+                WriteRaw(Tag::BOOL);
+                WriteRaw(static_cast<uint8_t>(p_value));
+            }
+            else if constexpr (std::is_same_v<TValue, char>)
+            {
+                WriteRaw(Tag::CHAR);
+                WriteRaw(p_value);
+            }
+            else if constexpr (std::is_enum_v<TValue>)
+            {
+                WriteArgument(static_cast<std::underlying_type_t<TValue>>(p_value));
+            }
+            else if constexpr (std::is_integral_v<TValue> && std::is_signed_v<TValue>)
+            {
+                WriteRaw(Tag::INT64);
+                WriteRaw(static_cast<int64_t>(p_value));
+            }
+            else if constexpr (std::is_integral_v<TValue>)
+            {
+                WriteRaw(Tag::UINT64);
+                WriteRaw(static_cast<uint64_t>(p_value));
+            }
+            else if constexpr (std::is_floating_point_v<TValue>)
+            {
+                WriteRaw(Tag::DOUBLE);
+                WriteRaw(static_cast<double>(p_value));
+            }
+            else if constexpr (std::is_same_v<TValue, const char*> || std::is_same_v<TValue, char*>)
+            {
+                WriteRaw(Tag::STRING);
+                WriteString(p_value != nullptr ? std::string_view(p_value) : std::string_view("(null)"));
+            }
+            else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+            {
+                WriteRaw(Tag::STRING);
+                WriteString(std::string_view(p_value));
+            }
+            else if constexpr (std::is_pointer_v<TValue>)
+            {
+                WriteRaw(Tag::POINTER);
+                WriteRaw(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(p_value)));
+            }
+            else
+            {
+                // Types without binary representation (glm vectors etc.) still have to be formatted in place
+                WriteRaw(Tag::STRING);
+                WriteString(fmt::format("{}", p_value));
+            }
+        }
+
+    private:
+        static constexpr size_t FLUSH_THRESHOLD = 1024 * 1024;
+        // Entries reach the file at least this often even when the buffer does not fill up
+        static constexpr std::chrono::milliseconds FLUSH_INTERVAL { 500 };
+
+        std::mutex _bufferMutex;
+        std::vector<uint8_t> _buffer;
+        std::condition_variable _flushCondition;
+        bool _isStopping = false;
+
+        // Held while writing, keeps buffers written in the order they were swapped out
+        std::mutex _fileMutex;
+        std::vector<uint8_t> _writeBuffer;
+        FILE* _file = nullptr;
+        std::thread _flusherThread;
+
+        uint32_t _sitesCount = 0;
+        uint16_t _channelsCount = 0;
+    };
+
+}
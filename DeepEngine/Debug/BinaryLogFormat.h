@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+
+// Layout of the binary log stream shared between the engine (writer) and DeepLogDecoder (reader).
+// Keep this header free of engine/spdlog dependencies, decoder includes it directly.
+//
+// Stream: FileHeader, then records one after another. Each record starts with RecordType byte.
+//  * SITE_DEFINITION    - uint32 siteId, uint8 level, uint32 line, string file, string format
+//  * CHANNEL_DEFINITION - uint16 channelId, string name
+//  * ENTRY              - uint32 siteId, uint16 channelId, uint64 timestamp (ns), uint8 argsCount, args...
+// Every argument is ArgumentTag byte followed by its payload, strings are uint32 length + bytes.
+
+namespace DeepEngine::Debug::BinaryLogFormat
+{
+
+    constexpr uint32_t MAGIC = 0x474F4C44; // "DLOG"
+    constexpr uint32_t VERSION = 1;
+
+    struct FileHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        // steady_clock time the file was opened, lets decoder print relative timestamps. Entries buffered
+        // before opening are older than that
+        uint64_t StartTimestamp;
+    };
+
+    enum class RecordType : uint8_t
+    {
+        SITE_DEFINITION = 0,
+        CHANNEL_DEFINITION = 1,
+        ENTRY = 2,
+    };
+
+    enum class ArgumentTag : uint8_t
+    {
+        INT64 = 0,
+        UINT64 = 1,
+        DOUBLE = 2,
+        BOOL = 3,
+        CHAR = 4,
+        STRING = 5,
+        POINTER = 6,
+    };
+
+}
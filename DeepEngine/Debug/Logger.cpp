@@ -1,5 +1,7 @@
 #include "Logger.h"
 
+#include <filesystem>
+
 namespace DeepEngine::Debug
 {
     std::shared_ptr<Logger> Logger::_engineLogger = nullptr;
@@ -7,15 +9,22 @@ namespace DeepEngine::Debug
     std::shared_ptr<spdlog::sinks::basic_file_sink_st> Logger::_fileSink = nullptr;
 
     Logger::Logger(const char* p_name) : _logger(p_name, { _consoleSink, _fileSink })
+#ifdef DEEP_LOG_BINARY
+        , _binaryChannel(BinaryLog::RegisterChannel(p_name))
+#endif
     {
     }
 
     void Logger::Initialize(const char* p_filepath)
     {
-        spdlog::set_level(spdlog::level::trace);
+        spdlog::set_level(static_cast<spdlog::level::level_enum>(DEEP_LOG_LEVEL));
+
+#ifdef DEEP_LOG_BINARY
+        BinaryLog::Open(std::filesystem::path(p_filepath).replace_extension(".dlog").string());
+#endif
         
         _fileSink = std::make_shared<spdlog::sinks::basic_file_sink_st>(p_filepath);
-        _fileSink->set_level(spdlog::level::trace);
+        _fileSink->set_level(static_cast<spdlog::level::level_enum>(DEEP_LOG_LEVEL));
         _fileSink->set_pattern("[%D %T] %-42s (%#) [%=22n][%^%=7l%$]: %v");
         
         _engineLogger = CreateLoggerInstance("Engine");
@@ -26,17 +35,28 @@ namespace DeepEngine::Debug
         Initialize(p_filepath.c_str());
     }
 
+    void Logger::Flush()
+    {
+#ifdef DEEP_LOG_BINARY
+        BinaryLog::Flush();
+#endif
+        if (_fileSink != nullptr)
+        {
+            _fileSink->flush();
+        }
+    }
+
     std::shared_ptr<Logger> Logger::CreateLoggerInstance(const char* p_name)
     { 
         if (_consoleSink == nullptr)
         {
             _consoleSink = std::make_shared<spdlog::sinks::stdout_color_sink_st>();
-            _consoleSink->set_level(spdlog::level::trace);
+            _consoleSink->set_level(static_cast<spdlog::level::level_enum>(DEEP_LOG_LEVEL));
             _consoleSink->set_pattern("[%T]%=42s(%#) [%=22n][%^%=7l%$]: %v");
         }
 
         auto* logger = new Logger(p_name);
-        logger->GetLogger()->set_level(spdlog::level::trace);
+        logger->GetLogger()->set_level(static_cast<spdlog::level::level_enum>(DEEP_LOG_LEVEL));
         std::shared_ptr<Logger> loggerPtr;
         loggerPtr.reset(logger);
         return loggerPtr;
@@ -1,9 +1,38 @@
 #pragma once
-#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE 
+
+// Compile-time log floors, values match SPDLOG_LEVEL_* (0 - trace ... 6 - off).
+// Calls below the floor are discarded at compile time, so their arguments are never formatted nor evaluated.
+// Set from CMake, see CMake/ConfigureLogging.cmake
+#ifndef DEEP_LOG_LEVEL
+#   define DEEP_LOG_LEVEL 0
+#endif
+
+#define SPDLOG_ACTIVE_LEVEL DEEP_LOG_LEVEL
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/basic_file_sink.h>
 
+#ifdef DEEP_LOG_BINARY
+#   include "BinaryLog.h"
+#endif
+
+// Per channel floors, by default they follow the global one
+#ifndef DEEP_LOG_LEVEL_ENGINE
+#   define DEEP_LOG_LEVEL_ENGINE DEEP_LOG_LEVEL
+#endif
+#ifndef DEEP_LOG_LEVEL_SUBSYSTEM
+#   define DEEP_LOG_LEVEL_SUBSYSTEM DEEP_LOG_LEVEL
+#endif
+#ifndef DEEP_LOG_LEVEL_RENDERER
+#   define DEEP_LOG_LEVEL_RENDERER DEEP_LOG_LEVEL_SUBSYSTEM
+#endif
+#ifndef DEEP_LOG_LEVEL_WINDOW
+#   define DEEP_LOG_LEVEL_WINDOW DEEP_LOG_LEVEL_SUBSYSTEM
+#endif
+#ifndef DEEP_LOG_LEVEL_VULKAN
+#   define DEEP_LOG_LEVEL_VULKAN DEEP_LOG_LEVEL
+#endif
+
 namespace DeepEngine::Debug
 {
 
@@ -18,33 +47,68 @@ namespace DeepEngine::Debug
         {
             return &_logger;
         }
-        
+
+#ifdef DEEP_LOG_BINARY
+        uint16_t GetBinaryChannel() const
+        {
+            return _binaryChannel;
+        }
+#endif
+
     public:
         static void Initialize(const char* p_filepath);
         static void Initialize(const std::string& p_filepath);
+        static void Flush();
         static std::shared_ptr<Logger> CreateLoggerInstance(const char* p_name);
         static std::shared_ptr<Logger> CreateLoggerInstance(const std::string& p_name);
         static std::shared_ptr<Logger> GetBaseEngineLogger();
 
     private:
         spdlog::logger _logger;
-        
+#ifdef DEEP_LOG_BINARY
+        const uint16_t _binaryChannel;
+#endif
+
     private:
         static std::shared_ptr<Logger> _engineLogger;
         static std::shared_ptr<spdlog::sinks::stdout_color_sink_st> _consoleSink;
         static std::shared_ptr<spdlog::sinks::basic_file_sink_st> _fileSink;
     };
-    
+
 }
 
-#define ENGINE_TRACE(...) SPDLOG_LOGGER_TRACE(DeepEngine::Debug::Logger::GetBaseEngineLogger()->GetLogger(), __VA_ARGS__)
-#define ENGINE_DEBUG(...) SPDLOG_LOGGER_DEBUG(DeepEngine::Debug::Logger::GetBaseEngineLogger()->GetLogger(), __VA_ARGS__)
-#define ENGINE_INFO(...) SPDLOG_LOGGER_INFO(DeepEngine::Debug::Logger::GetBaseEngineLogger()->GetLogger(), __VA_ARGS__)
-#define ENGINE_WARN(...) SPDLOG_LOGGER_WARN(DeepEngine::Debug::Logger::GetBaseEngineLogger()->GetLogger(), __VA_ARGS__)
-#define ENGINE_ERR(...) SPDLOG_LOGGER_ERROR(DeepEngine::Debug::Logger::GetBaseEngineLogger()->GetLogger(), __VA_ARGS__)
-
-#define LOG_TRACE(logger, ...) SPDLOG_LOGGER_TRACE(logger->GetLogger(), __VA_ARGS__)
-#define LOG_DEBUG(logger, ...) SPDLOG_LOGGER_DEBUG(logger->GetLogger(), __VA_ARGS__)
-#define LOG_INFO(logger, ...) SPDLOG_LOGGER_INFO(logger->GetLogger(), __VA_ARGS__)
-#define LOG_WARN(logger, ...) SPDLOG_LOGGER_WARN(logger->GetLogger(), __VA_ARGS__)
-#define LOG_ERR(logger, ...) SPDLOG_LOGGER_ERROR(logger->GetLogger(), __VA_ARGS__)
+#ifdef DEEP_LOG_BINARY
+    // Registers call site once (format, file, line, level) and afterwards only pushes site ID with raw arguments
+#   define DEEP_LOG_EMIT(Level, LoggerPtr, ...)                                                         \
+        [&]<typename... TArgs>(std::string_view p_format, const TArgs&... p_args)                      \
+        {                                                                                               \
+            static const uint32_t siteId = DeepEngine::Debug::BinaryLog::RegisterSite(                 \
+                Level, __FILE__, __LINE__, p_format);                                                   \
+            DeepEngine::Debug::BinaryLog::Record((LoggerPtr)->GetBinaryChannel(), siteId, p_args...);   \
+        }(__VA_ARGS__)
+#else
+#   define DEEP_LOG_EMIT(Level, LoggerPtr, ...)                                                         \
+        (LoggerPtr)->GetLogger()->log(spdlog::source_loc { __FILE__, __LINE__, SPDLOG_FUNCTION },       \
+            static_cast<spdlog::level::level_enum>(Level), __VA_ARGS__)
+#endif
+
+#define DEEP_LOG_IF(Floor, Level, LoggerPtr, ...)                                                       \
+    do                                                                                                  \
+    {                                                                                                   \
+        if constexpr ((Level) >= (Floor) && (Level) >= DEEP_LOG_LEVEL)                                  \
+        {                                                                                               \
+            DEEP_LOG_EMIT(Level, LoggerPtr, __VA_ARGS__);                                               \
+        }                                                                                               \
+    } while (false)
+
+#define ENGINE_TRACE(...) DEEP_LOG_IF(DEEP_LOG_LEVEL_ENGINE, SPDLOG_LEVEL_TRACE, DeepEngine::Debug::Logger::GetBaseEngineLogger(), __VA_ARGS__)
+#define ENGINE_DEBUG(...) DEEP_LOG_IF(DEEP_LOG_LEVEL_ENGINE, SPDLOG_LEVEL_DEBUG, DeepEngine::Debug::Logger::GetBaseEngineLogger(), __VA_ARGS__)
+#define ENGINE_INFO(...) DEEP_LOG_IF(DEEP_LOG_LEVEL_ENGINE, SPDLOG_LEVEL_INFO, DeepEngine::Debug::Logger::GetBaseEngineLogger(), __VA_ARGS__)
+#define ENGINE_WARN(...) DEEP_LOG_IF(DEEP_LOG_LEVEL_ENGINE, SPDLOG_LEVEL_WARN, DeepEngine::Debug::Logger::GetBaseEngineLogger(), __VA_ARGS__)
+#define ENGINE_ERR(...) DEEP_LOG_IF(DEEP_LOG_LEVEL_ENGINE, SPDLOG_LEVEL_ERROR, DeepEngine::Debug::Logger::GetBaseEngineLogger(), __VA_ARGS__)
+
+#define LOG_TRACE(logger, ...) DEEP_LOG_IF(DEEP_LOG_LEVEL, SPDLOG_LEVEL_TRACE, logger, __VA_ARGS__)
+#define LOG_DEBUG(logger, ...) DEEP_LOG_IF(DEEP_LOG_LEVEL, SPDLOG_LEVEL_DEBUG, logger, __VA_ARGS__)
+#define LOG_INFO(logger, ...) DEEP_LOG_IF(DEEP_LOG_LEVEL, SPDLOG_LEVEL_INFO, logger, __VA_ARGS__)
+#define LOG_WARN(logger, ...) DEEP_LOG_IF(DEEP_LOG_LEVEL, SPDLOG_LEVEL_WARN, logger, __VA_ARGS__)
+#define LOG_ERR(logger, ...) DEEP_LOG_IF(DEEP_LOG_LEVEL, SPDLOG_LEVEL_ERROR, logger, __VA_ARGS__)
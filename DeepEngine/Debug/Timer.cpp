@@ -2,5 +2,5 @@
 
 namespace DeepEngine::Debug
 {
-    std::vector<TimerTracker*> TimerTracker::_trackerInstances;
+    std::atomic<TimerTracker*> TimerTracker::_trackersHead = nullptr;
 }
@@ -1,97 +1,124 @@
 #pragma once
+#include <atomic>
 #include <chrono>
+#include <string>
+#include <vector>
 #include <fmt/format.h>
 
+// Tracker is a function-local static, so its name is evaluated only once (on first pass)
 #define TIMER(name)                                                                       \
-    static DeepEngine::Debug::TimerTracker __timerTracker;                                \
-    DeepEngine::Debug::Timer __timerInstance = __timerTracker.CreateTimer(__func__, name) \
+    static DeepEngine::Debug::TimerTracker __timerTracker(__func__, name);                \
+    DeepEngine::Debug::Timer __timerInstance = __timerTracker.CreateTimer()               \
 
 #define PRINT_TIMER_SUMMARY() DeepEngine::Debug::TimerTracker::PrintSummary()
 
 namespace DeepEngine::Debug
 {
-    class Timer;
-    
+    class TimerTracker;
+
     class Timer
     {
     public:
         Timer(const Timer& p_other) = default;
-        
-        Timer(float* p_durationResult, uint64_t* p_totalMilliseconds)
-            : _startTime(std::chrono::steady_clock::now())
-        {
-            _durationResult = p_durationResult;
-            _totalMilliseconds = p_totalMilliseconds;
-        }
-        
-        ~Timer()
-        {
-            const auto endTime = std::chrono::steady_clock::now();
 
-            using namespace std::literals;
-            *_durationResult = (endTime - _startTime) / 1ns;
-            *_durationResult /= 1000000.f;
+        Timer(TimerTracker* p_tracker)
+            : _startTime(std::chrono::steady_clock::now()), _tracker(p_tracker)
+        { }
 
-            *_totalMilliseconds += (endTime - _startTime) / 1ms;
-        }
+        inline ~Timer();
 
     private:
         std::chrono::time_point<std::chrono::steady_clock> _startTime;
-        uint64_t* _totalMilliseconds;
-        float* _durationResult;
+        TimerTracker* _tracker;
     };
 
+    // Collecting samples is lock-free: every tracker owns a ring buffer of atomic samples with a monotonic write
+    // index and trackers are linked into an intrusive list with CAS on its head. Readers (summary, profiler overlay)
+    // take snapshots without stopping writers, so a snapshot taken during heavy writes can contain a few samples
+    // newer than its write index - good enough for statistics.
     class TimerTracker
     {
     public:
-        TimerTracker()
+        static constexpr uint32_t SAMPLES_CAPACITY = 1000;
+
+        TimerTracker(const char* p_funcName, const char* p_name)
+            : _funcName(p_funcName), _name(p_name)
         {
-            std::memset(_durations, 0, sizeof(float) * _durationsLength);
-            _currentDurationIndex = 0;
-            _maxIndex = 0;
-            _totalMilliseconds = 0;
-            
-            _trackerInstances.push_back(this);
+            for (auto& duration : _durations)
+            {
+                duration.store(0.f, std::memory_order_relaxed);
+            }
+
+            _next = _trackersHead.load(std::memory_order_relaxed);
+            while (!_trackersHead.compare_exchange_weak(_next, this, std::memory_order_release, std::memory_order_relaxed))
+            { }
         }
 
-        ~TimerTracker()
+        TimerTracker(const TimerTracker&) = delete;
+        TimerTracker& operator=(const TimerTracker&) = delete;
+
+        Timer CreateTimer()
         {
-            delete _funcName;
-            delete _name;
+            return Timer(this);
         }
 
-        Timer CreateTimer(const char* p_funcName, const char* p_name)
+        void PushSample(std::chrono::steady_clock::duration p_duration)
         {
-            if (_funcName == nullptr)
-            {
-                _funcName = new char[strlen(p_funcName) + 1];
-                _name = new char[strlen(p_name) + 1];
+            using namespace std::literals;
+            const float milliseconds = static_cast<float>(p_duration / 1ns) / 1000000.f;
 
-                strcpy(const_cast<char*>(_funcName), p_funcName);
-                strcpy(const_cast<char*>(_name), p_name);
-            }
-            
-            float* currentDuration = &_durations[_currentDurationIndex];
-            _currentDurationIndex++;
+            const uint64_t index = _writeIndex.fetch_add(1, std::memory_order_relaxed);
+            _durations[index % SAMPLES_CAPACITY].store(milliseconds, std::memory_order_relaxed);
+            _totalNanoseconds.fetch_add(p_duration / 1ns, std::memory_order_relaxed);
+        }
 
-            if (_currentDurationIndex >= _durationsLength)
+        // Copies up to SAMPLES_CAPACITY most recent samples (oldest first) and returns how many were written
+        uint32_t CopySamples(float* p_output) const
+        {
+            const uint64_t writeIndex = _writeIndex.load(std::memory_order_acquire);
+            const uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(writeIndex, SAMPLES_CAPACITY));
+            const uint64_t first = writeIndex - count;
+
+            for (uint32_t i = 0; i < count; i++)
             {
-                _currentDurationIndex = 0;
+                p_output[i] = _durations[(first + i) % SAMPLES_CAPACITY].load(std::memory_order_relaxed);
             }
-            
-            _maxIndex = std::max(_currentDurationIndex, _maxIndex);
-            return Timer(currentDuration, &_totalMilliseconds);
+            return count;
         }
-        
+
+        uint64_t GetSamplesCount() const
+        { return _writeIndex.load(std::memory_order_relaxed); }
+
+        double GetTotalMilliseconds() const
+        { return static_cast<double>(_totalNanoseconds.load(std::memory_order_relaxed)) / 1000000.0; }
+
+        const std::string& GetName() const
+        { return _name; }
+
+        const std::string& GetFuncName() const
+        { return _funcName; }
+
+        const TimerTracker* GetNext() const
+        { return _next; }
+
+        static const TimerTracker* GetFirstTracker()
+        { return _trackersHead.load(std::memory_order_acquire); }
+
         static void PrintSummary()
         {
+            // List is in reverse creation order
+            std::vector<const TimerTracker*> trackers;
+            for (const TimerTracker* tracker = GetFirstTracker(); tracker != nullptr; tracker = tracker->GetNext())
+            {
+                trackers.push_back(tracker);
+            }
+
             std::string summary;
-            
-            for (int i = 0; i < _trackerInstances.size(); i++)
+            for (auto it = trackers.rbegin(); it != trackers.rend(); ++it)
             {
-                summary += _trackerInstances[i]->GetTimerSummary() + '\n';
+                summary += (*it)->GetTimerSummary() + '\n';
             }
-            
+
             fmt::print(
                 "/{0:-^147}\\\n"
                 "{1}\n"
@@ -102,44 +129,45 @@ namespace DeepEngine::Debug
                 fmt::format("| {:^85} | {:^12} | {:^12} | {:^12} | {:^12} |", "FUNCTION", "MIN", "MAX", "AVERAGE", "TOTAL"),
                 summary);
         }
-        
+
     private:
         std::string GetTimerSummary() const
         {
-            float minDuration = _durations[0];
-            float maxDuration = _durations[0];
-            
-            float averageDuration = 0.f;
-            float buffer = 0.f;
-            
-            for (int i = 0; i < _maxIndex; i++)
+            std::vector<float> samples(SAMPLES_CAPACITY);
+            const uint32_t count = CopySamples(samples.data());
+
+            float minDuration = count > 0 ? samples[0] : 0.f;
+            float maxDuration = minDuration;
+            double durationsSum = 0.0;
+
+            for (uint32_t i = 0; i < count; i++)
             {
-                buffer += _durations[i];
-                minDuration = std::min(minDuration, _durations[i]);
-                maxDuration = std::max(maxDuration, _durations[i]);
-
-                if (i % 100 == 0 || i == _maxIndex - 1)
-                {
-                    averageDuration += buffer / _maxIndex;
-                    buffer = 0.f;
-                }
+                durationsSum += samples[i];
+                minDuration = std::min(minDuration, samples[i]);
+                maxDuration = std::max(maxDuration, samples[i]);
             }
 
-            return fmt::format("| {:<64} {:>20} | {:^10.2f}ms | {:^10.2f}ms | {:^10.2f}ms | {:^10}ms |",
-                _name, _funcName, minDuration, maxDuration, averageDuration, _totalMilliseconds);
+            const float averageDuration = count > 0 ? static_cast<float>(durationsSum / count) : 0.f;
+
+            return fmt::format("| {:<64} {:>20} | {:^10.2f}ms | {:^10.2f}ms | {:^10.2f}ms | {:^10.0f}ms |",
+                _name, _funcName, minDuration, maxDuration, averageDuration, GetTotalMilliseconds());
         }
 
     private:
-        const char* _funcName;
-        const char* _name;
-
-        uint64_t _totalMilliseconds;
-        
-        const uint32_t _durationsLength = 1000;
-        uint32_t _currentDurationIndex;
-        uint32_t _maxIndex;
-        float _durations[1000];
-        
-        static std::vector<TimerTracker*> _trackerInstances;
+        const std::string _funcName;
+        const std::string _name;
+
+        std::atomic<uint64_t> _totalNanoseconds = 0;
+        std::atomic<uint64_t> _writeIndex = 0;
+        std::atomic<float> _durations[SAMPLES_CAPACITY];
+
+        TimerTracker* _next = nullptr;
+
+        static std::atomic<TimerTracker*> _trackersHead;
     };
+
+    Timer::~Timer()
+    {
+        _tracker->PushSample(std::chrono::steady_clock::now() - _startTime);
+    }
 }
@@ -1,3 +1,5 @@
+#include <cctype>
+#include <cstring>
 #include <fstream>
 #include <set>
 #include <stack>
@@ -33,10 +35,29 @@ struct MyCustomSecondSceneElement final : Core::Scene::SceneElement
 };
 
 void TestSerializer();
+void WriteFramePpm(const char* p_filepath, const Engine::Renderer::ReadbackFrame& p_frame,
+    const std::vector<uint8_t>& p_pixels);
 
 int main(int p_argc, char* p_argv[])
 {    
     Debug::Logger::Initialize("Logs/engine.log");
+
+    // "--headless [frames]" renders given number of frames without a window (e.g. on lavapipe on CI)
+    // and writes the last one to HeadlessFrame.ppm
+    bool isHeadless = false;
+    uint32_t headlessFramesCount = 100;
+    for (int i = 1; i < p_argc; i++)
+    {
+        if (std::strcmp(p_argv[i], "--headless") == 0)
+        {
+            isHeadless = true;
+            if (i + 1 < p_argc && std::isdigit(p_argv[i + 1][0]))
+            {
+                headlessFramesCount = std::max(static_cast<uint32_t>(std::stoul(p_argv[++i])), 1u);
+            }
+        }
+    }
+
     auto engineEventBus = Core::Events::EventBus();
 
     Core::Scene::Scene scene;
@@ -61,6 +82,9 @@ int main(int p_argc, char* p_argv[])
     }
 
     TestSerializer();
+
+    Engine::Renderer::ReadbackFrame lastFrame;
+    std::vector<uint8_t> lastFramePixels;
     
     {
         TIMER("Main");
@@ -74,8 +98,25 @@ int main(int p_argc, char* p_argv[])
         ENGINE_INFO("Hello World");
 
         auto subsystemsManager = Core::EngineSubsystemsManager(engineEventBus);
-        auto windowSubsystem = subsystemsManager.CreateSubsystem<WindowSubsystem>(800, 600, "1800 lines for fucking triangle (:");
-    	subsystemsManager.CreateSubsystem<Engine::Renderer::RendererSubsystem>();
+        WindowSubsystem* windowSubsystem = nullptr;
+        if (isHeadless)
+        {
+            auto renderer = subsystemsManager.CreateSubsystem<Engine::Renderer::RendererSubsystem>(
+                Engine::Renderer::HeadlessSettings { 800, 600 });
+
+            // Pixels are valid only during the callback
+            renderer->SetReadbackCallback([&lastFrame, &lastFramePixels](const Engine::Renderer::ReadbackFrame& p_frame)
+            {
+                lastFrame = p_frame;
+                lastFrame.Pixels = nullptr;
+                lastFramePixels.assign(p_frame.Pixels, p_frame.Pixels + p_frame.Width * p_frame.Height * 4);
+            });
+        }
+        else
+        {
+            windowSubsystem = subsystemsManager.CreateSubsystem<WindowSubsystem>(800, 600, "1800 lines for fucking triangle (:");
+            subsystemsManager.CreateSubsystem<Engine::Renderer::RendererSubsystem>();
+        }
 
         if (!subsystemsManager.Init())
         {
@@ -83,18 +124,33 @@ int main(int p_argc, char* p_argv[])
             return -1;
         }
 
+        uint32_t ticksCount = 0;
         while (true)
         {
             TIMER("Tick");
             
             subsystemsManager.Tick(scene);
-            if (windowSubsystem->WantsToExit())
+            ticksCount++;
+            if (isHeadless ? ticksCount >= headlessFramesCount : windowSubsystem->WantsToExit())
             {
                 break;
             }
         }
     }
 
+    // Renderer hands out the frames still in flight when it is destroyed
+    if (isHeadless)
+    {
+        if (lastFramePixels.empty())
+        {
+            ENGINE_INFO("Headless renderer did not read back any frame!");
+            return -1;
+        }
+        WriteFramePpm("HeadlessFrame.ppm", lastFrame, lastFramePixels);
+        ENGINE_INFO("Rendered {} frames headless, last one ({}x{}) written to HeadlessFrame.ppm",
+            lastFrame.FrameNumber + 1, lastFrame.Width, lastFrame.Height);
+    }
+
     PRINT_TIMER_SUMMARY();
     return 0;
 }
@@ -126,4 +182,28 @@ void TestSerializer()
         file << out.c_str();
         file.close();
     }
-}
\ No newline at end of file
+}
+
+void WriteFramePpm(const char* p_filepath, const Engine::Renderer::ReadbackFrame& p_frame,
+    const std::vector<uint8_t>& p_pixels)
+{
+    TIMER("Writing headless frame");
+    const bool isBgra = p_frame.Format == VK_FORMAT_B8G8R8A8_UNORM || p_frame.Format == VK_FORMAT_B8G8R8A8_SRGB;
+
+    std::ofstream file(p_filepath, std::ios::out | std::ios::binary);
+    file << "P6\n" << p_frame.Width << " " << p_frame.Height << "\n255\n";
+
+    // Alpha is dropped, sRGB values are written as they are
+    std::vector<char> row(p_frame.Width * 3);
+    for (uint32_t y = 0; y < p_frame.Height; y++)
+    {
+        const uint8_t* texel = p_pixels.data() + static_cast<size_t>(y) * p_frame.Width * 4;
+        for (uint32_t x = 0; x < p_frame.Width; x++, texel += 4)
+        {
+            row[x * 3 + 0] = static_cast<char>(texel[isBgra ? 2 : 0]);
+            row[x * 3 + 1] = static_cast<char>(texel[1]);
+            row[x * 3 + 2] = static_cast<char>(texel[isBgra ? 0 : 2]);
+        }
+        file.write(row.data(), static_cast<std::streamsize>(row.size()));
+    }
+}
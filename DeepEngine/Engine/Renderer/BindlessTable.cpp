@@ -0,0 +1,212 @@
+#include "BindlessTable.h"
+
+#include <algorithm>
+#include <array>
+
+namespace DeepEngine::Engine::Renderer
+{
+    BindlessTable::BindlessTable(Vulkan::VulkanInstance* p_vulkanInstance, uint32_t p_framesInFlight,
+        uint32_t p_maxSampledImages, uint32_t p_maxStorageBuffers)
+        : _vulkanInstance(p_vulkanInstance), _framesInFlight(p_framesInFlight)
+    {
+        _sampledImages.Capacity = p_maxSampledImages;
+        _storageBuffers.Capacity = p_maxStorageBuffers;
+    }
+
+    BindlessTable::~BindlessTable()
+    {
+        // Frees the set too
+        vkDestroyDescriptorPool(_vulkanInstance->GetLogicalDevice(), _descriptorPool, nullptr);
+
+        if (_descriptorSetLayout != nullptr)
+        {
+            _descriptorSetLayout->Terminate();
+        }
+    }
+
+    bool BindlessTable::Initialize()
+    {
+        if (!_vulkanInstance->IsDescriptorIndexingEnabled())
+        {
+            VULKAN_ERR("Bindless table needs descriptor indexing, which is not enabled");
+            return false;
+        }
+
+        VkPhysicalDeviceVulkan12Properties vulkan12Properties { };
+        vulkan12Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+        VkPhysicalDeviceProperties2 properties2 { };
+        properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties2.pNext = &vulkan12Properties;
+        vkGetPhysicalDeviceProperties2(_vulkanInstance->GetPhysicalDevice(), &properties2);
+
+        _sampledImages.Capacity = std::min({ _sampledImages.Capacity,
+            vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+            vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSamplers,
+            vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages,
+            vulkan12Properties.maxDescriptorSetUpdateAfterBindSamplers });
+        _storageBuffers.Capacity = std::min({ _storageBuffers.Capacity,
+            vulkan12Properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+            vulkan12Properties.maxDescriptorSetUpdateAfterBindStorageBuffers });
+
+        VULKAN_INFO("Bindless table holds {} sampled images and {} storage buffers", _sampledImages.Capacity,
+            _storageBuffers.Capacity);
+
+        std::vector<VkDescriptorSetLayoutBinding> bindings(2);
+        bindings[SAMPLED_IMAGES_BINDING].binding = SAMPLED_IMAGES_BINDING;
+        bindings[SAMPLED_IMAGES_BINDING].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[SAMPLED_IMAGES_BINDING].descriptorCount = _sampledImages.Capacity;
+        bindings[SAMPLED_IMAGES_BINDING].stageFlags = VK_SHADER_STAGE_ALL;
+
+        bindings[STORAGE_BUFFERS_BINDING].binding = STORAGE_BUFFERS_BINDING;
+        bindings[STORAGE_BUFFERS_BINDING].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[STORAGE_BUFFERS_BINDING].descriptorCount = _storageBuffers.Capacity;
+        bindings[STORAGE_BUFFERS_BINDING].stageFlags = VK_SHADER_STAGE_ALL;
+
+        // Slots which are not written yet (or removed) are never read, so they do not have to be valid
+        constexpr VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+            | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+            | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+        _descriptorSetLayout = new Vulkan::DescriptorSetLayout(bindings,
+            VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT, { bindingFlags, bindingFlags });
+        if (!_vulkanInstance->InitializeSubController(_descriptorSetLayout))
+        {
+            return false;
+        }
+
+        std::array<VkDescriptorPoolSize, 2> poolSizes { };
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[0].descriptorCount = _sampledImages.Capacity;
+        poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[1].descriptorCount = _storageBuffers.Capacity;
+
+        VkDescriptorPoolCreateInfo poolInfo { };
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+        poolInfo.maxSets = 1;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+
+        VULKAN_CHECK_CREATE(
+            vkCreateDescriptorPool(_vulkanInstance->GetLogicalDevice(), &poolInfo, nullptr, &_descriptorPool),
+            "Failed to create bindless descriptor pool!")
+
+        const VkDescriptorSetLayout setLayout = _descriptorSetLayout->GetVkDescriptorSetLayout();
+
+        VkDescriptorSetAllocateInfo allocateInfo { };
+        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool = _descriptorPool;
+        allocateInfo.descriptorSetCount = 1;
+        allocateInfo.pSetLayouts = &setLayout;
+
+        VULKAN_CHECK_CREATE(
+            vkAllocateDescriptorSets(_vulkanInstance->GetLogicalDevice(), &allocateInfo, &_descriptorSet),
+            "Failed to allocate bindless descriptor set!")
+
+        return true;
+    }
+
+    void BindlessTable::BeginFrame()
+    {
+        _frame++;
+        _sampledImages.Recycle(_frame, _framesInFlight);
+        _storageBuffers.Recycle(_frame, _framesInFlight);
+    }
+
+    uint32_t BindlessTable::AddSampledImage(VkImageView p_imageView, VkSampler p_sampler, VkImageLayout p_layout)
+    {
+        const uint32_t index = _sampledImages.Allocate();
+        if (index == INVALID_INDEX)
+        {
+            VULKAN_WARN("Bindless table can not hold more than {} sampled images", _sampledImages.Capacity);
+            return INVALID_INDEX;
+        }
+
+        VkDescriptorImageInfo imageInfo { };
+        imageInfo.imageView = p_imageView;
+        imageInfo.sampler = p_sampler;
+        imageInfo.imageLayout = p_layout;
+
+        VkWriteDescriptorSet write { };
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = _descriptorSet;
+        write.dstBinding = SAMPLED_IMAGES_BINDING;
+        write.dstArrayElement = index;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = &imageInfo;
+
+        vkUpdateDescriptorSets(_vulkanInstance->GetLogicalDevice(), 1, &write, 0, nullptr);
+        return index;
+    }
+
+    uint32_t BindlessTable::AddStorageBuffer(const Vulkan::Buffer* p_buffer)
+    {
+        const uint32_t index = _storageBuffers.Allocate();
+        if (index == INVALID_INDEX)
+        {
+            VULKAN_WARN("Bindless table can not hold more than {} storage buffers", _storageBuffers.Capacity);
+            return INVALID_INDEX;
+        }
+
+        VkDescriptorBufferInfo bufferInfo { };
+        bufferInfo.buffer = p_buffer->GetVkBuffer();
+        bufferInfo.offset = 0;
+        bufferInfo.range = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet write { };
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = _descriptorSet;
+        write.dstBinding = STORAGE_BUFFERS_BINDING;
+        write.dstArrayElement = index;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.pBufferInfo = &bufferInfo;
+
+        vkUpdateDescriptorSets(_vulkanInstance->GetLogicalDevice(), 1, &write, 0, nullptr);
+        return index;
+    }
+
+    void BindlessTable::RemoveSampledImage(uint32_t p_index)
+    {
+        _sampledImages.RetiredSlots.push_back({ p_index, _frame });
+    }
+
+    void BindlessTable::RemoveStorageBuffer(uint32_t p_index)
+    {
+        _storageBuffers.RetiredSlots.push_back({ p_index, _frame });
+    }
+
+    void BindlessTable::Bind(VkCommandBuffer p_commandBuffer, VkPipelineBindPoint p_bindPoint,
+        const Vulkan::PipelineLayout* p_pipelineLayout) const
+    {
+        vkCmdBindDescriptorSets(p_commandBuffer, p_bindPoint, p_pipelineLayout->GetVkPipelineLayout(), 0, 1,
+            &_descriptorSet, 0, nullptr);
+    }
+
+    uint32_t BindlessTable::SlotArray::Allocate()
+    {
+        if (!FreeSlots.empty())
+        {
+            const uint32_t index = FreeSlots.back();
+            FreeSlots.pop_back();
+            return index;
+        }
+
+        if (UsedCount == Capacity)
+        {
+            return INVALID_INDEX;
+        }
+        return UsedCount++;
+    }
+
+    void BindlessTable::SlotArray::Recycle(uint64_t p_frame, uint32_t p_framesInFlight)
+    {
+        // Retired in frame order, so the oldest ones are at the front
+        while (!RetiredSlots.empty() && p_frame - RetiredSlots.front().Frame >= p_framesInFlight)
+        {
+            FreeSlots.push_back(RetiredSlots.front().Index);
+            RetiredSlots.pop_front();
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <deque>
+
+#include "Vulkan/Buffer.h"
+#include "Vulkan/DescriptorSetLayout.h"
+#include "Vulkan/PipelineLayout.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+
+    // One descriptor set holding every texture and storage buffer of the renderer, shaders address them by index:
+    // binding SAMPLED_IMAGES_BINDING is an array of combined image samplers, STORAGE_BUFFERS_BINDING of storage
+    // buffers. Arrays are partially bound and updated after bind, so the set is bound once per command buffer
+    // and adding resources never waits for the GPU. Slot of a removed resource is reused only after frames in flight
+    // passed, until then pending frames may still read it. Needs VulkanInstance::IsDescriptorIndexingEnabled.
+    class BindlessTable
+    {
+    public:
+        static constexpr uint32_t SAMPLED_IMAGES_BINDING = 0;
+        static constexpr uint32_t STORAGE_BUFFERS_BINDING = 1;
+        static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+        static constexpr uint32_t DEFAULT_MAX_SAMPLED_IMAGES = 16 * 1024;
+        static constexpr uint32_t DEFAULT_MAX_STORAGE_BUFFERS = 16 * 1024;
+
+        // Capacities are clamped to the device update after bind limits
+        BindlessTable(Vulkan::VulkanInstance* p_vulkanInstance, uint32_t p_framesInFlight,
+            uint32_t p_maxSampledImages = DEFAULT_MAX_SAMPLED_IMAGES,
+            uint32_t p_maxStorageBuffers = DEFAULT_MAX_STORAGE_BUFFERS);
+        ~BindlessTable();
+
+        BindlessTable(const BindlessTable&) = delete;
+        BindlessTable& operator=(const BindlessTable&) = delete;
+
+        bool Initialize();
+
+        // Frame fence has to be waited, recycles slots removed frames in flight ago
+        void BeginFrame();
+
+        // Return index to use in shaders, INVALID_INDEX when the table is full
+        uint32_t AddSampledImage(VkImageView p_imageView, VkSampler p_sampler,
+            VkImageLayout p_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        uint32_t AddStorageBuffer(const Vulkan::Buffer* p_buffer);
+
+        // Descriptor is left in place, shaders must not read the index anymore
+        void RemoveSampledImage(uint32_t p_index);
+        void RemoveStorageBuffer(uint32_t p_index);
+
+        // Set index 0 of layouts made with GetDescriptorSetLayout
+        void Bind(VkCommandBuffer p_commandBuffer, VkPipelineBindPoint p_bindPoint,
+            const Vulkan::PipelineLayout* p_pipelineLayout) const;
+
+        const Vulkan::DescriptorSetLayout* GetDescriptorSetLayout() const
+        { return _descriptorSetLayout; }
+
+        VkDescriptorSet GetVkDescriptorSet() const
+        { return _descriptorSet; }
+
+        uint32_t GetMaxSampledImages() const
+        { return _sampledImages.Capacity; }
+
+        uint32_t GetMaxStorageBuffers() const
+        { return _storageBuffers.Capacity; }
+
+    private:
+        struct RetiredSlot
+        {
+            uint32_t Index;
+            uint64_t Frame;
+        };
+
+        // Never used slots are handed out in order, freed ones are reused first
+        struct SlotArray
+        {
+            uint32_t Capacity = 0;
+            uint32_t UsedCount = 0;
+            std::vector<uint32_t> FreeSlots;
+            std::deque<RetiredSlot> RetiredSlots;
+
+            uint32_t Allocate();
+            void Recycle(uint64_t p_frame, uint32_t p_framesInFlight);
+        };
+
+    private:
+        Vulkan::VulkanInstance* _vulkanInstance;
+        const uint32_t _framesInFlight;
+        uint64_t _frame = 0;
+
+        SlotArray _sampledImages;
+        SlotArray _storageBuffers;
+
+        Vulkan::DescriptorSetLayout* _descriptorSetLayout = nullptr;
+        VkDescriptorPool _descriptorPool = VK_NULL_HANDLE;
+        VkDescriptorSet _descriptorSet = VK_NULL_HANDLE;
+    };
+
+}
@@ -0,0 +1,129 @@
+#include "DescriptorAllocator.h"
+
+#include <algorithm>
+
+namespace DeepEngine::Engine::Renderer
+{
+    DescriptorAllocator::DescriptorAllocator(Vulkan::VulkanInstance* p_vulkanInstance, uint32_t p_framesInFlight,
+        uint32_t p_setsPerPool, const std::vector<PoolSizeRatio>& p_poolSizeRatios)
+        : _vulkanInstance(p_vulkanInstance), _setsPerPool(p_setsPerPool), _poolSizeRatios(p_poolSizeRatios),
+        _frames(p_framesInFlight)
+    { }
+
+    DescriptorAllocator::~DescriptorAllocator()
+    {
+        for (const FramePools& frame : _frames)
+        {
+            for (const VkDescriptorPool pool : frame.Pools)
+            {
+                vkDestroyDescriptorPool(_vulkanInstance->GetLogicalDevice(), pool, nullptr);
+            }
+        }
+    }
+
+    void DescriptorAllocator::BeginFrame(uint32_t p_frameIndex)
+    {
+        _frameIndex = p_frameIndex;
+        FramePools& frame = _frames[p_frameIndex];
+
+        // Pools after the current one were not touched since their last reset
+        const uint32_t usedPools = std::min(frame.CurrentPool + 1, static_cast<uint32_t>(frame.Pools.size()));
+        for (uint32_t i = 0; i < usedPools; i++)
+        {
+            vkResetDescriptorPool(_vulkanInstance->GetLogicalDevice(), frame.Pools[i], 0);
+        }
+
+        frame.CurrentPool = 0;
+        frame.AllocatedSets = 0;
+    }
+
+    VkDescriptorSet DescriptorAllocator::Allocate(const Vulkan::DescriptorSetLayout* p_layout)
+    {
+        FramePools& frame = _frames[_frameIndex];
+        const VkDescriptorSetLayout setLayout = p_layout->GetVkDescriptorSetLayout();
+
+        // Second attempt goes to an empty pool, failing there means the layout never fits
+        for (uint32_t attempt = 0; attempt < 2; attempt++)
+        {
+            if (frame.CurrentPool == frame.Pools.size())
+            {
+                const VkDescriptorPool pool = CreatePool();
+                if (pool == VK_NULL_HANDLE)
+                {
+                    return VK_NULL_HANDLE;
+                }
+                frame.Pools.push_back(pool);
+            }
+
+            VkDescriptorSetAllocateInfo allocateInfo { };
+            allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocateInfo.descriptorPool = frame.Pools[frame.CurrentPool];
+            allocateInfo.descriptorSetCount = 1;
+            allocateInfo.pSetLayouts = &setLayout;
+
+            VkDescriptorSet descriptorSet;
+            const VkResult result = vkAllocateDescriptorSets(_vulkanInstance->GetLogicalDevice(), &allocateInfo,
+                &descriptorSet);
+
+            if (result == VK_SUCCESS)
+            {
+                frame.AllocatedSets++;
+                return descriptorSet;
+            }
+
+            if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+            {
+                VULKAN_ERR("Failed to allocate descriptor set with returned result {}", string_VkResult(result));
+                return VK_NULL_HANDLE;
+            }
+
+            // Chain the next pool, this one stays full until the frame comes around again
+            frame.CurrentPool++;
+        }
+
+        VULKAN_ERR("Descriptor set layout does not fit into an empty pool of {} sets", _setsPerPool);
+        return VK_NULL_HANDLE;
+    }
+
+    DescriptorAllocatorStatistics DescriptorAllocator::GetStatistics() const
+    {
+        const FramePools& frame = _frames[_frameIndex];
+
+        DescriptorAllocatorStatistics statistics;
+        statistics.AllocatedSets = frame.AllocatedSets;
+        statistics.UsedPools = frame.AllocatedSets == 0 ? 0 : frame.CurrentPool + 1;
+        for (const FramePools& otherFrame : _frames)
+        {
+            statistics.TotalPools += static_cast<uint32_t>(otherFrame.Pools.size());
+        }
+        return statistics;
+    }
+
+    VkDescriptorPool DescriptorAllocator::CreatePool() const
+    {
+        std::vector<VkDescriptorPoolSize> poolSizes(_poolSizeRatios.size());
+        for (uint32_t i = 0; i < poolSizes.size(); i++)
+        {
+            poolSizes[i].type = _poolSizeRatios[i].Type;
+            poolSizes[i].descriptorCount = std::max(1u,
+                static_cast<uint32_t>(_poolSizeRatios[i].Ratio * static_cast<float>(_setsPerPool)));
+        }
+
+        // No FREE_DESCRIPTOR_SET flag, sets are only released by resetting the whole pool
+        VkDescriptorPoolCreateInfo poolInfo { };
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags = 0;
+        poolInfo.maxSets = _setsPerPool;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+
+        VkDescriptorPool pool;
+        const VkResult result = vkCreateDescriptorPool(_vulkanInstance->GetLogicalDevice(), &poolInfo, nullptr, &pool);
+        if (result != VK_SUCCESS)
+        {
+            VULKAN_ERR("Failed to create descriptor pool with returned result {}", string_VkResult(result));
+            return VK_NULL_HANDLE;
+        }
+        return pool;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "Vulkan/DescriptorSetLayout.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+
+    struct DescriptorAllocatorStatistics
+    {
+        uint32_t AllocatedSets = 0;
+        // Pools of the frame which had at least one set allocated
+        uint32_t UsedPools = 0;
+        // Pools of all frames, they are kept once created
+        uint32_t TotalPools = 0;
+    };
+
+    // Transient descriptor sets valid until the frame they were allocated in is finished on the GPU.
+    // Every frame in flight has its own chain of pools, sets are allocated linearly from the current pool
+    // and the next one is taken (or created) when it runs out. Sets are never freed one by one, BeginFrame
+    // resets all pools of the frame at once, so allocation cost does not depend on the count of sets and pools
+    // do not fragment. Not thread safe, allocate from the thread which calls BeginFrame.
+    class DescriptorAllocator
+    {
+    public:
+        struct PoolSizeRatio
+        {
+            VkDescriptorType Type;
+            // Descriptors of the type per set in the pool
+            float Ratio;
+        };
+
+        static constexpr uint32_t DEFAULT_SETS_PER_POOL = 256;
+
+        DescriptorAllocator(Vulkan::VulkanInstance* p_vulkanInstance, uint32_t p_framesInFlight,
+            uint32_t p_setsPerPool = DEFAULT_SETS_PER_POOL, const std::vector<PoolSizeRatio>& p_poolSizeRatios = {
+                { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f },
+                { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3.0f },
+                { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2.0f },
+                { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f },
+            });
+        ~DescriptorAllocator();
+
+        DescriptorAllocator(const DescriptorAllocator&) = delete;
+        DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+        // Frame fence has to be waited, all sets allocated in the frame before become invalid
+        void BeginFrame(uint32_t p_frameIndex);
+
+        // VK_NULL_HANDLE on failure. Layout has to fit into one pool
+        VkDescriptorSet Allocate(const Vulkan::DescriptorSetLayout* p_layout);
+
+        DescriptorAllocatorStatistics GetStatistics() const;
+
+    private:
+        struct FramePools
+        {
+            std::vector<VkDescriptorPool> Pools;
+            // Pools before it are full
+            uint32_t CurrentPool = 0;
+            uint32_t AllocatedSets = 0;
+        };
+
+        VkDescriptorPool CreatePool() const;
+
+    private:
+        Vulkan::VulkanInstance* _vulkanInstance;
+        const uint32_t _setsPerPool;
+        const std::vector<PoolSizeRatio> _poolSizeRatios;
+
+        std::vector<FramePools> _frames;
+        uint32_t _frameIndex = 0;
+    };
+
+}
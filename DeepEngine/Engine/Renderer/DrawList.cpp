@@ -0,0 +1,231 @@
+#include "DrawList.h"
+
+#include <cstring>
+
+namespace DeepEngine::Engine::Renderer
+{
+    DrawListStatistics& DrawListStatistics::operator+=(const DrawListStatistics& p_other)
+    {
+        Draws += p_other.Draws;
+        IndirectDraws += p_other.IndirectDraws;
+        PipelineBinds += p_other.PipelineBinds;
+        DescriptorSetBinds += p_other.DescriptorSetBinds;
+        VertexBufferBinds += p_other.VertexBufferBinds;
+        IndexBufferBinds += p_other.IndexBufferBinds;
+        PushConstants += p_other.PushConstants;
+        UnsortedPipelineBinds += p_other.UnsortedPipelineBinds;
+        return *this;
+    }
+
+    void DrawList::Clear()
+    {
+        _packets.clear();
+        _pushConstants.clear();
+        _sortEntries.clear();
+        _unsortedPipelineBinds = 0;
+    }
+
+    void DrawList::Add(uint64_t p_sortKey, const DrawPacket& p_packet,
+        const void* p_pushConstants, uint32_t p_pushConstantsSize)
+    {
+        if (_packets.empty() || _packets.back().Pipeline != p_packet.Pipeline)
+        {
+            _unsortedPipelineBinds++;
+        }
+
+        DrawPacket& packet = _packets.emplace_back(p_packet);
+        packet.PushConstantsOffset = 0;
+        packet.PushConstantsSize = 0;
+
+        if (p_pushConstants != nullptr && p_pushConstantsSize > 0)
+        {
+            packet.PushConstantsOffset = static_cast<uint32_t>(_pushConstants.size());
+            packet.PushConstantsSize = p_pushConstantsSize;
+
+            const auto bytes = static_cast<const uint8_t*>(p_pushConstants);
+            _pushConstants.insert(_pushConstants.end(), bytes, bytes + p_pushConstantsSize);
+        }
+
+        _sortEntries.push_back({ p_sortKey, static_cast<uint32_t>(_packets.size() - 1) });
+    }
+
+    void DrawList::Sort()
+    {
+        // LSD radix sort, 8 bits per pass. Stable, so packets with equal keys keep submission order
+        constexpr uint32_t RADIX_BITS = 8;
+        constexpr uint32_t BUCKETS_COUNT = 1 << RADIX_BITS;
+        constexpr uint32_t PASSES_COUNT = 64 / RADIX_BITS;
+
+        const size_t count = _sortEntries.size();
+        if (count < 2)
+        {
+            return;
+        }
+
+        // All histograms in one read of the keys
+        std::array<std::array<uint32_t, BUCKETS_COUNT>, PASSES_COUNT> histograms { };
+        for (const SortEntry& entry : _sortEntries)
+        {
+            for (uint32_t pass = 0; pass < PASSES_COUNT; pass++)
+            {
+                histograms[pass][(entry.Key >> (pass * RADIX_BITS)) & (BUCKETS_COUNT - 1)]++;
+            }
+        }
+
+        _sortScratch.resize(count);
+        for (uint32_t pass = 0; pass < PASSES_COUNT; pass++)
+        {
+            auto& histogram = histograms[pass];
+            const uint32_t shift = pass * RADIX_BITS;
+
+            // Every key has the same digit (e.g. unused depth or layer bits), pass would not move anything
+            if (histogram[(_sortEntries[0].Key >> shift) & (BUCKETS_COUNT - 1)] == count)
+            {
+                continue;
+            }
+
+            uint32_t offset = 0;
+            for (uint32_t& bucket : histogram)
+            {
+                const uint32_t bucketSize = bucket;
+                bucket = offset;
+                offset += bucketSize;
+            }
+
+            for (const SortEntry& entry : _sortEntries)
+            {
+                _sortScratch[histogram[(entry.Key >> shift) & (BUCKETS_COUNT - 1)]++] = entry;
+            }
+            _sortEntries.swap(_sortScratch);
+        }
+    }
+
+    bool DrawList::IsSamePushed(const DrawPacket& p_packet, const DrawPacket* p_lastPushed,
+        const Vulkan::PipelineLayout* p_layout, const Vulkan::PipelineLayout* p_pushedLayout) const
+    {
+        // Pushed values survive pipeline binds only between layouts with identical push constant ranges
+        if (p_lastPushed == nullptr || !p_layout->HasSamePushConstantRanges(p_pushedLayout))
+        {
+            return false;
+        }
+
+        return p_lastPushed->PushConstantsStages == p_packet.PushConstantsStages
+            && p_lastPushed->PushConstantsSize == p_packet.PushConstantsSize
+            && memcmp(_pushConstants.data() + p_lastPushed->PushConstantsOffset,
+                _pushConstants.data() + p_packet.PushConstantsOffset, p_packet.PushConstantsSize) == 0;
+    }
+
+    void DrawList::Record(VkCommandBuffer p_commandBuffer, uint32_t p_begin, uint32_t p_end,
+        DrawListStatistics& p_statistics, bool p_isDepthPrePass) const
+    {
+        const DrawPacket* previous = nullptr;
+        const Vulkan::GraphicsPipeline* boundPipeline = nullptr;
+
+        VkDescriptorSet boundSet = VK_NULL_HANDLE;
+        const Vulkan::PipelineLayout* boundSetLayout = nullptr;
+        const DrawPacket* lastPushed = nullptr;
+        const Vulkan::PipelineLayout* pushedLayout = nullptr;
+
+        // Global set stays bound for the whole range, packets never disturb it as they bind only sets after it
+        const uint32_t packetSetIndex = _globalDescriptorSet != VK_NULL_HANDLE ? 1 : 0;
+        if (_globalDescriptorSet != VK_NULL_HANDLE && p_begin < p_end)
+        {
+            vkCmdBindDescriptorSets(p_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                _globalDescriptorSetLayout->GetVkPipelineLayout(), 0, 1, &_globalDescriptorSet, 0, nullptr);
+            p_statistics.DescriptorSetBinds++;
+        }
+
+        for (uint32_t i = p_begin; i < p_end; i++)
+        {
+            const DrawPacket& packet = _packets[_sortEntries[i].PacketIndex];
+            const Vulkan::GraphicsPipeline* pipeline = p_isDepthPrePass ? packet.DepthPipeline : packet.Pipeline;
+            if (pipeline == nullptr)
+            {
+                continue;
+            }
+
+            const Vulkan::PipelineLayout* layout = pipeline->GetPipelineLayout();
+            if (boundPipeline != pipeline)
+            {
+                vkCmdBindPipeline(p_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->GetVkPipeline());
+                p_statistics.PipelineBinds++;
+                boundPipeline = pipeline;
+            }
+
+            // Set stays usable by every pipeline with layout compatible with the one it was bound with
+            if (packet.DescriptorSet != VK_NULL_HANDLE
+                && (boundSet != packet.DescriptorSet || !layout->IsCompatibleForSet(boundSetLayout, packetSetIndex)))
+            {
+                vkCmdBindDescriptorSets(p_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    layout->GetVkPipelineLayout(), packetSetIndex, 1, &packet.DescriptorSet, 0, nullptr);
+                p_statistics.DescriptorSetBinds++;
+
+                boundSet = packet.DescriptorSet;
+                boundSetLayout = layout;
+            }
+
+            if (packet.VertexBuffer != VK_NULL_HANDLE
+                && (previous == nullptr || previous->VertexBuffer != packet.VertexBuffer
+                    || previous->VertexBufferOffset != packet.VertexBufferOffset))
+            {
+                vkCmdBindVertexBuffers(p_commandBuffer, 0, 1, &packet.VertexBuffer, &packet.VertexBufferOffset);
+                p_statistics.VertexBufferBinds++;
+            }
+
+            if (packet.InstanceBuffer != VK_NULL_HANDLE
+                && (previous == nullptr || previous->InstanceBuffer != packet.InstanceBuffer
+                    || previous->InstanceBufferOffset != packet.InstanceBufferOffset))
+            {
+                vkCmdBindVertexBuffers(p_commandBuffer, 1, 1, &packet.InstanceBuffer, &packet.InstanceBufferOffset);
+                p_statistics.VertexBufferBinds++;
+            }
+
+            if (packet.IndexBuffer != VK_NULL_HANDLE
+                && (previous == nullptr || previous->IndexBuffer != packet.IndexBuffer
+                    || previous->IndexBufferOffset != packet.IndexBufferOffset
+                    || previous->IndexType != packet.IndexType))
+            {
+                vkCmdBindIndexBuffer(p_commandBuffer, packet.IndexBuffer, packet.IndexBufferOffset, packet.IndexType);
+                p_statistics.IndexBufferBinds++;
+            }
+
+            if (packet.PushConstantsSize > 0 && !IsSamePushed(packet, lastPushed, layout, pushedLayout))
+            {
+                vkCmdPushConstants(p_commandBuffer, layout->GetVkPipelineLayout(), packet.PushConstantsStages,
+                    0, packet.PushConstantsSize, _pushConstants.data() + packet.PushConstantsOffset);
+                p_statistics.PushConstants++;
+
+                lastPushed = &packet;
+                pushedLayout = layout;
+            }
+
+            if (packet.IndirectBuffer != VK_NULL_HANDLE)
+            {
+                if (packet.IndexBuffer != VK_NULL_HANDLE)
+                {
+                    vkCmdDrawIndexedIndirect(p_commandBuffer, packet.IndirectBuffer, packet.IndirectBufferOffset,
+                        packet.IndirectDrawsCount, sizeof(VkDrawIndexedIndirectCommand));
+                }
+                else
+                {
+                    vkCmdDrawIndirect(p_commandBuffer, packet.IndirectBuffer, packet.IndirectBufferOffset,
+                        packet.IndirectDrawsCount, sizeof(VkDrawIndirectCommand));
+                }
+                p_statistics.IndirectDraws++;
+            }
+            else if (packet.IndexBuffer != VK_NULL_HANDLE)
+            {
+                vkCmdDrawIndexed(p_commandBuffer, packet.ElementsCount, packet.InstancesCount, packet.FirstElement,
+                    packet.VertexOffset, packet.FirstInstance);
+            }
+            else
+            {
+                vkCmdDraw(p_commandBuffer, packet.ElementsCount, packet.InstancesCount, packet.FirstElement,
+                    packet.FirstInstance);
+            }
+            p_statistics.Draws++;
+
+            previous = &packet;
+        }
+    }
+}
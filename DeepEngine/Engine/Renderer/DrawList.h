@@ -0,0 +1,132 @@
+#pragma once
+#include "Vulkan/GraphicsPipeline.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+
+    // Everything needed to record one draw. Handles left as VK_NULL_HANDLE are not bound,
+    // draw is indexed when IndexBuffer is set. With IndirectBuffer set draw parameters are read from it
+    // (VkDrawIndexedIndirectCommand or VkDrawIndirectCommand) and counts below are ignored.
+    struct DrawPacket
+    {
+        const Vulkan::GraphicsPipeline* Pipeline = nullptr;
+        // Depth only variant of Pipeline for the depth pre-pass, packets without it are drawn only in the shading
+        // subpass (which then has to test and write depth on its own)
+        const Vulkan::GraphicsPipeline* DepthPipeline = nullptr;
+        // Bound after the list global set, if there is one
+        VkDescriptorSet DescriptorSet = VK_NULL_HANDLE;
+        VkBuffer VertexBuffer = VK_NULL_HANDLE;
+        VkDeviceSize VertexBufferOffset = 0;
+        // Per instance attributes, bound to binding 1
+        VkBuffer InstanceBuffer = VK_NULL_HANDLE;
+        VkDeviceSize InstanceBufferOffset = 0;
+        VkBuffer IndexBuffer = VK_NULL_HANDLE;
+        VkDeviceSize IndexBufferOffset = 0;
+        VkIndexType IndexType = VK_INDEX_TYPE_UINT32;
+
+        // Count of vertices, or indices for indexed draw
+        uint32_t ElementsCount = 0;
+        uint32_t InstancesCount = 1;
+        uint32_t FirstElement = 0;
+        int32_t VertexOffset = 0;
+        uint32_t FirstInstance = 0;
+
+        VkBuffer IndirectBuffer = VK_NULL_HANDLE;
+        VkDeviceSize IndirectBufferOffset = 0;
+        uint32_t IndirectDrawsCount = 1;
+
+        // Range inside DrawList push constants storage, filled by DrawList::Add
+        VkShaderStageFlags PushConstantsStages = 0;
+        uint32_t PushConstantsOffset = 0;
+        uint32_t PushConstantsSize = 0;
+    };
+
+    struct DrawListStatistics
+    {
+        uint32_t Draws = 0;
+        // Part of Draws, instance counts of those are known only to the GPU
+        uint32_t IndirectDraws = 0;
+        uint32_t PipelineBinds = 0;
+        uint32_t DescriptorSetBinds = 0;
+        uint32_t VertexBufferBinds = 0;
+        uint32_t IndexBufferBinds = 0;
+        uint32_t PushConstants = 0;
+        // Pipeline binds the same packets would need in submission order, to see what sorting saves
+        uint32_t UnsortedPipelineBinds = 0;
+
+        DrawListStatistics& operator+=(const DrawListStatistics& p_other);
+    };
+
+    // Draw packets gathered during the frame, sorted by 64 bit key before recording.
+    // Key layout (most significant first): layer 8 bits | pipeline 24 bits | material 16 bits | depth 16 bits,
+    // so recording visits all draws of a pipeline together and within it all draws of a descriptor set.
+    // Recording emits only state that differs from the previous packet. Descriptor sets and push constants are kept
+    // across pipelines with compatible layouts (see Vulkan::PipelineLayout), so sharing layouts saves rebinding them.
+    class DrawList
+    {
+    public:
+        static uint64_t MakeSortKey(uint8_t p_layer, uint32_t p_pipelineID, uint16_t p_materialID, uint16_t p_depth)
+        {
+            return (static_cast<uint64_t>(p_layer) << 56)
+                | (static_cast<uint64_t>(p_pipelineID & 0xFFFFFF) << 32)
+                | (static_cast<uint64_t>(p_materialID) << 16)
+                | static_cast<uint64_t>(p_depth);
+        }
+
+        void Clear();
+
+        // Bound as set 0 at the start of every recorded range (e.g. BindlessTable), kept by Clear.
+        // Layout has to be compatible for set 0 with layouts of all pipelines in the list
+        void SetGlobalDescriptorSet(VkDescriptorSet p_descriptorSet, const Vulkan::PipelineLayout* p_layout)
+        {
+            _globalDescriptorSet = p_descriptorSet;
+            _globalDescriptorSetLayout = p_layout;
+        }
+
+        // Push constants are copied into the list storage
+        void Add(uint64_t p_sortKey, const DrawPacket& p_packet,
+            const void* p_pushConstants = nullptr, uint32_t p_pushConstantsSize = 0);
+
+        // Adds packet with key made from its pipeline, on layer 0
+        void Add(const DrawPacket& p_packet)
+        {
+            Add(MakeSortKey(0, p_packet.Pipeline->GetSortID(), 0, 0), p_packet);
+        }
+
+        void Sort();
+
+        // Records sorted packets in range [p_begin, p_end), starts with no state bound. Depth pre-pass binds
+        // DepthPipeline instead of Pipeline and skips packets which have none
+        void Record(VkCommandBuffer p_commandBuffer, uint32_t p_begin, uint32_t p_end,
+            DrawListStatistics& p_statistics, bool p_isDepthPrePass = false) const;
+
+        uint32_t GetPacketsCount() const
+        { return static_cast<uint32_t>(_packets.size()); }
+
+        uint32_t GetUnsortedPipelineBinds() const
+        { return _unsortedPipelineBinds; }
+
+    private:
+        struct SortEntry
+        {
+            uint64_t Key;
+            uint32_t PacketIndex;
+        };
+
+        bool IsSamePushed(const DrawPacket& p_packet, const DrawPacket* p_lastPushed,
+            const Vulkan::PipelineLayout* p_layout, const Vulkan::PipelineLayout* p_pushedLayout) const;
+
+    private:
+        std::vector<DrawPacket> _packets;
+        std::vector<uint8_t> _pushConstants;
+
+        std::vector<SortEntry> _sortEntries;
+        std::vector<SortEntry> _sortScratch;
+
+        uint32_t _unsortedPipelineBinds = 0;
+
+        VkDescriptorSet _globalDescriptorSet = VK_NULL_HANDLE;
+        const Vulkan::PipelineLayout* _globalDescriptorSetLayout = nullptr;
+    };
+
+}
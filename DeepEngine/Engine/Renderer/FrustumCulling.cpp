@@ -0,0 +1,198 @@
+#include "FrustumCulling.h"
+
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define DEEP_TARGET_AVX
+#else
+#define DEEP_TARGET_AVX __attribute__((target("avx")))
+#endif
+
+namespace DeepEngine::Engine::Renderer
+{
+    BoundingSphere BoundingSphere::Transformed(const glm::mat4& p_transform) const
+    {
+        const float scale = std::max({
+            glm::length(glm::vec3(p_transform[0])),
+            glm::length(glm::vec3(p_transform[1])),
+            glm::length(glm::vec3(p_transform[2])),
+        });
+
+        BoundingSphere sphere;
+        sphere.Center = glm::vec3(p_transform * glm::vec4(Center, 1.0f));
+        sphere.Radius = Radius * scale;
+        return sphere;
+    }
+
+    Frustum Frustum::FromViewProjection(const glm::mat4& p_viewProjection)
+    {
+        // Gribb-Hartmann, rows of the matrix combined per clip space bound (glm is column major)
+        const auto row = [&p_viewProjection](int p_index)
+        {
+            return glm::vec4(p_viewProjection[0][p_index], p_viewProjection[1][p_index],
+                p_viewProjection[2][p_index], p_viewProjection[3][p_index]);
+        };
+
+        Frustum frustum;
+        frustum.Planes[0] = row(3) + row(0);
+        frustum.Planes[1] = row(3) - row(0);
+        frustum.Planes[2] = row(3) + row(1);
+        frustum.Planes[3] = row(3) - row(1);
+        frustum.Planes[4] = row(2);
+        frustum.Planes[5] = row(3) - row(2);
+
+        for (glm::vec4& plane : frustum.Planes)
+        {
+            // Infinite far plane degenerates to zero normal, replace it with one passing every point
+            const float length = glm::length(glm::vec3(plane));
+            plane = length > FLT_EPSILON ? plane / length : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        }
+        return frustum;
+    }
+
+    bool Frustum::IsVisible(const BoundingSphere& p_sphere) const
+    {
+        for (const glm::vec4& plane : Planes)
+        {
+            if (glm::dot(glm::vec3(plane), p_sphere.Center) + plane.w < -p_sphere.Radius)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void BoundingSpheres::Clear()
+    {
+        _count = 0;
+        _centersX.clear();
+        _centersY.clear();
+        _centersZ.clear();
+        _radii.clear();
+    }
+
+    void BoundingSpheres::Reserve(uint32_t p_count)
+    {
+        const uint32_t paddedCount = (p_count + LANES - 1) / LANES * LANES;
+        _centersX.reserve(paddedCount);
+        _centersY.reserve(paddedCount);
+        _centersZ.reserve(paddedCount);
+        _radii.reserve(paddedCount);
+    }
+
+    void BoundingSpheres::Add(const BoundingSphere& p_sphere)
+    {
+        // Whole group of lanes is added at once, later spheres overwrite the padding
+        if (_count % LANES == 0)
+        {
+            _centersX.resize(_count + LANES, 0.0f);
+            _centersY.resize(_count + LANES, 0.0f);
+            _centersZ.resize(_count + LANES, 0.0f);
+            _radii.resize(_count + LANES, -FLT_MAX);
+        }
+
+        _centersX[_count] = p_sphere.Center.x;
+        _centersY[_count] = p_sphere.Center.y;
+        _centersZ[_count] = p_sphere.Center.z;
+        _radii[_count] = p_sphere.Radius;
+        _count++;
+    }
+
+    uint32_t CullSpheres(const Frustum& p_frustum, const BoundingSpheres& p_spheres, uint32_t* p_outIndices)
+    {
+        static const bool isAvxSupported = IsAvxSupported();
+
+        return isAvxSupported
+            ? CullSpheresAvx(p_frustum, p_spheres, p_outIndices)
+            : CullSpheresScalar(p_frustum, p_spheres, p_outIndices);
+    }
+
+    uint32_t CullSpheresScalar(const Frustum& p_frustum, const BoundingSpheres& p_spheres, uint32_t* p_outIndices)
+    {
+        uint32_t visibleCount = 0;
+
+        for (uint32_t i = 0; i < p_spheres.GetCount(); i++)
+        {
+            const float x = p_spheres.GetCentersX()[i];
+            const float y = p_spheres.GetCentersY()[i];
+            const float z = p_spheres.GetCentersZ()[i];
+            const float negativeRadius = -p_spheres.GetRadii()[i];
+
+            bool isVisible = true;
+            for (const glm::vec4& plane : p_frustum.Planes)
+            {
+                isVisible &= plane.x * x + plane.y * y + plane.z * z + plane.w >= negativeRadius;
+            }
+
+            // Written unconditionally, count moves only for visible ones, so there is no branch to mispredict
+            p_outIndices[visibleCount] = i;
+            visibleCount += isVisible;
+        }
+
+        return visibleCount;
+    }
+
+    DEEP_TARGET_AVX
+    uint32_t CullSpheresAvx(const Frustum& p_frustum, const BoundingSpheres& p_spheres, uint32_t* p_outIndices)
+    {
+        __m256 planesX[6];
+        __m256 planesY[6];
+        __m256 planesZ[6];
+        __m256 planesW[6];
+        for (uint32_t i = 0; i < 6; i++)
+        {
+            planesX[i] = _mm256_set1_ps(p_frustum.Planes[i].x);
+            planesY[i] = _mm256_set1_ps(p_frustum.Planes[i].y);
+            planesZ[i] = _mm256_set1_ps(p_frustum.Planes[i].z);
+            planesW[i] = _mm256_set1_ps(p_frustum.Planes[i].w);
+        }
+
+        const __m256 signMask = _mm256_set1_ps(-0.0f);
+        uint32_t visibleCount = 0;
+
+        // Storage is padded to full lanes, padding has radius -FLT_MAX so it never passes
+        for (uint32_t base = 0; base < p_spheres.GetCount(); base += BoundingSpheres::LANES)
+        {
+            const __m256 x = _mm256_loadu_ps(p_spheres.GetCentersX() + base);
+            const __m256 y = _mm256_loadu_ps(p_spheres.GetCentersY() + base);
+            const __m256 z = _mm256_loadu_ps(p_spheres.GetCentersZ() + base);
+            const __m256 negativeRadius = _mm256_xor_ps(_mm256_loadu_ps(p_spheres.GetRadii() + base), signMask);
+
+            __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (uint32_t i = 0; i < 6; i++)
+            {
+                __m256 distance = _mm256_add_ps(_mm256_mul_ps(planesX[i], x), planesW[i]);
+                distance = _mm256_add_ps(_mm256_mul_ps(planesY[i], y), distance);
+                distance = _mm256_add_ps(_mm256_mul_ps(planesZ[i], z), distance);
+                visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+            }
+
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(visible));
+            while (mask != 0)
+            {
+                p_outIndices[visibleCount++] = base + std::countr_zero(mask);
+                mask &= mask - 1;
+            }
+        }
+
+        return visibleCount;
+    }
+
+    bool IsAvxSupported()
+    {
+#if defined(_MSC_VER)
+        // CPU has to support it and OS has to save YMM registers on context switch
+        int cpuInfo[4];
+        __cpuid(cpuInfo, 1);
+        const bool hasAvx = (cpuInfo[2] & (1 << 28)) != 0;
+        const bool hasOsxsave = (cpuInfo[2] & (1 << 27)) != 0;
+        return hasAvx && hasOsxsave && (_xgetbv(0) & 0x6) == 0x6;
+#else
+        return __builtin_cpu_supports("avx");
+#endif
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace DeepEngine::Engine::Renderer
+{
+
+    struct BoundingSphere
+    {
+        glm::vec3 Center { 0.0f };
+        float Radius = 0.0f;
+
+        // Radius grows by the biggest axis scale of the transform
+        BoundingSphere Transformed(const glm::mat4& p_transform) const;
+    };
+
+    struct Frustum
+    {
+        // Normals point inside, point is inside plane when dot(xyz, point) + w >= 0
+        std::array<glm::vec4, 6> Planes;
+
+        // Vulkan clip space (depth in [0, 1]), planes are normalized so distances are in world units
+        static Frustum FromViewProjection(const glm::mat4& p_viewProjection);
+
+        bool IsVisible(const BoundingSphere& p_sphere) const;
+    };
+
+    // Spheres as structure of arrays, so SIMD culling loads 8 of them per component with one instruction.
+    // Storage is padded to a multiple of 8, padding is never reported visible.
+    class BoundingSpheres
+    {
+    public:
+        static constexpr uint32_t LANES = 8;
+
+        void Clear();
+        void Reserve(uint32_t p_count);
+        void Add(const BoundingSphere& p_sphere);
+
+        uint32_t GetCount() const
+        { return _count; }
+
+        const float* GetCentersX() const
+        { return _centersX.data(); }
+        const float* GetCentersY() const
+        { return _centersY.data(); }
+        const float* GetCentersZ() const
+        { return _centersZ.data(); }
+        const float* GetRadii() const
+        { return _radii.data(); }
+
+    private:
+        uint32_t _count = 0;
+        std::vector<float> _centersX;
+        std::vector<float> _centersY;
+        std::vector<float> _centersZ;
+        std::vector<float> _radii;
+    };
+
+    // Writes indices of visible spheres in ascending order (p_outIndices has to fit every sphere),
+    // returns how many were written. Uses AVX when the CPU supports it
+    uint32_t CullSpheres(const Frustum& p_frustum, const BoundingSpheres& p_spheres, uint32_t* p_outIndices);
+
+    uint32_t CullSpheresScalar(const Frustum& p_frustum, const BoundingSpheres& p_spheres, uint32_t* p_outIndices);
+    // 8 spheres per iteration, can be called only when IsAvxSupported
+    uint32_t CullSpheresAvx(const Frustum& p_frustum, const BoundingSpheres& p_spheres, uint32_t* p_outIndices);
+
+    bool IsAvxSupported();
+
+}
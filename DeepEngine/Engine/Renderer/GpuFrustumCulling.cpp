@@ -0,0 +1,179 @@
+#include "GpuFrustumCulling.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+    GpuFrustumCulling::GpuFrustumCulling(Vulkan::VulkanInstance* p_vulkanInstance, const ShaderLibrary* p_shaderLibrary,
+        DescriptorAllocator* p_descriptorAllocator, uint32_t p_framesInFlight)
+        : _vulkanInstance(p_vulkanInstance), _shaderLibrary(p_shaderLibrary), _descriptorAllocator(p_descriptorAllocator),
+        _frames(p_framesInFlight)
+    { }
+
+    GpuFrustumCulling::~GpuFrustumCulling()
+    {
+        vkDestroyPipeline(_vulkanInstance->GetLogicalDevice(), _pipeline, nullptr);
+        for (const RetiredPipeline& retired : _retiredPipelines)
+        {
+            vkDestroyPipeline(_vulkanInstance->GetLogicalDevice(), retired.Pipeline, nullptr);
+        }
+
+        for (Vulkan::BaseVulkanController* controller : std::initializer_list<Vulkan::BaseVulkanController*> {
+            _pipelineLayout, _descriptorSetLayout })
+        {
+            if (controller != nullptr)
+            {
+                controller->Terminate();
+            }
+        }
+    }
+
+    bool GpuFrustumCulling::Initialize()
+    {
+        // Input instances, output instances, draw command
+        std::vector<VkDescriptorSetLayoutBinding> bindings(3);
+        for (uint32_t i = 0; i < bindings.size(); i++)
+        {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        _descriptorSetLayout = new Vulkan::DescriptorSetLayout(bindings);
+        if (!_vulkanInstance->InitializeSubController(_descriptorSetLayout))
+        {
+            return false;
+        }
+
+        VkPushConstantRange pushConstantRange { };
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(PushConstants);
+
+        _pipelineLayout = new Vulkan::PipelineLayout(nullptr, 0, { _descriptorSetLayout }, { pushConstantRange });
+        if (!_vulkanInstance->InitializeSubController(_pipelineLayout))
+        {
+            return false;
+        }
+
+        _pipeline = CreatePipeline();
+        return _pipeline != VK_NULL_HANDLE;
+    }
+
+    void GpuFrustumCulling::BeginFrame()
+    {
+        std::erase_if(_retiredPipelines, [this](RetiredPipeline& p_retired)
+        {
+            if (p_retired.FramesLeft-- > 0)
+            {
+                return false;
+            }
+
+            vkDestroyPipeline(_vulkanInstance->GetLogicalDevice(), p_retired.Pipeline, nullptr);
+            return true;
+        });
+    }
+
+    bool GpuFrustumCulling::RecreatePipeline()
+    {
+        const VkPipeline pipeline = CreatePipeline();
+        if (pipeline == VK_NULL_HANDLE)
+        {
+            return false;
+        }
+
+        _retiredPipelines.push_back({ _pipeline, static_cast<uint32_t>(_frames.size()) });
+        _pipeline = pipeline;
+        return true;
+    }
+
+    VkPipeline GpuFrustumCulling::CreatePipeline() const
+    {
+        const Vulkan::ShaderModule* shaderModule = _shaderLibrary->Get(SHADER_NAME);
+        if (shaderModule == nullptr || shaderModule->GetShaderStageFlags() != VK_SHADER_STAGE_COMPUTE_BIT)
+        {
+            VULKAN_ERR("There is no frustum culling compute shader \"{}\"", SHADER_NAME);
+            return VK_NULL_HANDLE;
+        }
+
+        VkComputePipelineCreateInfo pipelineInfo { };
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage = shaderModule->GetShaderStageCreateInfo();
+        pipelineInfo.layout = _pipelineLayout->GetVkPipelineLayout();
+
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        const VkResult result = vkCreateComputePipelines(_vulkanInstance->GetLogicalDevice(),
+            _vulkanInstance->GetVkPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline);
+        if (result != VK_SUCCESS)
+        {
+            VULKAN_ERR("Failed to create culling compute pipeline with returned result {}", string_VkResult(result));
+            return VK_NULL_HANDLE;
+        }
+        return pipeline;
+    }
+
+    void GpuFrustumCulling::SetFrameBuffers(uint32_t p_frameIndex, const Vulkan::Buffer* p_inputInstances,
+        const Vulkan::Buffer* p_outputInstances, const Vulkan::Buffer* p_drawCommand)
+    {
+        _frames[p_frameIndex] = { p_inputInstances, p_outputInstances, p_drawCommand };
+    }
+
+    void GpuFrustumCulling::Record(VkCommandBuffer p_commandBuffer, uint32_t p_frameIndex, const Frustum& p_frustum,
+        const BoundingSphere& p_meshSphere, uint32_t p_instancesCount) const
+    {
+        if (p_instancesCount == 0)
+        {
+            return;
+        }
+
+        const VkDescriptorSet descriptorSet = _descriptorAllocator->Allocate(_descriptorSetLayout);
+        if (descriptorSet == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        const FrameBuffers& frame = _frames[p_frameIndex];
+        const std::array<const Vulkan::Buffer*, 3> buffers { frame.InputInstances, frame.OutputInstances,
+            frame.DrawCommand };
+
+        std::array<VkDescriptorBufferInfo, 3> bufferInfos { };
+        std::array<VkWriteDescriptorSet, 3> writes { };
+        for (uint32_t i = 0; i < buffers.size(); i++)
+        {
+            bufferInfos[i].buffer = buffers[i]->GetVkBuffer();
+            bufferInfos[i].offset = 0;
+            bufferInfos[i].range = VK_WHOLE_SIZE;
+
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = descriptorSet;
+            writes[i].dstBinding = i;
+            writes[i].descriptorCount = 1;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].pBufferInfo = &bufferInfos[i];
+        }
+
+        vkUpdateDescriptorSets(_vulkanInstance->GetLogicalDevice(), static_cast<uint32_t>(writes.size()),
+            writes.data(), 0, nullptr);
+
+        PushConstants pushConstants;
+        pushConstants.Planes = p_frustum.Planes;
+        pushConstants.MeshSphere = glm::vec4(p_meshSphere.Center, p_meshSphere.Radius);
+        pushConstants.InstancesCount = p_instancesCount;
+
+        const VkPipelineLayout pipelineLayout = _pipelineLayout->GetVkPipelineLayout();
+
+        vkCmdBindPipeline(p_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
+        vkCmdBindDescriptorSets(p_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1,
+            &descriptorSet, 0, nullptr);
+        vkCmdPushConstants(p_commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants),
+            &pushConstants);
+        vkCmdDispatch(p_commandBuffer, (p_instancesCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+        // Visible instances count is read back by the host once the frame is finished
+        VkMemoryBarrier hostBarrier { };
+        hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        hostBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(p_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+            1, &hostBarrier, 0, nullptr, 0, nullptr);
+    }
+}
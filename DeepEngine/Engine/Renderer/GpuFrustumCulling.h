@@ -0,0 +1,85 @@
+#pragma once
+#include "DescriptorAllocator.h"
+#include "FrustumCulling.h"
+#include "Vulkan/Buffer.h"
+#include "Vulkan/DescriptorSetLayout.h"
+#include "Vulkan/PipelineLayout.h"
+#include "ShaderLibrary.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+
+    // Frustum culling of instances in a compute shader (Shader/frustumCull.comp). Every invocation tests one
+    // transform's bounding sphere, visible transforms are appended to the output buffer and counted into
+    // instanceCount of the VkDrawIndexedIndirectCommand, which has to be 0 when the dispatch starts. The count is
+    // made visible to the host too, so it can be read back after the frame fence.
+    // Descriptor set is transient, taken from the DescriptorAllocator every time the dispatch is recorded.
+    // When the shader is reloaded the pipeline is recreated, the old one lives until frames using it finish.
+    class GpuFrustumCulling
+    {
+    public:
+        static constexpr uint32_t WORKGROUP_SIZE = 64;
+        static constexpr const char* SHADER_NAME = "frustumCull.spv";
+
+        GpuFrustumCulling(Vulkan::VulkanInstance* p_vulkanInstance, const ShaderLibrary* p_shaderLibrary,
+            DescriptorAllocator* p_descriptorAllocator, uint32_t p_framesInFlight);
+        ~GpuFrustumCulling();
+
+        GpuFrustumCulling(const GpuFrustumCulling&) = delete;
+        GpuFrustumCulling& operator=(const GpuFrustumCulling&) = delete;
+
+        bool Initialize();
+
+        // Called at the start of every frame, destroys pipelines replaced framesInFlight frames ago
+        void BeginFrame();
+
+        // Recreates the pipeline from the current module in the shader library, on failure the old one stays
+        bool RecreatePipeline();
+
+        // Buffers have to be storage buffers and stay alive as long as the frame may use them
+        void SetFrameBuffers(uint32_t p_frameIndex, const Vulkan::Buffer* p_inputInstances,
+            const Vulkan::Buffer* p_outputInstances, const Vulkan::Buffer* p_drawCommand);
+
+        // Recorded outside of a render pass, results are written by the compute shader stage and the caller makes them
+        // visible to indirect draws and vertex input (see RenderGraph). Descriptor allocator has to be in the same frame
+        void Record(VkCommandBuffer p_commandBuffer, uint32_t p_frameIndex, const Frustum& p_frustum,
+            const BoundingSphere& p_meshSphere, uint32_t p_instancesCount) const;
+
+    private:
+        // Matches push constant block of Shader/frustumCull.comp
+        struct PushConstants
+        {
+            std::array<glm::vec4, 6> Planes;
+            glm::vec4 MeshSphere;
+            uint32_t InstancesCount;
+        };
+
+        struct FrameBuffers
+        {
+            const Vulkan::Buffer* InputInstances = nullptr;
+            const Vulkan::Buffer* OutputInstances = nullptr;
+            const Vulkan::Buffer* DrawCommand = nullptr;
+        };
+
+        struct RetiredPipeline
+        {
+            VkPipeline Pipeline;
+            // Frames in flight which may still use it
+            uint32_t FramesLeft;
+        };
+
+        VkPipeline CreatePipeline() const;
+
+    private:
+        Vulkan::VulkanInstance* _vulkanInstance;
+        const ShaderLibrary* _shaderLibrary;
+        DescriptorAllocator* _descriptorAllocator;
+        std::vector<FrameBuffers> _frames;
+
+        Vulkan::DescriptorSetLayout* _descriptorSetLayout = nullptr;
+        Vulkan::PipelineLayout* _pipelineLayout = nullptr;
+        VkPipeline _pipeline = VK_NULL_HANDLE;
+        std::vector<RetiredPipeline> _retiredPipelines;
+    };
+
+}
@@ -0,0 +1,148 @@
+#include "HeadlessReadback.h"
+
+#include <algorithm>
+
+namespace DeepEngine::Engine::Renderer
+{
+    namespace
+    {
+        bool HasFourByteTexels(VkFormat p_format)
+        {
+            switch (p_format)
+            {
+            case VK_FORMAT_R8G8B8A8_UNORM:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_B8G8R8A8_UNORM:
+            case VK_FORMAT_B8G8R8A8_SRGB:
+            case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+                return true;
+            default:
+                return false;
+            }
+        }
+    }
+
+    HeadlessReadback::HeadlessReadback(Vulkan::VulkanInstance* p_vulkanInstance, uint32_t p_framesInFlight)
+        : _vulkanInstance(p_vulkanInstance), _frames(p_framesInFlight)
+    { }
+
+    HeadlessReadback::~HeadlessReadback()
+    {
+        for (FrameReadback& frame : _frames)
+        {
+            if (frame.HostBuffer != nullptr)
+            {
+                frame.HostBuffer->Terminate();
+            }
+        }
+    }
+
+    void HeadlessReadback::BeginFrame(uint32_t p_frameIndex)
+    {
+        _frameIndex = p_frameIndex;
+        Deliver(_frames[_frameIndex]);
+    }
+
+    bool HeadlessReadback::AddReadbackPass(RenderGraph& p_renderGraph, RenderGraph::ResourceID p_image,
+        const RenderGraphImageDescription& p_description)
+    {
+        if (!HasFourByteTexels(p_description.Format))
+        {
+            VULKAN_ERR("Reading back images of format {} is not supported", string_VkFormat(p_description.Format));
+            return false;
+        }
+
+        FrameReadback& frame = _frames[_frameIndex];
+        const VkDeviceSize size = static_cast<VkDeviceSize>(p_description.Width) * p_description.Height * TEXEL_SIZE;
+
+        // Frame fence was waited, nothing uses the old buffer anymore
+        if (frame.HostBuffer == nullptr || frame.HostBuffer->GetSize() < size)
+        {
+            if (frame.HostBuffer != nullptr)
+            {
+                frame.HostBuffer->Terminate();
+            }
+
+            frame.HostBuffer = new Vulkan::Buffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, Vulkan::MemoryUsage::GPU_TO_CPU);
+            if (!_vulkanInstance->InitializeSubController(frame.HostBuffer))
+            {
+                frame.HostBuffer = nullptr;
+                return false;
+            }
+        }
+
+        // CPU read it in BeginFrame of this frame
+        const RenderGraph::ResourceID hostBuffer = p_renderGraph.ImportBuffer("Readback buffer",
+            frame.HostBuffer->GetVkBuffer(), RenderGraphUsage::HostRead());
+
+        p_renderGraph.AddPass("Readback", [this, &p_renderGraph, &frame, p_image, p_description]
+            (VkCommandBuffer p_commandBuffer)
+            {
+                VkBufferImageCopy region { };
+                region.bufferOffset = 0;
+                // Zero means tightly packed
+                region.bufferRowLength = 0;
+                region.bufferImageHeight = 0;
+                region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                region.imageSubresource.mipLevel = 0;
+                region.imageSubresource.baseArrayLayer = 0;
+                region.imageSubresource.layerCount = 1;
+                region.imageExtent = { p_description.Width, p_description.Height, 1 };
+
+                vkCmdCopyImageToBuffer(p_commandBuffer, p_renderGraph.GetImage(p_image),
+                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, frame.HostBuffer->GetVkBuffer(), 1, &region);
+
+                frame.Frame.Width = p_description.Width;
+                frame.Frame.Height = p_description.Height;
+                frame.Frame.Format = p_description.Format;
+                frame.Frame.FrameNumber = _recordedFrames++;
+                frame.IsPending = true;
+            })
+            .Read(p_image, RenderGraphUsage::TransferSource())
+            .Write(hostBuffer, RenderGraphUsage::TransferDestination());
+
+        p_renderGraph.Export(hostBuffer, RenderGraphUsage::HostRead());
+        return true;
+    }
+
+    void HeadlessReadback::Flush()
+    {
+        std::vector<FrameReadback*> pendingFrames;
+        for (FrameReadback& frame : _frames)
+        {
+            if (frame.IsPending)
+            {
+                pendingFrames.push_back(&frame);
+            }
+        }
+
+        std::sort(pendingFrames.begin(), pendingFrames.end(), [](const FrameReadback* p_lhs, const FrameReadback* p_rhs)
+            {
+                return p_lhs->Frame.FrameNumber < p_rhs->Frame.FrameNumber;
+            });
+
+        for (FrameReadback* frame : pendingFrames)
+        {
+            Deliver(*frame);
+        }
+    }
+
+    void HeadlessReadback::Deliver(FrameReadback& p_frame) const
+    {
+        if (!p_frame.IsPending)
+        {
+            return;
+        }
+        p_frame.IsPending = false;
+
+        if (!_callback)
+        {
+            return;
+        }
+
+        p_frame.HostBuffer->InvalidateMappedData();
+        p_frame.Frame.Pixels = static_cast<const uint8_t*>(p_frame.HostBuffer->GetMappedData());
+        _callback(p_frame.Frame);
+        p_frame.Frame.Pixels = nullptr;
+    }
+}
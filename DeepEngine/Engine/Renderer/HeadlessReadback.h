@@ -0,0 +1,74 @@
+#pragma once
+#include <functional>
+
+#include "RenderGraph.h"
+#include "Vulkan/Buffer.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+
+    // Pixels of one rendered frame in host memory, rows are tightly packed
+    struct ReadbackFrame
+    {
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        VkFormat Format = VK_FORMAT_UNDEFINED;
+        const uint8_t* Pixels = nullptr;
+        // Counts recorded frames from 0
+        uint64_t FrameNumber = 0;
+    };
+
+    // Takes place of presentation when the renderer runs without a window. Last pass of every frame copies the
+    // final image into a host visible buffer of the frame in flight, the copy is complete once the frame fence is
+    // signaled. Frame is handed to the callback when the same frame in flight begins again (or on Flush), so
+    // reading back never stalls the GPU. Pixels are valid only during the callback.
+    class HeadlessReadback
+    {
+    public:
+        using ReadbackCallback = std::function<void(const ReadbackFrame&)>;
+
+        HeadlessReadback(Vulkan::VulkanInstance* p_vulkanInstance, uint32_t p_framesInFlight);
+        ~HeadlessReadback();
+
+        HeadlessReadback(const HeadlessReadback&) = delete;
+        HeadlessReadback& operator=(const HeadlessReadback&) = delete;
+
+        void SetCallback(ReadbackCallback p_callback)
+        { _callback = std::move(p_callback); }
+
+        // Frame fence has to be waited, frame read back by it the last time is handed to the callback
+        void BeginFrame(uint32_t p_frameIndex);
+
+        // Copies the whole image into the buffer of the current frame, the image needs
+        // VK_IMAGE_USAGE_TRANSFER_SRC_BIT and a format of 4 bytes per texel. Buffer grows with the image
+        bool AddReadbackPass(RenderGraph& p_renderGraph, RenderGraph::ResourceID p_image,
+            const RenderGraphImageDescription& p_description);
+
+        // Device has to be idle, every frame not handed to the callback yet is
+        void Flush();
+
+        uint64_t GetRecordedFramesCount() const
+        { return _recordedFrames; }
+
+    private:
+        struct FrameReadback
+        {
+            Vulkan::Buffer* HostBuffer = nullptr;
+            ReadbackFrame Frame;
+            // Set when the copy is recorded, a graph which failed to compile records nothing
+            bool IsPending = false;
+        };
+
+        void Deliver(FrameReadback& p_frame) const;
+
+    private:
+        static constexpr uint32_t TEXEL_SIZE = 4;
+
+        Vulkan::VulkanInstance* _vulkanInstance;
+        std::vector<FrameReadback> _frames;
+        uint32_t _frameIndex = 0;
+        uint64_t _recordedFrames = 0;
+        ReadbackCallback _callback;
+    };
+
+}
@@ -4,19 +4,17 @@ namespace DeepEngine::Engine::Renderer
 {
 	
 	ImGuiController::ImGuiController(Vulkan::VulkanInstance* p_vulkanInstance,
-		const Vulkan::VulkanInstance::QueueInstance* p_mainQueue, MainRenderPass* p_mainRenderPass): _vulkanInstance(p_vulkanInstance), _mainQueue(p_mainQueue), _mainRenderPass(p_mainRenderPass)
+		const Vulkan::VulkanInstance::QueueInstance* p_mainQueue, Vulkan::QueryPool* p_queryPool,
+		uint32_t p_framesInFlight): _vulkanInstance(p_vulkanInstance), _mainQueue(p_mainQueue), _queryPool(p_queryPool)
 	{
+		_profilerSamplesScratch.resize(Debug::TimerTracker::SAMPLES_CAPACITY);
+
 		_imGuiRenderPass = new ImGuiRenderPass();
 		if (!_vulkanInstance->InitializeSubController(_imGuiRenderPass))
 		{
 			return;
 		}
 			
-		_commandPool = new Vulkan::CommandPool(_mainQueue, Vulkan::CommandPoolFlag::RESET_COMMAND_BUFFER);
-		_vulkanInstance->InitializeSubController(_commandPool);
-
-		_commandBuffers = _commandPool->CreateCommandBuffers(_vulkanInstance->GetSwapChainImageViews().size());
-			
 		IMGUI_CHECKVERSION();
 		ImGui::CreateContext();
 		ImGuiIO& io = ImGui::GetIO(); (void)io;
@@ -29,15 +27,16 @@ namespace DeepEngine::Engine::Renderer
 		ImGui::StyleColorsDark();
 		//ImGui::StyleColorsClassic();
 			
+		// Font texture and viewport texture of every frame in flight
 		std::array pool_sizes
 		{
-			VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 },
+			VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 + p_framesInFlight },
 		};
 			
 		VkDescriptorPoolCreateInfo pool_info = {};
 		pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 		pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-		pool_info.maxSets = 4;
+		pool_info.maxSets = 1 + p_framesInFlight;
 		pool_info.poolSizeCount = pool_sizes.size();
 		pool_info.pPoolSizes = pool_sizes.data();
 		auto result = vkCreateDescriptorPool(
@@ -62,27 +61,53 @@ namespace DeepEngine::Engine::Renderer
 		init_info.DescriptorPool = _descPool;
 		init_info.Allocator = nullptr;
 		init_info.MinImageCount = 2;
-		init_info.ImageCount = static_cast<uint32_t>(_vulkanInstance->GetSwapChainImageViews().size());
+		// Backend keeps vertex/index buffers per ImageCount frames, it can not be less than frames in flight
+		init_info.ImageCount = std::max(static_cast<uint32_t>(_vulkanInstance->GetSwapChainImageViews().size()), p_framesInFlight);
 		init_info.Subpass = 0;
 		ImGui_ImplVulkan_Init(&init_info, _imGuiRenderPass->GetVkRenderPass());
 
 		LoadFontLol();
 
-		_attachmentsRecreatedListener = _vulkanInstance->GetRendererEventBus().CreateListener<MainRenderPassRecreatedAttachment>();
-		_attachmentsRecreatedListener->BindCallback(&ImGuiController::RecreatedRenderPassAttachmentsHandler, this);
-		CreateRenderPassTextures();
+		VkSamplerCreateInfo samplerInfo { };
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_LINEAR;
+		samplerInfo.minFilter = VK_FILTER_LINEAR;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		samplerInfo.anisotropyEnable = VK_FALSE;
+		samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+		samplerInfo.unnormalizedCoordinates = VK_FALSE;
+		samplerInfo.compareEnable = VK_FALSE;
+		samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		samplerInfo.mipLodBias = 0.0f;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = 0.0f;
+
+		vkCreateSampler(_vulkanInstance->GetLogicalDevice(), &samplerInfo, nullptr, &_viewportSampler);
+
+		_viewportViews.resize(p_framesInFlight, VK_NULL_HANDLE);
+		_viewportTextures.resize(p_framesInFlight, VK_NULL_HANDLE);
 	}
 
 	void ImGuiController::Terminate() const
 	{
-		for (VkDescriptorSet texture : _renderPassTextures)
+		// Device is idle by now, staging objects are destroyed by ImGui_ImplVulkan_Shutdown
+		if (_fontUploadFence != nullptr)
 		{
-			ImGui_ImplVulkan_RemoveTexture(texture);
+			_fontUploadFence->Terminate();
+			_fontUploadCommandPool->Terminate();
 		}
-		for (VkSampler sampler : _renderPassTexturesSamplers)
+
+		for (VkDescriptorSet texture : _viewportTextures)
 		{
-			vkDestroySampler(_vulkanInstance->GetLogicalDevice(), sampler, nullptr);
+			if (texture != VK_NULL_HANDLE)
+			{
+				ImGui_ImplVulkan_RemoveTexture(texture);
+			}
 		}
+		vkDestroySampler(_vulkanInstance->GetLogicalDevice(), _viewportSampler, nullptr);
 			
 		ImGui_ImplVulkan_Shutdown();
 		ImGui_ImplGlfw_Shutdown();
@@ -90,7 +115,29 @@ namespace DeepEngine::Engine::Renderer
 		vkDestroyDescriptorPool(_vulkanInstance->GetLogicalDevice(), _descPool, nullptr);
 	}
 
-	void ImGuiController::Renderrr(uint32_t p_frameID, const Core::Scene::Scene& p_scene)
+	void ImGuiController::SetViewportImage(uint32_t p_frameIndex, VkImageView p_imageView)
+	{
+		if (_viewportViews[p_frameIndex] == p_imageView)
+		{
+			return;
+		}
+
+		// Last command buffer using the texture of this frame has finished
+		if (_viewportTextures[p_frameIndex] != VK_NULL_HANDLE)
+		{
+			ImGui_ImplVulkan_RemoveTexture(_viewportTextures[p_frameIndex]);
+			_viewportTextures[p_frameIndex] = VK_NULL_HANDLE;
+		}
+
+		_viewportViews[p_frameIndex] = p_imageView;
+		if (p_imageView != VK_NULL_HANDLE)
+		{
+			_viewportTextures[p_frameIndex] = ImGui_ImplVulkan_AddTexture(_viewportSampler, p_imageView,
+				VK_IMAGE_LAYOUT_READ_ONLY_OPTIMAL);
+		}
+	}
+
+	void ImGuiController::BuildFrame(uint32_t p_frameIndex, const Core::Scene::Scene& p_scene)
 	{
 		// Start the Dear ImGui frame
 		ImGui_ImplVulkan_NewFrame();
@@ -100,58 +147,38 @@ namespace DeepEngine::Engine::Renderer
 		// ...
 		ImGui::ShowDemoWindow();
 		DrawVulkanStructureWindow();
-		DrawViewportWindow(p_frameID);
+		DrawViewportWindow(p_frameIndex);
 		DrawScene(p_scene);
+		DrawProfilerWindow();
 			
 		ImGui::Render();
+	}
 
-		{
-			auto result = vkResetCommandPool(_vulkanInstance->GetLogicalDevice(), _commandPool->GetVkCommandPool(), 0);
-
-			if (result != VK_SUCCESS)
-			{
-				return;
-			}
-				
-			VkCommandBufferBeginInfo info = {};
-			info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-			info.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-				
-			result = vkBeginCommandBuffer(_commandBuffers[p_frameID]->GetVkCommandBuffer(), &info);
-
-			if (result != VK_SUCCESS)
-			{
-				return;
-			}
-		}
-
+	void ImGuiController::RecordDrawData(VkCommandBuffer p_commandBuffer, uint32_t p_imageIndex) const
+	{
 		{
 			VkClearValue clearColor { 0.1f, 0.1, 0.1f, 0.5f };
 				
 			VkRenderPassBeginInfo info = {};
 			info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 			info.renderPass = _imGuiRenderPass->GetVkRenderPass();
-			info.framebuffer = _imGuiRenderPass->GetSwapchainImageVkFramebuffer(p_frameID);
+			info.framebuffer = _imGuiRenderPass->GetSwapchainImageVkFramebuffer(p_imageIndex);
 			info.renderArea.extent.width = _vulkanInstance->GetFrameBufferSize().x;
 			info.renderArea.extent.height = _vulkanInstance->GetFrameBufferSize().y;
 			info.clearValueCount = 1;
 			info.pClearValues = &clearColor;
-			vkCmdBeginRenderPass(_commandBuffers[p_frameID]->GetVkCommandBuffer(), &info, VK_SUBPASS_CONTENTS_INLINE);
+			vkCmdBeginRenderPass(p_commandBuffer, &info, VK_SUBPASS_CONTENTS_INLINE);
 		}
 
-		ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), _commandBuffers[p_frameID]->GetVkCommandBuffer());
-
-		vkCmdEndRenderPass(_commandBuffers[p_frameID]->GetVkCommandBuffer());
-		auto result = vkEndCommandBuffer(_commandBuffers[p_frameID]->GetVkCommandBuffer());
+		ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), p_commandBuffer);
 
-		if (result != VK_SUCCESS)
-		{
-			return;
-		}
+		vkCmdEndRenderPass(p_commandBuffer);
 	}
 
 	void ImGuiController::PostRenderUpdate()
 	{
+		TryFinishFontUpload();
+
 		// Update and Render additional Platform Windows
 		if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
 		{
@@ -187,23 +214,20 @@ namespace DeepEngine::Engine::Renderer
 		//ImFont* font = io.Fonts->AddFontFromFileTTF("c:\\Windows\\Fonts\\ArialUni.ttf", 18.0f, nullptr, io.Fonts->GetGlyphRangesJapanese());
 		//IM_ASSERT(font != nullptr);
 
-		auto buffer = new Vulkan::CommandBuffer(_commandPool, false);
-		_commandPool->InitializeSubController(buffer);
+		_fontUploadCommandPool = new Vulkan::CommandPool(_mainQueue, Vulkan::CommandPoolFlag::TRANSIENT);
+		_vulkanInstance->InitializeSubController(_fontUploadCommandPool);
+		auto buffer = _fontUploadCommandPool->CreateCommandBuffers(1)[0];
+
+		_fontUploadFence = new Vulkan::Fence();
+		_vulkanInstance->InitializeSubController(_fontUploadFence);
 
 		// Upload Fonts
 		{
-			// Use any command queue
-			VkResult err = vkResetCommandPool(_vulkanInstance->GetLogicalDevice(), _commandPool->GetVkCommandPool(), 0);
-		    	
-			if (err != VK_SUCCESS)
-			{
-				return;
-			}
-    			
+			// Submitted before the first frame on the same queue, so frames see the texture without waiting for it
 			VkCommandBufferBeginInfo begin_info = {};
 			begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 			begin_info.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-			err = vkBeginCommandBuffer(buffer->GetVkCommandBuffer(), &begin_info);
+			VkResult err = vkBeginCommandBuffer(buffer->GetVkCommandBuffer(), &begin_info);
 		    	
 			if (err != VK_SUCCESS)
 			{
@@ -223,27 +247,33 @@ namespace DeepEngine::Engine::Renderer
 				return;
 			}
 		    	
-			err = vkQueueSubmit(_mainQueue->Queue, 1, &end_info, VK_NULL_HANDLE);
+			err = vkQueueSubmit(_mainQueue->Queue, 1, &end_info, _fontUploadFence->GetVkFence());
 		    	
 			if (err != VK_SUCCESS)
 			{
 				return;
 			}
+		}
+	}
 
-			err = vkDeviceWaitIdle(_vulkanInstance->GetLogicalDevice());
-		    	
-			if (err != VK_SUCCESS)
-			{
-				return;
-			}
-		    	
-			ImGui_ImplVulkan_DestroyFontUploadObjects();
+	void ImGuiController::TryFinishFontUpload()
+	{
+		if (_fontUploadFence == nullptr
+			|| vkGetFenceStatus(_vulkanInstance->GetLogicalDevice(), _fontUploadFence->GetVkFence()) != VK_SUCCESS)
+		{
+			return;
 		}
 
-		buffer->Terminate();
+		ImGui_ImplVulkan_DestroyFontUploadObjects();
+
+		// Terminates the command buffer too
+		_fontUploadCommandPool->Terminate();
+		_fontUploadCommandPool = nullptr;
+		_fontUploadFence->Terminate();
+		_fontUploadFence = nullptr;
 	}
 
-	void ImGuiController::DrawViewportWindow(uint32_t p_frameID)
+	void ImGuiController::DrawViewportWindow(uint32_t p_frameIndex)
 	{
 		static bool isOpen = true;
 			
@@ -260,7 +290,10 @@ namespace DeepEngine::Engine::Renderer
 				_viewportSize = size;
 			}
 
-			ImGui::Image(_renderPassTextures[p_frameID], { _viewportSize.x, _viewportSize.y });
+			if (_viewportTextures[p_frameIndex] != VK_NULL_HANDLE)
+			{
+				ImGui::Image(_viewportTextures[p_frameIndex], { _viewportSize.x, _viewportSize.y });
+			}
 		}
 			
 		ImGui::End();
@@ -277,28 +310,60 @@ namespace DeepEngine::Engine::Renderer
 				DrawVulkanControllerChilds(_vulkanInstance);
 				ImGui::TreePop();
 			}
+
+			if (ImGui::TreeNode("Device memory"))
+			{
+				DrawDeviceMemoryStatistics();
+				ImGui::TreePop();
+			}
 		}
 
 		ImGui::End();
 	}
 
+	void ImGuiController::DrawDeviceMemoryStatistics()
+	{
+		const Vulkan::DeviceMemoryAllocator* allocator = _vulkanInstance->GetMemoryAllocator();
+		const VkPhysicalDeviceMemoryProperties& properties = allocator->GetMemoryProperties();
+
+		constexpr float MEGABYTE = 1024.0f * 1024.0f;
+
+		for (uint32_t i = 0; i < properties.memoryTypeCount; i++)
+		{
+			const Vulkan::MemoryTypeStatistics statistics = allocator->GetStatistics(i);
+			if (statistics.BlocksCount == 0 && statistics.DedicatedAllocationsCount == 0)
+			{
+				continue;
+			}
+
+			const VkMemoryPropertyFlags flags = properties.memoryTypes[i].propertyFlags;
+			ImGui::Text("Type %u (heap %u)%s%s%s", i, properties.memoryTypes[i].heapIndex,
+				flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT ? " DEVICE_LOCAL" : "",
+				flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT ? " HOST_VISIBLE" : "",
+				flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT ? " HOST_CACHED" : "");
+
+			ImGui::TextDisabled("Blocks: %u  Used: %.2f / %.2f MB  Allocations: %u",
+				statistics.BlocksCount, static_cast<float>(statistics.UsedBytes) / MEGABYTE,
+				static_cast<float>(statistics.BlocksBytes) / MEGABYTE, statistics.AllocationsCount);
+			ImGui::TextDisabled("Dedicated: %u (%.2f MB)", statistics.DedicatedAllocationsCount,
+				static_cast<float>(statistics.DedicatedBytes) / MEGABYTE);
+		}
+	}
+
 	void ImGuiController::DrawVulkanControllerChilds(Vulkan::BaseVulkanController* p_controller)
 	{
-		auto& childs = p_controller->GetChildControllers();
-		auto it = childs.begin();
-			
-		for (uint32_t i = 0; i < childs.size(); i++)
+		// Holds the lock of every expanded level, pipeline compilation adds children meanwhile
+		uint32_t i = 0;
+		p_controller->ForEachChildController([this, &i](Vulkan::BaseVulkanController* p_child)
 		{
-			ImGui::PushID(i);
-			if (ImGui::TreeNode((*it)->GetDebugTypeName()))
+			ImGui::PushID(i++);
+			if (ImGui::TreeNode(p_child->GetDebugTypeName()))
 			{
-				DrawVulkanControllerChilds(*it);
+				DrawVulkanControllerChilds(p_child);
 				ImGui::TreePop();
 			}
 			ImGui::PopID();
-				
-			++it;
-		}
+		});
 	}
 
 	void ImGuiController::DrawScene(const Core::Scene::Scene& p_scene)
@@ -356,52 +421,161 @@ namespace DeepEngine::Engine::Renderer
 		ImGui::End();
 	}
 
-	Core::Events::EventResult ImGuiController::RecreatedRenderPassAttachmentsHandler(
-		const MainRenderPassRecreatedAttachment& p_event)
+	void ImGuiController::DrawProfilerWindow()
 	{
-		CreateRenderPassTextures();
-		return Core::Events::EventResult::PASS;
+		static bool isOpen = true;
+		const auto overlayStart = std::chrono::steady_clock::now();
+
+		_cpuFrameTimes.Push(ImGui::GetIO().DeltaTime * 1000.0f);
+		for (const Vulkan::GpuScopeResult& result : _queryPool->GetResults())
+		{
+			_gpuScopesTimes[result.Name].Push(result.Milliseconds);
+		}
+
+		if (ImGui::Begin("Profiler", &isOpen))
+		{
+			const uint32_t lastIndex = (_cpuFrameTimes.Offset + PROFILER_HISTORY_LENGTH - 1) % PROFILER_HISTORY_LENGTH;
+			const float lastFrameTime = _cpuFrameTimes.Values[lastIndex];
+
+			ImGui::Text("CPU frame: %.3f ms (%.0f FPS)", lastFrameTime, ImGui::GetIO().Framerate);
+			ImGui::PlotLines("##CpuFrameTimes", _cpuFrameTimes.Values.data(), PROFILER_HISTORY_LENGTH,
+				_cpuFrameTimes.Offset, nullptr, 0.0f, FLT_MAX, { 0.0f, 60.0f });
+
+			// Fragment invocations of the "Scene" scope drop with overlapping geometry
+			ImGui::Checkbox("Depth pre-pass", &_isDepthPrePassEnabled);
+
+			if (_queryPool->IsTimestampSupported())
+			{
+				// Results are a few frames old, they are read back without waiting for the GPU
+				for (const Vulkan::GpuScopeResult& result : _queryPool->GetResults())
+				{
+					const ProfilerHistory& history = _gpuScopesTimes[result.Name];
+
+					ImGui::PushID(result.Name);
+					ImGui::Text("GPU %s: %.3f ms", result.Name, result.Milliseconds);
+					if (result.HasStatistics)
+					{
+						ImGui::TextDisabled("Vertices: %llu  VS: %llu  Primitives: %llu  FS: %llu",
+							static_cast<unsigned long long>(result.InputAssemblyVertices),
+							static_cast<unsigned long long>(result.VertexShaderInvocations),
+							static_cast<unsigned long long>(result.ClippingPrimitives),
+							static_cast<unsigned long long>(result.FragmentShaderInvocations));
+					}
+					ImGui::PlotLines("##GpuScopeTimes", history.Values.data(), PROFILER_HISTORY_LENGTH,
+						history.Offset, nullptr, 0.0f, FLT_MAX, { 0.0f, 40.0f });
+					ImGui::PopID();
+				}
+			}
+			else
+			{
+				ImGui::TextDisabled("GPU timestamps are not supported by the graphics queue");
+			}
+
+			ImGui::Text("Draws: %u (indirect: %u)  Pipeline binds: %u (unsorted: %u)", _drawStatistics.Draws,
+				_drawStatistics.IndirectDraws, _drawStatistics.PipelineBinds, _drawStatistics.UnsortedPipelineBinds);
+			ImGui::TextDisabled("Descriptor sets: %u  Vertex buffers: %u  Index buffers: %u  Push constants: %u",
+				_drawStatistics.DescriptorSetBinds, _drawStatistics.VertexBufferBinds,
+				_drawStatistics.IndexBufferBinds, _drawStatistics.PushConstants);
+			ImGui::TextDisabled("Instances: %u  Visible: %u (%s culling)", _instancesCount, _visibleInstancesCount,
+				_instanceCullingName);
+			ImGui::TextDisabled("Transient descriptor sets: %u  Pools used: %u (total: %u)",
+				_descriptorStatistics.AllocatedSets, _descriptorStatistics.UsedPools, _descriptorStatistics.TotalPools);
+			ImGui::TextDisabled("Render graph passes: %u (culled: %u)  Barriers: %u (images: %u, buffers: %u)",
+				_renderGraphStatistics.Passes, _renderGraphStatistics.CulledPasses,
+				_renderGraphStatistics.BarrierBatches, _renderGraphStatistics.ImageBarriers,
+				_renderGraphStatistics.BufferBarriers);
+			ImGui::TextDisabled("Transient images: %u (lazily allocated: %u)  Memory: %.2f MB (requested: %.2f MB)",
+				_transientImageStatistics.Images, _transientImageStatistics.LazilyAllocatedImages,
+				static_cast<float>(_transientImageStatistics.AllocatedBytes) / (1024.0f * 1024.0f),
+				static_cast<float>(_transientImageStatistics.RequestedBytes) / (1024.0f * 1024.0f));
+
+			// Measured last frame, this one is still being drawn
+			ImGui::Text("Profiler overlay: %.3f ms", _profilerOverlayMilliseconds);
+			ImGui::Separator();
+
+			for (const Debug::TimerTracker* tracker = Debug::TimerTracker::GetFirstTracker(); tracker != nullptr;
+				tracker = tracker->GetNext())
+			{
+				DrawProfilerScope(tracker);
+			}
+		}
+
+		ImGui::End();
+
+		using namespace std::literals;
+		_profilerOverlayMilliseconds = static_cast<float>((std::chrono::steady_clock::now() - overlayStart) / 1ns) / 1000000.0f;
 	}
 
-	void ImGuiController::CreateRenderPassTextures()
+	void ImGuiController::DrawProfilerScope(const Debug::TimerTracker* p_tracker)
 	{
-		for (VkDescriptorSet texture : _renderPassTextures)
+		if (!ImGui::TreeNode(p_tracker, "%s (%s)", p_tracker->GetName().c_str(), p_tracker->GetFuncName().c_str()))
 		{
-			ImGui_ImplVulkan_RemoveTexture(texture);
+			return;
 		}
-		for (VkSampler sampler : _renderPassTexturesSamplers)
+
+		ProfilerScopeStats& stats = _profilerScopesStats[p_tracker];
+		const auto now = std::chrono::steady_clock::now();
+
+		if (now - stats.UpdateTime >= PROFILER_STATS_INTERVAL)
 		{
-			vkDestroySampler(_vulkanInstance->GetLogicalDevice(), sampler, nullptr);
-		}
+			stats.UpdateTime = now;
+			stats.SamplesCount = p_tracker->CopySamples(_profilerSamplesScratch.data());
+			stats.Histogram.fill(0.0f);
 
-		_renderPassTexturesSamplers.clear();
-		_renderPassTexturesSamplers.resize(_mainRenderPass->GetAllVkFramebuffer().size());
-		_renderPassTextures.clear();
-		_renderPassTextures.resize(_mainRenderPass->GetAllVkFramebuffer().size());
+			if (stats.SamplesCount > 0)
+			{
+				const auto begin = _profilerSamplesScratch.begin();
+				const auto end = begin + stats.SamplesCount;
 
-		for (uint32_t i = 0; i < static_cast<uint32_t>(_renderPassTextures.size()); i++)
+				double sum = 0.0;
+				stats.Min = *begin;
+				stats.Max = *begin;
+				for (auto it = begin; it != end; ++it)
+				{
+					sum += *it;
+					stats.Min = std::min(stats.Min, *it);
+					stats.Max = std::max(stats.Max, *it);
+				}
+				stats.Average = static_cast<float>(sum / stats.SamplesCount);
+
+				const float bucketSize = std::max(stats.Max - stats.Min, FLT_EPSILON) / PROFILER_HISTOGRAM_BUCKETS;
+				for (auto it = begin; it != end; ++it)
+				{
+					const uint32_t bucket = std::min(static_cast<uint32_t>((*it - stats.Min) / bucketSize),
+						PROFILER_HISTOGRAM_BUCKETS - 1);
+					stats.Histogram[bucket] += 1.0f;
+				}
+
+				// Each nth_element leaves smaller values before the pivot, so next (higher) percentile searches only the rest
+				auto percentile = [&](auto p_from, float p_percent)
+				{
+					auto nth = begin + std::min(static_cast<uint32_t>(p_percent * stats.SamplesCount), stats.SamplesCount - 1);
+					std::nth_element(p_from, nth, end);
+					return nth;
+				};
+
+				auto p50 = percentile(begin, 0.50f);
+				stats.P50 = *p50;
+				auto p95 = percentile(p50, 0.95f);
+				stats.P95 = *p95;
+				stats.P99 = *percentile(p95, 0.99f);
+			}
+		}
+
+		if (stats.SamplesCount == 0)
 		{
-			VkSamplerCreateInfo samplerInfo { };
-			samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-			samplerInfo.magFilter = VK_FILTER_LINEAR;
-			samplerInfo.minFilter = VK_FILTER_LINEAR;
-			samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-			samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-			samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-			samplerInfo.anisotropyEnable = VK_FALSE;
-			samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-			samplerInfo.unnormalizedCoordinates = VK_FALSE;
-			samplerInfo.compareEnable = VK_FALSE;
-			samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-			samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-			samplerInfo.mipLodBias = 0.0f;
-			samplerInfo.minLod = 0.0f;
-			samplerInfo.maxLod = 0.0f;
-
-			vkCreateSampler(_vulkanInstance->GetLogicalDevice(), &samplerInfo, nullptr, &_renderPassTexturesSamplers[i]);
-				
-			_renderPassTextures[i] = ImGui_ImplVulkan_AddTexture(_renderPassTexturesSamplers[i], _mainRenderPass->GetVkImageView(i), VK_IMAGE_LAYOUT_READ_ONLY_OPTIMAL);
+			ImGui::TextDisabled("No samples");
 		}
+		else
+		{
+			ImGui::Text("Samples: %u (total %.1f ms)", stats.SamplesCount, p_tracker->GetTotalMilliseconds());
+			ImGui::Text("Min: %.3f ms  Avg: %.3f ms  Max: %.3f ms", stats.Min, stats.Average, stats.Max);
+			ImGui::Text("p50: %.3f ms  p95: %.3f ms  p99: %.3f ms", stats.P50, stats.P95, stats.P99);
+			ImGui::PlotHistogram("##Histogram", stats.Histogram.data(), PROFILER_HISTOGRAM_BUCKETS, 0,
+				nullptr, 0.0f, FLT_MAX, { 0.0f, 50.0f });
+		}
+
+		ImGui::TreePop();
 	}
 	
 }
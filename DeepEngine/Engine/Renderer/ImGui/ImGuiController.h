@@ -8,10 +8,16 @@
 #include "Core/Scene/Scene.h"
 #include "Engine/Renderer/Vulkan/CommandBuffer.h"
 #include "Engine/Renderer/Vulkan/CommandPool.h"
+#include "Engine/Renderer/Vulkan/Fence.h"
 #include "Engine/Renderer/Vulkan/Instance/VulkanInstance.h"
 #include "Engine/Renderer/Vulkan/Events/VulkanEvents.h"
 #include "Engine/Renderer/Events.h"
-#include "Engine/Renderer/MainRenderPass.h"
+#include "Engine/Renderer/DescriptorAllocator.h"
+#include "Engine/Renderer/DrawList.h"
+#include "Engine/Renderer/RenderGraph.h"
+#include "Engine/Renderer/Vulkan/QueryPool.h"
+#include "Engine/Renderer/Vulkan/Memory/DeviceMemoryAllocator.h"
+#include "Debug/Timing.h"
 
 namespace DeepEngine::Engine::Renderer
 {
@@ -22,29 +28,101 @@ namespace DeepEngine::Engine::Renderer
 
 	public:
 		ImGuiController(Vulkan::VulkanInstance* p_vulkanInstance, const Vulkan::VulkanInstance::QueueInstance* p_mainQueue,
-			MainRenderPass* p_mainRenderPass);
+			Vulkan::QueryPool* p_queryPool, uint32_t p_framesInFlight);
 
 		void Terminate() const;
 
-		void Renderrr(uint32_t p_frameID, const Core::Scene::Scene& p_scene);
+		// Scene image shown by the viewport window of the frame, has to be in READ_ONLY_OPTIMAL when drawn.
+		// Frame fence has to be waited, texture of the frame is recreated when the view changed
+		void SetViewportImage(uint32_t p_frameIndex, VkImageView p_imageView);
+		// Builds windows of the frame, frame index selects the shown viewport image
+		void BuildFrame(uint32_t p_frameIndex, const Core::Scene::Scene& p_scene);
+		// Draws the built frame into swapchain framebuffer, recorded by the ImGui pass of the render graph
+		void RecordDrawData(VkCommandBuffer p_commandBuffer, uint32_t p_imageIndex) const;
 		void PostRenderUpdate();
 
-		Vulkan::CommandBuffer* GetCommandBuffer(uint32_t p_frameID) const
+		void SetDrawStatistics(const DrawListStatistics& p_statistics)
 		{
-			return _commandBuffers[p_frameID];
+			_drawStatistics = p_statistics;
+		}
+
+		void SetDescriptorStatistics(const DescriptorAllocatorStatistics& p_statistics)
+		{
+			_descriptorStatistics = p_statistics;
+		}
+
+		void SetRenderGraphStatistics(const RenderGraphStatistics& p_statistics)
+		{
+			_renderGraphStatistics = p_statistics;
+		}
+
+		void SetTransientImageStatistics(const TransientImageStatistics& p_statistics)
+		{
+			_transientImageStatistics = p_statistics;
+		}
+
+		// Visible count of GPU culling is framesInFlight frames old
+		void SetInstanceStatistics(uint32_t p_instancesCount, uint32_t p_visibleInstancesCount, const char* p_cullingName)
+		{
+			_instancesCount = p_instancesCount;
+			_visibleInstancesCount = p_visibleInstancesCount;
+			_instanceCullingName = p_cullingName;
+		}
+
+		// Shown as a checkbox of the profiler window, read it back after BuildFrame
+		void SetDepthPrePassEnabled(bool p_isEnabled)
+		{
+			_isDepthPrePassEnabled = p_isEnabled;
+		}
+
+		bool IsDepthPrePassEnabled() const
+		{
+			return _isDepthPrePassEnabled;
 		}
 
 	private:
 		void LoadFontLol();
+		// Releases font staging objects once the upload fence is signaled
+		void TryFinishFontUpload();
 
-		void DrawViewportWindow(uint32_t p_frameID);
+		void DrawViewportWindow(uint32_t p_frameIndex);
 		void DrawVulkanStructureWindow();
+		void DrawDeviceMemoryStatistics();
 		void DrawVulkanControllerChilds(Vulkan::BaseVulkanController* p_controller);
 		void DrawScene(const Core::Scene::Scene& p_scene);
+		void DrawProfilerWindow();
+		void DrawProfilerScope(const Debug::TimerTracker* p_tracker);
 
-		Core::Events::EventResult RecreatedRenderPassAttachmentsHandler(const MainRenderPassRecreatedAttachment& p_event);
+	private:
+		static constexpr uint32_t PROFILER_HISTORY_LENGTH = 240;
+		static constexpr uint32_t PROFILER_HISTOGRAM_BUCKETS = 32;
+		// Scope statistics are recalculated at most this often, and only for expanded scopes
+		static constexpr std::chrono::milliseconds PROFILER_STATS_INTERVAL { 250 };
 
-		void CreateRenderPassTextures();
+		struct ProfilerScopeStats
+		{
+			std::chrono::steady_clock::time_point UpdateTime;
+			uint32_t SamplesCount;
+			float Min;
+			float Max;
+			float Average;
+			float P50;
+			float P95;
+			float P99;
+			std::array<float, PROFILER_HISTOGRAM_BUCKETS> Histogram;
+		};
+
+		struct ProfilerHistory
+		{
+			std::array<float, PROFILER_HISTORY_LENGTH> Values { };
+			uint32_t Offset = 0;
+
+			void Push(float p_value)
+			{
+				Values[Offset] = p_value;
+				Offset = (Offset + 1) % PROFILER_HISTORY_LENGTH;
+			}
+		};
 
 	private:
 		// From where it should be take from????
@@ -56,15 +134,31 @@ namespace DeepEngine::Engine::Renderer
 
 		Vulkan::VulkanInstance* _vulkanInstance;
 		const Vulkan::VulkanInstance::QueueInstance* _mainQueue;
-		Vulkan::CommandPool* _commandPool;
-		std::vector<Vulkan::CommandBuffer*> _commandBuffers;
+		// Alive only until the font texture upload finishes
+		Vulkan::CommandPool* _fontUploadCommandPool = nullptr;
+		Vulkan::Fence* _fontUploadFence = nullptr;
         ImGuiRenderPass* _imGuiRenderPass = nullptr;
-        MainRenderPass* _mainRenderPass = nullptr;
-
-        std::vector<VkSampler> _renderPassTexturesSamplers;
-        std::vector<VkDescriptorSet> _renderPassTextures;
 
-		std::shared_ptr<Core::Events::EventListener<MainRenderPassRecreatedAttachment>> _attachmentsRecreatedListener;
+		VkSampler _viewportSampler = VK_NULL_HANDLE;
+		// Per frame in flight, views change when the render graph recreates its images
+		std::vector<VkImageView> _viewportViews;
+		std::vector<VkDescriptorSet> _viewportTextures;
+
+		Vulkan::QueryPool* _queryPool;
+		ProfilerHistory _cpuFrameTimes;
+		// Keyed by scope name pointer, GPU scope names are string literals
+		std::unordered_map<const char*, ProfilerHistory> _gpuScopesTimes;
+		float _profilerOverlayMilliseconds = 0.0f;
+		std::unordered_map<const Debug::TimerTracker*, ProfilerScopeStats> _profilerScopesStats;
+		std::vector<float> _profilerSamplesScratch;
+		DrawListStatistics _drawStatistics;
+		DescriptorAllocatorStatistics _descriptorStatistics;
+		RenderGraphStatistics _renderGraphStatistics;
+		TransientImageStatistics _transientImageStatistics;
+		bool _isDepthPrePassEnabled = true;
+		uint32_t _instancesCount = 0;
+		uint32_t _visibleInstancesCount = 0;
+		const char* _instanceCullingName = "";
 	};
 
 }
@@ -14,22 +14,14 @@ namespace DeepEngine::Engine::Renderer
 		baseColorAttachmentDesc.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 		baseColorAttachmentDesc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		baseColorAttachmentDesc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		baseColorAttachmentDesc.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		baseColorAttachmentDesc.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-		VkSubpassDependency dependency { };
-		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependency.dstSubpass = 0;
-		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.srcAccessMask = 0;
-		dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		// Transitioned from acquire and to present by RenderGraph barriers
+		baseColorAttachmentDesc.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		baseColorAttachmentDesc.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
             
 		CreateRenderAttachment(baseColorAttachmentDesc, &_colorAttachment);
             
 		CreateRenderSubPass(VK_PIPELINE_BIND_POINT_GRAPHICS)
 			.AddColorAttachment(_colorAttachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
-			.AddDependency(dependency)
 			.GetSubPassPtr(&_baseSubPass);
 
 		_swapChainRecreatedListener = vulkanController->GetVulkanEventBus().CreateListener<Vulkan::Events::OnSwapChainRecreated>();
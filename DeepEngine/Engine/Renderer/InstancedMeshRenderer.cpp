@@ -0,0 +1,268 @@
+#include "InstancedMeshRenderer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Debug/Timing.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+    Vulkan::PipelineVertexLayout InstancedMeshRenderer::GetVertexLayout()
+    {
+        Vulkan::PipelineVertexLayout layout = MeshVertex::GetLayout();
+        layout.AddBinding(INSTANCE_BINDING, sizeof(glm::mat4), VK_VERTEX_INPUT_RATE_INSTANCE);
+
+        // Matrix attribute takes one location per column
+        for (uint32_t column = 0; column < 4; column++)
+        {
+            layout.AddAttribute(2 + column, INSTANCE_BINDING, VK_FORMAT_R32G32B32A32_SFLOAT,
+                column * sizeof(glm::vec4));
+        }
+        return layout;
+    }
+
+    bool InstancedMeshRenderer::Init(Vulkan::VulkanInstance* p_vulkanInstance, const ShaderLibrary* p_shaderLibrary,
+        PipelineRegistry& p_pipelineRegistry, DescriptorAllocator* p_descriptorAllocator,
+        const GraphicsPipelineDescription& p_pipelineDescription, const Vulkan::GraphicsPipeline* p_fallbackPipeline,
+        const Mesh* p_mesh, uint32_t p_framesInFlight, uint32_t p_maxInstances,
+        Vulkan::PipelineLayout* p_depthPrePassLayout)
+    {
+        _mesh = p_mesh;
+        _maxInstances = p_maxInstances;
+        _instances.reserve(p_maxInstances);
+        _pipeline.Init(p_pipelineRegistry, p_pipelineDescription, p_fallbackPipeline, p_depthPrePassLayout);
+
+        _gpuCulling = new GpuFrustumCulling(p_vulkanInstance, p_shaderLibrary, p_descriptorAllocator, p_framesInFlight);
+        if (!_gpuCulling->Initialize())
+        {
+            return false;
+        }
+
+        _frames.resize(p_framesInFlight);
+        for (uint32_t i = 0; i < p_framesInFlight; i++)
+        {
+            FrameBuffers& frame = _frames[i];
+            frame.Instances = new Vulkan::Buffer(p_maxInstances * sizeof(glm::mat4),
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Vulkan::MemoryUsage::CPU_TO_GPU);
+            frame.CulledInstances = new Vulkan::Buffer(p_maxInstances * sizeof(glm::mat4),
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Vulkan::MemoryUsage::GPU_ONLY);
+            frame.IndirectCommand = new Vulkan::Buffer(sizeof(VkDrawIndexedIndirectCommand),
+                VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Vulkan::MemoryUsage::CPU_TO_GPU);
+
+            if (!p_vulkanInstance->InitializeSubController(frame.Instances)
+                || !p_vulkanInstance->InitializeSubController(frame.CulledInstances)
+                || !p_vulkanInstance->InitializeSubController(frame.IndirectCommand))
+            {
+                return false;
+            }
+
+            _gpuCulling->SetFrameBuffers(i, frame.Instances, frame.CulledInstances, frame.IndirectCommand);
+        }
+
+        return true;
+    }
+
+    void InstancedMeshRenderer::Release(PipelineRegistry& p_pipelineRegistry)
+    {
+        _pipeline.Release(p_pipelineRegistry);
+
+        for (FrameBuffers& frame : _frames)
+        {
+            for (Vulkan::Buffer* buffer : { frame.Instances, frame.CulledInstances, frame.IndirectCommand })
+            {
+                if (buffer != nullptr)
+                {
+                    buffer->Terminate();
+                }
+            }
+        }
+        _frames.clear();
+
+        delete _gpuCulling;
+        _gpuCulling = nullptr;
+
+        _instances.clear();
+    }
+
+    void InstancedMeshRenderer::BeginFrame(uint32_t p_frameIndex)
+    {
+        _gpuCulling->BeginFrame();
+        _frameIndex = p_frameIndex;
+
+        // Frame was finished, instance count added up by the culling pass is visible to the host
+        FrameBuffers& frame = _frames[p_frameIndex];
+        if (frame.GpuCulledInstancesCount > 0)
+        {
+            VkDrawIndexedIndirectCommand command;
+            memcpy(&command, frame.IndirectCommand->GetMappedData(), sizeof(command));
+            _gpuVisibleInstancesCount = command.instanceCount;
+            frame.GpuCulledInstancesCount = 0;
+        }
+
+        _instances.clear();
+        _gpuCulledInstancesCount = 0;
+        _culledInstancesResource = RenderGraph::INVALID_RESOURCE;
+        _drawCommandResource = RenderGraph::INVALID_RESOURCE;
+    }
+
+    uint32_t InstancedMeshRenderer::RebuildWithShader(const std::string& p_shaderName)
+    {
+        if (p_shaderName != GpuFrustumCulling::SHADER_NAME)
+        {
+            return 0;
+        }
+
+        // Single compute pipeline, created right away through the pipeline cache
+        return _gpuCulling->RecreatePipeline() ? 1 : 0;
+    }
+
+    bool InstancedMeshRenderer::AddInstance(const glm::mat4& p_transform)
+    {
+        if (_instances.size() == _maxInstances)
+        {
+            return false;
+        }
+
+        _instances.push_back(p_transform);
+        return true;
+    }
+
+    bool InstancedMeshRenderer::AddInstances(const std::vector<glm::mat4>& p_transforms)
+    {
+        const size_t count = std::min(p_transforms.size(), _maxInstances - _instances.size());
+        _instances.insert(_instances.end(), p_transforms.begin(), p_transforms.begin() + count);
+
+        return count == p_transforms.size();
+    }
+
+    bool InstancedMeshRenderer::AddInstances(const Core::Scene::Scene& p_scene)
+    {
+        for (auto it = p_scene.Begin(); it != p_scene.End(); ++it)
+        {
+            if (!AddInstance(it->GetTransform().GetLocalTransform()))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void InstancedMeshRenderer::Draw(DrawList& p_drawList, const Frustum& p_frustum)
+    {
+        _visibleInstancesCount = static_cast<uint32_t>(_instances.size());
+
+        // Fallback pipeline has no vertex input
+        if (_instances.empty() || _pipeline.IsUsingFallbackPipeline())
+        {
+            return;
+        }
+
+        FrameBuffers& frame = _frames[_frameIndex];
+        const auto mappedInstances = static_cast<glm::mat4*>(frame.Instances->GetMappedData());
+
+        VkDrawIndexedIndirectCommand command { };
+        command.indexCount = _mesh->GetIndicesCount();
+        command.instanceCount = static_cast<uint32_t>(_instances.size());
+        command.firstIndex = 0;
+        command.vertexOffset = 0;
+        command.firstInstance = 0;
+
+        DrawPacket packet { };
+        packet.Pipeline = _pipeline.GetGraphicsPipeline();
+        packet.DepthPipeline = _pipeline.GetDepthPipeline();
+        _mesh->FillDrawPacket(packet);
+        packet.InstanceBuffer = frame.Instances->GetVkBuffer();
+        packet.InstanceBufferOffset = 0;
+        packet.IndirectBuffer = frame.IndirectCommand->GetVkBuffer();
+        packet.IndirectBufferOffset = 0;
+        packet.IndirectDrawsCount = 1;
+
+        switch (_cullingMode)
+        {
+        case InstanceCullingMode::NONE:
+            // Mapped memory is write combined, one sequential copy is the fastest way to fill it
+            memcpy(mappedInstances, _instances.data(), _instances.size() * sizeof(glm::mat4));
+            break;
+
+        case InstanceCullingMode::CPU:
+            CullOnCpu(p_frustum, mappedInstances);
+            command.instanceCount = _visibleInstancesCount;
+            break;
+
+        case InstanceCullingMode::GPU:
+            memcpy(mappedInstances, _instances.data(), _instances.size() * sizeof(glm::mat4));
+            // Counted up by the compute pass
+            command.instanceCount = 0;
+            packet.InstanceBuffer = frame.CulledInstances->GetVkBuffer();
+            _frustum = p_frustum;
+            _gpuCulledInstancesCount = static_cast<uint32_t>(_instances.size());
+            frame.GpuCulledInstancesCount = _gpuCulledInstancesCount;
+            _visibleInstancesCount = _gpuVisibleInstancesCount;
+            break;
+        }
+
+        memcpy(frame.IndirectCommand->GetMappedData(), &command, sizeof(command));
+        p_drawList.Add(packet);
+    }
+
+    void InstancedMeshRenderer::AddCullingPass(RenderGraph& p_graph)
+    {
+        if (_gpuCulledInstancesCount == 0)
+        {
+            return;
+        }
+
+        const FrameBuffers& frame = _frames[_frameIndex];
+        // Host writes are visible to the whole submission, and the frame fence was waited for before they were done
+        const RenderGraph::ResourceID instances = p_graph.ImportBuffer("Instances", frame.Instances->GetVkBuffer(),
+            RenderGraphUsage::None());
+        _culledInstancesResource = p_graph.ImportBuffer("Culled instances", frame.CulledInstances->GetVkBuffer(),
+            RenderGraphUsage::None());
+        _drawCommandResource = p_graph.ImportBuffer("Instances draw command", frame.IndirectCommand->GetVkBuffer(),
+            RenderGraphUsage::None());
+
+        p_graph.AddPass("Frustum culling", [this](VkCommandBuffer p_commandBuffer)
+            {
+                _gpuCulling->Record(p_commandBuffer, _frameIndex, _frustum, _mesh->GetBoundingSphere(),
+                    _gpuCulledInstancesCount);
+            })
+            .Read(instances, RenderGraphUsage::ComputeStorageRead())
+            .Write(_culledInstancesResource, RenderGraphUsage::ComputeStorageWrite())
+            // Instance count is added up from the value written by the CPU
+            .Read(_drawCommandResource, RenderGraphUsage::ComputeStorageWrite())
+            .Write(_drawCommandResource, RenderGraphUsage::ComputeStorageWrite());
+    }
+
+    void InstancedMeshRenderer::ReadDrawInputs(RenderGraph::PassBuilder& p_pass) const
+    {
+        if (_culledInstancesResource == RenderGraph::INVALID_RESOURCE)
+        {
+            return;
+        }
+
+        p_pass.Read(_culledInstancesResource, RenderGraphUsage::VertexInput());
+        p_pass.Read(_drawCommandResource, RenderGraphUsage::IndirectCommand());
+    }
+
+    void InstancedMeshRenderer::CullOnCpu(const Frustum& p_frustum, glm::mat4* p_outInstances)
+    {
+        TIMER("Cull instances on CPU");
+
+        const BoundingSphere& meshSphere = _mesh->GetBoundingSphere();
+
+        _spheres.Clear();
+        _spheres.Reserve(static_cast<uint32_t>(_instances.size()));
+        for (const glm::mat4& transform : _instances)
+        {
+            _spheres.Add(meshSphere.Transformed(transform));
+        }
+
+        _visibleIndices.resize(_instances.size());
+        _visibleInstancesCount = CullSpheres(p_frustum, _spheres, _visibleIndices.data());
+
+        for (uint32_t i = 0; i < _visibleInstancesCount; i++)
+        {
+            p_outInstances[i] = _instances[_visibleIndices[i]];
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include "Core/Scene/Scene.h"
+#include "DrawList.h"
+#include "FrustumCulling.h"
+#include "GpuFrustumCulling.h"
+#include "Mesh.h"
+#include "RenderGraph.h"
+#include "TriangleRenderer.h"
+#include "Vulkan/Buffer.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+
+    enum class InstanceCullingMode
+    {
+        NONE,
+        // Spheres tested on the CPU (AVX when available), only visible transforms are written
+        CPU,
+        // All transforms are written, compute pass compacts visible ones and fills the draw command
+        GPU,
+    };
+
+    // Draws any number of copies of one mesh with a single indirect draw, so draw calls do not grow with objects.
+    // Every frame in flight has its own persistently mapped instance buffer (transforms read as per instance
+    // vertex attributes, Shader/meshInstanced.vert) and indirect command buffer. Instances outside the frustum
+    // are culled by the CPU or by a compute pass, see InstanceCullingMode.
+    class InstancedMeshRenderer
+    {
+    public:
+        static constexpr uint32_t INSTANCE_BINDING = 1;
+
+        // MeshVertex layout plus transform at locations 2-5 from INSTANCE_BINDING
+        static Vulkan::PipelineVertexLayout GetVertexLayout();
+
+        InstancedMeshRenderer() = default;
+
+        // Shader library and descriptor allocator provide the shader and sets of GPU culling, depth layout enables
+        // drawing in the depth pre-pass
+        bool Init(Vulkan::VulkanInstance* p_vulkanInstance, const ShaderLibrary* p_shaderLibrary,
+            PipelineRegistry& p_pipelineRegistry, DescriptorAllocator* p_descriptorAllocator,
+            const GraphicsPipelineDescription& p_pipelineDescription, const Vulkan::GraphicsPipeline* p_fallbackPipeline,
+            const Mesh* p_mesh, uint32_t p_framesInFlight, uint32_t p_maxInstances,
+            Vulkan::PipelineLayout* p_depthPrePassLayout = nullptr);
+
+        // GPU can not use any frame anymore
+        void Release(PipelineRegistry& p_pipelineRegistry);
+
+        void UpdatePipeline()
+        { _pipeline.UpdatePipeline(); }
+
+        bool IsPipelinePending() const
+        { return _pipeline.IsPipelinePending(); }
+
+        void SetCullingMode(InstanceCullingMode p_mode)
+        { _cullingMode = p_mode; }
+
+        InstanceCullingMode GetCullingMode() const
+        { return _cullingMode; }
+
+        // Starts gathering instances drawn in the frame, previous submission of the frame has to be finished
+        void BeginFrame(uint32_t p_frameIndex);
+
+        // Recreates the culling pipeline when it uses the reloaded shader (graphics pipelines are rebuilt by the
+        // registry), returns how many pipelines were recreated
+        uint32_t RebuildWithShader(const std::string& p_shaderName);
+
+        // Return false when instances do not fit, those above capacity are dropped
+        bool AddInstance(const glm::mat4& p_transform);
+        bool AddInstances(const std::vector<glm::mat4>& p_transforms);
+        // Every element of the scene, with its local transform
+        bool AddInstances(const Core::Scene::Scene& p_scene);
+
+        // Culls on the CPU or prepares the GPU culling, then writes instances of the frame
+        void Draw(DrawList& p_drawList, const Frustum& p_frustum);
+
+        // Adds compute pass of GPU culling when the frame is culled on the GPU, after Draw
+        void AddCullingPass(RenderGraph& p_graph);
+
+        // Declares buffers written by the culling pass on the pass which records the draw list
+        void ReadDrawInputs(RenderGraph::PassBuilder& p_pass) const;
+
+        uint32_t GetInstancesCount() const
+        { return static_cast<uint32_t>(_instances.size()); }
+
+        // Instances drawn in the last frame. GPU culling count is read back from the draw command when the frame
+        // slot is reused, so it belongs to the frame framesInFlight frames older
+        uint32_t GetVisibleInstancesCount() const
+        { return _visibleInstancesCount; }
+
+        uint32_t GetMaxInstances() const
+        { return _maxInstances; }
+
+    private:
+        struct FrameBuffers
+        {
+            // Host visible, every instance for GPU culling, otherwise only the drawn ones
+            Vulkan::Buffer* Instances = nullptr;
+            // Device local, filled by GPU culling
+            Vulkan::Buffer* CulledInstances = nullptr;
+            Vulkan::Buffer* IndirectCommand = nullptr;
+            // Instances given to GPU culling when the frame was drawn last time, 0 when it was not culled on the GPU
+            uint32_t GpuCulledInstancesCount = 0;
+        };
+
+        void CullOnCpu(const Frustum& p_frustum, glm::mat4* p_outInstances);
+
+    private:
+        // Owns pipeline handles and swaps fallback for the compiled pipeline
+        TriangleRenderer _pipeline;
+        const Mesh* _mesh = nullptr;
+        GpuFrustumCulling* _gpuCulling = nullptr;
+        InstanceCullingMode _cullingMode = InstanceCullingMode::GPU;
+
+        std::vector<FrameBuffers> _frames;
+        uint32_t _maxInstances = 0;
+
+        uint32_t _frameIndex = 0;
+        std::vector<glm::mat4> _instances;
+        uint32_t _visibleInstancesCount = 0;
+        // Read back in BeginFrame from the previous use of the frame slot
+        uint32_t _gpuVisibleInstancesCount = 0;
+        // Frustum and count given to the culling recorded this frame
+        Frustum _frustum { };
+        uint32_t _gpuCulledInstancesCount = 0;
+        // Written by the culling pass of the current graph, INVALID_RESOURCE without one
+        RenderGraph::ResourceID _culledInstancesResource = RenderGraph::INVALID_RESOURCE;
+        RenderGraph::ResourceID _drawCommandResource = RenderGraph::INVALID_RESOURCE;
+
+        BoundingSpheres _spheres;
+        std::vector<uint32_t> _visibleIndices;
+    };
+
+}
@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+
 #include "Vulkan/RenderPass.h"
 #include "Vulkan/PipelineLayout.h"
 #include "Vulkan/Events/VulkanEvents.h"
@@ -7,80 +9,98 @@
 namespace DeepEngine::Engine::Renderer
 {
 
-    BEGIN_LOCAL_EVENT_DEFINITION(MainRenderPassRecreatedAttachment)
-    END_EVENT_DEFINITION
-
+    // Scene color and depth are transient images of the render graph, the pass only keeps the size the viewport
+    // wants them in. First subpass only writes depth (depth pre-pass, left empty when disabled), second one shades
+    // with depth test against it, so occluded fragments are rejected before the fragment shader runs.
+    // Depth is never stored, it is an attachment only image which may stay in tile memory.
     class MainRenderPass : public Vulkan::RenderPass
     {
+    public:
+        static constexpr VkFormat COLOR_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+
     protected:
         void Initialize() override
         {
             auto vulkanController = GetVulkanInstanceController();
             
             VkAttachmentDescription baseColorAttachmentDesc { };
-            baseColorAttachmentDesc.format = VK_FORMAT_R8G8B8A8_SRGB;
+            baseColorAttachmentDesc.format = COLOR_FORMAT;
             baseColorAttachmentDesc.samples = VK_SAMPLE_COUNT_1_BIT;
             baseColorAttachmentDesc.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
             baseColorAttachmentDesc.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
             baseColorAttachmentDesc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
             baseColorAttachmentDesc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-            baseColorAttachmentDesc.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            // Layout transitions and synchronization with the other passes are done by RenderGraph barriers
+            baseColorAttachmentDesc.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
             baseColorAttachmentDesc.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-            
-            VkSubpassDependency dependency { };
-            dependency.srcSubpass = VK_SUBPASS_EXTERNAL; // Take last operating 
-            dependency.dstSubpass = 0; // ours
-            dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT; // Wait for finish reading from it from another process
-            dependency.srcAccessMask = 0;
-            dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
             
             CreateRenderAttachment(baseColorAttachmentDesc, &_colorAttachment);
-            
+
+            _depthFormat = FindDepthFormat(vulkanController->GetPhysicalDevice());
+
+            VkAttachmentDescription depthAttachmentDesc { };
+            depthAttachmentDesc.format = _depthFormat;
+            depthAttachmentDesc.samples = VK_SAMPLE_COUNT_1_BIT;
+            depthAttachmentDesc.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+            depthAttachmentDesc.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            depthAttachmentDesc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            depthAttachmentDesc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            depthAttachmentDesc.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            depthAttachmentDesc.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+            CreateRenderAttachment(depthAttachmentDesc, &_depthAttachment);
+
+            CreateRenderSubPass(VK_PIPELINE_BIND_POINT_GRAPHICS)
+                .SetDepthStencilAttachment(_depthAttachment, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+                .GetSubPassPtr(&_depthPrePassSubPass);
+
+            // Shading reads depth written by the pre-pass, only within the same pixel
+            VkSubpassDependency depthDependency { };
+            depthDependency.srcSubpass = 0;
+            depthDependency.dstSubpass = 1;
+            depthDependency.srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
+                | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            depthDependency.dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
+                | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            depthDependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            depthDependency.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT
+                | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            depthDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
             CreateRenderSubPass(VK_PIPELINE_BIND_POINT_GRAPHICS)
                 .AddColorAttachment(_colorAttachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
-                .AddDependency(dependency)
+                .SetDepthStencilAttachment(_depthAttachment, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+                .AddDependency(depthDependency)
                 .GetSubPassPtr(&_baseSubPass);
 
             _swapChainRecreatedListener = vulkanController->GetVulkanEventBus().CreateListener<Events::OnViewportResized>();
             _swapChainRecreatedListener->BindCallback(&MainRenderPass::SwapChainRecreatedHandler, this);
         }
 
-        void PostInitialize() override
-        {
-            RecreateFrameBuffers(800, 600);
-        }
-
-        void OnTerminate() override
+    public:
+        Vulkan::PipelineLayout* CreateBaseSubPassPipelineLayout(
+            const std::vector<const Vulkan::DescriptorSetLayout*>& p_setLayouts = { },
+            const std::vector<VkPushConstantRange>& p_pushConstantRanges = { })
         {
-            RenderPass::OnTerminate();
-            
-            for (const VkFramebuffer framebuffer : _framebuffers)
-            {
-                vkDestroyFramebuffer(GetVulkanInstanceController()->GetLogicalDevice(), framebuffer, nullptr);
-            }
-
-            for (const VkImageView imageView : _renderImagesViews)
-            {
-                vkDestroyImageView(GetVulkanInstanceController()->GetLogicalDevice(), imageView, nullptr);
-            }
-
-            for (const VkImage image : _renderImages)
-            {
-                vkDestroyImage(GetVulkanInstanceController()->GetLogicalDevice(), image, nullptr);
-            }
-
-            for (const VkDeviceMemory memory : _renderImageMem)
+            auto pipelineLayout = new Vulkan::PipelineLayout(this, _baseSubPass->ID, p_setLayouts,
+                p_pushConstantRanges);
+            if (!InitializeSubController(pipelineLayout))
             {
-                vkFreeMemory(GetVulkanInstanceController()->GetLogicalDevice(), memory, nullptr);
+                pipelineLayout->Terminate();
+                return nullptr;
             }
+            
+            return pipelineLayout;
         }
 
-    public:
-        Vulkan::PipelineLayout* CreateBaseSubPassPipelineLayout()
+        // Layout of depth only pipelines of the pre-pass, has to be given the same sets and push constants
+        // as the base subpass layout
+        Vulkan::PipelineLayout* CreateDepthPrePassPipelineLayout(
+            const std::vector<const Vulkan::DescriptorSetLayout*>& p_setLayouts = { },
+            const std::vector<VkPushConstantRange>& p_pushConstantRanges = { })
         {
-            auto pipelineLayout = new Vulkan::PipelineLayout(this, _baseSubPass->ID);
+            auto pipelineLayout = new Vulkan::PipelineLayout(this, _depthPrePassSubPass->ID, p_setLayouts,
+                p_pushConstantRanges);
             if (!InitializeSubController(pipelineLayout))
             {
                 pipelineLayout->Terminate();
@@ -90,197 +110,58 @@ namespace DeepEngine::Engine::Renderer
             return pipelineLayout;
         }
 
-        VkFramebuffer GetVkFramebuffer(uint32_t p_index) const
+        uint32_t GetDepthPrePassSubPassIndex() const
         {
-            return _framebuffers[p_index];
+            return _depthPrePassSubPass->ID;
         }
 
-        VkImage GetVkImage(uint32_t p_index) const
+        uint32_t GetBaseSubPassIndex() const
         {
-            return _renderImages[p_index];
+            return _baseSubPass->ID;
         }
 
-        VkImageView GetVkImageView(uint32_t p_index) const
+        VkFormat GetDepthFormat() const
         {
-            return _renderImagesViews[p_index];
+            return _depthFormat;
         }
 
-        const std::vector<VkFramebuffer>& GetAllVkFramebuffer() const
+        // Size of the scene color image and the render area
+        VkExtent2D GetExtent() const
         {
-            return _framebuffers;
+            return _extent;
         }
 
     private:
-        void RecreateFrameBuffers(uint32_t p_width, uint32_t p_height)
+        // D32 when it can be an attachment, D16 always can
+        static VkFormat FindDepthFormat(VkPhysicalDevice p_physicalDevice)
         {
-            uint32_t imageCount = static_cast<uint32_t>(GetVulkanInstanceController()->GetSwapChainImageViews().size());
-            glm::vec2 framebufferSize = GetVulkanInstanceController()->GetFrameBufferSize();
-
-            for (const VkFramebuffer framebuffer : _framebuffers)
-            {
-                vkDestroyFramebuffer(GetVulkanInstanceController()->GetLogicalDevice(), framebuffer, nullptr);
-            }
-
-            for (const VkImageView imageView : _renderImagesViews)
+            VkFormatProperties properties;
+            vkGetPhysicalDeviceFormatProperties(p_physicalDevice, VK_FORMAT_D32_SFLOAT, &properties);
+            if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
             {
-                vkDestroyImageView(GetVulkanInstanceController()->GetLogicalDevice(), imageView, nullptr);
+                return VK_FORMAT_D32_SFLOAT;
             }
-
-            for (const VkImage image : _renderImages)
-            {
-                vkDestroyImage(GetVulkanInstanceController()->GetLogicalDevice(), image, nullptr);
-            }
-
-            for (const VkDeviceMemory memory : _renderImageMem)
-            {
-                vkFreeMemory(GetVulkanInstanceController()->GetLogicalDevice(), memory, nullptr);
-            }
-
-            _renderImages.clear();
-            _renderImages.resize(imageCount);
-            _renderImagesViews.clear();
-            _renderImagesViews.resize(imageCount);
-            _framebuffers.clear();
-            _framebuffers.resize(imageCount);
-            _renderImageMem.clear();
-            _renderImageMem.resize(imageCount);
-            
-            for (uint32_t i = 0; i < imageCount; i++)
-            {
-                CreateImage(p_width, p_height,
-                    VK_FORMAT_R8G8B8A8_SRGB,
-                    VK_IMAGE_TILING_OPTIMAL,
-                    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL | VK_IMAGE_LAYOUT_GENERAL,
-                    _renderImages[i],
-                    _renderImageMem[i]);
-
-                VkImageViewCreateInfo viewInfo{};
-                viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-                viewInfo.image = _renderImages[i];
-                viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-                viewInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
-                viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-                viewInfo.subresourceRange.baseMipLevel = 0;
-                viewInfo.subresourceRange.levelCount = 1;
-                viewInfo.subresourceRange.baseArrayLayer = 0;
-                viewInfo.subresourceRange.layerCount = 1;
-
-                VkResult result = vkCreateImageView(
-                    GetVulkanInstanceController()->GetLogicalDevice(),
-                    &viewInfo,
-                    nullptr,
-                    &_renderImagesViews[i]);
-
-                if (result != VK_SUCCESS)
-                {
-                    continue;
-                }
-                
-                VkImageView attachments[] { _renderImagesViews[i] };
-                    
-                VkFramebufferCreateInfo createInfo { };
-                createInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-                createInfo.renderPass = GetVkRenderPass();
-                createInfo.attachmentCount = 1;
-                createInfo.pAttachments = attachments;
-                createInfo.width = framebufferSize.x;
-                createInfo.height = framebufferSize.y;
-                createInfo.layers = 1;
-
-                VkFramebuffer _framebuffer;
-                result = vkCreateFramebuffer(
-                    GetVulkanInstanceController()->GetLogicalDevice(),
-                    &createInfo,
-                    nullptr,
-                    &_framebuffer);
-
-                if (result != VK_SUCCESS)
-                {
-                    VULKAN_ERR("Failed to create SwapChain image view! (result: {})", string_VkResult(result));
-                    continue;
-                }
-
-                _framebuffers[i] = _framebuffer;
-            }
-
-            GetVulkanInstanceController()->GetRendererEventBus().Publish<MainRenderPassRecreatedAttachment>();
-        }
-
-        void CreateImage(uint32_t p_width, uint32_t p_height, VkFormat p_format, VkImageTiling p_tiling,
-            VkImageUsageFlags p_usage, VkMemoryPropertyFlags p_properties, VkImage& p_image, VkDeviceMemory& p_imageMemory)
-        {
-            VkImageCreateInfo imageInfo { };
-            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-            imageInfo.imageType = VK_IMAGE_TYPE_2D;
-            imageInfo.extent.width = p_width;
-            imageInfo.extent.height = p_height;
-            imageInfo.extent.depth = 1;
-            imageInfo.mipLevels = 1;
-            imageInfo.arrayLayers = 1;
-            imageInfo.format = p_format;
-            imageInfo.tiling = p_tiling;
-            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            imageInfo.usage = p_usage;
-            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-            auto result = vkCreateImage(GetVulkanInstanceController()->GetLogicalDevice(), &imageInfo, nullptr, &p_image);
-            if (result != VK_SUCCESS)
-            {
-                return;
-            }
-
-            VkMemoryRequirements memRequirements;
-            vkGetImageMemoryRequirements(GetVulkanInstanceController()->GetLogicalDevice(), p_image, &memRequirements);
-
-            VkMemoryAllocateInfo allocInfo { };
-            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            allocInfo.allocationSize = memRequirements.size;
-            allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, p_properties);
-
-            result = vkAllocateMemory(GetVulkanInstanceController()->GetLogicalDevice(), &allocInfo, nullptr, &p_imageMemory);
-            if (result != VK_SUCCESS)
-            {
-                return;
-            }
-
-            vkBindImageMemory(GetVulkanInstanceController()->GetLogicalDevice(), p_image, p_imageMemory, 0);
-        }
-
-        uint32_t FindMemoryType(uint32_t p_typeFilter, VkMemoryPropertyFlags p_properties)
-        {
-            VkPhysicalDeviceMemoryProperties memProperties;
-            vkGetPhysicalDeviceMemoryProperties(GetVulkanInstanceController()->GetPhysicalDevice(), &memProperties);
-            
-            for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
-            {
-                if ((p_typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & p_properties) == p_properties)
-                {
-                    return i;
-                }
-            }
-
-            // do sth ;-;
-            return 0;
+            return VK_FORMAT_D16_UNORM;
         }
 
         Core::Events::EventResult SwapChainRecreatedHandler(const Events::OnViewportResized& p_event)
         {
-            RecreateFrameBuffers(p_event.NewViewportSize.x, p_event.NewViewportSize.y);
+            // Minimized viewport window would request an empty image
+            _extent.width = std::max(static_cast<uint32_t>(p_event.NewViewportSize.x), 1u);
+            _extent.height = std::max(static_cast<uint32_t>(p_event.NewViewportSize.y), 1u);
             return Core::Events::EventResult::PASS;
         }
 
     private:
         std::shared_ptr<Core::Events::EventListener<Events::OnViewportResized>> _swapChainRecreatedListener;
         
+        RenderSubPass* _depthPrePassSubPass;
         RenderSubPass* _baseSubPass;
         const RenderAttachment* _colorAttachment;
+        const RenderAttachment* _depthAttachment;
+        VkFormat _depthFormat = VK_FORMAT_UNDEFINED;
 
-        std::vector<VkImage> _renderImages;
-        std::vector<VkDeviceMemory> _renderImageMem;
-        std::vector<VkImageView> _renderImagesViews;
-        std::vector<VkFramebuffer> _framebuffers;
+        VkExtent2D _extent { 800, 600 };
     };
     
 }
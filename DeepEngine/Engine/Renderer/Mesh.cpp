@@ -0,0 +1,60 @@
+#include "Mesh.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+    bool Mesh::Create(Vulkan::VulkanInstance* p_vulkanInstance, UploadQueue& p_uploadQueue,
+        const void* p_vertices, VkDeviceSize p_verticesSize, const std::vector<uint32_t>& p_indices)
+    {
+        const VkDeviceSize indicesSize = p_indices.size() * sizeof(uint32_t);
+
+        _vertexBuffer = new Vulkan::Buffer(p_verticesSize,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, Vulkan::MemoryUsage::GPU_ONLY);
+        _indexBuffer = new Vulkan::Buffer(indicesSize,
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, Vulkan::MemoryUsage::GPU_ONLY);
+
+        if (!p_vulkanInstance->InitializeSubController(_vertexBuffer)
+            || !p_vulkanInstance->InitializeSubController(_indexBuffer))
+        {
+            Destroy();
+            return false;
+        }
+
+        if (!p_uploadQueue.Upload(_vertexBuffer, 0, p_vertices, p_verticesSize)
+            || !p_uploadQueue.Upload(_indexBuffer, 0, p_indices.data(), indicesSize))
+        {
+            Destroy();
+            return false;
+        }
+
+        _indicesCount = static_cast<uint32_t>(p_indices.size());
+        return true;
+    }
+
+    void Mesh::Destroy()
+    {
+        if (_vertexBuffer != nullptr)
+        {
+            _vertexBuffer->Terminate();
+            _vertexBuffer = nullptr;
+        }
+        if (_indexBuffer != nullptr)
+        {
+            _indexBuffer->Terminate();
+            _indexBuffer = nullptr;
+        }
+        _indicesCount = 0;
+        _boundingSphere = { };
+    }
+
+    void Mesh::FillDrawPacket(DrawPacket& p_packet) const
+    {
+        p_packet.VertexBuffer = _vertexBuffer->GetVkBuffer();
+        p_packet.VertexBufferOffset = 0;
+        p_packet.IndexBuffer = _indexBuffer->GetVkBuffer();
+        p_packet.IndexBufferOffset = 0;
+        p_packet.IndexType = VK_INDEX_TYPE_UINT32;
+        p_packet.ElementsCount = _indicesCount;
+        p_packet.FirstElement = 0;
+        p_packet.VertexOffset = 0;
+    }
+}
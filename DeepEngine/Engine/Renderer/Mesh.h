@@ -0,0 +1,107 @@
+#pragma once
+#include <cfloat>
+
+#include "DrawList.h"
+#include "FrustumCulling.h"
+#include "UploadQueue.h"
+#include "Vulkan/Buffer.h"
+#include "Vulkan/GraphicsPipeline.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+
+    struct MeshVertex
+    {
+        glm::vec3 Position;
+        glm::vec3 Color;
+
+        // Matches Shader/mesh.vert
+        static Vulkan::PipelineVertexLayout GetLayout()
+        {
+            Vulkan::PipelineVertexLayout layout;
+            layout.AddBinding(0, sizeof(MeshVertex))
+                .AddAttribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(MeshVertex, Position))
+                .AddAttribute(1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(MeshVertex, Color));
+            return layout;
+        }
+    };
+
+    // Per draw data of mesh renderers, matches push constant block of Shader/mesh.vert
+    struct MeshPushConstants
+    {
+        glm::mat4 Model;
+
+        // Range of the layout shared by scene pipelines
+        static VkPushConstantRange GetRange()
+        {
+            VkPushConstantRange range { };
+            range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+            range.offset = 0;
+            range.size = sizeof(MeshPushConstants);
+            return range;
+        }
+    };
+
+    // Device local vertex and index buffers filled through the UploadQueue.
+    // Data reaches the GPU with the next UploadQueue::Flush, frames drawing the mesh have to be submitted with
+    // the UploadQueue::PrepareFrame sync taken after that flush.
+    class Mesh
+    {
+    public:
+        Mesh() = default;
+
+        template <typename TVertex>
+        bool Create(Vulkan::VulkanInstance* p_vulkanInstance, UploadQueue& p_uploadQueue,
+            const std::vector<TVertex>& p_vertices, const std::vector<uint32_t>& p_indices)
+        {
+            if constexpr (requires (const TVertex& p_vertex) { glm::vec3(p_vertex.Position); })
+            {
+                // Centered on the bounds box, not minimal but good enough for culling
+                glm::vec3 min(FLT_MAX);
+                glm::vec3 max(-FLT_MAX);
+                for (const TVertex& vertex : p_vertices)
+                {
+                    min = glm::min(min, glm::vec3(vertex.Position));
+                    max = glm::max(max, glm::vec3(vertex.Position));
+                }
+
+                _boundingSphere.Center = (min + max) * 0.5f;
+                _boundingSphere.Radius = 0.0f;
+                for (const TVertex& vertex : p_vertices)
+                {
+                    _boundingSphere.Radius = std::max(_boundingSphere.Radius,
+                        glm::length(glm::vec3(vertex.Position) - _boundingSphere.Center));
+                }
+            }
+
+            return Create(p_vulkanInstance, p_uploadQueue, p_vertices.data(), p_vertices.size() * sizeof(TVertex),
+                p_indices);
+        }
+
+        bool Create(Vulkan::VulkanInstance* p_vulkanInstance, UploadQueue& p_uploadQueue,
+            const void* p_vertices, VkDeviceSize p_verticesSize, const std::vector<uint32_t>& p_indices);
+
+        // GPU can not use the mesh anymore
+        void Destroy();
+
+        // Fills geometry part of the packet, pipeline and the rest are up to the caller
+        void FillDrawPacket(DrawPacket& p_packet) const;
+
+        bool IsCreated() const
+        { return _vertexBuffer != nullptr; }
+
+        uint32_t GetIndicesCount() const
+        { return _indicesCount; }
+
+        // Mesh space, empty when created from raw vertex bytes
+        const BoundingSphere& GetBoundingSphere() const
+        { return _boundingSphere; }
+
+    private:
+        Vulkan::Buffer* _vertexBuffer = nullptr;
+        Vulkan::Buffer* _indexBuffer = nullptr;
+        uint32_t _indicesCount = 0;
+        BoundingSphere _boundingSphere;
+    };
+
+}
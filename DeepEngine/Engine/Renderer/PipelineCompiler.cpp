@@ -0,0 +1,68 @@
+#include "PipelineCompiler.h"
+
+#include "Debug/Timing.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+    std::shared_ptr<PipelineHandle> PipelineCompiler::CompileAsync(const GraphicsPipelineDescription& p_description)
+    {
+        auto promise = std::make_shared<std::promise<Vulkan::GraphicsPipeline*>>();
+        auto handle = std::make_shared<PipelineHandle>(promise->get_future().share());
+
+        _pendingCount.fetch_add(1, std::memory_order_relaxed);
+
+        _threadPool->Submit([this, promise, p_description](uint32_t)
+        {
+            TIMER("Compile pipeline (async)");
+            promise->set_value(CompileNow(p_description));
+
+            std::lock_guard lock(_idleMutex);
+            if (_pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                _idleCondition.notify_all();
+            }
+        });
+
+        return handle;
+    }
+
+    Vulkan::GraphicsPipeline* PipelineCompiler::CompileNow(const GraphicsPipelineDescription& p_description) const
+    {
+        Vulkan::PipelineLayout* pipelineLayout = p_description.PipelineLayout;
+
+        // Modules are owned by the library and shared by every pipeline using them
+        const Vulkan::ShaderModule* vertShader = _shaderLibrary->Get(p_description.VertexShader);
+        if (vertShader == nullptr || vertShader->GetShaderStageFlags() != VK_SHADER_STAGE_VERTEX_BIT)
+        {
+            VULKAN_ERR("There is no vertex shader \"{}\"", p_description.VertexShader);
+            return nullptr;
+        }
+
+        const Vulkan::ShaderModule* fragShader = nullptr;
+        if (!p_description.FragmentShader.empty())
+        {
+            fragShader = _shaderLibrary->Get(p_description.FragmentShader);
+            if (fragShader == nullptr || fragShader->GetShaderStageFlags() != VK_SHADER_STAGE_FRAGMENT_BIT)
+            {
+                VULKAN_ERR("There is no fragment shader \"{}\"", p_description.FragmentShader);
+                return nullptr;
+            }
+        }
+
+        auto pipeline = new Vulkan::GraphicsPipeline(pipelineLayout, vertShader, fragShader,
+            p_description.VertexLayout, p_description.DynamicState, p_description.ColorBlend, p_description.AttachmentsBlend,
+            p_description.Rasterization, p_description.DepthStencil);
+        if (!pipelineLayout->InitializeSubController(pipeline))
+        {
+            pipeline->Terminate();
+            return nullptr;
+        }
+        return pipeline;
+    }
+
+    void PipelineCompiler::WaitIdle()
+    {
+        std::unique_lock lock(_idleMutex);
+        _idleCondition.wait(lock, [this] { return _pendingCount.load(std::memory_order_acquire) == 0; });
+    }
+}
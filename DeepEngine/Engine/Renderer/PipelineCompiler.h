@@ -0,0 +1,132 @@
+#pragma once
+#include <future>
+
+#include "Core/Threading/ThreadPool.h"
+#include "ShaderLibrary.h"
+#include "Vulkan/GraphicsPipeline.h"
+#include "Vulkan/PipelineLayout.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+
+    // Everything needed to create graphics pipeline, copied into the compilation task
+    struct GraphicsPipelineDescription
+    {
+        // Names of the shaders in the ShaderLibrary
+        std::string VertexShader;
+        // Empty for depth only pipelines
+        std::string FragmentShader;
+
+        Vulkan::PipelineVertexLayout VertexLayout;
+        Vulkan::PipelineDynamicState DynamicState;
+        Vulkan::PipelineColorBlend ColorBlend;
+        std::vector<Vulkan::PipelineColorBlendAttachment> AttachmentsBlend;
+        Vulkan::PipelineRasterization Rasterization;
+        Vulkan::PipelineDepthStencil DepthStencil;
+
+        Vulkan::PipelineLayout* PipelineLayout;
+
+        // Same vertex stage and depth state without fragment shader and color attachments, for a depth only
+        // subpass. Layout should have the same sets and push constants, so draws need no rebinding
+        GraphicsPipelineDescription GetDepthOnly(Vulkan::PipelineLayout* p_depthLayout) const
+        {
+            GraphicsPipelineDescription description = *this;
+            description.FragmentShader.clear();
+            description.AttachmentsBlend.clear();
+            description.PipelineLayout = p_depthLayout;
+            return description;
+        }
+    };
+
+    // Result of asynchronous compilation. Pipeline is owned by its PipelineLayout (as every controller),
+    // handle only tells whether it is ready.
+    class PipelineHandle
+    {
+    public:
+        PipelineHandle(std::shared_future<Vulkan::GraphicsPipeline*> p_future)
+            : _future(std::move(p_future))
+        { }
+
+        bool IsReady() const
+        { return _future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+        // Ready but compilation failed
+        bool HasFailed() const
+        { return IsReady() && _future.get() == nullptr; }
+
+        // Never blocks, nullptr until compiled (or when compilation failed)
+        const Vulkan::GraphicsPipeline* GetPipeline() const
+        { return IsReady() ? _future.get() : nullptr; }
+
+        const Vulkan::GraphicsPipeline* GetPipelineOr(const Vulkan::GraphicsPipeline* p_fallback) const
+        {
+            const Vulkan::GraphicsPipeline* pipeline = GetPipeline();
+            return pipeline != nullptr ? pipeline : p_fallback;
+        }
+
+        const Vulkan::GraphicsPipeline* Wait() const
+        { return _future.get(); }
+
+        // Set by PipelineRegistry at a frame boundary once the pipeline was rebuilt with reloaded shaders (the
+        // replacement is compiled by then). Render thread only
+        void SetReplacement(std::shared_ptr<PipelineHandle> p_replacement)
+        { _replacement = std::move(p_replacement); }
+
+        bool IsReplaced() const
+        { return _replacement != nullptr; }
+
+        // Last handle in the chain of replacements
+        static std::shared_ptr<PipelineHandle> GetLatest(std::shared_ptr<PipelineHandle> p_handle)
+        {
+            while (p_handle->_replacement != nullptr)
+            {
+                p_handle = p_handle->_replacement;
+            }
+            return p_handle;
+        }
+
+    private:
+        std::shared_future<Vulkan::GraphicsPipeline*> _future;
+        std::shared_ptr<PipelineHandle> _replacement;
+    };
+
+    // Creates graphics pipelines on the thread pool from modules of the ShaderLibrary.
+    // vkCreateGraphicsPipelines may be called concurrently and the pipeline cache is internally synchronized,
+    // so compilations do not wait for each other. Meanwhile renderers should draw with a fallback pipeline
+    // compiled synchronously with CompileNow.
+    class PipelineCompiler
+    {
+    public:
+        PipelineCompiler(Core::Threading::ThreadPool* p_threadPool, const ShaderLibrary* p_shaderLibrary)
+            : _threadPool(p_threadPool), _shaderLibrary(p_shaderLibrary)
+        { }
+
+        ~PipelineCompiler()
+        {
+            WaitIdle();
+        }
+
+        PipelineCompiler(const PipelineCompiler&) = delete;
+        PipelineCompiler& operator=(const PipelineCompiler&) = delete;
+
+        std::shared_ptr<PipelineHandle> CompileAsync(const GraphicsPipelineDescription& p_description);
+
+        // Blocking compilation on the calling thread, returns nullptr on failure
+        Vulkan::GraphicsPipeline* CompileNow(const GraphicsPipelineDescription& p_description) const;
+
+        // Blocks until all requested compilations are finished
+        void WaitIdle();
+
+        uint32_t GetPendingCount() const
+        { return _pendingCount.load(std::memory_order_relaxed); }
+
+    private:
+        Core::Threading::ThreadPool* _threadPool;
+        const ShaderLibrary* _shaderLibrary;
+
+        std::atomic<uint32_t> _pendingCount = 0;
+        std::mutex _idleMutex;
+        std::condition_variable _idleCondition;
+    };
+    
+}
@@ -0,0 +1,248 @@
+#include "PipelineRegistry.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+    namespace
+    {
+        // Appends fields one by one, so padding and bitfield layout never end up in the key
+        class KeyWriter
+        {
+        public:
+            KeyWriter(std::vector<uint8_t>& p_output) : _output(p_output)
+            { }
+
+            template <typename T>
+            requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+            void Write(T p_value)
+            {
+                const auto bytes = reinterpret_cast<const uint8_t*>(&p_value);
+                _output.insert(_output.end(), bytes, bytes + sizeof(T));
+            }
+
+            void Write(const std::string& p_value)
+            {
+                Write(static_cast<uint32_t>(p_value.size()));
+                _output.insert(_output.end(), p_value.begin(), p_value.end());
+            }
+
+        private:
+            std::vector<uint8_t>& _output;
+        };
+    }
+
+    std::shared_ptr<PipelineHandle> PipelineRegistry::Acquire(const GraphicsPipelineDescription& p_description)
+    {
+        PipelineKey key = CreateKey(p_description);
+
+        auto it = _entries.find(key);
+        if (it != _entries.end())
+        {
+            it->second.ReferencesCount++;
+            _deduplicatedCount++;
+            return it->second.Handle;
+        }
+
+        auto handle = _compiler->CompileAsync(p_description);
+        _entries.emplace(std::move(key), PipelineEntry { handle, 1, p_description, nullptr, false });
+        return handle;
+    }
+
+    const Vulkan::GraphicsPipeline* PipelineRegistry::AcquireNow(const GraphicsPipelineDescription& p_description)
+    {
+        PipelineKey key = CreateKey(p_description);
+
+        auto it = _entries.find(key);
+        if (it != _entries.end())
+        {
+            it->second.ReferencesCount++;
+            _deduplicatedCount++;
+            return it->second.Handle->Wait();
+        }
+
+        std::promise<Vulkan::GraphicsPipeline*> promise;
+        promise.set_value(_compiler->CompileNow(p_description));
+        auto handle = std::make_shared<PipelineHandle>(promise.get_future().share());
+
+        _entries.emplace(std::move(key), PipelineEntry { handle, 1, p_description, nullptr, true });
+        return handle->GetPipeline();
+    }
+
+    void PipelineRegistry::Release(const std::shared_ptr<PipelineHandle>& p_handle)
+    {
+        const std::shared_ptr<PipelineHandle> handle = PipelineHandle::GetLatest(p_handle);
+        for (auto it = _entries.begin(); it != _entries.end(); ++it)
+        {
+            if (it->second.Handle != handle)
+            {
+                continue;
+            }
+
+            if (--it->second.ReferencesCount == 0)
+            {
+                _pendingDestruction.push_back({ it->second.Handle, _frameNumber });
+                if (it->second.Rebuilt != nullptr)
+                {
+                    _pendingDestruction.push_back({ it->second.Rebuilt, _frameNumber });
+                }
+                _entries.erase(it);
+            }
+            return;
+        }
+    }
+
+    void PipelineRegistry::CollectUnused()
+    {
+        _frameNumber++;
+
+        std::erase_if(_pendingDestruction, [this](const PendingDestruction& p_pending)
+        {
+            // Compilation task still owns the pipeline until it is finished
+            if (_frameNumber - p_pending.ReleaseFrame <= _framesInFlight || !p_pending.Handle->IsReady())
+            {
+                return false;
+            }
+
+            if (Vulkan::GraphicsPipeline* pipeline = p_pending.Handle->Wait())
+            {
+                pipeline->Terminate();
+            }
+            return true;
+        });
+    }
+
+    uint32_t PipelineRegistry::RebuildWithShader(const std::string& p_shaderName)
+    {
+        uint32_t rebuiltCount = 0;
+        for (auto& [key, entry] : _entries)
+        {
+            // Users of pinned pipelines keep the plain pointer, they would never switch to the rebuilt one
+            if (entry.IsPinned
+                || (entry.Description.VertexShader != p_shaderName && entry.Description.FragmentShader != p_shaderName))
+            {
+                continue;
+            }
+
+            // Shader changed again before the previous rebuild was swapped in, that one is outdated
+            if (entry.Rebuilt != nullptr)
+            {
+                _pendingDestruction.push_back({ entry.Rebuilt, _frameNumber });
+            }
+            entry.Rebuilt = _compiler->CompileAsync(entry.Description);
+            rebuiltCount++;
+        }
+        return rebuiltCount;
+    }
+
+    void PipelineRegistry::SwapRebuiltPipelines()
+    {
+        for (auto& [key, entry] : _entries)
+        {
+            if (entry.Rebuilt == nullptr || !entry.Rebuilt->IsReady())
+            {
+                continue;
+            }
+
+            if (entry.Rebuilt->HasFailed())
+            {
+                // Broken shader keeps the pipeline it had before
+                entry.Rebuilt = nullptr;
+                continue;
+            }
+
+            entry.Handle->SetReplacement(entry.Rebuilt);
+            _pendingDestruction.push_back({ entry.Handle, _frameNumber });
+            entry.Handle = std::move(entry.Rebuilt);
+            entry.Rebuilt = nullptr;
+        }
+    }
+
+    PipelineRegistry::PipelineKey PipelineRegistry::CreateKey(const GraphicsPipelineDescription& p_description)
+    {
+        PipelineKey key { };
+        key.State.reserve(256);
+        KeyWriter writer(key.State);
+
+        // Shaders are identified by their name in the library
+        writer.Write(p_description.VertexShader);
+        writer.Write(p_description.FragmentShader);
+
+        const Vulkan::PipelineLayout* layout = p_description.PipelineLayout;
+        writer.Write(reinterpret_cast<uint64_t>(layout->GetVkPipelineLayout()));
+        writer.Write(reinterpret_cast<uint64_t>(layout->GetRenderPass()->GetVkRenderPass()));
+        writer.Write(layout->GetSubPassIndex());
+
+        // Written in declaration order, layouts listing the same bindings in different order are not merged
+        const Vulkan::PipelineVertexLayout& vertexLayout = p_description.VertexLayout;
+        writer.Write(static_cast<uint32_t>(vertexLayout.Bindings.size()));
+        for (const VkVertexInputBindingDescription& binding : vertexLayout.Bindings)
+        {
+            writer.Write(binding.binding);
+            writer.Write(binding.stride);
+            writer.Write(binding.inputRate);
+        }
+        writer.Write(static_cast<uint32_t>(vertexLayout.Attributes.size()));
+        for (const VkVertexInputAttributeDescription& attribute : vertexLayout.Attributes)
+        {
+            writer.Write(attribute.location);
+            writer.Write(attribute.binding);
+            writer.Write(attribute.format);
+            writer.Write(attribute.offset);
+        }
+
+        const Vulkan::PipelineDynamicState& dynamicState = p_description.DynamicState;
+        writer.Write<uint8_t>(dynamicState.Viewport);
+        writer.Write<uint8_t>(dynamicState.Scissor);
+        writer.Write<uint8_t>(dynamicState.LineWidth);
+
+        const Vulkan::PipelineColorBlend& colorBlend = p_description.ColorBlend;
+        for (glm::length_t i = 0; i < 4; i++)
+        {
+            writer.Write(colorBlend.ColorBlendConstants[i]);
+        }
+        writer.Write<uint8_t>(colorBlend.EnableLogicalBlendOperation);
+        // Logic operation is ignored when it is disabled, it could hold garbage
+        writer.Write(colorBlend.EnableLogicalBlendOperation ? colorBlend.LogicalBlendOperation : VK_LOGIC_OP_CLEAR);
+
+        writer.Write(static_cast<uint32_t>(p_description.AttachmentsBlend.size()));
+        for (const Vulkan::PipelineColorBlendAttachment& attachment : p_description.AttachmentsBlend)
+        {
+            writer.Write<uint8_t>(attachment.WriteChannelR);
+            writer.Write<uint8_t>(attachment.WriteChannelG);
+            writer.Write<uint8_t>(attachment.WriteChannelB);
+            writer.Write<uint8_t>(attachment.WriteChannelA);
+            writer.Write<uint8_t>(attachment.EnableBlend);
+            writer.Write(attachment.ColorBlendOperation);
+            writer.Write(attachment.SrsColorBlendFactor);
+            writer.Write(attachment.DstColorBlendFactor);
+            writer.Write(attachment.AlphaBlendOperation);
+            writer.Write(attachment.SrsAlphaBlendFactor);
+            writer.Write(attachment.DstAlphaBlendFactor);
+        }
+
+        const Vulkan::PipelineRasterization& rasterization = p_description.Rasterization;
+        writer.Write<uint8_t>(rasterization.EnableDepthClamp);
+        writer.Write<uint8_t>(rasterization.EnableDiscardRasterizer);
+        writer.Write<uint8_t>(rasterization.EnableDepthBias);
+        writer.Write(rasterization.PolygonMode);
+        writer.Write(rasterization.LineWidth);
+        writer.Write(rasterization.CullMode);
+        writer.Write(rasterization.FrontFace);
+        writer.Write(rasterization.DepthBiasConstFactor);
+        writer.Write(rasterization.DepthBiasClamp);
+        writer.Write(rasterization.DepthBiasSlopeFactor);
+
+        const Vulkan::PipelineDepthStencil& depthStencil = p_description.DepthStencil;
+        writer.Write<uint8_t>(depthStencil.EnableDepthTest);
+        writer.Write<uint8_t>(depthStencil.EnableDepthWrite);
+        writer.Write(depthStencil.DepthCompareOperation);
+
+        // FNV-1a
+        key.Hash = 14695981039346656037ull;
+        for (uint8_t byte : key.State)
+        {
+            key.Hash ^= byte;
+            key.Hash *= 1099511628211ull;
+        }
+        return key;
+    }
+}
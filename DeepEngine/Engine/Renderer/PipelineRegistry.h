@@ -0,0 +1,96 @@
+#pragma once
+#include <unordered_map>
+
+#include "PipelineCompiler.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+
+    // Deduplicates graphics pipelines by their full content - shaders, every fixed function state and
+    // render pass/subpass/layout. Identical requests share one VkPipeline (one compilation, one bind).
+    // Pipelines are reference counted, pipeline released by its last user is destroyed only after
+    // all frames in flight, which could still use it, are finished.
+    // When a shader is reloaded every pipeline using it is rebuilt in background and swapped in at a frame
+    // boundary, old handle points its users to the new one (see PipelineHandle::SetReplacement).
+    // Registry is not thread safe, it is meant to be used from the render thread.
+    class PipelineRegistry
+    {
+    public:
+        PipelineRegistry(PipelineCompiler* p_compiler, uint32_t p_framesInFlight)
+            : _compiler(p_compiler), _framesInFlight(p_framesInFlight)
+        { }
+
+        // Returns pipeline compiled in background (or already existing one) and adds a reference to it
+        std::shared_ptr<PipelineHandle> Acquire(const GraphicsPipelineDescription& p_description);
+
+        // Same as Acquire, but blocks until the pipeline is compiled, returns nullptr on failure
+        const Vulkan::GraphicsPipeline* AcquireNow(const GraphicsPipelineDescription& p_description);
+
+        // Handle may already be replaced, its latest replacement is released
+        void Release(const std::shared_ptr<PipelineHandle>& p_handle);
+
+        // Has to be called once per frame, destroys pipelines released at least framesInFlight frames ago
+        void CollectUnused();
+
+        // Starts compiling new versions of every pipeline using the shader, returns how many there are.
+        // Pipelines acquired with AcquireNow keep the shader they were compiled with
+        uint32_t RebuildWithShader(const std::string& p_shaderName);
+
+        // Called once per frame before renderers update their pipelines. Rebuilt pipelines which are compiled
+        // replace the old ones, which are destroyed as if they were released
+        void SwapRebuiltPipelines();
+
+        uint32_t GetPipelinesCount() const
+        { return static_cast<uint32_t>(_entries.size()); }
+
+        // Requests which were served with already existing pipeline
+        uint64_t GetDeduplicatedCount() const
+        { return _deduplicatedCount; }
+
+    private:
+        struct PipelineKey
+        {
+            std::vector<uint8_t> State;
+            uint64_t Hash;
+
+            bool operator==(const PipelineKey& p_other) const
+            { return Hash == p_other.Hash && State == p_other.State; }
+        };
+
+        struct PipelineKeyHasher
+        {
+            size_t operator()(const PipelineKey& p_key) const
+            { return static_cast<size_t>(p_key.Hash); }
+        };
+
+        struct PipelineEntry
+        {
+            std::shared_ptr<PipelineHandle> Handle;
+            uint32_t ReferencesCount;
+            GraphicsPipelineDescription Description;
+            // Compiling with reloaded shaders, nullptr when there is no rebuild
+            std::shared_ptr<PipelineHandle> Rebuilt;
+            // Acquired with AcquireNow, its users keep plain pointer so it is never rebuilt
+            bool IsPinned;
+        };
+
+        struct PendingDestruction
+        {
+            std::shared_ptr<PipelineHandle> Handle;
+            uint64_t ReleaseFrame;
+        };
+
+        static PipelineKey CreateKey(const GraphicsPipelineDescription& p_description);
+
+    private:
+        PipelineCompiler* _compiler;
+        const uint32_t _framesInFlight;
+
+        std::unordered_map<PipelineKey, PipelineEntry, PipelineKeyHasher> _entries;
+        std::vector<PendingDestruction> _pendingDestruction;
+
+        uint64_t _frameNumber = 0;
+        uint64_t _deduplicatedCount = 0;
+    };
+    
+}
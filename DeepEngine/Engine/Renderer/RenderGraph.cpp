@@ -0,0 +1,502 @@
+#include "RenderGraph.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+    namespace
+    {
+        constexpr VkAccessFlags WRITE_ACCESS_MASK = VK_ACCESS_SHADER_WRITE_BIT
+            | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+            | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+            | VK_ACCESS_TRANSFER_WRITE_BIT
+            | VK_ACCESS_HOST_WRITE_BIT
+            | VK_ACCESS_MEMORY_WRITE_BIT;
+
+        bool HasWorkToWaitFor(VkPipelineStageFlags p_stages)
+        {
+            return (p_stages & ~VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT) != 0;
+        }
+    }
+
+    RenderGraph::PassBuilder& RenderGraph::PassBuilder::Read(ResourceID p_resource, const RenderGraphUsage& p_usage)
+    {
+        _graph.GetPassResource(_passIndex, p_resource, p_usage).IsRead = true;
+        return *this;
+    }
+
+    RenderGraph::PassBuilder& RenderGraph::PassBuilder::Write(ResourceID p_resource, const RenderGraphUsage& p_usage)
+    {
+        _graph.GetPassResource(_passIndex, p_resource, p_usage).IsWritten = true;
+        return *this;
+    }
+
+    RenderGraph::PassBuilder& RenderGraph::PassBuilder::SetSideEffects()
+    {
+        _graph._passes[_passIndex].HasSideEffects = true;
+        return *this;
+    }
+
+    void RenderGraph::Reset()
+    {
+        _resources.clear();
+        _passes.clear();
+        _barrierBatches.clear();
+        _imageBarriers.clear();
+        _bufferBarriers.clear();
+        _states.clear();
+        _transientImages = nullptr;
+        _isCompiled = false;
+        _statistics = { };
+    }
+
+    RenderGraph::ResourceID RenderGraph::ImportImage(const char* p_name, VkImage p_image, VkImageAspectFlags p_aspect,
+        const RenderGraphUsage& p_currentUsage, VkImageView p_view)
+    {
+        Resource resource { };
+        resource.Name = p_name;
+        resource.Image = p_image;
+        resource.View = p_view;
+        resource.Aspect = p_aspect;
+        resource.ImportedUsage = p_currentUsage;
+
+        _resources.push_back(resource);
+        return static_cast<ResourceID>(_resources.size() - 1);
+    }
+
+    RenderGraph::ResourceID RenderGraph::ImportBuffer(const char* p_name, VkBuffer p_buffer,
+        const RenderGraphUsage& p_currentUsage)
+    {
+        Resource resource { };
+        resource.Name = p_name;
+        resource.Buffer = p_buffer;
+        resource.ImportedUsage = p_currentUsage;
+
+        _resources.push_back(resource);
+        return static_cast<ResourceID>(_resources.size() - 1);
+    }
+
+    RenderGraph::ResourceID RenderGraph::CreateImage(const char* p_name,
+        const RenderGraphImageDescription& p_description)
+    {
+        Resource resource { };
+        resource.Name = p_name;
+        resource.Aspect = p_description.Aspect;
+        resource.ImportedUsage = RenderGraphUsage::None();
+        resource.IsTransient = true;
+        resource.Description = p_description;
+
+        _resources.push_back(resource);
+        return static_cast<ResourceID>(_resources.size() - 1);
+    }
+
+    void RenderGraph::Export(ResourceID p_resource, const RenderGraphUsage& p_finalUsage)
+    {
+        if (_resources[p_resource].IsTransient)
+        {
+            VULKAN_WARN("Transient image \"{}\" can not be exported", _resources[p_resource].Name);
+            return;
+        }
+
+        _resources[p_resource].IsExported = true;
+        _resources[p_resource].FinalUsage = p_finalUsage;
+    }
+
+    RenderGraph::PassBuilder RenderGraph::AddPass(const char* p_name, RecordCallback p_record)
+    {
+        Pass pass { };
+        pass.Name = p_name;
+        pass.Record = std::move(p_record);
+
+        _passes.push_back(std::move(pass));
+        return PassBuilder(*this, static_cast<uint32_t>(_passes.size() - 1));
+    }
+
+    bool RenderGraph::Compile(TransientImageAllocator* p_transientImages)
+    {
+        CullPasses();
+
+        if (!AcquireTransientImages(p_transientImages))
+        {
+            return false;
+        }
+
+        _states.resize(_resources.size());
+        for (uint32_t i = 0; i < _resources.size(); i++)
+        {
+            const RenderGraphUsage& imported = _resources[i].ImportedUsage;
+
+            ResourceState& state = _states[i];
+            state = { };
+            state.WriteStages = imported.Stages;
+            state.WriteAccess = imported.Access & WRITE_ACCESS_MASK;
+            state.Layout = imported.Layout;
+        }
+
+        _barrierBatches.resize(_passes.size() + 1);
+        for (uint32_t i = 0; i < _passes.size(); i++)
+        {
+            _barrierBatches[i] = { };
+            _barrierBatches[i].FirstImageBarrier = static_cast<uint32_t>(_imageBarriers.size());
+            _barrierBatches[i].FirstBufferBarrier = static_cast<uint32_t>(_bufferBarriers.size());
+
+            const Pass& pass = _passes[i];
+            if (pass.IsCulled)
+            {
+                _statistics.CulledPasses++;
+                continue;
+            }
+
+            for (const PassResource& passResource : pass.Resources)
+            {
+                const Resource& resource = _resources[passResource.Resource];
+                ResourceState& state = _states[passResource.Resource];
+
+                if (resource.FirstPass == i && resource.AliasedAfter != INVALID_RESOURCE)
+                {
+                    // Memory is written by the last pass of the previous image in it, or by its layout transition
+                    const ResourceState& aliasedState = _states[resource.AliasedAfter];
+                    state.WriteStages = aliasedState.WriteStages | aliasedState.ReadStages;
+                    state.WriteAccess = aliasedState.WriteAccess;
+                }
+
+                TransitionResource(i, passResource.Resource, state, passResource.Usage, passResource.IsWritten);
+            }
+        }
+
+        BarrierBatch& lastBatch = _barrierBatches.back();
+        lastBatch = { };
+        lastBatch.FirstImageBarrier = static_cast<uint32_t>(_imageBarriers.size());
+        lastBatch.FirstBufferBarrier = static_cast<uint32_t>(_bufferBarriers.size());
+        for (uint32_t i = 0; i < _resources.size(); i++)
+        {
+            if (_resources[i].IsExported)
+            {
+                TransitionResource(static_cast<uint32_t>(_passes.size()), i, _states[i], _resources[i].FinalUsage,
+                    false);
+            }
+        }
+
+        _statistics.Passes = static_cast<uint32_t>(_passes.size());
+        _statistics.ImageBarriers = static_cast<uint32_t>(_imageBarriers.size());
+        _statistics.BufferBarriers = static_cast<uint32_t>(_bufferBarriers.size());
+        for (const BarrierBatch& batch : _barrierBatches)
+        {
+            if (batch.DstStages != 0)
+            {
+                _statistics.BarrierBatches++;
+            }
+        }
+
+        _isCompiled = true;
+        return true;
+    }
+
+    void RenderGraph::Execute(VkCommandBuffer p_commandBuffer, Vulkan::QueryPool* p_queryPool) const
+    {
+        if (!_isCompiled)
+        {
+            return;
+        }
+
+        for (uint32_t i = 0; i < _passes.size(); i++)
+        {
+            const Pass& pass = _passes[i];
+            if (pass.IsCulled)
+            {
+                continue;
+            }
+
+            RecordBarriers(p_commandBuffer, _barrierBatches[i]);
+
+            Vulkan::GpuScope scope(p_queryPool, p_commandBuffer, pass.Name);
+            pass.Record(p_commandBuffer);
+        }
+
+        RecordBarriers(p_commandBuffer, _barrierBatches.back());
+    }
+
+    VkFramebuffer RenderGraph::GetFramebuffer(VkRenderPass p_renderPass,
+        const std::vector<ResourceID>& p_attachments) const
+    {
+        std::vector<VkImageView> views(p_attachments.size());
+        for (uint32_t i = 0; i < p_attachments.size(); i++)
+        {
+            const Resource& resource = _resources[p_attachments[i]];
+            if (!resource.IsTransient || resource.View == VK_NULL_HANDLE)
+            {
+                VULKAN_ERR("Framebuffer attachment \"{}\" is not a created image used by the graph", resource.Name);
+                return VK_NULL_HANDLE;
+            }
+            views[i] = resource.View;
+        }
+
+        const RenderGraphImageDescription& description = _resources[p_attachments[0]].Description;
+        return _transientImages->GetFramebuffer(p_renderPass, views, description.Width, description.Height);
+    }
+
+    RenderGraph::PassResource& RenderGraph::GetPassResource(uint32_t p_passIndex, ResourceID p_resource,
+        const RenderGraphUsage& p_usage)
+    {
+        std::vector<PassResource>& passResources = _passes[p_passIndex].Resources;
+        for (PassResource& passResource : passResources)
+        {
+            if (passResource.Resource != p_resource)
+            {
+                continue;
+            }
+
+            if (_resources[p_resource].IsImage() && passResource.Usage.Layout != p_usage.Layout)
+            {
+                VULKAN_WARN("Pass \"{}\" uses image \"{}\" in two layouts, using the last one",
+                    _passes[p_passIndex].Name, _resources[p_resource].Name);
+                passResource.Usage.Layout = p_usage.Layout;
+            }
+            passResource.Usage.Stages |= p_usage.Stages;
+            passResource.Usage.Access |= p_usage.Access;
+            return passResource;
+        }
+
+        PassResource passResource { };
+        passResource.Resource = p_resource;
+        passResource.Usage = p_usage;
+        passResources.push_back(passResource);
+        return passResources.back();
+    }
+
+    void RenderGraph::CullPasses()
+    {
+        // Only read after write makes a pass depend on another, a later write alone does not need the earlier one
+        std::vector<uint32_t> lastWriters(_resources.size(), NO_PASS);
+        std::vector<std::vector<uint32_t>> producers(_passes.size());
+
+        for (uint32_t i = 0; i < _passes.size(); i++)
+        {
+            Pass& pass = _passes[i];
+            pass.IsCulled = true;
+
+            for (const PassResource& passResource : pass.Resources)
+            {
+                const uint32_t writer = lastWriters[passResource.Resource];
+                if (passResource.IsRead && writer != NO_PASS)
+                {
+                    producers[i].push_back(writer);
+                }
+            }
+
+            for (const PassResource& passResource : pass.Resources)
+            {
+                if (passResource.IsWritten)
+                {
+                    lastWriters[passResource.Resource] = i;
+                }
+            }
+        }
+
+        std::vector<uint32_t> pending;
+        for (uint32_t i = 0; i < _passes.size(); i++)
+        {
+            if (_passes[i].HasSideEffects)
+            {
+                pending.push_back(i);
+            }
+        }
+        for (uint32_t i = 0; i < _resources.size(); i++)
+        {
+            if (_resources[i].IsExported && lastWriters[i] != NO_PASS)
+            {
+                pending.push_back(lastWriters[i]);
+            }
+        }
+
+        while (!pending.empty())
+        {
+            const uint32_t passIndex = pending.back();
+            pending.pop_back();
+
+            if (!_passes[passIndex].IsCulled)
+            {
+                continue;
+            }
+            _passes[passIndex].IsCulled = false;
+
+            for (const uint32_t producer : producers[passIndex])
+            {
+                pending.push_back(producer);
+            }
+        }
+    }
+
+    bool RenderGraph::AcquireTransientImages(TransientImageAllocator* p_transientImages)
+    {
+        _transientImages = p_transientImages;
+        _transientRequests.clear();
+
+        for (uint32_t i = 0; i < _passes.size(); i++)
+        {
+            if (_passes[i].IsCulled)
+            {
+                continue;
+            }
+
+            for (const PassResource& passResource : _passes[i].Resources)
+            {
+                Resource& resource = _resources[passResource.Resource];
+                resource.FirstPass = resource.FirstPass == NO_PASS ? i : resource.FirstPass;
+                resource.LastPass = i;
+            }
+        }
+
+        // Requests of used transient images, in order of the resources
+        std::vector<ResourceID> requestResources;
+        for (uint32_t i = 0; i < _resources.size(); i++)
+        {
+            const Resource& resource = _resources[i];
+            if (resource.IsTransient && resource.FirstPass != NO_PASS)
+            {
+                _transientRequests.push_back({ resource.Description, resource.FirstPass, resource.LastPass });
+                requestResources.push_back(i);
+            }
+        }
+
+        if (_transientRequests.empty())
+        {
+            return true;
+        }
+
+        if (p_transientImages == nullptr)
+        {
+            VULKAN_ERR("Render graph has transient images but no allocator for them");
+            return false;
+        }
+
+        if (!p_transientImages->Acquire(_transientRequests, _transientImagesScratch))
+        {
+            VULKAN_ERR("Failed to acquire transient images of the render graph");
+            return false;
+        }
+
+        for (uint32_t i = 0; i < requestResources.size(); i++)
+        {
+            const TransientImageAllocator::AcquiredImage& image = _transientImagesScratch[i];
+            Resource& resource = _resources[requestResources[i]];
+            resource.Image = image.Image;
+            resource.View = image.View;
+            resource.AliasedAfter = image.AliasedAfter != TransientImageAllocator::NO_IMAGE
+                ? requestResources[image.AliasedAfter]
+                : INVALID_RESOURCE;
+        }
+        return true;
+    }
+
+    void RenderGraph::TransitionResource(uint32_t p_batchIndex, ResourceID p_resource, ResourceState& p_state,
+        const RenderGraphUsage& p_usage, bool p_isWrite)
+    {
+        const Resource& resource = _resources[p_resource];
+        const bool isImage = resource.IsImage();
+        const bool isLayoutTransition = isImage && p_usage.Layout != p_state.Layout;
+
+        VkPipelineStageFlags srcStages;
+        bool isBarrierNeeded;
+        if (p_isWrite || isLayoutTransition)
+        {
+            // Layout transition writes the image too, so both have to wait for every earlier write and read
+            srcStages = p_state.WriteStages | p_state.ReadStages;
+            isBarrierNeeded = isLayoutTransition || HasWorkToWaitFor(srcStages);
+        }
+        else
+        {
+            // Reads only wait for the last write, unless it was already made visible to them
+            const bool isVisible = (p_usage.Stages & ~p_state.VisibleStages) == 0
+                && (p_usage.Access & ~p_state.VisibleAccess) == 0;
+            srcStages = p_state.WriteStages;
+            isBarrierNeeded = HasWorkToWaitFor(srcStages) && p_usage.Access != 0 && !isVisible;
+        }
+
+        if (isBarrierNeeded)
+        {
+            BarrierBatch& batch = _barrierBatches[p_batchIndex];
+            batch.SrcStages |= srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+            batch.DstStages |= p_usage.Stages;
+
+            if (isImage)
+            {
+                VkImageMemoryBarrier barrier { };
+                barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                barrier.srcAccessMask = p_state.WriteAccess;
+                barrier.dstAccessMask = p_usage.Access;
+                barrier.oldLayout = p_state.Layout;
+                barrier.newLayout = p_usage.Layout;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.image = resource.Image;
+                barrier.subresourceRange.aspectMask = resource.Aspect;
+                barrier.subresourceRange.baseMipLevel = 0;
+                barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+                barrier.subresourceRange.baseArrayLayer = 0;
+                barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+                _imageBarriers.push_back(barrier);
+                batch.ImageBarriersCount++;
+            }
+            else
+            {
+                VkBufferMemoryBarrier barrier { };
+                barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                barrier.srcAccessMask = p_state.WriteAccess;
+                barrier.dstAccessMask = p_usage.Access;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.buffer = resource.Buffer;
+                barrier.offset = 0;
+                barrier.size = VK_WHOLE_SIZE;
+
+                _bufferBarriers.push_back(barrier);
+                batch.BufferBarriersCount++;
+            }
+        }
+
+        if (p_isWrite)
+        {
+            p_state.WriteStages = p_usage.Stages;
+            p_state.WriteAccess = p_usage.Access & WRITE_ACCESS_MASK;
+            p_state.ReadStages = 0;
+            p_state.VisibleStages = 0;
+            p_state.VisibleAccess = 0;
+        }
+        else if (isLayoutTransition)
+        {
+            // Later reads from other stages wait for the transition
+            p_state.WriteStages = p_usage.Stages;
+            p_state.WriteAccess = 0;
+            p_state.ReadStages = p_usage.Stages;
+            p_state.VisibleStages = p_usage.Stages;
+            p_state.VisibleAccess = p_usage.Access;
+        }
+        else
+        {
+            p_state.ReadStages |= p_usage.Stages;
+            if (isBarrierNeeded)
+            {
+                p_state.VisibleStages |= p_usage.Stages;
+                p_state.VisibleAccess |= p_usage.Access;
+            }
+        }
+        p_state.Layout = isImage ? p_usage.Layout : p_state.Layout;
+    }
+
+    void RenderGraph::RecordBarriers(VkCommandBuffer p_commandBuffer, const BarrierBatch& p_batch) const
+    {
+        if (p_batch.DstStages == 0)
+        {
+            return;
+        }
+
+        vkCmdPipelineBarrier(p_commandBuffer,
+            p_batch.SrcStages,
+            p_batch.DstStages,
+            0,
+            0, nullptr,
+            p_batch.BufferBarriersCount, _bufferBarriers.data() + p_batch.FirstBufferBarrier,
+            p_batch.ImageBarriersCount, _imageBarriers.data() + p_batch.FirstImageBarrier);
+    }
+
+}
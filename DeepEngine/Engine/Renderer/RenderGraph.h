@@ -0,0 +1,254 @@
+#pragma once
+#include <functional>
+
+#include "TransientImageAllocator.h"
+#include "Vulkan/QueryPool.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+
+    // How a resource is used: stages and accesses of the use, and layout the image has to be in (ignored for buffers)
+    struct RenderGraphUsage
+    {
+        VkPipelineStageFlags Stages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        VkAccessFlags Access = 0;
+        VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        // Nothing to wait for, image content is discarded
+        static RenderGraphUsage None()
+        { return { VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED }; }
+
+        static RenderGraphUsage ColorAttachment()
+        {
+            return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+        }
+
+        // Tested and written in early and late fragment tests
+        static RenderGraphUsage DepthAttachment()
+        {
+            return { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+        }
+
+        static RenderGraphUsage FragmentSampled()
+        { return { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_READ_ONLY_OPTIMAL }; }
+
+        static RenderGraphUsage ComputeStorageRead()
+        { return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL }; }
+
+        static RenderGraphUsage ComputeStorageWrite()
+        {
+            return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                VK_IMAGE_LAYOUT_GENERAL };
+        }
+
+        static RenderGraphUsage VertexInput()
+        { return { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT }; }
+
+        static RenderGraphUsage IndirectCommand()
+        { return { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT }; }
+
+        static RenderGraphUsage TransferSource()
+        { return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL }; }
+
+        static RenderGraphUsage TransferDestination()
+        { return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL }; }
+
+        // Mapped memory read by the CPU after the frame fence
+        static RenderGraphUsage HostRead()
+        { return { VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT }; }
+
+        // Image acquired from the swapchain, acquire semaphore is waited at color attachment output
+        static RenderGraphUsage SwapchainAcquired()
+        { return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED }; }
+
+        static RenderGraphUsage Present()
+        { return { VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR }; }
+    };
+
+    struct RenderGraphStatistics
+    {
+        uint32_t Passes = 0;
+        uint32_t CulledPasses = 0;
+        // vkCmdPipelineBarrier calls, at most one before every pass and one after the last
+        uint32_t BarrierBatches = 0;
+        uint32_t ImageBarriers = 0;
+        uint32_t BufferBarriers = 0;
+    };
+
+    // Passes of one frame with resources they read and write. Graph is built every frame: Reset, import or create
+    // resources, add passes, export what is used after the graph, Compile and Execute.
+    // Created images are transient, they exist only between their first and last pass and may share memory with
+    // other transient images (see TransientImageAllocator). Their content is undefined before the first pass
+    // writes it and they can not be exported.
+    // Passes execute in the order they were added, a pass can only depend on passes added before it, so this order
+    // always satisfies the dependencies. Passes whose writes reach no exported resource (and which do not have
+    // side effects) are culled. Compile tracks the state of every resource through the remaining passes and batches
+    // all barriers and layout transitions a pass needs into one vkCmdPipelineBarrier recorded before it.
+    // Render passes recorded by graph passes should keep attachments in the declared layouts
+    // (initialLayout and finalLayout equal to the usage layout) and leave external dependencies to the graph.
+    class RenderGraph
+    {
+    public:
+        using ResourceID = uint32_t;
+        using RecordCallback = std::function<void(VkCommandBuffer)>;
+
+        static constexpr ResourceID INVALID_RESOURCE = UINT32_MAX;
+
+        class PassBuilder
+        {
+        public:
+            // Pass needs previous content of the resource
+            PassBuilder& Read(ResourceID p_resource, const RenderGraphUsage& p_usage);
+            // Pass modifies the resource, declare Read as well when previous content is kept (e.g. load op LOAD)
+            PassBuilder& Write(ResourceID p_resource, const RenderGraphUsage& p_usage);
+            // Never culled, e.g. writes to host visible memory read back by the CPU
+            PassBuilder& SetSideEffects();
+
+        private:
+            friend class RenderGraph;
+
+            PassBuilder(RenderGraph& p_graph, uint32_t p_passIndex)
+                : _graph(p_graph), _passIndex(p_passIndex)
+            { }
+
+        private:
+            RenderGraph& _graph;
+            uint32_t _passIndex;
+        };
+
+        void Reset();
+
+        // Current usage is the last one before the graph, resources keep the state in which last pass left them
+        // unless they are exported
+        ResourceID ImportImage(const char* p_name, VkImage p_image, VkImageAspectFlags p_aspect,
+            const RenderGraphUsage& p_currentUsage, VkImageView p_view = VK_NULL_HANDLE);
+        ResourceID ImportBuffer(const char* p_name, VkBuffer p_buffer, const RenderGraphUsage& p_currentUsage);
+        ResourceID CreateImage(const char* p_name, const RenderGraphImageDescription& p_description);
+
+        // Resource is used after the graph, transitioned to the final usage after the last pass
+        void Export(ResourceID p_resource, const RenderGraphUsage& p_finalUsage);
+
+        // Name is a string literal, it names GPU scope of the pass
+        PassBuilder AddPass(const char* p_name, RecordCallback p_record);
+
+        // Allocator is needed only when the graph has created images, they are acquired from it. On failure Execute
+        // records nothing
+        bool Compile(TransientImageAllocator* p_transientImages = nullptr);
+
+        // Every pass gets its own GPU scope when query pool is given
+        void Execute(VkCommandBuffer p_commandBuffer, Vulkan::QueryPool* p_queryPool = nullptr) const;
+
+        // Valid after Compile, VK_NULL_HANDLE for created images not used by any pass
+        VkImage GetImage(ResourceID p_resource) const
+        { return _resources[p_resource].Image; }
+
+        VkImageView GetImageView(ResourceID p_resource) const
+        { return _resources[p_resource].View; }
+
+        // For pass recording, attachments have to be created images of the same size
+        VkFramebuffer GetFramebuffer(VkRenderPass p_renderPass, const std::vector<ResourceID>& p_attachments) const;
+
+        // Valid after Compile
+        const RenderGraphStatistics& GetStatistics() const
+        { return _statistics; }
+
+    private:
+        static constexpr uint32_t NO_PASS = UINT32_MAX;
+
+        struct Resource
+        {
+            const char* Name;
+            VkImage Image = VK_NULL_HANDLE;
+            VkImageView View = VK_NULL_HANDLE;
+            VkImageAspectFlags Aspect = 0;
+            VkBuffer Buffer = VK_NULL_HANDLE;
+            RenderGraphUsage ImportedUsage;
+            bool IsExported = false;
+            RenderGraphUsage FinalUsage;
+
+            bool IsTransient = false;
+            RenderGraphImageDescription Description;
+            // Not culled passes using the transient image, NO_PASS when there are none
+            uint32_t FirstPass = NO_PASS;
+            uint32_t LastPass = NO_PASS;
+            // Transient image which used the memory before, its last use is waited for
+            ResourceID AliasedAfter = INVALID_RESOURCE;
+
+            bool IsImage() const
+            { return Buffer == VK_NULL_HANDLE; }
+        };
+
+        // Read and write of the same resource in one pass are merged
+        struct PassResource
+        {
+            ResourceID Resource;
+            RenderGraphUsage Usage;
+            bool IsRead = false;
+            bool IsWritten = false;
+        };
+
+        struct Pass
+        {
+            const char* Name;
+            RecordCallback Record;
+            std::vector<PassResource> Resources;
+            bool HasSideEffects = false;
+            bool IsCulled = false;
+        };
+
+        struct BarrierBatch
+        {
+            VkPipelineStageFlags SrcStages = 0;
+            VkPipelineStageFlags DstStages = 0;
+            uint32_t FirstImageBarrier = 0;
+            uint32_t ImageBarriersCount = 0;
+            uint32_t FirstBufferBarrier = 0;
+            uint32_t BufferBarriersCount = 0;
+        };
+
+        // Tracked while compiling, in the order passes execute
+        struct ResourceState
+        {
+            // Last write (or layout transition), later reads from stages it was not made visible to wait for it
+            VkPipelineStageFlags WriteStages = 0;
+            VkAccessFlags WriteAccess = 0;
+            // Stages which read since the last write, later write has to wait for them
+            VkPipelineStageFlags ReadStages = 0;
+            // Reads the last write was already made visible to
+            VkPipelineStageFlags VisibleStages = 0;
+            VkAccessFlags VisibleAccess = 0;
+            VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        };
+
+        PassResource& GetPassResource(uint32_t p_passIndex, ResourceID p_resource, const RenderGraphUsage& p_usage);
+
+        void CullPasses();
+        bool AcquireTransientImages(TransientImageAllocator* p_transientImages);
+        // Adds barrier to the batch when usage needs one, updates the state
+        void TransitionResource(uint32_t p_batchIndex, ResourceID p_resource, ResourceState& p_state,
+            const RenderGraphUsage& p_usage, bool p_isWrite);
+        void RecordBarriers(VkCommandBuffer p_commandBuffer, const BarrierBatch& p_batch) const;
+
+    private:
+        std::vector<Resource> _resources;
+        std::vector<Pass> _passes;
+
+        // One batch before every pass (empty for culled ones) and the last after all of them
+        std::vector<BarrierBatch> _barrierBatches;
+        std::vector<VkImageMemoryBarrier> _imageBarriers;
+        std::vector<VkBufferMemoryBarrier> _bufferBarriers;
+        std::vector<ResourceState> _states;
+
+        TransientImageAllocator* _transientImages = nullptr;
+        std::vector<TransientImageAllocator::Request> _transientRequests;
+        std::vector<TransientImageAllocator::AcquiredImage> _transientImagesScratch;
+        bool _isCompiled = false;
+
+        RenderGraphStatistics _statistics;
+    };
+
+}
@@ -1,6 +1,130 @@
 #include "RendererCommandRecorder.h"
 
-namespace DeepEngine::Renderer
+namespace DeepEngine::Engine::Renderer
 {
-    
+    void RendererCommandRecorder::InitializeSecondaryPools(uint32_t p_framesInFlight)
+    {
+        if (_threadPool == nullptr)
+        {
+            return;
+        }
+
+        _secondaryPools.resize(p_framesInFlight);
+        for (auto& framePools : _secondaryPools)
+        {
+            framePools.resize(_threadPool->GetThreadIndicesCount());
+            for (auto& threadPool : framePools)
+            {
+                // Pools are reset as a whole at the beginning of the frame, buffers are never reset one by one
+                threadPool.Pool = new Vulkan::CommandPool(_mainGraphicsQueue, Vulkan::CommandPoolFlag::TRANSIENT);
+                _vulkanInstance->InitializeSubController(threadPool.Pool);
+            }
+        }
+    }
+
+    bool RendererCommandRecorder::CanRecordInSecondaryBuffers(uint32_t p_drawsCount) const
+    {
+        // Single batch gains nothing from other threads, it would only pay for vkCmdExecuteCommands
+        if (_secondaryPools.empty() || p_drawsCount <= DRAWS_PER_BATCH)
+        {
+            return false;
+        }
+
+        // Pipeline statistics query of the "Scene" scope is active during the render pass,
+        // executing secondary buffers inside such query requires them to inherit it
+        if (_queryPool->GetActivePipelineStatistics() != 0
+            && !_vulkanInstance->GetPhysicalDeviceFeatures().inheritedQueries)
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    void RendererCommandRecorder::ResetSecondaryPools(uint32_t p_frameIndex)
+    {
+        for (auto& threadPool : _secondaryPools[p_frameIndex])
+        {
+            threadPool.Pool->Reset();
+            threadPool.UsedBuffersCount = 0;
+        }
+    }
+
+    void RendererCommandRecorder::RecordSecondaryBuffers(VkCommandBuffer p_primaryBuffer, uint32_t p_frameIndex,
+        VkRenderPass p_renderPass, uint32_t p_subPassIndex, VkFramebuffer p_framebuffer,
+        const VkViewport& p_viewport, const VkRect2D& p_scissor,
+        const DrawList& p_drawList, bool p_isDepthPrePass)
+    {
+        auto& framePools = _secondaryPools[p_frameIndex];
+
+        const uint32_t drawsCount = p_drawList.GetPacketsCount();
+        _threadsStatistics.assign(_threadPool->GetThreadIndicesCount(), { });
+        _batchBuffers.assign((drawsCount + DRAWS_PER_BATCH - 1) / DRAWS_PER_BATCH, VK_NULL_HANDLE);
+
+        VkCommandBufferInheritanceInfo inheritanceInfo { };
+        inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritanceInfo.renderPass = p_renderPass;
+        inheritanceInfo.subpass = p_subPassIndex;
+        inheritanceInfo.framebuffer = p_framebuffer;
+        inheritanceInfo.occlusionQueryEnable = VK_FALSE;
+        inheritanceInfo.pipelineStatistics = _queryPool->GetActivePipelineStatistics();
+
+        _threadPool->ParallelFor(drawsCount, DRAWS_PER_BATCH,
+            [&](uint32_t p_begin, uint32_t p_end, uint32_t p_threadIndex)
+            {
+                // Only this thread touches its pool, including growing it
+                SecondaryCommandPool& threadPool = framePools[p_threadIndex];
+                if (threadPool.UsedBuffersCount == threadPool.Buffers.size())
+                {
+                    auto buffers = threadPool.Pool->CreateCommandBuffers(1, true);
+                    threadPool.Buffers.push_back(buffers[0]);
+                }
+
+                const VkCommandBuffer commandBuffer =
+                    threadPool.Buffers[threadPool.UsedBuffersCount++]->GetVkCommandBuffer();
+
+                VkCommandBufferBeginInfo beginInfo { };
+                beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+                beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+                                | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+                beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+                const auto beginResult = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+                if (beginResult != VK_SUCCESS)
+                {
+                    VULKAN_ERR("Failed to begin secondary command buffer with returned result {}",
+                        string_VkResult(beginResult));
+                    return;
+                }
+
+                vkCmdSetViewport(commandBuffer, 0, 1, &p_viewport);
+                vkCmdSetScissor(commandBuffer, 0, 1, &p_scissor);
+                // Counted locally, neighbouring threads' statistics share a cache line
+                DrawListStatistics batchStatistics;
+                p_drawList.Record(commandBuffer, p_begin, p_end, batchStatistics, p_isDepthPrePass);
+                _threadsStatistics[p_threadIndex] += batchStatistics;
+
+                const auto endResult = vkEndCommandBuffer(commandBuffer);
+                if (endResult != VK_SUCCESS)
+                {
+                    VULKAN_ERR("Failed to record secondary command buffer with returned result {}",
+                        string_VkResult(endResult));
+                    return;
+                }
+
+                _batchBuffers[p_begin / DRAWS_PER_BATCH] = commandBuffer;
+            });
+
+        // Failed batches are skipped, rest of the scene is still drawn
+        std::erase(_batchBuffers, VK_NULL_HANDLE);
+        if (!_batchBuffers.empty())
+        {
+            vkCmdExecuteCommands(p_primaryBuffer, static_cast<uint32_t>(_batchBuffers.size()), _batchBuffers.data());
+        }
+
+        for (const DrawListStatistics& statistics : _threadsStatistics)
+        {
+            _lastStatistics += statistics;
+        }
+    }
 }
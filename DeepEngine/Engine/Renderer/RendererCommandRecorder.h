@@ -1,166 +1,229 @@
 #pragma once
 #include "MainRenderPass.h"
-#include "TriangleRenderer.h"
+#include "DrawList.h"
+#include "RenderGraph.h"
+#include "UploadQueue.h"
+#include "Core/Threading/ThreadPool.h"
 #include "Vulkan/Semaphore.h"
 #include "Vulkan/VulkanPCH.h"
 #include "Vulkan/CommandBuffer.h"
 #include "Vulkan/CommandPool.h"
 #include "Vulkan/Fence.h"
 #include "Vulkan/GraphicsPipeline.h"
+#include "Vulkan/QueryPool.h"
 #include "Vulkan/RenderPass.h"
 
 namespace DeepEngine::Engine::Renderer
 {
 
+    // Draws are recorded inline when there are few of them, otherwise they are split into batches of DRAWS_PER_BATCH
+    // and every batch is recorded on the thread pool into a secondary command buffer. Secondary buffers come from
+    // per thread pools (one set per frame in flight), so recording threads never share a VkCommandPool.
     class RendererCommandRecorder
     {
     public:
+        static constexpr uint32_t DRAWS_PER_BATCH = 256;
+
         RendererCommandRecorder() = default;
-        RendererCommandRecorder(Vulkan::VulkanInstance* p_vulkanInstance, const Vulkan::VulkanInstance::QueueInstance* p_mainGraphicsQueue)
-                : _vulkanInstance(p_vulkanInstance), _mainGraphicsQueue(p_mainGraphicsQueue)
+        RendererCommandRecorder(Vulkan::VulkanInstance* p_vulkanInstance, const Vulkan::VulkanInstance::QueueInstance* p_mainGraphicsQueue,
+            Vulkan::QueryPool* p_queryPool, Core::Threading::ThreadPool* p_threadPool, uint32_t p_framesInFlight)
+                : _vulkanInstance(p_vulkanInstance), _mainGraphicsQueue(p_mainGraphicsQueue), _queryPool(p_queryPool),
+                _threadPool(p_threadPool)
         {
             uint32_t cmdPoolFlags = 0;
             cmdPoolFlags |= Vulkan::CommandPoolFlag::RESET_COMMAND_BUFFER;
             
             _commandPool = new Vulkan::CommandPool(_mainGraphicsQueue, (Vulkan::CommandPoolFlag)cmdPoolFlags);
             _vulkanInstance->InitializeSubController(_commandPool);
-            
-            _commandBuffer = new Vulkan::CommandBuffer(_commandPool, false);
-            _commandPool->InitializeSubController(_commandBuffer);
+
+            // One buffer per frame in flight, buffer of a frame is reused only after its fence was waited
+            _commandBuffers = _commandPool->CreateCommandBuffers(p_framesInFlight);
+
+            InitializeSecondaryPools(p_framesInFlight);
         }
         
         void Terminate()
         {
-            _commandPool->Terminate();
+            for (auto& framePools : _secondaryPools)
+            {
+                for (auto& threadPool : framePools)
+                {
+                    threadPool.Pool->Terminate();
+                }
+            }
+            _secondaryPools.clear();
+            
+            // Default constructed when the renderer failed to initialize before creating it
+            if (_commandPool != nullptr)
+            {
+                _commandPool->Terminate();
+                _commandPool = nullptr;
+            }
+        }
+
+        Vulkan::CommandBuffer* GetCommandBuffer(uint32_t p_frameIndex) const
+        {
+            return _commandBuffers[p_frameIndex];
+        }
+
+        // State changes emitted by the last RecordBuffer
+        const DrawListStatistics& GetLastStatistics() const
+        {
+            return _lastStatistics;
         }
         
-        void RecordBuffer(glm::vec4 p_clearColor, uint32_t p_frameBufferIndex,
-            MainRenderPass* p_renderPass,
-            const std::vector<TriangleRenderer>& p_renderers, 
-            VkImage p_renderPassOutputImage)
+        // Records passes of the compiled graph into the frame command buffer
+        void RecordBuffer(uint32_t p_frameIndex, const RenderGraph& p_renderGraph)
         {
+            const VkCommandBuffer commandBuffer = _commandBuffers[p_frameIndex]->GetVkCommandBuffer();
+
             VkCommandBufferBeginInfo beginInfo { };
             beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
             beginInfo.flags = 0;
             beginInfo.pInheritanceInfo = nullptr;
 
-            const auto status = vkBeginCommandBuffer(_commandBuffer->GetVkCommandBuffer(), &beginInfo);
+            const auto status = vkBeginCommandBuffer(commandBuffer, &beginInfo);
             if (status != VK_SUCCESS)
             {
                 VULKAN_ERR("Failed to create begin command buffer with returned result {}", string_VkResult(status));
                 return;
             }
 
-            VkClearValue clearColor = {
-                { p_clearColor.r, p_clearColor.g, p_clearColor.b, p_clearColor.a }
-            };
+            // Recorded first in the frame submission, resets queries of all passes
+            _queryPool->BeginFrame(commandBuffer, p_frameIndex);
+
+            p_renderGraph.Execute(commandBuffer, _queryPool);
+
+            const auto result = vkEndCommandBuffer(commandBuffer);
+            if (result != VK_SUCCESS)
+            {
+                VULKAN_ERR("Failed to record command buffer with returned result {}", string_VkResult(result));
+                return;
+            }
+        }
 
-            VkExtent2D renderAreaExtent(_vulkanInstance->GetFrameBufferSize().x,
-                    _vulkanInstance->GetFrameBufferSize().y);
+        // Render pass drawing the list, recorded by the scene pass of the render graph. Frame index selects
+        // secondary command buffers, framebuffer comes from the graph images of the given size. With depth pre-pass
+        // packets having depth pipelines are drawn into depth first, so the shading subpass runs fragment shader
+        // only for the visible ones. Otherwise the pre-pass subpass is left empty
+        void RecordScenePass(VkCommandBuffer p_commandBuffer, glm::vec4 p_clearColor, uint32_t p_frameIndex,
+            const MainRenderPass* p_renderPass, VkFramebuffer p_framebuffer, VkExtent2D p_extent,
+            const DrawList& p_drawList, bool p_isDepthPrePassEnabled)
+        {
+            _lastStatistics = { };
+            _lastStatistics.UnsortedPipelineBinds = p_drawList.GetUnsortedPipelineBinds();
+
+            // In attachment order, color and depth
+            std::array<VkClearValue, 2> clearValues { };
+            clearValues[0].color = { p_clearColor.r, p_clearColor.g, p_clearColor.b, p_clearColor.a };
+            clearValues[1].depthStencil = { 1.0f, 0 };
 
             VkRenderPassBeginInfo renderPassInfo { };
             renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-            renderPassInfo.renderPass = p_renderers[0].GetGraphicsPipeline()->GetVkRenderPass();
-            renderPassInfo.framebuffer = p_renderPass->GetVkFramebuffer(p_frameBufferIndex);
-            renderPassInfo.clearValueCount = 1;
-            renderPassInfo.pClearValues = &clearColor;
+            renderPassInfo.renderPass = p_renderPass->GetVkRenderPass();
+            renderPassInfo.framebuffer = p_framebuffer;
+            renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+            renderPassInfo.pClearValues = clearValues.data();
             renderPassInfo.renderArea.offset = { 0, 0 };
-            renderPassInfo.renderArea.extent = renderAreaExtent;
+            renderPassInfo.renderArea.extent = p_extent;
 
-            vkCmdBeginRenderPass(_commandBuffer->GetVkCommandBuffer(), &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+            const bool useSecondaryBuffers = CanRecordInSecondaryBuffers(p_drawList.GetPacketsCount());
+            const VkSubpassContents contents = useSecondaryBuffers
+                ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                : VK_SUBPASS_CONTENTS_INLINE;
 
             VkViewport viewport;
             viewport.x = 0.0f;
             viewport.y = 0.0f;
-            viewport.width = _vulkanInstance->GetFrameBufferSize().x;
-            viewport.height = _vulkanInstance->GetFrameBufferSize().y;
+            viewport.width = static_cast<float>(p_extent.width);
+            viewport.height = static_cast<float>(p_extent.height);
             viewport.minDepth = 0.0f;
             viewport.maxDepth = 1.0f;
             
-            vkCmdSetViewport(_commandBuffer->GetVkCommandBuffer(), 0, 1, &viewport);
-
             VkRect2D scissor;
             scissor.offset = {0, 0};
-            scissor.extent = renderAreaExtent;
-            
-            vkCmdSetScissor(_commandBuffer->GetVkCommandBuffer(), 0, 1, &scissor);
+            scissor.extent = p_extent;
 
-            for (auto& renderer : p_renderers)
+            if (useSecondaryBuffers)
             {
-                vkCmdBindPipeline(_commandBuffer->GetVkCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                renderer.GetGraphicsPipeline()->GetVkPipeline());
-
-                vkCmdDraw(_commandBuffer->GetVkCommandBuffer(), 3, 1, 0, 0);
+                ResetSecondaryPools(p_frameIndex);
             }
-            
-            vkCmdEndRenderPass(_commandBuffer->GetVkCommandBuffer());
 
-            
+            auto recordSubPass = [&](uint32_t p_subPassIndex, bool p_isDepthPrePass)
+            {
+                if (useSecondaryBuffers)
+                {
+                    // Dynamic state is not inherited, every secondary buffer sets its own viewport and scissor
+                    RecordSecondaryBuffers(p_commandBuffer, p_frameIndex, renderPassInfo.renderPass, p_subPassIndex,
+                        renderPassInfo.framebuffer, viewport, scissor, p_drawList, p_isDepthPrePass);
+                }
+                else
+                {
+                    vkCmdSetViewport(p_commandBuffer, 0, 1, &viewport);
+                    vkCmdSetScissor(p_commandBuffer, 0, 1, &scissor);
+                    p_drawList.Record(p_commandBuffer, 0, p_drawList.GetPacketsCount(), _lastStatistics,
+                        p_isDepthPrePass);
+                }
+            };
 
-            VkImageSubresourceRange aspect { };
-            aspect.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            aspect.baseMipLevel = 0;
-            aspect.levelCount = 1;
-            aspect.baseArrayLayer = 0;
-            aspect.layerCount = 1;
-
-            VkImageMemoryBarrier imageBarrier = {};
-            imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-            imageBarrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-            imageBarrier.newLayout = VK_IMAGE_LAYOUT_READ_ONLY_OPTIMAL;
-            imageBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-            imageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            imageBarrier.image = p_renderPassOutputImage;
-            imageBarrier.subresourceRange = aspect;
-
-            vkCmdPipelineBarrier(_commandBuffer->GetVkCommandBuffer(),
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                0,
-                0,
-                nullptr,
-                0,
-                nullptr,
-                1,
-                &imageBarrier);
-
-            const auto result = vkEndCommandBuffer(_commandBuffer->GetVkCommandBuffer());
-            if (result != VK_SUCCESS)
+            vkCmdBeginRenderPass(p_commandBuffer, &renderPassInfo, contents);
+            if (p_isDepthPrePassEnabled)
             {
-                VULKAN_ERR("Failed to record command buffer with returned result {}", string_VkResult(status));
-                return;
+                recordSubPass(p_renderPass->GetDepthPrePassSubPassIndex(), true);
             }
+
+            vkCmdNextSubpass(p_commandBuffer, contents);
+            recordSubPass(p_renderPass->GetBaseSubPassIndex(), false);
+            
+            vkCmdEndRenderPass(p_commandBuffer);
         }
         
-        void SubmitBuffer(const Vulkan::Fence* p_finishFence,
+        void SubmitBuffer(uint32_t p_frameIndex, const Vulkan::Fence* p_finishFence,
             const std::vector<const Vulkan::Semaphore*>& p_waitSemaphores,
             const std::vector<const Vulkan::Semaphore*>& p_finishSemaphores,
-            const Vulkan::CommandBuffer* p_imGuiComamandBuffer)
+            const UploadFrameSync& p_uploadSync)
         {
+            // Binary semaphores wait for swapchain image at color output, their timeline values are ignored
             std::vector<VkSemaphore> waitSemaphores(p_waitSemaphores.size());
+            std::vector<VkPipelineStageFlags> waitStages(p_waitSemaphores.size(), VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+            std::vector<uint64_t> waitValues(p_waitSemaphores.size(), 0);
             for (uint32_t i = 0; i < waitSemaphores.size(); i++)
             {
                 waitSemaphores[i] = p_waitSemaphores[i]->GetVkSemaphore();
             }
 
+            if (p_uploadSync.Semaphore != VK_NULL_HANDLE)
+            {
+                waitSemaphores.push_back(p_uploadSync.Semaphore);
+                waitStages.push_back(p_uploadSync.WaitStages);
+                waitValues.push_back(p_uploadSync.WaitValue);
+            }
+
             std::vector<VkSemaphore> finishSubmitSemaphores(p_finishSemaphores.size());
             for (uint32_t i = 0; i < finishSubmitSemaphores.size(); i++)
             {
                 finishSubmitSemaphores[i] = p_finishSemaphores[i]->GetVkSemaphore();
             }
 
-            std::array<VkCommandBuffer, 2> commandBuffers{
-                _commandBuffer->GetVkCommandBuffer(),
-                p_imGuiComamandBuffer->GetVkCommandBuffer(),
-            };
+            std::vector<VkCommandBuffer> commandBuffers;
+            commandBuffers.reserve(2);
+            if (p_uploadSync.AcquireCommandBuffer != VK_NULL_HANDLE)
+            {
+                commandBuffers.push_back(p_uploadSync.AcquireCommandBuffer);
+            }
+            commandBuffers.push_back(_commandBuffers[p_frameIndex]->GetVkCommandBuffer());
 
-            VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+            VkTimelineSemaphoreSubmitInfo timelineInfo { };
+            timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+            timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+            timelineInfo.pWaitSemaphoreValues = waitValues.data();
 
             VkSubmitInfo submitInfo { };
             submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.pNext = &timelineInfo;
             submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
             submitInfo.pWaitSemaphores = waitSemaphores.data();
-            submitInfo.pWaitDstStageMask = waitStages;
+            submitInfo.pWaitDstStageMask = waitStages.data();
             submitInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
             submitInfo.pCommandBuffers = commandBuffers.data();
             submitInfo.signalSemaphoreCount = static_cast<uint32_t>(finishSubmitSemaphores.size());
@@ -175,11 +238,40 @@ namespace DeepEngine::Engine::Renderer
         }
 
     private:
-        const Vulkan::VulkanInstance::QueueInstance* _mainGraphicsQueue;
-        Vulkan::VulkanInstance* _vulkanInstance;
+        struct SecondaryCommandPool
+        {
+            Vulkan::CommandPool* Pool;
+            std::vector<Vulkan::CommandBuffer*> Buffers;
+            // Buffers are handed out in order and all of them are reset together with the pool
+            uint32_t UsedBuffersCount = 0;
+        };
+
+        void InitializeSecondaryPools(uint32_t p_framesInFlight);
+        bool CanRecordInSecondaryBuffers(uint32_t p_drawsCount) const;
+
+        // Secondary buffers of the frame are handed out again from the first one
+        void ResetSecondaryPools(uint32_t p_frameIndex);
+        void RecordSecondaryBuffers(VkCommandBuffer p_primaryBuffer, uint32_t p_frameIndex,
+            VkRenderPass p_renderPass, uint32_t p_subPassIndex, VkFramebuffer p_framebuffer,
+            const VkViewport& p_viewport, const VkRect2D& p_scissor,
+            const DrawList& p_drawList, bool p_isDepthPrePass);
+
+    private:
+        const Vulkan::VulkanInstance::QueueInstance* _mainGraphicsQueue = nullptr;
+        Vulkan::VulkanInstance* _vulkanInstance = nullptr;
+
+        std::vector<Vulkan::CommandBuffer*> _commandBuffers;
+        Vulkan::CommandPool* _commandPool = nullptr;
+        Vulkan::QueryPool* _queryPool = nullptr;
 
-        Vulkan::CommandBuffer* _commandBuffer;
-        Vulkan::CommandPool* _commandPool;
+        Core::Threading::ThreadPool* _threadPool = nullptr;
+        // [frame in flight][thread index]
+        std::vector<std::vector<SecondaryCommandPool>> _secondaryPools;
+        // Secondary buffers in batch order, so execution order does not depend on which thread recorded a batch
+        std::vector<VkCommandBuffer> _batchBuffers;
+        // Indexed by thread index, summed after recording
+        std::vector<DrawListStatistics> _threadsStatistics;
+        DrawListStatistics _lastStatistics;
     };
     
 }
@@ -2,6 +2,19 @@
 
 namespace DeepEngine::Engine::Renderer
 {
+    namespace
+    {
+        // Sources of the shaders in SHADER_DIRECTORY, keep in sync with Shader/compile.bat
+        const std::vector<ShaderSourceFile> SHADER_SOURCES {
+            { "shader.vert", "vert.spv" },
+            { "shader.frag", "frag.spv" },
+            { "mesh.vert", "meshVert.spv" },
+            { "mesh.frag", "meshFrag.spv" },
+            { "meshInstanced.vert", "meshInstancedVert.spv" },
+            { "frustumCull.comp", "frustumCull.spv" },
+        };
+    }
+
     bool RendererSubsystem::Init()
     {
         if (!InitializeVulkanInstance())
@@ -9,31 +22,53 @@ namespace DeepEngine::Engine::Renderer
             return false;
         }
 
-        _readyToRenderFence = new Vulkan::Fence(true);
-        if (!_vulkanInstance->InitializeSubController(_readyToRenderFence))
+        _mainRenderPass = new MainRenderPass();
+        if (!_vulkanInstance->InitializeSubController(_mainRenderPass))
         {
             return false;
         }
 
-        _availableImageToRenderSemaphore = new Vulkan::Semaphore();
-        if (!_vulkanInstance->InitializeSubController(_availableImageToRenderSemaphore))
+        if (IsHeadless())
         {
-            return false;
+            // There is no viewport window to size the scene, offscreen image has fixed size
+            Events::OnViewportResized event;
+            event.NewViewportSize = { static_cast<float>(_headlessSettings.Width),
+                static_cast<float>(_headlessSettings.Height) };
+            _vulkanInstance->GetRendererEventBus().Publish(event);
         }
 
-        _finishRenderingSemaphore = new Vulkan::Semaphore();
-        if (!_vulkanInstance->InitializeSubController(_finishRenderingSemaphore))
+        std::vector<const Vulkan::DescriptorSetLayout*> sceneSetLayouts;
+        if (_vulkanInstance->IsDescriptorIndexingEnabled())
+        {
+            _bindlessTable = new BindlessTable(_vulkanInstance, _framesInFlightCount);
+            if (!_bindlessTable->Initialize())
+            {
+                return false;
+            }
+            sceneSetLayouts.push_back(_bindlessTable->GetDescriptorSetLayout());
+        }
+
+        // Shared by every scene pipeline, so push constants and sets stay bound when pipelines switch
+        Vulkan::PipelineLayout* pipelineLayout = _mainRenderPass->CreateBaseSubPassPipelineLayout(
+            sceneSetLayouts, { MeshPushConstants::GetRange() });
+        if (pipelineLayout == nullptr)
         {
             return false;
         }
-        
-        _mainRenderPass = new MainRenderPass();
-        if (!_vulkanInstance->InitializeSubController(_mainRenderPass))
+
+        // Same sets and push constants, pre-pass draws bind the same resources
+        Vulkan::PipelineLayout* depthPrePassLayout = _mainRenderPass->CreateDepthPrePassPipelineLayout(
+            sceneSetLayouts, { MeshPushConstants::GetRange() });
+        if (depthPrePassLayout == nullptr)
         {
             return false;
         }
 
-        Vulkan::PipelineLayout* pipelineLayout = _mainRenderPass->CreateBaseSubPassPipelineLayout();
+        if (_bindlessTable != nullptr)
+        {
+            // Bound once per command buffer, resources are addressed by index from then on
+            _drawList.SetGlobalDescriptorSet(_bindlessTable->GetVkDescriptorSet(), pipelineLayout);
+        }
 
         Vulkan::PipelineDynamicState dynamicState {
             .Viewport = true,
@@ -63,27 +98,527 @@ namespace DeepEngine::Engine::Renderer
             .FrontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
         };
 
-        _renderers.resize(2);
-        if(!_renderers[0].Init("../DeepEngine/Engine/Renderer/Shader/vert.spv",
-            "../DeepEngine/Engine/Renderer/Shader/frag.spv",
-                            dynamicState, colorBlend, attachmentBlend, rasterization, pipelineLayout))
+        // Less or equal passes fragments whose depth was already written by the pre-pass, and still tests draws
+        // which were not in it, so the same pipelines work with and without the pre-pass
+        Vulkan::PipelineDepthStencil depthStencil {
+            .EnableDepthTest = true,
+            .EnableDepthWrite = true,
+            .DepthCompareOperation = VK_COMPARE_OP_LESS_OR_EQUAL,
+        };
+
+        _isDepthPrePassEnabled = _workload.DepthPrePass;
+
+        _threadPool = new Core::Threading::ThreadPool(_workload.RecordingThreads != 0
+            ? _workload.RecordingThreads - 1
+            : Core::Threading::ThreadPool::GetDefaultWorkersCount());
+        INFO("Running renderer jobs on {} threads", _threadPool->GetThreadIndicesCount());
+
+        _shaderLibrary = new ShaderLibrary(_vulkanInstance, _threadPool);
+        if (!_shaderLibrary->Load(SHADER_ARCHIVE_PATH, SHADER_DIRECTORY))
         {
             return false;
         }
-        if(!_renderers[1].Init("../DeepEngine/Engine/Renderer/Shader/vert1.spv",
-            "../DeepEngine/Engine/Renderer/Shader/frag1.spv",
-                            dynamicState, colorBlend, attachmentBlend, rasterization, pipelineLayout))
+
+        if (!IsHeadless())
+        {
+            _shaderHotReload = new ShaderHotReload(_shaderLibrary, SHADER_DIRECTORY, SHADER_SOURCES);
+            if (!_shaderHotReload->Start())
+            {
+                WARN("Shader directory \"{}\" can not be watched, shaders will not be reloaded", SHADER_DIRECTORY);
+                delete _shaderHotReload;
+                _shaderHotReload = nullptr;
+            }
+        }
+
+        _pipelineCompiler = new PipelineCompiler(_threadPool, _shaderLibrary);
+        _pipelineRegistry = new PipelineRegistry(_pipelineCompiler, _framesInFlightCount);
+
+        GraphicsPipelineDescription pipelineDescription {
+            .VertexShader = "vert.spv",
+            .FragmentShader = "frag.spv",
+            .DynamicState = dynamicState,
+            .ColorBlend = colorBlend,
+            .AttachmentsBlend = { attachmentBlend },
+            .Rasterization = rasterization,
+            .DepthStencil = depthStencil,
+            .PipelineLayout = pipelineLayout,
+        };
+
+        // Only pipeline the engine waits for, everything else is drawn with it until compiled
+        _fallbackPipeline = _pipelineRegistry->AcquireNow(pipelineDescription);
+        if (_fallbackPipeline == nullptr)
+        {
+            return false;
+        }
+
+        _uploadQueue = new UploadQueue(_vulkanInstance, _transferQueue, _mainGraphicsQueue, _framesInFlightCount);
+        if (!_uploadQueue->Initialize())
+        {
+            return false;
+        }
+
+        const std::vector<MeshVertex> quadVertices {
+            { { -0.9f, -0.9f, 0.0f }, { 1.0f, 0.0f, 0.0f } },
+            { { -0.5f, -0.9f, 0.0f }, { 0.0f, 1.0f, 0.0f } },
+            { { -0.5f, -0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+            { { -0.9f, -0.5f, 0.0f }, { 1.0f, 1.0f, 1.0f } },
+        };
+        const std::vector<uint32_t> quadIndices { 0, 1, 2, 2, 3, 0 };
+
+        if (!_quadMesh.Create(_vulkanInstance, *_uploadQueue, quadVertices, quadIndices))
+        {
+            return false;
+        }
+
+        _renderers.resize(3 + _workload.PipelineVariants);
+        _renderers[0].Init(*_pipelineRegistry, pipelineDescription, _fallbackPipeline, depthPrePassLayout);
+
+        for (uint32_t i = 0; i < _workload.PipelineVariants; i++)
+        {
+            // Blending is disabled, constants change nothing but the pipeline identity
+            GraphicsPipelineDescription variantDescription = pipelineDescription;
+            variantDescription.ColorBlend.ColorBlendConstants.r = static_cast<float>(i + 2);
+            _renderers[3 + i].Init(*_pipelineRegistry, variantDescription, _fallbackPipeline, depthPrePassLayout);
+        }
+
+        pipelineDescription.VertexShader = "vert1.spv";
+        pipelineDescription.FragmentShader = "frag1.spv";
+        _renderers[1].Init(*_pipelineRegistry, pipelineDescription, _fallbackPipeline, depthPrePassLayout);
+
+        pipelineDescription.VertexShader = "meshVert.spv";
+        pipelineDescription.FragmentShader = "meshFrag.spv";
+        pipelineDescription.VertexLayout = MeshVertex::GetLayout();
+        _renderers[2].Init(*_pipelineRegistry, pipelineDescription, _fallbackPipeline, depthPrePassLayout);
+        _renderers[2].SetMesh(&_quadMesh);
+
+        pipelineDescription.VertexShader = "meshInstancedVert.spv";
+        pipelineDescription.VertexLayout = InstancedMeshRenderer::GetVertexLayout();
+        _descriptorAllocator = new DescriptorAllocator(_vulkanInstance, _framesInFlightCount);
+        _transientImages = new TransientImageAllocator(_vulkanInstance, _framesInFlightCount);
+        if (!_instancedRenderer.Init(_vulkanInstance, _shaderLibrary, *_pipelineRegistry, _descriptorAllocator,
+            pipelineDescription, _fallbackPipeline, &_quadMesh, _framesInFlightCount, _workload.MaxInstances,
+            depthPrePassLayout))
         {
             return false;
         }
+        _instancedRenderer.SetCullingMode(_workload.CullingMode);
+
+        // Quad mesh spans [-0.9, -0.5], grid of its copies fills the upper right quarter of the screen
+        const uint32_t gridSize = _workload.InstancesGridSize;
+        const float cellSize = 0.9f / static_cast<float>(std::max(gridSize, 1u));
+        _gridInstances.reserve(static_cast<size_t>(gridSize) * gridSize);
+        for (uint32_t y = 0; y < gridSize; y++)
+        {
+            for (uint32_t x = 0; x < gridSize; x++)
+            {
+                glm::mat4 transform = glm::translate(glm::mat4(1.0f), { (x + 0.5f) * cellSize, (y + 0.5f) * cellSize, 0.0f });
+                transform = glm::scale(transform, glm::vec3(cellSize * 0.8f / 0.4f));
+                transform = glm::translate(transform, { 0.7f, 0.7f, 0.0f });
+                _gridInstances.push_back(transform);
+            }
+        }
+
+        INFO("Requested {} pipelines, {} unique", _renderers.size() + 2, _pipelineRegistry->GetPipelinesCount());
+
+        if (_workload.UploadBytesPerFrame > 0)
+        {
+            _workloadUploadBuffer = new Vulkan::Buffer(_workload.UploadBytesPerFrame,
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Vulkan::MemoryUsage::GPU_ONLY);
+            if (!_vulkanInstance->InitializeSubController(_workloadUploadBuffer))
+            {
+                return false;
+            }
+            _workloadUploadData.resize(_workload.UploadBytesPerFrame);
+            for (size_t i = 0; i < _workloadUploadData.size(); i++)
+            {
+                _workloadUploadData[i] = static_cast<uint8_t>(i);
+            }
+        }
+        
+        _gpuQueryPool = new Vulkan::QueryPool(_mainGraphicsQueue, _framesInFlightCount, 16, true);
+        if (!_vulkanInstance->InitializeSubController(_gpuQueryPool))
+        {
+            return false;
+        }
+        
+        _commandRecorder = RendererCommandRecorder(_vulkanInstance, _mainGraphicsQueue, _gpuQueryPool, _threadPool,
+            _framesInFlightCount);
         
-        _commandRecorder = RendererCommandRecorder(_vulkanInstance, _mainGraphicsQueue);
+        if (!IsHeadless())
+        {
+            _imGuiController = new ImGuiController(_vulkanInstance, _mainGraphicsQueue, _gpuQueryPool, _framesInFlightCount);
+        }
+
+        if (!InitializeFramesInFlight())
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    bool RendererSubsystem::InitializeFramesInFlight()
+    {
+        _framesInFlight.resize(_framesInFlightCount);
         
-        _imGuiController = new ImGuiController(_vulkanInstance, _mainGraphicsQueue, _mainRenderPass);
+        for (uint32_t i = 0; i < _framesInFlightCount; i++)
+        {
+            FrameInFlight& frame = _framesInFlight[i];
+            frame.SceneCommandBuffer = _commandRecorder.GetCommandBuffer(i);
+            
+            // Signaled, so the first wait on every frame passes
+            frame.RenderFinishedFence = new Vulkan::Fence(true);
+            if (!_vulkanInstance->InitializeSubController(frame.RenderFinishedFence))
+            {
+                return false;
+            }
+
+            frame.ImageAvailableSemaphore = new Vulkan::Semaphore();
+            if (!_vulkanInstance->InitializeSubController(frame.ImageAvailableSemaphore))
+            {
+                return false;
+            }
+
+            frame.RenderFinishedSemaphore = new Vulkan::Semaphore();
+            if (!_vulkanInstance->InitializeSubController(frame.RenderFinishedSemaphore))
+            {
+                return false;
+            }
+        }
 
+        _imagesInFlight.assign(_vulkanInstance->GetSwapChainImageViews().size(), nullptr);
+        
+        INFO("Rendering with {} frames in flight", _framesInFlightCount);
         return true;
     }
 
+    void RendererSubsystem::Tick(const Core::Scene::Scene& p_scene)
+    {
+        if (_isWindowMinimized)
+        {
+            return;
+        }
+
+        const FrameInFlight& frame = _framesInFlight[_currentFrame];
+
+        {
+            // Time spent here is time when CPU is ahead of GPU by all frames in flight
+            TIMER("Waiting for frame in flight");
+            vkWaitForFences(
+                _vulkanInstance->GetLogicalDevice(),
+                1,
+                frame.RenderFinishedFence->GetVkFencePtr(),
+                VK_TRUE,
+                UINT64_MAX);
+        }
+
+        uint32_t imageIndex = 0;
+        bool invalidSwapChain = false;
+        if (!IsHeadless() && !AcquireSwapchainImage(frame, &imageIndex, &invalidSwapChain))
+        {
+            return;
+        }
+
+        // Reset only when work is surely submitted, otherwise next wait on this frame would dead lock
+        vkResetFences(_vulkanInstance->GetLogicalDevice(), 1, frame.RenderFinishedFence->GetVkFencePtr());
+
+        // Frame fence was waited, so pipelines released framesInFlight frames ago are no longer in use
+        _pipelineRegistry->CollectUnused();
+        if (_shaderHotReload != nullptr)
+        {
+            for (const std::string& shader : _shaderHotReload->TakeReloadedShaders())
+            {
+                const uint32_t rebuiltCount = _pipelineRegistry->RebuildWithShader(shader)
+                    + _instancedRenderer.RebuildWithShader(shader);
+                INFO("Shader \"{}\" was reloaded, rebuilding {} pipelines", shader, rebuiltCount);
+            }
+
+            // Compilations which could have taken modules replaced by reloads are finished
+            if (_pipelineCompiler->GetPendingCount() == 0)
+            {
+                _shaderLibrary->ReleaseRetiredModules();
+            }
+        }
+        // Before renderers update their pipelines, so the whole frame records with the same ones
+        _pipelineRegistry->SwapRebuiltPipelines();
+
+        if (_bindlessTable != nullptr)
+        {
+            _bindlessTable->BeginFrame();
+        }
+        _descriptorAllocator->BeginFrame(_currentFrame);
+        _transientImages->BeginFrame(_currentFrame);
+        if (_headlessReadback != nullptr)
+        {
+            _headlessReadback->BeginFrame(_currentFrame);
+        }
+        uint32_t failedAllocations = 0;
+        for (uint32_t i = 0; i < _workload.BufferAllocationsPerFrame; i++)
+        {
+            // Created and destroyed right away, only allocation cost is of interest
+            auto buffer = new Vulkan::Buffer(64 * 1024, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Vulkan::MemoryUsage::GPU_ONLY);
+            if (!_vulkanInstance->InitializeSubController(buffer))
+            {
+                failedAllocations++;
+            }
+            buffer->Terminate();
+        }
+        if (failedAllocations > 0)
+        {
+            _failedWorkloadAllocations += failedAllocations;
+            ERR("Failed to allocate {} of {} workload buffers", failedAllocations, _workload.BufferAllocationsPerFrame);
+        }
+        {
+            TIMER("Build draw list");
+            _drawList.Clear();
+            for (auto& renderer : _renderers)
+            {
+                renderer.UpdatePipeline();
+                renderer.Draw(_drawList);
+            }
+            for (uint32_t i = 0; i < _workload.TriangleDraws; i++)
+            {
+                _renderers[0].Draw(_drawList);
+            }
+
+            _instancedRenderer.UpdatePipeline();
+            _instancedRenderer.BeginFrame(_currentFrame);
+            _instancedRenderer.AddInstances(p_scene);
+            _instancedRenderer.AddInstances(_gridInstances);
+            // No camera yet, instances are already in clip space
+            _instancedRenderer.Draw(_drawList, Frustum::FromViewProjection(glm::mat4(1.0f)));
+            _drawList.Sort();
+        }
+
+        bool isGraphCompiled;
+        {
+            TIMER("Build render graph");
+            isGraphCompiled = BuildRenderGraph(imageIndex);
+        }
+
+        if (_imGuiController != nullptr)
+        {
+            // Scene color view changes only when the graph recreates its images
+            _imGuiController->SetViewportImage(_currentFrame, isGraphCompiled
+                ? _renderGraph.GetImageView(_sceneColorResource)
+                : VK_NULL_HANDLE);
+            _imGuiController->SetDepthPrePassEnabled(_isDepthPrePassEnabled);
+            _imGuiController->BuildFrame(_currentFrame, p_scene);
+            // Checkbox of the profiler window, takes effect in this frame already
+            _isDepthPrePassEnabled = _imGuiController->IsDepthPrePassEnabled();
+        }
+
+        {
+            TIMER("Record scene command buffers");
+            _commandRecorder.RecordBuffer(_currentFrame, _renderGraph);
+        }
+        if (_imGuiController != nullptr)
+        {
+            // Shown by the UI of the next frame, this one is already built
+            _imGuiController->SetDrawStatistics(_commandRecorder.GetLastStatistics());
+            _imGuiController->SetDescriptorStatistics(_descriptorAllocator->GetStatistics());
+            _imGuiController->SetRenderGraphStatistics(_renderGraph.GetStatistics());
+            _imGuiController->SetTransientImageStatistics(_transientImages->GetStatistics());
+            const InstanceCullingMode cullingMode = _instancedRenderer.GetCullingMode();
+            _imGuiController->SetInstanceStatistics(_instancedRenderer.GetInstancesCount(),
+                _instancedRenderer.GetVisibleInstancesCount(), cullingMode == InstanceCullingMode::GPU
+                    ? "GPU"
+                    : cullingMode == InstanceCullingMode::CPU ? "CPU" : "no");
+        }
+
+        if (_workloadUploadBuffer != nullptr)
+        {
+            // Whole buffer is rewritten, so it may be released to the graphics queue every frame
+            _uploadQueue->Upload(_workloadUploadBuffer, 0, _workloadUploadData.data(), _workloadUploadData.size());
+        }
+
+        // Frame waits for the uploads on the GPU, never on the CPU
+        _uploadQueue->Flush();
+        const UploadFrameSync uploadSync = _uploadQueue->PrepareFrame(_currentFrame);
+
+        if (IsHeadless())
+        {
+            // Nothing to acquire nor present, readback is complete when the fence is signaled
+            _commandRecorder.SubmitBuffer(_currentFrame, frame.RenderFinishedFence, { }, { }, uploadSync);
+        }
+        else
+        {
+            _commandRecorder.SubmitBuffer(_currentFrame, frame.RenderFinishedFence,
+                { frame.ImageAvailableSemaphore },
+                { frame.RenderFinishedSemaphore },
+                uploadSync);
+
+            PresentSwapchainImage(frame, imageIndex, invalidSwapChain);
+            _imGuiController->PostRenderUpdate();
+        }
+
+        _currentFrame = (_currentFrame + 1) % _framesInFlightCount;
+    }
+
+    uint32_t RendererSubsystem::GetPendingPipelinesCount() const
+    {
+        uint32_t pendingCount = _instancedRenderer.IsPipelinePending() ? 1 : 0;
+        for (const TriangleRenderer& renderer : _renderers)
+        {
+            pendingCount += renderer.IsPipelinePending() ? 1 : 0;
+        }
+        return pendingCount;
+    }
+
+    float RendererSubsystem::GetGpuFrameMilliseconds() const
+    {
+        if (_gpuQueryPool == nullptr)
+        {
+            return 0.0f;
+        }
+
+        // Graph passes are the only scopes and they never overlap
+        float milliseconds = 0.0f;
+        for (const Vulkan::GpuScopeResult& result : _gpuQueryPool->GetResults())
+        {
+            milliseconds += result.Milliseconds;
+        }
+        return milliseconds;
+    }
+
+    uint64_t RendererSubsystem::GetGpuFragmentInvocations() const
+    {
+        if (_gpuQueryPool == nullptr)
+        {
+            return 0;
+        }
+
+        uint64_t invocations = 0;
+        for (const Vulkan::GpuScopeResult& result : _gpuQueryPool->GetResults())
+        {
+            invocations += result.HasStatistics ? result.FragmentShaderInvocations : 0;
+        }
+        return invocations;
+    }
+
+    bool RendererSubsystem::AcquireSwapchainImage(const FrameInFlight& p_frame, uint32_t* p_outImageIndex,
+        bool* p_outIsSwapChainInvalid)
+    {
+        const auto acquireResult = vkAcquireNextImageKHR(
+            _vulkanInstance->GetLogicalDevice(),
+            _vulkanInstance->GetSwapchain(),
+            UINT64_MAX,
+            p_frame.ImageAvailableSemaphore->GetVkSemaphore(),
+            VK_NULL_HANDLE,
+            p_outImageIndex);
+
+        *p_outIsSwapChainInvalid = acquireResult == VK_SUBOPTIMAL_KHR;
+        if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            _vulkanInstance->RecreateSwapChain();
+            _imagesInFlight.assign(_vulkanInstance->GetSwapChainImageViews().size(), nullptr);
+            return false;
+        }
+
+        // Per image resources (framebuffers, render pass images) can not be overwritten while other frame uses them
+        const uint32_t imageIndex = *p_outImageIndex;
+        if (_imagesInFlight[imageIndex] != nullptr && _imagesInFlight[imageIndex] != p_frame.RenderFinishedFence)
+        {
+            vkWaitForFences(
+                _vulkanInstance->GetLogicalDevice(),
+                1,
+                _imagesInFlight[imageIndex]->GetVkFencePtr(),
+                VK_TRUE,
+                UINT64_MAX);
+        }
+        _imagesInFlight[imageIndex] = p_frame.RenderFinishedFence;
+        return true;
+    }
+
+    void RendererSubsystem::PresentSwapchainImage(const FrameInFlight& p_frame, uint32_t p_imageIndex,
+        bool p_isSwapChainInvalid)
+    {
+        VkSwapchainKHR swapChains[] = { _vulkanInstance->GetSwapchain() };
+        VkSemaphore waitSemaphores[] = { p_frame.RenderFinishedSemaphore->GetVkSemaphore() };
+        
+        VkPresentInfoKHR presentInfo { };
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = waitSemaphores;
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = swapChains;
+        presentInfo.pImageIndices = &p_imageIndex;
+        presentInfo.pResults = nullptr;
+
+        VkResult presentResult = vkQueuePresentKHR(_mainGraphicsQueue->Queue, &presentInfo);
+        if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR || p_isSwapChainInvalid)
+        {
+            _vulkanInstance->RecreateSwapChain();
+            _imagesInFlight.assign(_vulkanInstance->GetSwapChainImageViews().size(), nullptr);
+        }
+        else if (presentResult != VK_SUCCESS)
+        {
+            VULKAN_ERR("Failed to present swapchain with returned result {}", string_VkResult(presentResult));
+        }
+    }
+
+    bool RendererSubsystem::BuildRenderGraph(uint32_t p_imageIndex)
+    {
+        _renderGraph.Reset();
+
+        // Sized by the viewport window, not the swapchain
+        const VkExtent2D sceneExtent = _mainRenderPass->GetExtent();
+        RenderGraphImageDescription sceneColorDescription { };
+        sceneColorDescription.Width = sceneExtent.width;
+        sceneColorDescription.Height = sceneExtent.height;
+        sceneColorDescription.Format = MainRenderPass::COLOR_FORMAT;
+        // Sampled by the viewport window, or copied to host memory when headless
+        sceneColorDescription.Usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
+            | (IsHeadless() ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : VK_IMAGE_USAGE_SAMPLED_BIT);
+        const RenderGraph::ResourceID sceneColor = _renderGraph.CreateImage("Scene color", sceneColorDescription);
+        _sceneColorResource = sceneColor;
+
+        // Used only inside the scene render pass, so it can live in lazily allocated memory
+        RenderGraphImageDescription sceneDepthDescription = sceneColorDescription;
+        sceneDepthDescription.Format = _mainRenderPass->GetDepthFormat();
+        sceneDepthDescription.Usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        sceneDepthDescription.Aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+        const RenderGraph::ResourceID sceneDepth = _renderGraph.CreateImage("Scene depth", sceneDepthDescription);
+
+        _instancedRenderer.AddCullingPass(_renderGraph);
+
+        RenderGraph::PassBuilder scenePass = _renderGraph.AddPass("Scene",
+            [this, sceneColor, sceneDepth, sceneExtent](VkCommandBuffer p_commandBuffer)
+            {
+                const VkFramebuffer framebuffer = _renderGraph.GetFramebuffer(_mainRenderPass->GetVkRenderPass(),
+                    { sceneColor, sceneDepth });
+                _commandRecorder.RecordScenePass(p_commandBuffer, {0.05f, 0.05f, 0.15f, 1.0f}, _currentFrame,
+                    _mainRenderPass, framebuffer, sceneExtent, _drawList, _isDepthPrePassEnabled);
+            });
+        scenePass.Write(sceneColor, RenderGraphUsage::ColorAttachment());
+        scenePass.Write(sceneDepth, RenderGraphUsage::DepthAttachment());
+        _instancedRenderer.ReadDrawInputs(scenePass);
+
+        if (IsHeadless())
+        {
+            if (!_headlessReadback->AddReadbackPass(_renderGraph, sceneColor, sceneColorDescription))
+            {
+                return false;
+            }
+            return _renderGraph.Compile(_transientImages);
+        }
+
+        // Content left by the previous frame is not needed, the image is cleared
+        const RenderGraph::ResourceID swapchainImage = _renderGraph.ImportImage("Swapchain image",
+            _vulkanInstance->GetSwapChainImages()[p_imageIndex], VK_IMAGE_ASPECT_COLOR_BIT,
+            RenderGraphUsage::SwapchainAcquired());
+
+        _renderGraph.AddPass("ImGui", [this, p_imageIndex](VkCommandBuffer p_commandBuffer)
+            {
+                _imGuiController->RecordDrawData(p_commandBuffer, p_imageIndex);
+            })
+            .Read(sceneColor, RenderGraphUsage::FragmentSampled())
+            .Write(swapchainImage, RenderGraphUsage::ColorAttachment());
+
+        _renderGraph.Export(swapchainImage, RenderGraphUsage::Present());
+        return _renderGraph.Compile(_transientImages);
+    }
+
     bool RendererSubsystem::InitializeVulkanInstance()
     {
         MESSENGER_PREINITIALIZE(VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT
@@ -101,7 +636,7 @@ namespace DeepEngine::Engine::Renderer
             _vulkanInstance->EnableInstanceExtension(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
         }
 
-        if (!EnableGlfwExtensions())
+        if (!IsHeadless() && !EnableGlfwExtensions())
         {
             return false;
         }
@@ -111,23 +646,40 @@ namespace DeepEngine::Engine::Renderer
             return false;
         }
 
-        _vulkanInstance->EnablePhysicalExtension(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        if (!IsHeadless())
+        {
+            _vulkanInstance->EnablePhysicalExtension(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        }
 
         if (!_vulkanInstance->InitializePhysicalDevice())
         {
             return false;
         }
 
-        if (!_vulkanInstance->TryAddQueueToCreate(VK_QUEUE_GRAPHICS_BIT, true, &_mainGraphicsQueue))
+        if (!_vulkanInstance->TryAddQueueToCreate(VK_QUEUE_GRAPHICS_BIT, !IsHeadless(), &_mainGraphicsQueue))
         {
             return false;
         }
 
+        // Transfer only family maps to the copy engine, so uploads run alongside rendering
+        if (!_vulkanInstance->TryAddQueueToCreate(VK_QUEUE_TRANSFER_BIT, false, &_transferQueue,
+            VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))
+        {
+            INFO("No dedicated transfer queue family, uploading on the graphics queue");
+            _transferQueue = _mainGraphicsQueue;
+        }
+
         if (!_vulkanInstance->InitializeLogicalDevice())
         {
             return false;
         }
 
+        if (IsHeadless())
+        {
+            INFO("Running headless, rendering offscreen at {}x{}", _headlessSettings.Width, _headlessSettings.Height);
+            return true;
+        }
+
         const auto& availableFormats = _vulkanInstance->GetAvailableSurfaceFormats();
         VkSurfaceFormatKHR bestFormat = availableFormats[0];
         for (int i = 0; i < (uint32_t)availableFormats.size(); i++)
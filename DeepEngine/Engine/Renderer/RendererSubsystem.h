@@ -3,147 +3,267 @@
 #include "Vulkan/Instance/VulkanInstance.h"
 
 #define MESSENGER_UTILS
+#include "BindlessTable.h"
+#include "DescriptorAllocator.h"
+#include "DrawList.h"
+#include "HeadlessReadback.h"
+#include "InstancedMeshRenderer.h"
 #include "MainRenderPass.h"
+#include "Mesh.h"
+#include "PipelineCompiler.h"
+#include "PipelineRegistry.h"
+#include "RenderGraph.h"
 #include "RendererCommandRecorder.h"
+#include "ShaderHotReload.h"
 #include "TriangleRenderer.h"
+#include "UploadQueue.h"
 #include "ImGui/ImGuiController.h"
 #include "Vulkan/Semaphore.h"
 #include "Vulkan/RenderPass.h"
 #include "Vulkan/Debug/VulkanDebug.h"
 #include "Vulkan/Fence.h"
+#include "Vulkan/QueryPool.h"
 
 namespace DeepEngine::Engine::Renderer
 {
+    // Everything that GPU may still use while CPU records the next frames
     struct FrameInFlight
     {
-        Vulkan::CommandBuffer* _commandBuffer;
-        Vulkan::Fence* _fence;
-        
+        Vulkan::CommandBuffer* SceneCommandBuffer;
+        Vulkan::Fence* RenderFinishedFence;
+        Vulkan::Semaphore* ImageAvailableSemaphore;
+        Vulkan::Semaphore* RenderFinishedSemaphore;
+    };
+    
+    // Renderer without a window (no WindowSubsystem needed), e.g. on a software device on CI. Scene is rendered
+    // into an offscreen image of the given size and every frame is read back to host memory instead of presented
+    struct HeadlessSettings
+    {
+        uint32_t Width = 800;
+        uint32_t Height = 600;
     };
     
+    // Work drawn every frame on top of scene elements, benchmark scenarios scale it. Defaults are the demo scene
+    struct RendererWorkload
+    {
+        // Additional draws of the generated triangle, each one a separate draw packet
+        uint32_t TriangleDraws = 0;
+        // Pipelines compiled at startup on top of the demo ones, each drawn once per frame. They differ only in
+        // blend constants, so registry can not merge them
+        uint32_t PipelineVariants = 0;
+        // Side of the grid of quad instances drawn together with scene elements
+        uint32_t InstancesGridSize = 100;
+        uint32_t MaxInstances = 100'000;
+        InstanceCullingMode CullingMode = InstanceCullingMode::GPU;
+        // Rewritten through the upload queue every frame
+        VkDeviceSize UploadBytesPerFrame = 0;
+        // Device local buffers created and destroyed every frame, load on the memory allocator
+        uint32_t BufferAllocationsPerFrame = 0;
+        // Threads recording draws and compiling pipelines including the render thread, which records too
+        // (pool gets one worker less). 1 records inline and compiles pipelines synchronously, 0 for ThreadPool default
+        uint32_t RecordingThreads = 0;
+        // Initial state, may be switched at runtime (SetDepthPrePassEnabled, profiler window)
+        bool DepthPrePass = true;
+    };
+
     class RendererSubsystem final : Core::EngineSubsystem
     {
     public:
-        RendererSubsystem(Core::Events::EventBus& p_engineEventBus)
-            : EngineSubsystem(p_engineEventBus, "Renderer")
+        static constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+        // Relative to the working directory (Build), archive is packed by Shader/compile.bat
+        static constexpr const char* SHADER_ARCHIVE_PATH = "../DeepEngine/Engine/Renderer/Shader/Shaders.dsa";
+        static constexpr const char* SHADER_DIRECTORY = "../DeepEngine/Engine/Renderer/Shader";
+        
+        RendererSubsystem(Core::Events::EventBus& p_engineEventBus, uint32_t p_framesInFlight = DEFAULT_FRAMES_IN_FLIGHT)
+            : EngineSubsystem(p_engineEventBus, "Renderer"), _framesInFlightCount(std::max(p_framesInFlight, 1u))
         { 
             _vulkanInstance = new Vulkan::VulkanInstance(p_engineEventBus, _internalSubsystemEventBus);
             _wndChangeMinimizedListener = _internalSubsystemEventBus.CreateListener<Core::Events::OnWindowChangeMinimized>();
             _wndChangeMinimizedListener->BindCallback(&RendererSubsystem::WindowChangedMinimizedHandler, this);
         }
 
-    protected:
-        bool Init() override;
+        RendererSubsystem(Core::Events::EventBus& p_engineEventBus, HeadlessSettings p_headlessSettings,
+            uint32_t p_framesInFlight = DEFAULT_FRAMES_IN_FLIGHT)
+            : RendererSubsystem(p_engineEventBus, p_framesInFlight)
+        {
+            _headlessSettings = p_headlessSettings;
+            _vulkanInstance->SetHeadless(true);
+            _headlessReadback = new HeadlessReadback(_vulkanInstance, _framesInFlightCount);
+        }
 
-        void Destroy() override
+        bool IsHeadless() const
+        { return _headlessReadback != nullptr; }
+
+        // Has to be set before Init
+        void SetWorkload(const RendererWorkload& p_workload)
+        { _workload = p_workload; }
+
+        // Pipelines still compiled in background, renderers draw with the fallback pipeline until then
+        uint32_t GetPendingPipelinesCount() const;
+
+        // Sum of GPU scopes of the most recent frame with available results (framesInFlight frames old),
+        // 0 when timestamps are not supported
+        float GetGpuFrameMilliseconds() const;
+
+        // Sum of GPU scopes of the same frame as GetGpuFrameMilliseconds,
+        // 0 when pipeline statistics are not supported
+        uint64_t GetGpuFragmentInvocations() const;
+
+        // Opaque draws are rendered into depth first, fragment shader then runs once per covered pixel.
+        // Compare "Scene" fragment invocations in the profiler with it on and off
+        void SetDepthPrePassEnabled(bool p_isEnabled)
+        { _isDepthPrePassEnabled = p_isEnabled; }
+
+        bool IsDepthPrePassEnabled() const
+        { return _isDepthPrePassEnabled; }
+
+        // Of the last recorded frame
+        const DrawListStatistics& GetDrawStatistics() const
+        { return _commandRecorder.GetLastStatistics(); }
+
+        // Buffers of RendererWorkload::BufferAllocationsPerFrame which failed to allocate, since Init
+        uint64_t GetFailedWorkloadAllocationsCount() const
+        { return _failedWorkloadAllocations; }
+
+        // Empty when Init failed before creating the upload queue
+        const UploadQueueStatistics& GetUploadStatistics() const
         {
-            vkDeviceWaitIdle(_vulkanInstance->GetLogicalDevice());
-            
-            _imGuiController->Terminate();
-            delete _imGuiController;
-            
-            _commandRecorder.Terminate();
-            _vulkanInstance->Terminate();
-            Vulkan::VulkanDebugger::Terminate();
+            static const UploadQueueStatistics emptyStatistics { };
+            return _uploadQueue != nullptr ? _uploadQueue->GetStatistics() : emptyStatistics;
         }
-        
-        void Tick(const Core::Scene::Scene& p_scene) override
+
+        // Headless only, called with every rendered frame framesInFlight frames after it was recorded
+        // (remaining ones when the renderer is destroyed)
+        void SetReadbackCallback(HeadlessReadback::ReadbackCallback p_callback)
         {
-            if (_isWindowMinimized)
+            if (_headlessReadback != nullptr)
             {
-                return;
+                _headlessReadback->SetCallback(std::move(p_callback));
             }
+        }
 
-            vkWaitForFences(
-                _vulkanInstance->GetLogicalDevice(),
-                1,
-                _readyToRenderFence->GetVkFencePtr(),
-                VK_TRUE,
-                UINT64_MAX);
-
-            uint32_t imageIndex;
-            const auto acquireResult = vkAcquireNextImageKHR(
-                _vulkanInstance->GetLogicalDevice(),
-                _vulkanInstance->GetSwapchain(),
-                UINT64_MAX,
-                _availableImageToRenderSemaphore->GetVkSemaphore(),
-                VK_NULL_HANDLE,
-                &imageIndex);
-
-            bool invalidSwapChain = false;
-            if (acquireResult == VK_SUBOPTIMAL_KHR)
+    protected:
+        static constexpr int LogLevelFloor = DEEP_LOG_LEVEL_RENDERER;
+
+        bool Init() override;
+
+        // Called also when Init failed, anything past the failed step was never created
+        void Destroy() override
+        {
+            // Watcher creates shader modules from its thread
+            delete _shaderHotReload;
+            // Compilation tasks create controllers, they have to finish before the tree is terminated
+            delete _pipelineCompiler;
+            if (_vulkanInstance->GetLogicalDevice() != VK_NULL_HANDLE)
             {
-                invalidSwapChain = true;
+                vkDeviceWaitIdle(_vulkanInstance->GetLogicalDevice());
             }
-            if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR)
+            if (_headlessReadback != nullptr)
             {
-                _vulkanInstance->RecreateSwapChain();
-                return;
+                _headlessReadback->Flush();
+                delete _headlessReadback;
             }
-            
-            vkResetFences(_vulkanInstance->GetLogicalDevice(), 1, _readyToRenderFence->GetVkFencePtr());
-
-            _commandRecorder.RecordBuffer(
-                {0.05f, 0.05f, 0.15f, 1.0f},
-                imageIndex,
-                _mainRenderPass,
-                _renderers,
-                _mainRenderPass->GetVkImage(imageIndex)
-                );
-
-            _imGuiController->Renderrr(imageIndex, p_scene);
-
-            _commandRecorder.SubmitBuffer(_readyToRenderFence,
-                { _availableImageToRenderSemaphore },
-                { _finishRenderingSemaphore },
-                _imGuiController->GetCommandBuffer(imageIndex));
-
-            VkSwapchainKHR swapChains[] = { _vulkanInstance->GetSwapchain() };
-            VkSemaphore waitSemaphores[] = { _finishRenderingSemaphore->GetVkSemaphore() };
-            
-            VkPresentInfoKHR presentInfo { };
-            presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-            presentInfo.waitSemaphoreCount = 1;
-            presentInfo.pWaitSemaphores = waitSemaphores;
-            presentInfo.swapchainCount = 1;
-            presentInfo.pSwapchains = swapChains;
-            presentInfo.pImageIndices = &imageIndex;
-            presentInfo.pResults = nullptr;
-
-            VkResult presentResult = vkQueuePresentKHR(_mainGraphicsQueue->Queue, &presentInfo);
-            if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR || invalidSwapChain)
+            if (_pipelineRegistry != nullptr)
             {
-                _vulkanInstance->RecreateSwapChain();
+                _instancedRenderer.Release(*_pipelineRegistry);
+                delete _pipelineRegistry;
             }
-            else if (presentResult != VK_SUCCESS)
+            delete _shaderLibrary;
+            delete _bindlessTable;
+            delete _descriptorAllocator;
+            delete _transientImages;
+            if (_workloadUploadBuffer != nullptr)
             {
-                VULKAN_ERR("Failed to present swapchain with returned result {}", string_VkResult(presentResult));
+                _workloadUploadBuffer->Terminate();
             }
 
-            _imGuiController->PostRenderUpdate();
+            _quadMesh.Destroy();
+            delete _uploadQueue;
+            
+            if (_imGuiController != nullptr)
+            {
+                _imGuiController->Terminate();
+                delete _imGuiController;
+            }
+            
+            _commandRecorder.Terminate();
+            delete _threadPool;
+            _vulkanInstance->Terminate();
+            Vulkan::VulkanDebugger::Terminate();
         }
+        
+        void Tick(const Core::Scene::Scene& p_scene) override;
 
     private:
         bool InitializeVulkanInstance();
+        bool InitializeFramesInFlight();
+        // Returns false when the frame has to be skipped (swapchain was recreated)
+        bool AcquireSwapchainImage(const FrameInFlight& p_frame, uint32_t* p_outImageIndex, bool* p_outIsSwapChainInvalid);
+        void PresentSwapchainImage(const FrameInFlight& p_frame, uint32_t p_imageIndex, bool p_isSwapChainInvalid);
+        // Culling, scene and ImGui passes drawing to the acquired swapchain image, or culling, scene and readback
+        // passes when headless (image index is ignored)
+        bool BuildRenderGraph(uint32_t p_imageIndex);
         bool EnableGlfwExtensions();
         Core::Events::EventResult WindowChangedMinimizedHandler(const Core::Events::OnWindowChangeMinimized& p_event);
 
     private:
         Vulkan::VulkanInstance* _vulkanInstance = nullptr;
         MainRenderPass* _mainRenderPass = nullptr;
-        Vulkan::Fence* _readyToRenderFence = nullptr;
-        Vulkan::Semaphore* _availableImageToRenderSemaphore = nullptr; 
-        Vulkan::Semaphore* _finishRenderingSemaphore = nullptr;
+        Vulkan::QueryPool* _gpuQueryPool = nullptr;
+
+        const uint32_t _framesInFlightCount;
+        uint32_t _currentFrame = 0;
+        std::vector<FrameInFlight> _framesInFlight;
+        // Fence of the frame which last rendered to given swapchain image (nullptr if none yet),
+        // swapchain may return an image which is still used by a different frame in flight
+        std::vector<const Vulkan::Fence*> _imagesInFlight;
 
-        ImGuiController* _imGuiController;
+        // nullptr when headless, ImGui needs a GLFW window
+        ImGuiController* _imGuiController = nullptr;
+        // nullptr unless headless
+        HeadlessReadback* _headlessReadback = nullptr;
+        HeadlessSettings _headlessSettings;
 
+        RendererWorkload _workload;
         std::vector<TriangleRenderer> _renderers;
+        InstancedMeshRenderer _instancedRenderer;
+        // Drawn every frame together with scene elements
+        std::vector<glm::mat4> _gridInstances;
+        DrawList _drawList;
+        // Rebuilt every frame
+        RenderGraph _renderGraph;
+        // Images created by the render graph, kept per frame in flight while the graph does not change
+        TransientImageAllocator* _transientImages = nullptr;
+        // Of the graph being built, shown by the viewport window
+        RenderGraph::ResourceID _sceneColorResource = RenderGraph::INVALID_RESOURCE;
+        PipelineCompiler* _pipelineCompiler = nullptr;
+        PipelineRegistry* _pipelineRegistry = nullptr;
+        ShaderLibrary* _shaderLibrary = nullptr;
+        // nullptr when headless or when shader sources can not be watched
+        ShaderHotReload* _shaderHotReload = nullptr;
+        const Vulkan::GraphicsPipeline* _fallbackPipeline = nullptr;
+
+        // nullptr when device does not support descriptor indexing
+        BindlessTable* _bindlessTable = nullptr;
+        // Transient sets, valid until the frame they were allocated in finishes
+        DescriptorAllocator* _descriptorAllocator = nullptr;
+        UploadQueue* _uploadQueue = nullptr;
+        Mesh _quadMesh;
+        // Destination of the workload uploads, nullptr without them
+        Vulkan::Buffer* _workloadUploadBuffer = nullptr;
+        std::vector<uint8_t> _workloadUploadData;
+        uint64_t _failedWorkloadAllocations = 0;
  
         const Vulkan::VulkanInstance::QueueInstance* _mainGraphicsQueue = nullptr;
+        // Same as main graphics queue when device has no dedicated transfer family
+        const Vulkan::VulkanInstance::QueueInstance* _transferQueue = nullptr;
 
         RendererCommandRecorder _commandRecorder;
+        // Records scene draws into secondary command buffers and compiles pipelines
+        Core::Threading::ThreadPool* _threadPool = nullptr;
 
         bool _isWindowMinimized = false;
+        bool _isDepthPrePassEnabled = true;
 
         std::shared_ptr<Core::Events::EventListener<Core::Events::OnWindowChangeMinimized>> _wndChangeMinimizedListener;
     };
@@ -1,3 +1,8 @@
 "C:\VulkanSDK\1.3.239.0\Bin\glslc.exe" shader.vert -o vert.spv
 "C:\VulkanSDK\1.3.239.0\Bin\glslc.exe" shader.frag -o frag.spv
+"C:\VulkanSDK\1.3.239.0\Bin\glslc.exe" mesh.vert -o meshVert.spv
+"C:\VulkanSDK\1.3.239.0\Bin\glslc.exe" mesh.frag -o meshFrag.spv
+"C:\VulkanSDK\1.3.239.0\Bin\glslc.exe" meshInstanced.vert -o meshInstancedVert.spv
+"C:\VulkanSDK\1.3.239.0\Bin\glslc.exe" frustumCull.comp -o frustumCull.spv
+"..\..\..\..\Build\DeepShaderPacker.exe" Shaders.dsa vert.spv frag.spv vert1.spv frag1.spv meshVert.spv meshFrag.spv meshInstancedVert.spv frustumCull.spv
 pause
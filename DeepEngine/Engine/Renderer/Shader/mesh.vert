@@ -0,0 +1,16 @@
+#version 450
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+
+// Matches MeshPushConstants
+layout(push_constant) uniform ObjectConstants {
+    mat4 Model;
+} object;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    gl_Position = object.Model * vec4(inPosition, 1.0);
+    fragColor = inColor;
+}
@@ -0,0 +1,13 @@
+#version 450
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+// Per instance, takes locations 2-5
+layout(location = 2) in mat4 inTransform;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    gl_Position = inTransform * vec4(inPosition, 1.0);
+    fragColor = inColor;
+}
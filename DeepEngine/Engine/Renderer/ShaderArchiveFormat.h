@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+
+// Layout of shader archive (.dsa) shared between the engine (ShaderLibrary) and DeepShaderPacker.
+// Keep this header free of engine/Vulkan dependencies, packer includes it directly.
+//
+// File: FileHeader, EntriesCount Entries, then SPIR-V code of the entries. Code offsets are aligned to
+// CODE_ALIGNMENT and the archive is mapped at a page boundary, so code is passed to Vulkan straight from the mapping.
+
+namespace DeepEngine::Engine::Renderer::ShaderArchiveFormat
+{
+
+    constexpr uint32_t MAGIC = 0x41485344; // "DSHA"
+    constexpr uint32_t VERSION = 1;
+
+    constexpr uint32_t MAX_NAME_LENGTH = 64;
+    constexpr uint32_t CODE_ALIGNMENT = 16;
+
+    struct FileHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t EntriesCount;
+        uint32_t Reserved;
+    };
+
+    struct Entry
+    {
+        // File name of the .spv the code was packed from, null terminated
+        char Name[MAX_NAME_LENGTH];
+        // From the start of the file, in bytes
+        uint64_t CodeOffset;
+        uint64_t CodeSize;
+    };
+
+}
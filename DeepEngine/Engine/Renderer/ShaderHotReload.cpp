@@ -0,0 +1,190 @@
+#include "ShaderHotReload.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include <fmt/format.h>
+
+#ifdef __linux__
+#   include <poll.h>
+#   include <sys/inotify.h>
+#   include <unistd.h>
+#endif
+
+namespace DeepEngine::Engine::Renderer
+{
+    ShaderHotReload::~ShaderHotReload()
+    {
+        _isStopping.store(true, std::memory_order_relaxed);
+        if (_watchThread.joinable())
+        {
+            _watchThread.join();
+        }
+
+#ifdef __linux__
+        if (_inotifyDescriptor >= 0)
+        {
+            close(_inotifyDescriptor);
+        }
+#endif
+    }
+
+    bool ShaderHotReload::Start()
+    {
+#ifdef __linux__
+        _inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (_inotifyDescriptor < 0)
+        {
+            return false;
+        }
+
+        // Written in place or renamed over the old file
+        if (inotify_add_watch(_inotifyDescriptor, _shaderDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        {
+            return false;
+        }
+#else
+        std::error_code error;
+        if (!std::filesystem::is_directory(_shaderDirectory, error))
+        {
+            return false;
+        }
+
+        _lastWriteTimes.resize(_sources.size());
+        for (size_t i = 0; i < _sources.size(); i++)
+        {
+            _lastWriteTimes[i] = std::filesystem::last_write_time(
+                std::filesystem::path(_shaderDirectory) / _sources[i].Source, error);
+        }
+#endif
+
+        _watchThread = std::thread(&ShaderHotReload::WatchLoop, this);
+        VULKAN_INFO("Watching {} shader sources in \"{}\"", _sources.size(), _shaderDirectory);
+        return true;
+    }
+
+    std::vector<std::string> ShaderHotReload::TakeReloadedShaders()
+    {
+        std::lock_guard lock(_reloadedMutex);
+        return std::exchange(_reloadedShaders, { });
+    }
+
+    void ShaderHotReload::WatchLoop()
+    {
+        while (!_isStopping.load(std::memory_order_relaxed))
+        {
+            for (const std::string& changedFile : WaitForChanges())
+            {
+                for (const ShaderSourceFile& source : _sources)
+                {
+                    if (source.Source == changedFile)
+                    {
+                        Recompile(source);
+                    }
+                }
+            }
+        }
+    }
+
+#ifdef __linux__
+    std::vector<std::string> ShaderHotReload::WaitForChanges()
+    {
+        std::vector<std::string> changedFiles;
+        const auto readEvents = [this, &changedFiles]
+        {
+            alignas(inotify_event) char buffer[4096];
+            ssize_t length;
+            while ((length = read(_inotifyDescriptor, buffer, sizeof(buffer))) > 0)
+            {
+                for (ssize_t offset = 0; offset < length; )
+                {
+                    const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                    if (event->len > 0
+                        && std::find(changedFiles.begin(), changedFiles.end(), event->name) == changedFiles.end())
+                    {
+                        changedFiles.emplace_back(event->name);
+                    }
+                    offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                }
+            }
+        };
+
+        pollfd descriptor { _inotifyDescriptor, POLLIN, 0 };
+        if (poll(&descriptor, 1, static_cast<int>(POLL_INTERVAL.count())) <= 0)
+        {
+            return changedFiles;
+        }
+
+        readEvents();
+        std::this_thread::sleep_for(SETTLE_TIME);
+        readEvents();
+        return changedFiles;
+    }
+#else
+    std::vector<std::string> ShaderHotReload::WaitForChanges()
+    {
+        std::this_thread::sleep_for(POLL_INTERVAL);
+
+        std::vector<std::string> changedFiles;
+        for (size_t i = 0; i < _sources.size(); i++)
+        {
+            std::error_code error;
+            const auto writeTime = std::filesystem::last_write_time(
+                std::filesystem::path(_shaderDirectory) / _sources[i].Source, error);
+            if (!error && writeTime != _lastWriteTimes[i])
+            {
+                _lastWriteTimes[i] = writeTime;
+                changedFiles.push_back(_sources[i].Source);
+            }
+        }
+
+        if (!changedFiles.empty())
+        {
+            std::this_thread::sleep_for(SETTLE_TIME);
+        }
+        return changedFiles;
+    }
+#endif
+
+    void ShaderHotReload::Recompile(const ShaderSourceFile& p_source)
+    {
+        const std::filesystem::path directory(_shaderDirectory);
+        const std::string sourcePath = (directory / p_source.Source).string();
+        const std::string compiledPath = (directory / p_source.Compiled).string();
+        // Old .spv stays untouched when compilation fails
+        const std::string temporaryPath = compiledPath + ".tmp";
+
+        const char* compiler = std::getenv("DEEP_GLSLC");
+        std::string command = fmt::format("\"{}\" \"{}\" -o \"{}\"", compiler != nullptr ? compiler : "glslc",
+            sourcePath, temporaryPath);
+#ifdef _WIN32
+        // cmd strips the first and the last quote of the whole command
+        command = "\"" + command + "\"";
+#endif
+
+        VULKAN_INFO("Recompiling shader \"{}\"", p_source.Source);
+        std::error_code error;
+        if (std::system(command.c_str()) != 0)
+        {
+            VULKAN_ERR("Failed to compile shader \"{}\", keeping the previous version", p_source.Source);
+            std::filesystem::remove(temporaryPath, error);
+            return;
+        }
+
+        std::filesystem::rename(temporaryPath, compiledPath, error);
+        if (error)
+        {
+            VULKAN_ERR("Failed to replace \"{}\": {}", compiledPath, error.message());
+            return;
+        }
+
+        if (!_shaderLibrary->Reload(p_source.Compiled, compiledPath))
+        {
+            VULKAN_ERR("Failed to reload shader \"{}\", keeping the previous version", p_source.Compiled);
+            return;
+        }
+
+        std::lock_guard lock(_reloadedMutex);
+        _reloadedShaders.push_back(p_source.Compiled);
+    }
+}
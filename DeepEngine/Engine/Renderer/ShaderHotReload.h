@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+#include "ShaderLibrary.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+
+    // GLSL source of a shader and the .spv it is compiled into, both in the shader directory
+    struct ShaderSourceFile
+    {
+        std::string Source;
+        std::string Compiled;
+    };
+
+    // Watches GLSL sources in the shader directory and recompiles changed ones with glslc (path from DEEP_GLSLC
+    // environment variable, glslc from PATH by default). Compilation runs on the watcher's own thread, so neither
+    // the render thread nor the thread pool recording frames waits for the compiler. Recompiled module replaces
+    // the old one in the ShaderLibrary and its name is queued, renderer takes the queue at a frame boundary and
+    // rebuilds pipelines using it (see PipelineRegistry::RebuildWithShader).
+    // Changes are reported by inotify on Linux, other platforms poll modification times.
+    class ShaderHotReload
+    {
+    public:
+        ShaderHotReload(ShaderLibrary* p_shaderLibrary, std::string p_shaderDirectory,
+            std::vector<ShaderSourceFile> p_sources)
+            : _shaderLibrary(p_shaderLibrary), _shaderDirectory(std::move(p_shaderDirectory)),
+            _sources(std::move(p_sources))
+        { }
+        ~ShaderHotReload();
+
+        ShaderHotReload(const ShaderHotReload&) = delete;
+        ShaderHotReload& operator=(const ShaderHotReload&) = delete;
+
+        // Fails when the directory can not be watched, shaders keep working without reloading then
+        bool Start();
+
+        // Names (in the ShaderLibrary) of shaders reloaded since the last call
+        std::vector<std::string> TakeReloadedShaders();
+
+    private:
+        void WatchLoop();
+        // Blocks for at most POLL_INTERVAL, returns file names of changed sources
+        std::vector<std::string> WaitForChanges();
+        void Recompile(const ShaderSourceFile& p_source);
+
+    private:
+        static constexpr std::chrono::milliseconds POLL_INTERVAL { 250 };
+        // Editors save in several steps (write, rename), changes are collected until the burst ends
+        static constexpr std::chrono::milliseconds SETTLE_TIME { 100 };
+
+        ShaderLibrary* _shaderLibrary;
+        const std::string _shaderDirectory;
+        const std::vector<ShaderSourceFile> _sources;
+
+        std::thread _watchThread;
+        std::atomic<bool> _isStopping = false;
+
+        std::mutex _reloadedMutex;
+        std::vector<std::string> _reloadedShaders;
+
+#ifdef __linux__
+        int _inotifyDescriptor = -1;
+#else
+        std::vector<std::filesystem::file_time_type> _lastWriteTimes;
+#endif
+    };
+
+}
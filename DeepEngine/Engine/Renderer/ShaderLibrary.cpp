@@ -0,0 +1,245 @@
+#include "ShaderLibrary.h"
+
+#include <cstring>
+#include <filesystem>
+
+#include "ShaderArchiveFormat.h"
+#include "Debug/Timing.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+    namespace
+    {
+        constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+        constexpr uint32_t SPIRV_HEADER_WORDS = 5;
+        constexpr uint32_t SPIRV_OP_ENTRY_POINT = 15;
+
+        // Execution model of the first OpEntryPoint, entry points come before any function in a module
+        bool ReadShaderStage(std::span<const uint32_t> p_code, VkShaderStageFlagBits& p_stage)
+        {
+            if (p_code.size() < SPIRV_HEADER_WORDS || p_code[0] != SPIRV_MAGIC)
+            {
+                return false;
+            }
+
+            size_t word = SPIRV_HEADER_WORDS;
+            while (word < p_code.size())
+            {
+                const uint32_t opcode = p_code[word] & 0xFFFF;
+                const uint32_t wordsCount = p_code[word] >> 16;
+                if (wordsCount == 0 || word + wordsCount > p_code.size())
+                {
+                    return false;
+                }
+
+                if (opcode == SPIRV_OP_ENTRY_POINT && wordsCount > 1)
+                {
+                    switch (p_code[word + 1])
+                    {
+                    case 0: p_stage = VK_SHADER_STAGE_VERTEX_BIT; return true;
+                    case 1: p_stage = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT; return true;
+                    case 2: p_stage = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT; return true;
+                    case 3: p_stage = VK_SHADER_STAGE_GEOMETRY_BIT; return true;
+                    case 4: p_stage = VK_SHADER_STAGE_FRAGMENT_BIT; return true;
+                    case 5: p_stage = VK_SHADER_STAGE_COMPUTE_BIT; return true;
+                    default: return false;
+                    }
+                }
+
+                word += wordsCount;
+            }
+            return false;
+        }
+
+        bool IsCodeAligned(const uint8_t* p_data, size_t p_size)
+        {
+            return reinterpret_cast<uintptr_t>(p_data) % alignof(uint32_t) == 0 && p_size % sizeof(uint32_t) == 0;
+        }
+    }
+
+    ShaderLibrary::~ShaderLibrary()
+    {
+        for (auto& [name, module] : _modules)
+        {
+            module->Terminate();
+        }
+        ReleaseRetiredModules();
+    }
+
+    bool ShaderLibrary::Load(const std::string& p_archivePath, const std::string& p_fallbackDirectory)
+    {
+        TIMER("Load shader library");
+
+        // Code in the archive points into the mapping, it has to stay mapped until modules are created
+        Core::IO::MappedFile archive;
+        std::vector<ShaderSource> sources;
+        if (archive.Open(p_archivePath))
+        {
+            if (!CollectArchiveShaders(archive, sources))
+            {
+                return false;
+            }
+            VULKAN_INFO("Loading {} shaders from archive \"{}\"", sources.size(), p_archivePath);
+        }
+        else
+        {
+            CollectDirectoryShaders(p_fallbackDirectory, sources);
+            VULKAN_INFO("There is no shader archive \"{}\", loading {} shaders from \"{}\"", p_archivePath,
+                sources.size(), p_fallbackDirectory);
+        }
+
+        if (sources.empty())
+        {
+            VULKAN_ERR("Found no shaders to load");
+            return false;
+        }
+
+        std::vector<Vulkan::ShaderModule*> modules(sources.size(), nullptr);
+        _threadPool->ParallelFor(static_cast<uint32_t>(sources.size()), 1,
+            [this, &sources, &modules](uint32_t p_begin, uint32_t p_end, uint32_t)
+            {
+                for (uint32_t i = p_begin; i < p_end; i++)
+                {
+                    modules[i] = CreateModule(sources[i]);
+                }
+            });
+
+        bool isLoaded = true;
+        for (size_t i = 0; i < sources.size(); i++)
+        {
+            if (modules[i] == nullptr)
+            {
+                isLoaded = false;
+                continue;
+            }
+            _modules.emplace(sources[i].Name, modules[i]);
+        }
+        return isLoaded;
+    }
+
+    const Vulkan::ShaderModule* ShaderLibrary::Get(const std::string& p_name) const
+    {
+        std::shared_lock lock(_modulesMutex);
+        auto it = _modules.find(p_name);
+        return it != _modules.end() ? it->second : nullptr;
+    }
+
+    bool ShaderLibrary::Reload(const std::string& p_name, const std::string& p_filepath)
+    {
+        Vulkan::ShaderModule* module = CreateModule({ p_name, p_filepath, { } });
+        if (module == nullptr)
+        {
+            return false;
+        }
+
+        std::lock_guard lock(_modulesMutex);
+        Vulkan::ShaderModule*& currentModule = _modules[p_name];
+        if (currentModule != nullptr)
+        {
+            _retiredModules.push_back(currentModule);
+        }
+        currentModule = module;
+        return true;
+    }
+
+    void ShaderLibrary::ReleaseRetiredModules()
+    {
+        std::lock_guard lock(_modulesMutex);
+        for (Vulkan::ShaderModule* module : _retiredModules)
+        {
+            module->Terminate();
+        }
+        _retiredModules.clear();
+    }
+
+    bool ShaderLibrary::CollectArchiveShaders(const Core::IO::MappedFile& p_archive,
+        std::vector<ShaderSource>& p_sources)
+    {
+        using namespace ShaderArchiveFormat;
+
+        if (p_archive.GetSize() < sizeof(FileHeader))
+        {
+            VULKAN_ERR("Shader archive is too small to contain its header");
+            return false;
+        }
+
+        FileHeader header;
+        std::memcpy(&header, p_archive.GetData(), sizeof(FileHeader));
+        if (header.Magic != MAGIC || header.Version != VERSION)
+        {
+            VULKAN_ERR("Shader archive has unknown format (magic {:#x}, version {})", header.Magic, header.Version);
+            return false;
+        }
+
+        const size_t entriesEnd = sizeof(FileHeader) + static_cast<size_t>(header.EntriesCount) * sizeof(Entry);
+        if (entriesEnd > p_archive.GetSize())
+        {
+            VULKAN_ERR("Shader archive is truncated, it can not contain {} entries", header.EntriesCount);
+            return false;
+        }
+
+        p_sources.reserve(header.EntriesCount);
+        for (uint32_t i = 0; i < header.EntriesCount; i++)
+        {
+            Entry entry;
+            std::memcpy(&entry, p_archive.GetData() + sizeof(FileHeader) + i * sizeof(Entry), sizeof(Entry));
+            entry.Name[MAX_NAME_LENGTH - 1] = '\0';
+
+            if (entry.CodeOffset < entriesEnd || entry.CodeOffset > p_archive.GetSize()
+                || entry.CodeSize > p_archive.GetSize() - entry.CodeOffset
+                || !IsCodeAligned(p_archive.GetData() + entry.CodeOffset, entry.CodeSize))
+            {
+                VULKAN_ERR("Shader \"{}\" has invalid code range in the archive", entry.Name);
+                return false;
+            }
+
+            const uint8_t* code = p_archive.GetData() + entry.CodeOffset;
+            p_sources.push_back({ entry.Name, { },
+                { reinterpret_cast<const uint32_t*>(code), entry.CodeSize / sizeof(uint32_t) } });
+        }
+        return true;
+    }
+
+    void ShaderLibrary::CollectDirectoryShaders(const std::string& p_directory, std::vector<ShaderSource>& p_sources)
+    {
+        std::error_code error;
+        for (const auto& file : std::filesystem::directory_iterator(p_directory, error))
+        {
+            if (file.is_regular_file() && file.path().extension() == ".spv")
+            {
+                p_sources.push_back({ file.path().filename().string(), file.path().string(), { } });
+            }
+        }
+    }
+
+    Vulkan::ShaderModule* ShaderLibrary::CreateModule(const ShaderSource& p_source) const
+    {
+        // Each loose file is mapped by the worker creating its module
+        Core::IO::MappedFile file;
+        std::span<const uint32_t> code = p_source.Code;
+        if (!p_source.Filepath.empty())
+        {
+            if (!file.Open(p_source.Filepath) || !IsCodeAligned(file.GetData(), file.GetSize()))
+            {
+                VULKAN_ERR("Failed to map shader file \"{}\"", p_source.Filepath);
+                return nullptr;
+            }
+            code = { reinterpret_cast<const uint32_t*>(file.GetData()), file.GetSize() / sizeof(uint32_t) };
+        }
+
+        VkShaderStageFlagBits stage;
+        if (!ReadShaderStage(code, stage))
+        {
+            VULKAN_ERR("Shader \"{}\" is not a valid SPIR-V module with an entry point", p_source.Name);
+            return nullptr;
+        }
+
+        auto module = new Vulkan::ShaderModule(p_source.Name, code, stage);
+        if (!_vulkanInstance->InitializeSubController(module))
+        {
+            module->Terminate();
+            return nullptr;
+        }
+        return module;
+    }
+}
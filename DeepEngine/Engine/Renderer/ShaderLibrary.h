@@ -0,0 +1,72 @@
+#pragma once
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "Core/IO/MappedFile.h"
+#include "Core/Threading/ThreadPool.h"
+#include "Vulkan/ShaderModule.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+
+    // Shader modules of the renderer, looked up by the file name of their .spv (e.g. "vert.spv").
+    // Shaders are read from one archive packed by DeepShaderPacker (see ShaderArchiveFormat.h): startup opens and
+    // maps a single file and passes the code to Vulkan straight from the mapping. When there is no archive, every
+    // .spv of the fallback directory is mapped instead. Modules of all shaders are created concurrently on the
+    // thread pool, stage of every module is read from the entry point of its SPIR-V.
+    // Modules live as long as the library, Get may be called from any thread. Module replaced by Reload is kept
+    // until ReleaseRetiredModules, pipeline compilations which got it before the reload may still use it.
+    class ShaderLibrary
+    {
+    public:
+        ShaderLibrary(Vulkan::VulkanInstance* p_vulkanInstance, Core::Threading::ThreadPool* p_threadPool)
+            : _vulkanInstance(p_vulkanInstance), _threadPool(p_threadPool)
+        { }
+        ~ShaderLibrary();
+
+        ShaderLibrary(const ShaderLibrary&) = delete;
+        ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+        // Blocks until every module is created, fails when any of them fails
+        bool Load(const std::string& p_archivePath, const std::string& p_fallbackDirectory);
+
+        // nullptr when there is no such shader
+        const Vulkan::ShaderModule* Get(const std::string& p_name) const;
+
+        // Creates module from the recompiled .spv and swaps it in, previous module is retired.
+        // May be called from any thread, on failure the previous module stays
+        bool Reload(const std::string& p_name, const std::string& p_filepath);
+
+        // No pipeline compilation may be running (nor start before this returns)
+        void ReleaseRetiredModules();
+
+        uint32_t GetShadersCount() const
+        {
+            std::shared_lock lock(_modulesMutex);
+            return static_cast<uint32_t>(_modules.size());
+        }
+
+    private:
+        struct ShaderSource
+        {
+            std::string Name;
+            // Empty when the code is in the archive
+            std::string Filepath;
+            std::span<const uint32_t> Code;
+        };
+
+        static bool CollectArchiveShaders(const Core::IO::MappedFile& p_archive, std::vector<ShaderSource>& p_sources);
+        static void CollectDirectoryShaders(const std::string& p_directory, std::vector<ShaderSource>& p_sources);
+        // Called from the thread pool, nullptr on failure
+        Vulkan::ShaderModule* CreateModule(const ShaderSource& p_source) const;
+
+    private:
+        Vulkan::VulkanInstance* _vulkanInstance;
+        Core::Threading::ThreadPool* _threadPool;
+
+        mutable std::shared_mutex _modulesMutex;
+        std::unordered_map<std::string, Vulkan::ShaderModule*> _modules;
+        std::vector<Vulkan::ShaderModule*> _retiredModules;
+    };
+
+}
@@ -0,0 +1,334 @@
+#include "TransientImageAllocator.h"
+
+#include <algorithm>
+
+namespace DeepEngine::Engine::Renderer
+{
+    namespace
+    {
+        constexpr VkImageUsageFlags ATTACHMENT_USAGE_MASK = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
+            | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT
+            | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+
+        // Never read outside of render passes, so their content does not have to leave the tile memory
+        bool IsAttachmentOnly(VkImageUsageFlags p_usage)
+        {
+            return (p_usage & ~ATTACHMENT_USAGE_MASK) == 0;
+        }
+
+        VkDeviceSize AlignUp(VkDeviceSize p_value, VkDeviceSize p_alignment)
+        {
+            return (p_value + p_alignment - 1) / p_alignment * p_alignment;
+        }
+    }
+
+    TransientImageAllocator::TransientImageAllocator(Vulkan::VulkanInstance* p_vulkanInstance,
+        uint32_t p_framesInFlight) : _vulkanInstance(p_vulkanInstance), _frames(p_framesInFlight)
+    { }
+
+    TransientImageAllocator::~TransientImageAllocator()
+    {
+        for (FrameImages& frame : _frames)
+        {
+            DestroyImages(frame);
+        }
+    }
+
+    void TransientImageAllocator::BeginFrame(uint32_t p_frameIndex)
+    {
+        _frameIndex = p_frameIndex;
+    }
+
+    bool TransientImageAllocator::Acquire(const std::vector<Request>& p_requests,
+        std::vector<AcquiredImage>& p_outImages)
+    {
+        FrameImages& frame = _frames[_frameIndex];
+
+        if (frame.Requests != p_requests || frame.Images.size() != p_requests.size())
+        {
+            DestroyImages(frame);
+            frame.Requests = p_requests;
+
+            if (!CreateImages(frame) || !BindAliasedImages(frame))
+            {
+                DestroyImages(frame);
+                return false;
+            }
+        }
+
+        p_outImages.resize(frame.Images.size());
+        for (uint32_t i = 0; i < frame.Images.size(); i++)
+        {
+            p_outImages[i] = frame.Images[i].Acquired;
+        }
+        return true;
+    }
+
+    VkFramebuffer TransientImageAllocator::GetFramebuffer(VkRenderPass p_renderPass,
+        const std::vector<VkImageView>& p_attachments, uint32_t p_width, uint32_t p_height)
+    {
+        FrameImages& frame = _frames[_frameIndex];
+        for (const Framebuffer& framebuffer : frame.Framebuffers)
+        {
+            if (framebuffer.RenderPass == p_renderPass && framebuffer.Attachments == p_attachments)
+            {
+                return framebuffer.Handle;
+            }
+        }
+
+        VkFramebufferCreateInfo createInfo { };
+        createInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        createInfo.renderPass = p_renderPass;
+        createInfo.attachmentCount = static_cast<uint32_t>(p_attachments.size());
+        createInfo.pAttachments = p_attachments.data();
+        createInfo.width = p_width;
+        createInfo.height = p_height;
+        createInfo.layers = 1;
+
+        VkFramebuffer handle;
+        const VkResult result = vkCreateFramebuffer(_vulkanInstance->GetLogicalDevice(), &createInfo, nullptr,
+            &handle);
+        if (result != VK_SUCCESS)
+        {
+            VULKAN_ERR("Failed to create transient framebuffer with returned result {}", string_VkResult(result));
+            return VK_NULL_HANDLE;
+        }
+
+        frame.Framebuffers.push_back({ p_renderPass, p_attachments, handle });
+        return handle;
+    }
+
+    bool TransientImageAllocator::CreateImages(FrameImages& p_frame)
+    {
+        const VkDevice device = _vulkanInstance->GetLogicalDevice();
+        Vulkan::DeviceMemoryAllocator* memoryAllocator = _vulkanInstance->GetMemoryAllocator();
+
+        p_frame.Images.resize(p_frame.Requests.size());
+        for (uint32_t i = 0; i < p_frame.Requests.size(); i++)
+        {
+            const RenderGraphImageDescription& description = p_frame.Requests[i].Description;
+            AllocatedImage& image = p_frame.Images[i];
+            image = { };
+
+            VkImageCreateInfo imageInfo { };
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.extent.width = description.Width;
+            imageInfo.extent.height = description.Height;
+            imageInfo.extent.depth = 1;
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.format = description.Format;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageInfo.usage = description.Usage;
+            if (IsAttachmentOnly(description.Usage))
+            {
+                imageInfo.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+            }
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            VkResult result = vkCreateImage(device, &imageInfo, nullptr, &image.Acquired.Image);
+            if (result != VK_SUCCESS)
+            {
+                VULKAN_ERR("Failed to create transient image with returned result {}", string_VkResult(result));
+                return false;
+            }
+
+            vkGetImageMemoryRequirements(device, image.Acquired.Image, &image.Requirements);
+
+            if (!IsAttachmentOnly(description.Usage)
+                || !memoryAllocator->HasLazilyAllocatedMemory(image.Requirements.memoryTypeBits))
+            {
+                continue;
+            }
+
+            if (!memoryAllocator->AllocateForImage(image.Acquired.Image, Vulkan::MemoryUsage::GPU_LAZILY_ALLOCATED,
+                &image.Allocation))
+            {
+                return false;
+            }
+            p_frame.Statistics.LazilyAllocatedImages++;
+        }
+
+        return true;
+    }
+
+    bool TransientImageAllocator::BindAliasedImages(FrameImages& p_frame)
+    {
+        struct Slot
+        {
+            VkDeviceSize Offset = 0;
+            VkDeviceSize Size = 0;
+            VkDeviceSize Alignment = 1;
+            uint32_t LastPass = 0;
+            uint32_t LastImage = NO_IMAGE;
+        };
+
+        std::vector<uint32_t> order;
+        for (uint32_t i = 0; i < p_frame.Images.size(); i++)
+        {
+            if (!p_frame.Images[i].Allocation.IsValid())
+            {
+                order.push_back(i);
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [&p_frame](uint32_t p_left, uint32_t p_right)
+        {
+            return p_frame.Requests[p_left].FirstPass < p_frame.Requests[p_right].FirstPass;
+        });
+
+        // Image goes into the free slot it fits best, smallest one big enough or else the biggest one
+        std::vector<Slot> slots;
+        std::vector<uint32_t> imageSlots(p_frame.Images.size(), NO_IMAGE);
+        uint32_t memoryTypeBits = UINT32_MAX;
+        VkDeviceSize requestedBytes = 0;
+
+        for (const uint32_t imageIndex : order)
+        {
+            const Request& request = p_frame.Requests[imageIndex];
+            const VkMemoryRequirements& requirements = p_frame.Images[imageIndex].Requirements;
+
+            uint32_t bestSlot = NO_IMAGE;
+            for (uint32_t i = 0; i < slots.size(); i++)
+            {
+                if (slots[i].LastPass >= request.FirstPass)
+                {
+                    continue;
+                }
+
+                if (bestSlot == NO_IMAGE)
+                {
+                    bestSlot = i;
+                    continue;
+                }
+
+                const bool fits = slots[i].Size >= requirements.size;
+                const bool bestFits = slots[bestSlot].Size >= requirements.size;
+                if ((fits && (!bestFits || slots[i].Size < slots[bestSlot].Size))
+                    || (!fits && !bestFits && slots[i].Size > slots[bestSlot].Size))
+                {
+                    bestSlot = i;
+                }
+            }
+
+            if (bestSlot == NO_IMAGE)
+            {
+                bestSlot = static_cast<uint32_t>(slots.size());
+                slots.emplace_back();
+            }
+
+            Slot& slot = slots[bestSlot];
+            p_frame.Images[imageIndex].Acquired.AliasedAfter = slot.LastImage;
+            slot.Size = std::max(slot.Size, requirements.size);
+            slot.Alignment = std::max(slot.Alignment, requirements.alignment);
+            slot.LastPass = request.LastPass;
+            slot.LastImage = imageIndex;
+
+            imageSlots[imageIndex] = bestSlot;
+            memoryTypeBits &= requirements.memoryTypeBits;
+            requestedBytes += requirements.size;
+        }
+
+        VkMemoryRequirements frameRequirements { };
+        frameRequirements.alignment = 1;
+        frameRequirements.memoryTypeBits = memoryTypeBits;
+        for (Slot& slot : slots)
+        {
+            slot.Offset = AlignUp(frameRequirements.size, slot.Alignment);
+            frameRequirements.size = slot.Offset + slot.Size;
+            frameRequirements.alignment = std::max(frameRequirements.alignment, slot.Alignment);
+        }
+
+        Vulkan::DeviceMemoryAllocator* memoryAllocator = _vulkanInstance->GetMemoryAllocator();
+        if (!slots.empty())
+        {
+            if (memoryTypeBits == 0)
+            {
+                VULKAN_ERR("Transient images have no memory type in common, they can not be aliased");
+                return false;
+            }
+
+            if (!memoryAllocator->AllocateForImages(frameRequirements, Vulkan::MemoryUsage::GPU_ONLY,
+                &p_frame.Allocation))
+            {
+                return false;
+            }
+        }
+
+        const VkDevice device = _vulkanInstance->GetLogicalDevice();
+        for (uint32_t i = 0; i < p_frame.Images.size(); i++)
+        {
+            AllocatedImage& image = p_frame.Images[i];
+
+            if (imageSlots[i] != NO_IMAGE)
+            {
+                const VkResult result = vkBindImageMemory(device, image.Acquired.Image, p_frame.Allocation.Memory,
+                    p_frame.Allocation.Offset + slots[imageSlots[i]].Offset);
+                if (result != VK_SUCCESS)
+                {
+                    VULKAN_ERR("Failed to bind transient image memory with returned result {}",
+                        string_VkResult(result));
+                    return false;
+                }
+            }
+
+            const RenderGraphImageDescription& description = p_frame.Requests[i].Description;
+
+            VkImageViewCreateInfo viewInfo { };
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = image.Acquired.Image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = description.Format;
+            viewInfo.subresourceRange.aspectMask = description.Aspect;
+            viewInfo.subresourceRange.baseMipLevel = 0;
+            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.baseArrayLayer = 0;
+            viewInfo.subresourceRange.layerCount = 1;
+
+            const VkResult result = vkCreateImageView(device, &viewInfo, nullptr, &image.Acquired.View);
+            if (result != VK_SUCCESS)
+            {
+                VULKAN_ERR("Failed to create transient image view with returned result {}", string_VkResult(result));
+                return false;
+            }
+        }
+
+        p_frame.Statistics.Images = static_cast<uint32_t>(p_frame.Images.size());
+        p_frame.Statistics.RequestedBytes = requestedBytes;
+        p_frame.Statistics.AllocatedBytes = frameRequirements.size;
+        return true;
+    }
+
+    void TransientImageAllocator::DestroyImages(FrameImages& p_frame) const
+    {
+        const VkDevice device = _vulkanInstance->GetLogicalDevice();
+        Vulkan::DeviceMemoryAllocator* memoryAllocator = _vulkanInstance->GetMemoryAllocator();
+
+        for (const Framebuffer& framebuffer : p_frame.Framebuffers)
+        {
+            vkDestroyFramebuffer(device, framebuffer.Handle, nullptr);
+        }
+
+        for (AllocatedImage& image : p_frame.Images)
+        {
+            if (image.Acquired.View != VK_NULL_HANDLE)
+            {
+                vkDestroyImageView(device, image.Acquired.View, nullptr);
+            }
+            if (image.Acquired.Image != VK_NULL_HANDLE)
+            {
+                vkDestroyImage(device, image.Acquired.Image, nullptr);
+            }
+            memoryAllocator->Free(image.Allocation);
+        }
+        memoryAllocator->Free(p_frame.Allocation);
+
+        p_frame.Requests.clear();
+        p_frame.Images.clear();
+        p_frame.Framebuffers.clear();
+        p_frame.Statistics = { };
+    }
+
+}
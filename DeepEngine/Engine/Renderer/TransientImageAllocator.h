@@ -0,0 +1,116 @@
+#pragma once
+#include "Vulkan/Instance/VulkanInstance.h"
+#include "Vulkan/Memory/DeviceMemoryAllocator.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+
+    struct RenderGraphImageDescription
+    {
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        VkFormat Format = VK_FORMAT_UNDEFINED;
+        VkImageUsageFlags Usage = 0;
+        VkImageAspectFlags Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+
+        bool operator==(const RenderGraphImageDescription& p_other) const = default;
+    };
+
+    struct TransientImageStatistics
+    {
+        uint32_t Images = 0;
+        // Part of Images, attachment only images in lazily allocated memory
+        uint32_t LazilyAllocatedImages = 0;
+        // Sum of sizes of the other images, what they would take with memory of their own
+        VkDeviceSize RequestedBytes = 0;
+        // Memory they share
+        VkDeviceSize AllocatedBytes = 0;
+    };
+
+    // Images which live only within one frame of the render graph. Every frame in flight has its own images,
+    // they are recreated only when the frame requests different ones than the last time, so with a stable graph
+    // nothing is created after the first frames.
+    // Images whose lifetimes (first and last pass using them) do not overlap share device memory: each is put
+    // into a slot of the frame allocation freed by an image which is no longer used, its first use then has to
+    // wait for the last use of the previous image in the slot. Attachment only images get
+    // VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT and lazily allocated memory when the device has it (tilers keep
+    // them in tile memory), those are never aliased.
+    class TransientImageAllocator
+    {
+    public:
+        struct Request
+        {
+            RenderGraphImageDescription Description;
+            uint32_t FirstPass;
+            uint32_t LastPass;
+
+            bool operator==(const Request& p_other) const = default;
+        };
+
+        static constexpr uint32_t NO_IMAGE = UINT32_MAX;
+
+        struct AcquiredImage
+        {
+            VkImage Image = VK_NULL_HANDLE;
+            VkImageView View = VK_NULL_HANDLE;
+            // Index of the request which used the memory before, NO_IMAGE if none
+            uint32_t AliasedAfter = NO_IMAGE;
+        };
+
+        TransientImageAllocator(Vulkan::VulkanInstance* p_vulkanInstance, uint32_t p_framesInFlight);
+        ~TransientImageAllocator();
+
+        TransientImageAllocator(const TransientImageAllocator&) = delete;
+        TransientImageAllocator& operator=(const TransientImageAllocator&) = delete;
+
+        // Frame fence has to be waited, images of the frame may be recreated
+        void BeginFrame(uint32_t p_frameIndex);
+
+        // One image per request, valid until the next Acquire in the same frame
+        bool Acquire(const std::vector<Request>& p_requests, std::vector<AcquiredImage>& p_outImages);
+
+        // Cached until images of the frame are recreated, all views have to come from the last Acquire
+        VkFramebuffer GetFramebuffer(VkRenderPass p_renderPass, const std::vector<VkImageView>& p_attachments,
+            uint32_t p_width, uint32_t p_height);
+
+        // Of the current frame
+        const TransientImageStatistics& GetStatistics() const
+        { return _frames[_frameIndex].Statistics; }
+
+    private:
+        struct AllocatedImage
+        {
+            AcquiredImage Acquired;
+            // Valid only for lazily allocated images, the others are bound into the frame allocation
+            Vulkan::DeviceAllocation Allocation;
+            VkMemoryRequirements Requirements;
+        };
+
+        struct Framebuffer
+        {
+            VkRenderPass RenderPass;
+            std::vector<VkImageView> Attachments;
+            VkFramebuffer Handle;
+        };
+
+        struct FrameImages
+        {
+            std::vector<Request> Requests;
+            std::vector<AllocatedImage> Images;
+            Vulkan::DeviceAllocation Allocation;
+            std::vector<Framebuffer> Framebuffers;
+            TransientImageStatistics Statistics;
+        };
+
+        bool CreateImages(FrameImages& p_frame);
+        // Assigns images which are not lazily allocated to slots and binds them, creates views of all images
+        bool BindAliasedImages(FrameImages& p_frame);
+        void DestroyImages(FrameImages& p_frame) const;
+
+    private:
+        Vulkan::VulkanInstance* _vulkanInstance;
+        std::vector<FrameImages> _frames;
+        uint32_t _frameIndex = 0;
+    };
+
+}
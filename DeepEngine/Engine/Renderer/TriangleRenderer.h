@@ -1,4 +1,7 @@
 #pragma once
+#include "DrawList.h"
+#include "Mesh.h"
+#include "PipelineRegistry.h"
 #include "Vulkan/ShaderModule.h"
 #include "Vulkan/GraphicsPipeline.h"
 
@@ -9,36 +12,82 @@ namespace DeepEngine::Engine::Renderer
     {
     public:
         TriangleRenderer() = default;
-        
-        bool Init(const char* p_vertexShaderPath, const char* p_fragmentShaderPath,
-                const Vulkan::PipelineDynamicState& p_dynamicState, const Vulkan::PipelineColorBlend& p_colorBlend,
-                const Vulkan::PipelineColorBlendAttachment& p_colorBlendAttachment,
-                const Vulkan::PipelineRasterization& p_pipelineRasterization,
-                Vulkan::PipelineLayout* p_pipelineLayout )
+
+        // Pipeline is compiled in background, until then renderer draws with the fallback pipeline. With depth
+        // layout given, depth only variant of the pipeline is compiled as well for the depth pre-pass
+        bool Init(PipelineRegistry& p_pipelineRegistry, const GraphicsPipelineDescription& p_pipelineDescription,
+                const Vulkan::GraphicsPipeline* p_fallbackPipeline, Vulkan::PipelineLayout* p_depthPrePassLayout = nullptr)
         {
-            auto vertShader = new Vulkan::ShaderModule(p_vertexShaderPath, VK_SHADER_STAGE_VERTEX_BIT);
-            if (!p_pipelineLayout->InitializeSubController(vertShader))
+            _fallbackPipeline = p_fallbackPipeline;
+            _graphicsPipeline = p_fallbackPipeline;
+            _pipelineHandle = p_pipelineRegistry.Acquire(p_pipelineDescription);
+            _acquiredHandle = _pipelineHandle;
+
+            if (p_depthPrePassLayout != nullptr)
             {
-                return false;
+                _depthPipelineHandle = p_pipelineRegistry.Acquire(p_pipelineDescription.GetDepthOnly(p_depthPrePassLayout));
+                _acquiredDepthHandle = _depthPipelineHandle;
             }
+            return true;
+        }
 
-            auto fragShader = new Vulkan::ShaderModule(p_fragmentShaderPath, VK_SHADER_STAGE_FRAGMENT_BIT);
-            if (!p_pipelineLayout->InitializeSubController(fragShader))
+        void Release(PipelineRegistry& p_pipelineRegistry)
+        {
+            if (_acquiredHandle != nullptr)
+            {
+                p_pipelineRegistry.Release(_acquiredHandle);
+                _acquiredHandle = nullptr;
+            }
+            if (_acquiredDepthHandle != nullptr)
             {
-                return false;
+                p_pipelineRegistry.Release(_acquiredDepthHandle);
+                _acquiredDepthHandle = nullptr;
             }
+            _pipelineHandle = nullptr;
+            _depthPipelineHandle = nullptr;
+            _graphicsPipeline = _fallbackPipeline;
+            _depthPipeline = nullptr;
+        }
 
-            _graphicsPipeline = new Vulkan::GraphicsPipeline(p_pipelineLayout, vertShader, fragShader, p_dynamicState,
-                                                            p_colorBlend, {p_colorBlendAttachment},
-                                                            p_pipelineRasterization);
-            if(!p_pipelineLayout->InitializeSubController(_graphicsPipeline))
+        // Swaps fallback for the compiled pipeline once it is ready, or the pipeline for its rebuilt replacement.
+        // Called once per frame before recording, so recording threads only read a plain pointer
+        void UpdatePipeline()
+        {
+            if (_acquiredHandle != nullptr && _acquiredHandle->IsReplaced())
             {
-                return false;
+                _acquiredHandle = PipelineHandle::GetLatest(_acquiredHandle);
+                _pipelineHandle = _acquiredHandle;
             }
-            vertShader->Terminate();
-            fragShader->Terminate();
-            
-            return true;    
+            if (_acquiredDepthHandle != nullptr && _acquiredDepthHandle->IsReplaced())
+            {
+                _acquiredDepthHandle = PipelineHandle::GetLatest(_acquiredDepthHandle);
+                _depthPipelineHandle = _acquiredDepthHandle;
+            }
+
+            if (_depthPipelineHandle != nullptr && _depthPipelineHandle->IsReady())
+            {
+                _depthPipeline = _depthPipelineHandle->GetPipeline();
+                _depthPipelineHandle = nullptr;
+            }
+
+            if (_pipelineHandle == nullptr || !_pipelineHandle->IsReady())
+            {
+                return;
+            }
+
+            _graphicsPipeline = _pipelineHandle->GetPipelineOr(_fallbackPipeline);
+            _pipelineHandle = nullptr;
+        }
+
+        // Compiled pipelines (main or depth only) were not picked up by UpdatePipeline yet
+        bool IsPipelinePending() const
+        {
+            return _pipelineHandle != nullptr || _depthPipelineHandle != nullptr;
+        }
+
+        bool IsUsingFallbackPipeline() const
+        {
+            return _graphicsPipeline == _fallbackPipeline;
         }
 
         const Vulkan::GraphicsPipeline* GetGraphicsPipeline() const
@@ -46,9 +95,62 @@ namespace DeepEngine::Engine::Renderer
             return _graphicsPipeline;
         }
 
+        // nullptr until both pipelines are compiled, fallback pipeline has a different vertex stage
+        const Vulkan::GraphicsPipeline* GetDepthPipeline() const
+        {
+            return IsUsingFallbackPipeline() ? nullptr : _depthPipeline;
+        }
+
+        // Without mesh vertex shader generates a triangle on its own
+        void SetMesh(const Mesh* p_mesh)
+        {
+            _mesh = p_mesh;
+        }
+
+        // Pushed with every mesh draw, pipeline layout has to have MeshPushConstants range
+        void SetTransform(const glm::mat4& p_transform)
+        {
+            _pushConstants.Model = p_transform;
+        }
+
+        void Draw(DrawList& p_drawList) const
+        {
+            DrawPacket packet { };
+            packet.Pipeline = _graphicsPipeline;
+            packet.DepthPipeline = GetDepthPipeline();
+
+            if (_mesh != nullptr)
+            {
+                // Fallback pipeline has no vertex input, mesh shows up once its own pipeline is compiled
+                if (IsUsingFallbackPipeline())
+                {
+                    return;
+                }
+                _mesh->FillDrawPacket(packet);
+                packet.PushConstantsStages = MeshPushConstants::GetRange().stageFlags;
+
+                p_drawList.Add(DrawList::MakeSortKey(0, packet.Pipeline->GetSortID(), 0, 0), packet,
+                    &_pushConstants, sizeof(_pushConstants));
+                return;
+            }
+
+            packet.ElementsCount = 3;
+            p_drawList.Add(packet);
+        }
+
     private:
-        Vulkan::GraphicsPipeline* _graphicsPipeline;
-        
+        const Vulkan::GraphicsPipeline* _graphicsPipeline = nullptr;
+        const Vulkan::GraphicsPipeline* _fallbackPipeline = nullptr;
+        const Mesh* _mesh = nullptr;
+        MeshPushConstants _pushConstants { glm::mat4(1.0f) };
+        // Pending until the pipeline is ready
+        std::shared_ptr<PipelineHandle> _pipelineHandle;
+        // Reference held in the registry
+        std::shared_ptr<PipelineHandle> _acquiredHandle;
+
+        const Vulkan::GraphicsPipeline* _depthPipeline = nullptr;
+        std::shared_ptr<PipelineHandle> _depthPipelineHandle;
+        std::shared_ptr<PipelineHandle> _acquiredDepthHandle;
     };
 }
 
@@ -0,0 +1,424 @@
+#include "UploadQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Debug/Timing.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+    UploadQueue::UploadQueue(Vulkan::VulkanInstance* p_vulkanInstance,
+        const Vulkan::VulkanInstance::QueueInstance* p_transferQueue,
+        const Vulkan::VulkanInstance::QueueInstance* p_graphicsQueue,
+        uint32_t p_framesInFlight, VkDeviceSize p_stagingSize)
+        : _vulkanInstance(p_vulkanInstance), _transferQueue(p_transferQueue), _graphicsQueue(p_graphicsQueue),
+        _framesInFlight(p_framesInFlight), _stagingSize(p_stagingSize),
+        _ownershipTransfer(p_transferQueue->FamilyIndex != p_graphicsQueue->FamilyIndex)
+    { }
+
+    UploadQueue::~UploadQueue()
+    {
+        if (_timeline != nullptr)
+        {
+            WaitIdle();
+            _timeline->Terminate();
+        }
+
+        // Pools terminate their command buffers too
+        if (_commandPool != nullptr)
+        {
+            _commandPool->Terminate();
+        }
+        if (_acquireCommandPool != nullptr)
+        {
+            _acquireCommandPool->Terminate();
+        }
+
+        if (_stagingBuffer != nullptr)
+        {
+            _stagingBuffer->Terminate();
+        }
+    }
+
+    bool UploadQueue::Initialize()
+    {
+        _stagingBuffer = new Vulkan::Buffer(_stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            Vulkan::MemoryUsage::CPU_TO_GPU);
+        if (!_vulkanInstance->InitializeSubController(_stagingBuffer))
+        {
+            return false;
+        }
+        _stagingData = static_cast<uint8_t*>(_stagingBuffer->GetMappedData());
+
+        _timeline = new Vulkan::TimelineSemaphore(0);
+        if (!_vulkanInstance->InitializeSubController(_timeline))
+        {
+            return false;
+        }
+
+        _commandPool = new Vulkan::CommandPool(_transferQueue, Vulkan::CommandPoolFlag::RESET_COMMAND_BUFFER);
+        if (!_vulkanInstance->InitializeSubController(_commandPool))
+        {
+            return false;
+        }
+
+        auto commandBuffers = _commandPool->CreateCommandBuffers(MAX_BATCHES_IN_FLIGHT);
+        for (uint32_t i = 0; i < MAX_BATCHES_IN_FLIGHT; i++)
+        {
+            _batches[i].CommandBuffer = commandBuffers[i];
+        }
+
+        if (_ownershipTransfer)
+        {
+            _acquireCommandPool = new Vulkan::CommandPool(_graphicsQueue, Vulkan::CommandPoolFlag::RESET_COMMAND_BUFFER);
+            if (!_vulkanInstance->InitializeSubController(_acquireCommandPool))
+            {
+                return false;
+            }
+            _acquireCommandBuffers = _acquireCommandPool->CreateCommandBuffers(_framesInFlight);
+        }
+
+        VULKAN_INFO("Uploads are submitted to queue family {}{}", _transferQueue->FamilyIndex,
+            _ownershipTransfer ? " (dedicated transfer)" : " (graphics)");
+        return true;
+    }
+
+    bool UploadQueue::Upload(const Vulkan::Buffer* p_destination, VkDeviceSize p_destinationOffset,
+        const void* p_data, VkDeviceSize p_size)
+    {
+        if (p_destinationOffset + p_size > p_destination->GetSize())
+        {
+            VULKAN_ERR("Upload of {} bytes at offset {} exceeds {} bytes buffer",
+                p_size, p_destinationOffset, p_destination->GetSize());
+            return false;
+        }
+
+        std::lock_guard lock(_mutex);
+
+        // Quarter of the ring, so a big upload still leaves space for batches in flight
+        const VkDeviceSize maxChunkSize = _stagingSize / 4;
+        const auto source = static_cast<const uint8_t*>(p_data);
+
+        for (VkDeviceSize uploaded = 0; uploaded < p_size; )
+        {
+            const VkDeviceSize chunkSize = std::min(p_size - uploaded, maxChunkSize);
+
+            VkDeviceSize stagingOffset;
+            if (!AllocateStaging(chunkSize, &stagingOffset))
+            {
+                return false;
+            }
+
+            memcpy(_stagingData + stagingOffset, source + uploaded, chunkSize);
+
+            PendingCopy copy;
+            copy.Destination = p_destination->GetVkBuffer();
+            copy.Region.srcOffset = stagingOffset;
+            copy.Region.dstOffset = p_destinationOffset + uploaded;
+            copy.Region.size = chunkSize;
+            _pendingCopies.push_back(copy);
+
+            uploaded += chunkSize;
+        }
+
+        _statistics.UploadedBytes += p_size;
+        return true;
+    }
+
+    uint64_t UploadQueue::Flush()
+    {
+        std::lock_guard lock(_mutex);
+        return FlushLocked();
+    }
+
+    UploadFrameSync UploadQueue::PrepareFrame(uint32_t p_frameIndex)
+    {
+        std::lock_guard lock(_mutex);
+
+        UploadFrameSync sync;
+        const uint64_t lastSubmittedBatchID = _nextBatchID - 1;
+
+        // Same queue orders batches before the frame on its own
+        if (!_ownershipTransfer || lastSubmittedBatchID == _lastAcquiredBatchID)
+        {
+            return sync;
+        }
+        _lastAcquiredBatchID = lastSubmittedBatchID;
+
+        const VkCommandBuffer commandBuffer = _acquireCommandBuffers[p_frameIndex]->GetVkCommandBuffer();
+
+        VkCommandBufferBeginInfo beginInfo { };
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        if (result != VK_SUCCESS)
+        {
+            VULKAN_ERR("Failed to begin upload acquire command buffer with returned result {}", string_VkResult(result));
+            return sync;
+        }
+
+        std::sort(_pendingAcquires.begin(), _pendingAcquires.end());
+        _pendingAcquires.erase(std::unique(_pendingAcquires.begin(), _pendingAcquires.end()), _pendingAcquires.end());
+
+        // Has to match release barriers recorded by FlushLocked
+        std::vector<VkBufferMemoryBarrier> barriers(_pendingAcquires.size());
+        for (size_t i = 0; i < _pendingAcquires.size(); i++)
+        {
+            barriers[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barriers[i].srcAccessMask = 0;
+            barriers[i].dstAccessMask = CONSUMER_ACCESS;
+            barriers[i].srcQueueFamilyIndex = _transferQueue->FamilyIndex;
+            barriers[i].dstQueueFamilyIndex = _graphicsQueue->FamilyIndex;
+            barriers[i].buffer = _pendingAcquires[i];
+            barriers[i].offset = 0;
+            barriers[i].size = VK_WHOLE_SIZE;
+        }
+        _pendingAcquires.clear();
+
+        // Source stages match semaphore wait stages, so the barrier is ordered after the wait
+        vkCmdPipelineBarrier(commandBuffer,
+            CONSUMER_STAGES,
+            CONSUMER_STAGES,
+            0,
+            0, nullptr,
+            static_cast<uint32_t>(barriers.size()), barriers.data(),
+            0, nullptr);
+
+        result = vkEndCommandBuffer(commandBuffer);
+        if (result != VK_SUCCESS)
+        {
+            VULKAN_ERR("Failed to record upload acquire command buffer with returned result {}", string_VkResult(result));
+            return sync;
+        }
+
+        sync.AcquireCommandBuffer = commandBuffer;
+        sync.Semaphore = _timeline->GetVkSemaphore();
+        sync.WaitValue = lastSubmittedBatchID;
+        sync.WaitStages = CONSUMER_STAGES;
+        return sync;
+    }
+
+    bool UploadQueue::IsBatchCompleted(uint64_t p_batchID)
+    {
+        std::lock_guard lock(_mutex);
+        CollectCompletedBatches();
+        return p_batchID < _oldestBatchInFlightID;
+    }
+
+    void UploadQueue::WaitIdle()
+    {
+        std::lock_guard lock(_mutex);
+        while (WaitOldestBatch())
+        { }
+    }
+
+    bool UploadQueue::AllocateStaging(VkDeviceSize p_size, VkDeviceSize* p_outOffset)
+    {
+        const VkDeviceSize size = (p_size + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+
+        while (true)
+        {
+            uint64_t position = _stagingWritePosition;
+
+            // Range can not wrap around the end of the ring, the tail is skipped
+            const uint64_t ringOffset = position % _stagingSize;
+            if (ringOffset + size > _stagingSize)
+            {
+                position += _stagingSize - ringOffset;
+            }
+
+            if (position + size - _stagingReleasedPosition <= _stagingSize)
+            {
+                _stagingWritePosition = position + size;
+                *p_outOffset = position % _stagingSize;
+                return true;
+            }
+
+            CollectCompletedBatches();
+            if (position + size - _stagingReleasedPosition <= _stagingSize)
+            {
+                continue;
+            }
+
+            // Ring is full of queued and in flight copies, queued ones have to be submitted to ever complete
+            TIMER("Wait for staging memory");
+            _statistics.StagingStalls++;
+            if (!_pendingCopies.empty())
+            {
+                FlushLocked();
+            }
+            if (!WaitOldestBatch())
+            {
+                VULKAN_ERR("Staging ring of {} bytes can not fit {} bytes", _stagingSize, size);
+                return false;
+            }
+        }
+    }
+
+    uint64_t UploadQueue::FlushLocked()
+    {
+        if (_pendingCopies.empty())
+        {
+            return _nextBatchID - 1;
+        }
+
+        TIMER("Flush uploads");
+
+        // Every slot is in flight, oldest one is most likely done anyway
+        if (_nextBatchID - _oldestBatchInFlightID >= MAX_BATCHES_IN_FLIGHT)
+        {
+            WaitOldestBatch();
+        }
+
+        Batch& batch = _batches[_nextBatchID % MAX_BATCHES_IN_FLIGHT];
+        const VkCommandBuffer commandBuffer = batch.CommandBuffer->GetVkCommandBuffer();
+
+        VkCommandBufferBeginInfo beginInfo { };
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        if (result != VK_SUCCESS)
+        {
+            VULKAN_ERR("Failed to begin upload command buffer with returned result {}", string_VkResult(result));
+            return _nextBatchID - 1;
+        }
+
+        // Stable, so copies into overlapping ranges keep their upload order
+        std::stable_sort(_pendingCopies.begin(), _pendingCopies.end(),
+            [](const PendingCopy& p_left, const PendingCopy& p_right)
+            {
+                return p_left.Destination < p_right.Destination;
+            });
+
+        std::vector<VkBufferCopy> regions;
+        regions.reserve(_pendingCopies.size());
+        std::vector<VkBufferMemoryBarrier> releaseBarriers;
+
+        for (size_t i = 0; i < _pendingCopies.size(); )
+        {
+            const VkBuffer destination = _pendingCopies[i].Destination;
+
+            regions.clear();
+            for (; i < _pendingCopies.size() && _pendingCopies[i].Destination == destination; i++)
+            {
+                regions.push_back(_pendingCopies[i].Region);
+            }
+
+            vkCmdCopyBuffer(commandBuffer, _stagingBuffer->GetVkBuffer(), destination,
+                static_cast<uint32_t>(regions.size()), regions.data());
+
+            if (_ownershipTransfer)
+            {
+                VkBufferMemoryBarrier& barrier = releaseBarriers.emplace_back();
+                barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = 0;
+                barrier.srcQueueFamilyIndex = _transferQueue->FamilyIndex;
+                barrier.dstQueueFamilyIndex = _graphicsQueue->FamilyIndex;
+                barrier.buffer = destination;
+                barrier.offset = 0;
+                barrier.size = VK_WHOLE_SIZE;
+            }
+        }
+
+        if (_ownershipTransfer)
+        {
+            // Release half of the ownership transfer, visibility is made by the acquire on the graphics queue
+            vkCmdPipelineBarrier(commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                0,
+                0, nullptr,
+                static_cast<uint32_t>(releaseBarriers.size()), releaseBarriers.data(),
+                0, nullptr);
+        }
+        else
+        {
+            VkMemoryBarrier barrier { };
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = CONSUMER_ACCESS;
+
+            vkCmdPipelineBarrier(commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                CONSUMER_STAGES,
+                0,
+                1, &barrier,
+                0, nullptr,
+                0, nullptr);
+        }
+
+        result = vkEndCommandBuffer(commandBuffer);
+        if (result != VK_SUCCESS)
+        {
+            VULKAN_ERR("Failed to record upload command buffer with returned result {}", string_VkResult(result));
+            return _nextBatchID - 1;
+        }
+
+        const uint64_t batchID = _nextBatchID;
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo { };
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &batchID;
+
+        VkSubmitInfo submitInfo { };
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = _timeline->GetVkSemaphorePtr();
+
+        result = vkQueueSubmit(_transferQueue->Queue, 1, &submitInfo, VK_NULL_HANDLE);
+        if (result != VK_SUCCESS)
+        {
+            VULKAN_ERR("Failed to submit uploads with returned result {}", string_VkResult(result));
+            return _nextBatchID - 1;
+        }
+
+        _statistics.CopiesCount += _pendingCopies.size();
+        _statistics.SubmittedBatches++;
+        _pendingCopies.clear();
+
+        for (const VkBufferMemoryBarrier& barrier : releaseBarriers)
+        {
+            _pendingAcquires.push_back(barrier.buffer);
+        }
+
+        batch.StagingEnd = _stagingWritePosition;
+        batch.ID = batchID;
+        _nextBatchID++;
+        return batch.ID;
+    }
+
+    bool UploadQueue::WaitOldestBatch()
+    {
+        if (_oldestBatchInFlightID == _nextBatchID)
+        {
+            return false;
+        }
+
+        _timeline->Wait(_oldestBatchInFlightID);
+        CollectCompletedBatches();
+        return true;
+    }
+
+    void UploadQueue::CollectCompletedBatches()
+    {
+        if (_oldestBatchInFlightID == _nextBatchID)
+        {
+            return;
+        }
+
+        const uint64_t completedBatchID = _timeline->GetCompletedValue();
+        while (_oldestBatchInFlightID < _nextBatchID && _oldestBatchInFlightID <= completedBatchID)
+        {
+            const Batch& batch = _batches[_oldestBatchInFlightID % MAX_BATCHES_IN_FLIGHT];
+            _stagingReleasedPosition = batch.StagingEnd;
+            _oldestBatchInFlightID++;
+        }
+    }
+}
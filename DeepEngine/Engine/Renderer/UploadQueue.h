@@ -0,0 +1,154 @@
+#pragma once
+#include <array>
+#include <mutex>
+
+#include "Vulkan/Buffer.h"
+#include "Vulkan/CommandBuffer.h"
+#include "Vulkan/CommandPool.h"
+#include "Vulkan/TimelineSemaphore.h"
+
+namespace DeepEngine::Engine::Renderer
+{
+
+    struct UploadQueueStatistics
+    {
+        uint64_t UploadedBytes = 0;
+        uint64_t CopiesCount = 0;
+        uint32_t SubmittedBatches = 0;
+        // Uploads which had to wait for the GPU to free staging memory
+        uint32_t StagingStalls = 0;
+    };
+
+    // What the frame submission has to do before it may read uploaded data. Empty when uploads are submitted
+    // to the graphics queue itself or nothing new was flushed since the previous frame
+    struct UploadFrameSync
+    {
+        // Acquires ownership of uploaded buffers, has to be submitted before the frame command buffers
+        VkCommandBuffer AcquireCommandBuffer = VK_NULL_HANDLE;
+        // Timeline semaphore and value to wait for at WaitStages
+        VkSemaphore Semaphore = VK_NULL_HANDLE;
+        uint64_t WaitValue = 0;
+        VkPipelineStageFlags WaitStages = 0;
+    };
+
+    // Uploads data into device local buffers through a persistently mapped staging ring.
+    // Upload copies data into the ring right away and queues the copy, Flush submits all queued copies as one
+    // batch (copies into the same buffer are merged into one vkCmdCopyBuffer). Every batch signals the timeline
+    // semaphore with its ID, ring memory of a batch is reclaimed once that value is reached, so uploading never
+    // waits for the GPU unless the ring is full.
+    // With a dedicated transfer queue batches run asynchronously to rendering: each one releases its destination
+    // buffers to the graphics queue family, PrepareFrame records the matching acquire barriers and the frame waits
+    // for the timeline on the GPU only, the CPU never does. Queue family ownership covers whole buffers, so a
+    // buffer already read by frames should be rewritten as a whole, ranges not uploaded again are undefined by
+    // the spec. When the transfer queue is the graphics queue, batches end with a barrier making copies visible
+    // to every later submission instead.
+    class UploadQueue
+    {
+    public:
+        static constexpr VkDeviceSize DEFAULT_STAGING_SIZE = 32ull * 1024 * 1024;
+        static constexpr uint32_t MAX_BATCHES_IN_FLIGHT = 8;
+
+        // Stages in which uploaded data can be read
+        static constexpr VkPipelineStageFlags CONSUMER_STAGES = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT
+            | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
+            | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        static constexpr VkAccessFlags CONSUMER_ACCESS = VK_ACCESS_INDIRECT_COMMAND_READ_BIT
+            | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT
+            | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+        // Transfer queue may be the graphics queue when device has no dedicated transfer family
+        UploadQueue(Vulkan::VulkanInstance* p_vulkanInstance,
+            const Vulkan::VulkanInstance::QueueInstance* p_transferQueue,
+            const Vulkan::VulkanInstance::QueueInstance* p_graphicsQueue,
+            uint32_t p_framesInFlight, VkDeviceSize p_stagingSize = DEFAULT_STAGING_SIZE);
+        ~UploadQueue();
+
+        UploadQueue(const UploadQueue&) = delete;
+        UploadQueue& operator=(const UploadQueue&) = delete;
+
+        bool Initialize();
+
+        // Destination has to be created with VK_BUFFER_USAGE_TRANSFER_DST_BIT. Data bigger than the staging
+        // ring is split into several copies. When the ring is full queued copies are flushed, so as Flush
+        // it has to be called from the thread submitting to the queue
+        bool Upload(const Vulkan::Buffer* p_destination, VkDeviceSize p_destinationOffset,
+            const void* p_data, VkDeviceSize p_size);
+
+        // Has to be called from the thread submitting to the transfer queue. Returns ID of the submitted batch,
+        // or of the last one if nothing was queued
+        uint64_t Flush();
+
+        // Called once per frame after Flush, from the thread submitting the frame. Acquire command buffer of the
+        // frame is reused, so the previous submission of that frame has to be finished
+        UploadFrameSync PrepareFrame(uint32_t p_frameIndex);
+
+        bool IsBatchCompleted(uint64_t p_batchID);
+        void WaitIdle();
+
+        bool HasDedicatedQueue() const
+        { return _ownershipTransfer; }
+
+        const UploadQueueStatistics& GetStatistics() const
+        { return _statistics; }
+
+    private:
+        struct PendingCopy
+        {
+            VkBuffer Destination;
+            VkBufferCopy Region;
+        };
+
+        struct Batch
+        {
+            Vulkan::CommandBuffer* CommandBuffer = nullptr;
+            // Ring position right after the last byte used by the batch
+            uint64_t StagingEnd = 0;
+            uint64_t ID = 0;
+        };
+
+        bool AllocateStaging(VkDeviceSize p_size, VkDeviceSize* p_outOffset);
+        uint64_t FlushLocked();
+        // Returns false if there was no batch in flight to wait for
+        bool WaitOldestBatch();
+        void CollectCompletedBatches();
+
+    private:
+        static constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+        Vulkan::VulkanInstance* _vulkanInstance;
+        const Vulkan::VulkanInstance::QueueInstance* _transferQueue;
+        const Vulkan::VulkanInstance::QueueInstance* _graphicsQueue;
+        const uint32_t _framesInFlight;
+        const VkDeviceSize _stagingSize;
+        // Transfer and graphics queues are in different families
+        const bool _ownershipTransfer;
+
+        Vulkan::Buffer* _stagingBuffer = nullptr;
+        uint8_t* _stagingData = nullptr;
+        // Both grow monotonically, ring offset is position modulo staging size
+        uint64_t _stagingWritePosition = 0;
+        uint64_t _stagingReleasedPosition = 0;
+
+        Vulkan::CommandPool* _commandPool = nullptr;
+        std::array<Batch, MAX_BATCHES_IN_FLIGHT> _batches;
+        // Signaled with ID of every completed batch
+        Vulkan::TimelineSemaphore* _timeline = nullptr;
+        // Batches are submitted and completed in ID order, slot of a batch is ID % MAX_BATCHES_IN_FLIGHT
+        uint64_t _nextBatchID = 1;
+        uint64_t _oldestBatchInFlightID = 1;
+        // Last batch some frame already waits for, frames are submitted in order so later ones need not to
+        uint64_t _lastAcquiredBatchID = 0;
+
+        // Graphics family pool, only with ownership transfer
+        Vulkan::CommandPool* _acquireCommandPool = nullptr;
+        std::vector<Vulkan::CommandBuffer*> _acquireCommandBuffers;
+        // Buffers released by flushed batches, waiting to be acquired by the next frame
+        std::vector<VkBuffer> _pendingAcquires;
+
+        std::vector<PendingCopy> _pendingCopies;
+
+        std::mutex _mutex;
+        UploadQueueStatistics _statistics;
+    };
+
+}
@@ -0,0 +1,48 @@
+#include "Buffer.h"
+
+namespace DeepEngine::Engine::Renderer::Vulkan
+{
+    Buffer::Buffer(VkDeviceSize p_size, VkBufferUsageFlags p_usage, MemoryUsage p_memoryUsage,
+        AllocationStrategy p_strategy)
+        : _size(p_size), _usage(p_usage), _memoryUsage(p_memoryUsage), _strategy(p_strategy)
+    { }
+
+    bool Buffer::OnInitialize()
+    {
+        VulkanInstance* vulkanInstance = GetVulkanInstanceController();
+
+        VkBufferCreateInfo createInfo { };
+        createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        createInfo.size = _size;
+        createInfo.usage = _usage;
+        createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        VULKAN_CHECK_CREATE(
+            vkCreateBuffer(vulkanInstance->GetLogicalDevice(), &createInfo, nullptr, &_buffer),
+            "Failed to create buffer!")
+
+        if (!vulkanInstance->GetMemoryAllocator()->AllocateForBuffer(_buffer, _memoryUsage, &_allocation, _strategy))
+        {
+            VULKAN_ERR("Failed to allocate memory for {} bytes buffer", _size);
+            return false;
+        }
+
+        return true;
+    }
+
+    void Buffer::InvalidateMappedData() const
+    {
+        GetVulkanInstanceController()->GetMemoryAllocator()->InvalidateMappedMemory(_allocation);
+    }
+
+    void Buffer::OnTerminate()
+    {
+        VulkanInstance* vulkanInstance = GetVulkanInstanceController();
+
+        if (_buffer != VK_NULL_HANDLE)
+        {
+            vkDestroyBuffer(vulkanInstance->GetLogicalDevice(), _buffer, nullptr);
+        }
+        vulkanInstance->GetMemoryAllocator()->Free(_allocation);
+    }
+}
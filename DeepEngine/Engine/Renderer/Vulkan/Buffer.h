@@ -0,0 +1,48 @@
+#pragma once
+#include "Controller/BaseVulkanController.h"
+#include "Instance/VulkanInstance.h"
+#include "Memory/DeviceMemoryAllocator.h"
+
+namespace DeepEngine::Engine::Renderer::Vulkan
+{
+
+    // VkBuffer with memory sub-allocated from the instance's DeviceMemoryAllocator.
+    // Host visible buffers (CPU_TO_GPU, GPU_TO_CPU) stay mapped for their whole life.
+    class Buffer final : public BaseVulkanController
+    {
+    public:
+        Buffer(VkDeviceSize p_size, VkBufferUsageFlags p_usage, MemoryUsage p_memoryUsage,
+            AllocationStrategy p_strategy = AllocationStrategy::GENERAL);
+        ~Buffer() override = default;
+
+        VkBuffer GetVkBuffer() const
+        { return _buffer; }
+
+        VkDeviceSize GetSize() const
+        { return _size; }
+
+        VkBufferUsageFlags GetUsage() const
+        { return _usage; }
+
+        // nullptr if memory is not host visible
+        void* GetMappedData() const
+        { return _allocation.MappedData; }
+
+        // Before the host reads what the GPU wrote into mapped data
+        void InvalidateMappedData() const;
+
+    protected:
+        bool OnInitialize() override;
+        void OnTerminate() override;
+
+    private:
+        const VkDeviceSize _size;
+        const VkBufferUsageFlags _usage;
+        const MemoryUsage _memoryUsage;
+        const AllocationStrategy _strategy;
+
+        VkBuffer _buffer = VK_NULL_HANDLE;
+        DeviceAllocation _allocation;
+    };
+
+}
@@ -7,19 +7,30 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         : _queue(p_queue), _flag(p_flags)
     { }
 
-    std::vector<CommandBuffer*> CommandPool::CreateCommandBuffers(uint32_t p_buffersCount)
+    std::vector<CommandBuffer*> CommandPool::CreateCommandBuffers(uint32_t p_buffersCount, bool p_createAsSecondary)
     {
         std::vector<CommandBuffer*> output(p_buffersCount);
 
         for (uint32_t i = 0; i < p_buffersCount; i++)
         {
-            output[i] = new CommandBuffer(this, false);
+            output[i] = new CommandBuffer(this, p_createAsSecondary);
             InitializeSubController(output[i]);
         }
         
         return output;
     }
 
+    bool CommandPool::Reset()
+    {
+        const VkResult result = vkResetCommandPool(GetVulkanInstanceController()->GetLogicalDevice(), _commandPool, 0);
+        if (result != VK_SUCCESS)
+        {
+            VULKAN_ERR("Failed to reset command pool with returned result {}", string_VkResult(result));
+            return false;
+        }
+        return true;
+    }
+
     bool CommandPool::OnInitialize()
     {
         VkCommandPoolCreateInfo createInfo { };
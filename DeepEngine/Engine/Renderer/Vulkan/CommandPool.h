@@ -25,7 +25,10 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         VkCommandPool GetVkCommandPool() const
         { return _commandPool; }
 
-        std::vector<CommandBuffer*> CreateCommandBuffers(uint32_t p_buffersCount);
+        std::vector<CommandBuffer*> CreateCommandBuffers(uint32_t p_buffersCount, bool p_createAsSecondary = false);
+
+        // Returns all buffers allocated from the pool to the initial state, none of them can be pending execution
+        bool Reset();
 
     protected:
         bool OnInitialize() override;
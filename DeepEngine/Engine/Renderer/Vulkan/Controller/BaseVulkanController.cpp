@@ -8,17 +8,23 @@ namespace DeepEngine::Engine::Renderer::Vulkan
     {
         if (_parentController != nullptr)
         {
+            std::lock_guard lock(_parentController->_childControllersMutex);
             _parentController->_childControllers.erase(this);
         }
 
-        for (auto child : _childControllers)
+        // Children are terminated outside of the lock, they no longer know their parent so they do not take it
+        std::unordered_set<BaseVulkanController*> childControllers;
+        {
+            std::lock_guard lock(_childControllersMutex);
+            childControllers.swap(_childControllers);
+        }
+
+        for (auto child : childControllers)
         {
             child->_parentController = nullptr;
             child->Terminate();
         }
 
-        _childControllers.clear();
-
         OnTerminate();
         
         delete this;
@@ -1,5 +1,6 @@
 #pragma once
 #include <list>
+#include <mutex>
 #include <type_traits>
 #include <iostream>
 #include <unordered_set>
@@ -30,17 +31,31 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         {
             auto baseController = (BaseVulkanController*)p_controller;
             baseController->_parentController = this;
-            _childControllers.insert((BaseVulkanController*)p_controller);
-
+            // Before the insert, visitors read it under the lock
             baseController->_debugTypeName = typeid(T).name();
+            {
+                // Controllers may be created from worker threads (e.g. pipeline compilation)
+                std::lock_guard lock(_childControllersMutex);
+                _childControllers.insert((BaseVulkanController*)p_controller);
+            }
+
             return baseController->OnInitialize();
         }
 
         const char* GetDebugTypeName() const
         { return _debugTypeName; }
         
-        const std::unordered_set<BaseVulkanController*>& GetChildControllers() const
-        { return _childControllers; }
+        // Children may be added from other threads at any time, so they are visited under the lock. Visitor must
+        // not initialize nor terminate children of this controller
+        template <typename TVisitor>
+        void ForEachChildController(TVisitor&& p_visitor) const
+        {
+            std::lock_guard lock(_childControllersMutex);
+            for (BaseVulkanController* child : _childControllers)
+            {
+                p_visitor(child);
+            }
+        }
 
     protected:
         virtual bool OnInitialize() = 0;
@@ -53,6 +68,7 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         static VulkanInstance* _vulkanInstance;
         
         std::unordered_set<BaseVulkanController*> _childControllers;
+        mutable std::mutex _childControllersMutex;
         BaseVulkanController* _parentController = nullptr;
         
         const char* _debugTypeName;
@@ -6,11 +6,11 @@
 
 #include "Debug/Logger.h"
 
-#define VULKAN_TRACE(mess, ...) LOG_TRACE(DeepEngine::Engine::Renderer::Vulkan::VulkanDebugger::GetLogger(), mess, __VA_ARGS__)
-#define VULKAN_DEBUG(mess, ...) LOG_DEBUG(DeepEngine::Engine::Renderer::Vulkan::VulkanDebugger::GetLogger(), mess, __VA_ARGS__)
-#define VULKAN_INFO(mess, ...) LOG_INFO(DeepEngine::Engine::Renderer::Vulkan::VulkanDebugger::GetLogger(), mess, __VA_ARGS__)
-#define VULKAN_WARN(mess, ...) LOG_WARN(DeepEngine::Engine::Renderer::Vulkan::VulkanDebugger::GetLogger(), mess, __VA_ARGS__)
-#define VULKAN_ERR(mess, ...) LOG_ERR(DeepEngine::Engine::Renderer::Vulkan::VulkanDebugger::GetLogger(), mess, __VA_ARGS__)
+#define VULKAN_TRACE(...) DEEP_LOG_IF(DEEP_LOG_LEVEL_VULKAN, SPDLOG_LEVEL_TRACE, DeepEngine::Engine::Renderer::Vulkan::VulkanDebugger::GetLogger(), __VA_ARGS__)
+#define VULKAN_DEBUG(...) DEEP_LOG_IF(DEEP_LOG_LEVEL_VULKAN, SPDLOG_LEVEL_DEBUG, DeepEngine::Engine::Renderer::Vulkan::VulkanDebugger::GetLogger(), __VA_ARGS__)
+#define VULKAN_INFO(...) DEEP_LOG_IF(DEEP_LOG_LEVEL_VULKAN, SPDLOG_LEVEL_INFO, DeepEngine::Engine::Renderer::Vulkan::VulkanDebugger::GetLogger(), __VA_ARGS__)
+#define VULKAN_WARN(...) DEEP_LOG_IF(DEEP_LOG_LEVEL_VULKAN, SPDLOG_LEVEL_WARN, DeepEngine::Engine::Renderer::Vulkan::VulkanDebugger::GetLogger(), __VA_ARGS__)
+#define VULKAN_ERR(...) DEEP_LOG_IF(DEEP_LOG_LEVEL_VULKAN, SPDLOG_LEVEL_ERROR, DeepEngine::Engine::Renderer::Vulkan::VulkanDebugger::GetLogger(), __VA_ARGS__)
 
 #define VULKAN_CHECK_CREATE(Result, FailMessage, ...)               \
     if (Result != VK_SUCCESS)                                       \
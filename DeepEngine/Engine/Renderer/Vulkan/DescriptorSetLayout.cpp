@@ -0,0 +1,80 @@
+#include "DescriptorSetLayout.h"
+
+namespace DeepEngine::Engine::Renderer::Vulkan
+{
+    DescriptorSetLayout::DescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& p_bindings,
+        VkDescriptorSetLayoutCreateFlags p_flags, const std::vector<VkDescriptorBindingFlags>& p_bindingFlags)
+        : _bindings(p_bindings), _flags(p_flags), _bindingFlags(p_bindingFlags)
+    { }
+
+    bool DescriptorSetLayout::IsDefinedSameAs(const DescriptorSetLayout* p_other) const
+    {
+        if (p_other == this)
+        {
+            return true;
+        }
+
+        if (p_other == nullptr
+            || p_other->_bindings.size() != _bindings.size()
+            || p_other->_flags != _flags
+            || p_other->_bindingFlags != _bindingFlags)
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < _bindings.size(); i++)
+        {
+            const VkDescriptorSetLayoutBinding& binding = _bindings[i];
+            const VkDescriptorSetLayoutBinding& otherBinding = p_other->_bindings[i];
+
+            // Immutable samplers are not used, layouts with them are never treated as the same
+            if (binding.binding != otherBinding.binding
+                || binding.descriptorType != otherBinding.descriptorType
+                || binding.descriptorCount != otherBinding.descriptorCount
+                || binding.stageFlags != otherBinding.stageFlags
+                || binding.pImmutableSamplers != nullptr
+                || otherBinding.pImmutableSamplers != nullptr)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool DescriptorSetLayout::OnInitialize()
+    {
+        if (!_bindingFlags.empty() && _bindingFlags.size() != _bindings.size())
+        {
+            VULKAN_ERR("Descriptor set layout has {} binding flags for {} bindings", _bindingFlags.size(),
+                _bindings.size());
+            return false;
+        }
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo { };
+        bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        bindingFlagsInfo.bindingCount = static_cast<uint32_t>(_bindingFlags.size());
+        bindingFlagsInfo.pBindingFlags = _bindingFlags.data();
+
+        VkDescriptorSetLayoutCreateInfo createInfo { };
+        createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        createInfo.pNext = _bindingFlags.empty() ? nullptr : &bindingFlagsInfo;
+        createInfo.flags = _flags;
+        createInfo.bindingCount = static_cast<uint32_t>(_bindings.size());
+        createInfo.pBindings = _bindings.data();
+
+        VULKAN_CHECK_CREATE(
+            vkCreateDescriptorSetLayout(
+                GetVulkanInstanceController()->GetLogicalDevice(),
+                &createInfo,
+                nullptr,
+                &_descriptorSetLayout),
+            "Failed to create Vulkan descriptor set layout!")
+
+        return true;
+    }
+
+    void DescriptorSetLayout::OnTerminate()
+    {
+        vkDestroyDescriptorSetLayout(GetVulkanInstanceController()->GetLogicalDevice(), _descriptorSetLayout, nullptr);
+    }
+}
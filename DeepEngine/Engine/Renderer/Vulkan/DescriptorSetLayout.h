@@ -0,0 +1,37 @@
+#pragma once
+#include "Controller/BaseVulkanController.h"
+#include "Instance/VulkanInstance.h"
+
+namespace DeepEngine::Engine::Renderer::Vulkan
+{
+
+    class DescriptorSetLayout final : public BaseVulkanController
+    {
+    public:
+        // Binding flags are empty or one per binding (e.g. partially bound arrays, needs descriptor indexing)
+        DescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& p_bindings,
+            VkDescriptorSetLayoutCreateFlags p_flags = 0,
+            const std::vector<VkDescriptorBindingFlags>& p_bindingFlags = { });
+        ~DescriptorSetLayout() override = default;
+
+        VkDescriptorSetLayout GetVkDescriptorSetLayout() const
+        { return _descriptorSetLayout; }
+
+        const std::vector<VkDescriptorSetLayoutBinding>& GetBindings() const
+        { return _bindings; }
+
+        // Compares definitions, layouts defined identically are interchangeable for pipeline layouts compatibility
+        bool IsDefinedSameAs(const DescriptorSetLayout* p_other) const;
+
+    protected:
+        bool OnInitialize() final;
+        void OnTerminate() final;
+
+    private:
+        const std::vector<VkDescriptorSetLayoutBinding> _bindings;
+        const VkDescriptorSetLayoutCreateFlags _flags;
+        const std::vector<VkDescriptorBindingFlags> _bindingFlags;
+        VkDescriptorSetLayout _descriptorSetLayout = VK_NULL_HANDLE;
+    };
+
+}
@@ -6,7 +6,7 @@
 namespace DeepEngine::Engine::Renderer::Vulkan
 {
 
-    class Fence final : BaseVulkanController
+    class Fence final : public BaseVulkanController
     {
     public:
         Fence(bool p_signalAtStart = false): _signaledAtStart(p_signalAtStart)
@@ -1,16 +1,21 @@
 #include "GraphicsPipeline.h"
 
+#include "Debug/Timing.h"
+
 namespace DeepEngine::Engine::Renderer::Vulkan
 {
+    std::atomic<uint32_t> GraphicsPipeline::_nextSortID = 0;
 
     GraphicsPipeline::GraphicsPipeline(PipelineLayout* p_pipelineLayout,
         const ShaderModule* p_vertShaderModule, const ShaderModule* p_fragShaderModule,
-        const PipelineDynamicState& p_dynamicStateFlags, const PipelineColorBlend& p_colorBlend,
-        const std::vector<PipelineColorBlendAttachment>& p_attachmentsBlend, const PipelineRasterization& p_rasterization)
+        const PipelineVertexLayout& p_vertexLayout, const PipelineDynamicState& p_dynamicStateFlags, const PipelineColorBlend& p_colorBlend,
+        const std::vector<PipelineColorBlendAttachment>& p_attachmentsBlend, const PipelineRasterization& p_rasterization,
+        const PipelineDepthStencil& p_depthStencil)
         : _pipelineLayout(p_pipelineLayout), 
-        _vertShaderModule(p_vertShaderModule), _fragShaderModule(p_fragShaderModule),
+        _vertShaderModule(p_vertShaderModule), _fragShaderModule(p_fragShaderModule), _vertexLayout(p_vertexLayout),
         _dynamicStateFlags(p_dynamicStateFlags), _colorBlend(p_colorBlend), _attachemntsBlend(p_attachmentsBlend),
-        _rasterization(p_rasterization)
+        _rasterization(p_rasterization), _depthStencil(p_depthStencil),
+        _sortID(_nextSortID.fetch_add(1, std::memory_order_relaxed))
     { }
     
     bool GraphicsPipeline::OnInitialize()
@@ -27,6 +32,7 @@ namespace DeepEngine::Engine::Renderer::Vulkan
             stages.push_back(vertCreateInfo);
         }
 
+        if (_fragShaderModule != nullptr)
         {
             VkPipelineShaderStageCreateInfo fragCreateInfo { };
             fragCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -60,13 +66,12 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
         dynamicState.pDynamicStates = dynamicStates.data();
 
-        // No fucking idea how pass this info
         VkPipelineVertexInputStateCreateInfo vertexBufferCreateInfo { };
         vertexBufferCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexBufferCreateInfo.vertexBindingDescriptionCount    = 0;
-        vertexBufferCreateInfo.pVertexBindingDescriptions       = nullptr;
-        vertexBufferCreateInfo.vertexAttributeDescriptionCount  = 0;
-        vertexBufferCreateInfo.pVertexAttributeDescriptions     = nullptr;
+        vertexBufferCreateInfo.vertexBindingDescriptionCount    = static_cast<uint32_t>(_vertexLayout.Bindings.size());
+        vertexBufferCreateInfo.pVertexBindingDescriptions       = _vertexLayout.Bindings.data();
+        vertexBufferCreateInfo.vertexAttributeDescriptionCount  = static_cast<uint32_t>(_vertexLayout.Attributes.size());
+        vertexBufferCreateInfo.pVertexAttributeDescriptions     = _vertexLayout.Attributes.data();
 
         VulkanInstance* vulkanInstance = GetVulkanInstanceController();
 
@@ -183,6 +188,15 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         multisampleCreateInfo.alphaToCoverageEnable = VK_FALSE;
         multisampleCreateInfo.alphaToOneEnable      = VK_FALSE;
 
+        VkPipelineDepthStencilStateCreateInfo depthStencilCreateInfo { };
+        depthStencilCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depthStencilCreateInfo.depthTestEnable      = _depthStencil.EnableDepthTest;
+        depthStencilCreateInfo.depthWriteEnable     = _depthStencil.EnableDepthWrite;
+        depthStencilCreateInfo.depthCompareOp       = _depthStencil.DepthCompareOperation;
+        depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;
+        depthStencilCreateInfo.stencilTestEnable    = VK_FALSE;
+        depthStencilCreateInfo.minDepthBounds       = 0.0f;
+        depthStencilCreateInfo.maxDepthBounds       = 1.0f;
         
         VkViewport viewport;
         viewport.x = 0.0f;
@@ -213,7 +227,7 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         pipelineInfo.pViewportState         = &viewportState;
         pipelineInfo.pRasterizationState    = &rasterizerCreateInfo;
         pipelineInfo.pMultisampleState      = &multisampleCreateInfo;
-        pipelineInfo.pDepthStencilState     = nullptr; // optional
+        pipelineInfo.pDepthStencilState     = &depthStencilCreateInfo;
         pipelineInfo.pColorBlendState       = &colorBlendingCreateInfo;
         pipelineInfo.pDynamicState          = &dynamicState;
         pipelineInfo.layout                 = _pipelineLayout->GetVkPipelineLayout();
@@ -224,9 +238,11 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         pipelineInfo.basePipelineHandle     = VK_NULL_HANDLE;
         pipelineInfo.basePipelineIndex      = -1;
 
+        // Compare with cold pipeline cache (remove cache file) to see how much the cache saves
+        TIMER("Create graphics pipeline");
         VULKAN_CHECK_CREATE(vkCreateGraphicsPipelines(
             GetVulkanInstanceController()->GetLogicalDevice(),
-                VK_NULL_HANDLE,
+                GetVulkanInstanceController()->GetVkPipelineCache(),
                 1,
                 &pipelineInfo,
                 nullptr,
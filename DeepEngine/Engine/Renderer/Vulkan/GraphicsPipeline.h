@@ -16,6 +16,28 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         // ...
     };
 
+    // Vertex buffers bindings and attributes read by the vertex shader, empty layout for shaders generating
+    // geometry themselves
+    struct PipelineVertexLayout
+    {
+        std::vector<VkVertexInputBindingDescription> Bindings;
+        std::vector<VkVertexInputAttributeDescription> Attributes;
+
+        PipelineVertexLayout& AddBinding(uint32_t p_binding, uint32_t p_stride,
+            VkVertexInputRate p_inputRate = VK_VERTEX_INPUT_RATE_VERTEX)
+        {
+            Bindings.push_back({ p_binding, p_stride, p_inputRate });
+            return *this;
+        }
+
+        PipelineVertexLayout& AddAttribute(uint32_t p_location, uint32_t p_binding, VkFormat p_format,
+            uint32_t p_offset)
+        {
+            Attributes.push_back({ p_location, p_binding, p_format, p_offset });
+            return *this;
+        }
+    };
+
     struct PipelineColorBlend
     {
         glm::vec4 ColorBlendConstants;
@@ -55,14 +77,25 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         float DepthBiasClamp            = 0.0f;
         float DepthBiasSlopeFactor      = 0.0f;
     };
+
+    // Subpass of the pipeline has to have depth attachment when depth test is enabled
+    struct PipelineDepthStencil
+    {
+        bool EnableDepthTest: 1         = false;
+        bool EnableDepthWrite: 1        = false;
+
+        VkCompareOp DepthCompareOperation = VK_COMPARE_OP_LESS_OR_EQUAL;
+    };
     
+    // Fragment shader module may be nullptr for depth only pipelines (e.g. depth pre-pass)
     class GraphicsPipeline : public BaseVulkanController
     {
     public:
         GraphicsPipeline(PipelineLayout* p_pipelineLayout,
             const ShaderModule* p_vertShaderModule, const ShaderModule* p_fragShaderModule,
-            const PipelineDynamicState& p_dynamicStateFlags, const PipelineColorBlend& p_colorBlend,
-            const std::vector<PipelineColorBlendAttachment>& p_attachmentsBlend, const PipelineRasterization& p_rasterization);
+            const PipelineVertexLayout& p_vertexLayout, const PipelineDynamicState& p_dynamicStateFlags, const PipelineColorBlend& p_colorBlend,
+            const std::vector<PipelineColorBlendAttachment>& p_attachmentsBlend, const PipelineRasterization& p_rasterization,
+            const PipelineDepthStencil& p_depthStencil);
 
         ~GraphicsPipeline() override = default;
 
@@ -71,10 +104,17 @@ namespace DeepEngine::Engine::Renderer::Vulkan
 
         const VkPipelineLayout& GetVkPipelineLayout() const
         { return _pipelineLayout->GetVkPipelineLayout(); }
+
+        const PipelineLayout* GetPipelineLayout() const
+        { return _pipelineLayout; }
         
         const VkPipeline& GetVkPipeline() const
         { return _pipeline; }
 
+        // Small unique number, used in draw sort keys instead of the handle
+        uint32_t GetSortID() const
+        { return _sortID; }
+
     protected:
         bool OnInitialize() final;
         void OnTerminate() final;
@@ -84,13 +124,18 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         
         const ShaderModule* _vertShaderModule; 
         const ShaderModule* _fragShaderModule;
-        
+
+        const PipelineVertexLayout _vertexLayout;
         const PipelineDynamicState _dynamicStateFlags;
         const PipelineColorBlend _colorBlend;
         const std::vector<PipelineColorBlendAttachment> _attachemntsBlend;
         const PipelineRasterization _rasterization;
+        const PipelineDepthStencil _depthStencil;
         
         VkPipeline _pipeline = VK_NULL_HANDLE;
+        const uint32_t _sortID;
+
+        static std::atomic<uint32_t> _nextSortID;
     };
     
 }
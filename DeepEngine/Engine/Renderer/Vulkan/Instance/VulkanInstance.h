@@ -11,6 +11,8 @@
 
 namespace DeepEngine::Engine::Renderer::Vulkan
 {
+    class PipelineCache;
+    class DeviceMemoryAllocator;
 
     class VulkanInstance : public BaseVulkanController
     {
@@ -49,7 +51,7 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         bool InitializePhysicalDevice()
         {
             if (OnInitializePhysicalDevice()
-                && OnInitializeSurface())
+                && (_isHeadless || OnInitializeSurface()))
             {
                 PreinitializeLogicalDevice();
                 return true;
@@ -67,8 +69,22 @@ namespace DeepEngine::Engine::Renderer::Vulkan
             return OnInitializeSwapChain();
         }
 
+        // Has to be set before InitializePhysicalDevice. Headless instance has no window, surface nor swapchain,
+        // GLFW is never called
+        void SetHeadless(bool p_isHeadless)
+        { _isHeadless = p_isHeadless; }
+
+        bool IsHeadless() const
+        { return _isHeadless; }
+
+        // Families having any of excluded features are skipped (e.g. to find transfer only family),
+        // so are families which already have a queue
         bool TryAddQueueToCreate(VkQueueFlagBits p_requiredFeatures, bool p_needSurfaceSupport,
-            const QueueInstance** p_outputInstance);
+            const QueueInstance** p_outputInstance, VkQueueFlags p_excludedFeatures = 0);
+
+        // Has to be set before InitializeLogicalDevice, cache is loaded together with the device
+        void SetPipelineCacheFilepath(const std::string& p_filepath)
+        { _pipelineCacheFilepath = p_filepath; }
         
     private:
         bool OnInitializeInstance();
@@ -91,11 +107,23 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         { return _physicalDevice; }
         const VkPhysicalDeviceFeatures& GetPhysicalDeviceFeatures() const
         { return _physicalDeviceFeatures; }
+        const VkPhysicalDeviceVulkan12Features& GetPhysicalDeviceVulkan12Features() const
+        { return _physicalDeviceVulkan12Features; }
+        // Features needed by bindless descriptor arrays are enabled on the logical device
+        bool IsDescriptorIndexingEnabled() const
+        { return _isDescriptorIndexingEnabled; }
         const VkPhysicalDeviceProperties& GetPhysicalDeviceProperties() const
         { return _physicalDeviceProperties; }
         
         VkDevice GetLogicalDevice() const
         { return _logicalDevice; }
+
+        // Shared by every pipeline creation, VK_NULL_HANDLE if the cache could not be created
+        VkPipelineCache GetVkPipelineCache() const;
+
+        // Every image and buffer memory should come from here, valid between logical device creation and termination
+        DeviceMemoryAllocator* GetMemoryAllocator() const
+        { return _memoryAllocator; }
         
         const std::vector<VkSurfaceFormatKHR>& GetAvailableSurfaceFormats() const 
         { return _availableSurfaceFormats; }
@@ -117,6 +145,9 @@ namespace DeepEngine::Engine::Renderer::Vulkan
 
         const std::vector<VkImageView>& GetSwapChainImageViews() const
         { return  _swapChainImageViews; }
+
+        const std::vector<VkImage>& GetSwapChainImages() const
+        { return _swapChainImages; }
         
         VkSurfaceKHR  GetSurface() const
         { return _surface; }
@@ -171,15 +202,23 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         std::shared_ptr<Core::Events::EventListener<Core::Events::OnCreateGlfwContext>> _glfwWindowCreateListener;
         std::shared_ptr<Core::Events::EventListener<Core::Events::OnWindowFramebufferResized>> _windowFramebufferResizedListener;
         
-        GLFWwindow* _glfwWindow;
+        GLFWwindow* _glfwWindow = nullptr;
+        bool _isHeadless = false;
         VkInstance _instance;
         
         VkPhysicalDevice _physicalDevice = VK_NULL_HANDLE;
         VkPhysicalDeviceProperties _physicalDeviceProperties;
         VkPhysicalDeviceFeatures _physicalDeviceFeatures;
+        // Supported, not enabled, features (pNext is not valid)
+        VkPhysicalDeviceVulkan12Features _physicalDeviceVulkan12Features { };
+        bool _isDescriptorIndexingEnabled = false;
         VkDevice _logicalDevice = VK_NULL_HANDLE;
         std::vector<QueueInstance> _queues;
 
+        std::string _pipelineCacheFilepath = "Cache/PipelineCache.bin";
+        PipelineCache* _pipelineCache = nullptr;
+        DeviceMemoryAllocator* _memoryAllocator = nullptr;
+
         VkSurfaceCapabilitiesKHR _availableSurfaceCapabilities;
         std::vector<VkSurfaceFormatKHR> _availableSurfaceFormats;
         std::vector<VkPresentModeKHR> _availableSurfacePresentModes;
@@ -1,6 +1,8 @@
 #include <stack>
 
 #include "VulkanInstance.h"
+#include "../PipelineCache.h"
+#include "../Memory/DeviceMemoryAllocator.h"
 
 namespace DeepEngine::Engine::Renderer::Vulkan
 {
@@ -15,20 +17,58 @@ namespace DeepEngine::Engine::Renderer::Vulkan
     
     bool VulkanInstance::OnInitializeLogicalDevice()
     {
+        // Feature structures have to outlive vkCreateDevice, so they are not scoped to the blocks filling them
         std::stack<void*> nextPtrStack;
         nextPtrStack.push(nullptr);
 
+        VkPhysicalDeviceSynchronization2Features synchronization2Feature { };
+        synchronization2Feature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
+        synchronization2Feature.pNext = nextPtrStack.top();
+        synchronization2Feature.synchronization2 = VK_TRUE;
+        nextPtrStack.push(&synchronization2Feature);
+
+        if (!_physicalDeviceVulkan12Features.timelineSemaphore)
+        {
+            VULKAN_ERR("Physical device does not support timeline semaphores!");
+            return false;
+        }
+
+        VkPhysicalDeviceVulkan12Features vulkan12Features { };
+        vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        vulkan12Features.pNext = nextPtrStack.top();
+        vulkan12Features.timelineSemaphore = VK_TRUE;
+        nextPtrStack.push(&vulkan12Features);
+
+        // Bindless arrays are optional, renderer binds resources per draw without them
+        const VkPhysicalDeviceVulkan12Features& supported = _physicalDeviceVulkan12Features;
+        _isDescriptorIndexingEnabled = supported.descriptorIndexing
+            && supported.runtimeDescriptorArray
+            && supported.descriptorBindingPartiallyBound
+            && supported.descriptorBindingUpdateUnusedWhilePending
+            && supported.descriptorBindingSampledImageUpdateAfterBind
+            && supported.descriptorBindingStorageBufferUpdateAfterBind
+            && supported.shaderSampledImageArrayNonUniformIndexing
+            && supported.shaderStorageBufferArrayNonUniformIndexing;
+
+        if (_isDescriptorIndexingEnabled)
+        {
+            vulkan12Features.descriptorIndexing = VK_TRUE;
+            vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+            vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+            vulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+            vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+            vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+            vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+            vulkan12Features.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+        }
+        else
         {
-            VkPhysicalDeviceSynchronization2Features feature;
-            feature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
-            feature.pNext = nextPtrStack.top();
-            feature.synchronization2 = true;
-            nextPtrStack.push(&feature);
+            VULKAN_WARN("Physical device does not support descriptor indexing, bindless resources are disabled");
         }
 
+        VkPhysicalDeviceDepthClipEnableFeaturesEXT enableDepthClipFeature { };
         if (IsPhysicalExtensionEnabled(VK_EXT_DEPTH_CLIP_ENABLE_EXTENSION_NAME))
         {
-            VkPhysicalDeviceDepthClipEnableFeaturesEXT enableDepthClipFeature { };
             enableDepthClipFeature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLIP_ENABLE_FEATURES_EXT;
             enableDepthClipFeature.pNext = nextPtrStack.top();
             enableDepthClipFeature.depthClipEnable = VK_TRUE;
@@ -62,21 +102,61 @@ namespace DeepEngine::Engine::Renderer::Vulkan
             vkGetDeviceQueue(_logicalDevice, _queuesCreateInfo[i].queueFamilyIndex, 0, &queue);
             _queueInstances[i].Queue = queue;
         }
+
+        _memoryAllocator = new DeviceMemoryAllocator(_physicalDevice, _logicalDevice);
+
+        // Working without cache only makes pipeline creation slower
+        _pipelineCache = new PipelineCache(_pipelineCacheFilepath);
+        if (!InitializeSubController(_pipelineCache))
+        {
+            VULKAN_WARN("Failed to initialize pipeline cache, pipelines will be compiled from scratch");
+            _pipelineCache->Terminate();
+            _pipelineCache = nullptr;
+        }
         return true;
     }
 
+    VkPipelineCache VulkanInstance::GetVkPipelineCache() const
+    {
+        return _pipelineCache != nullptr ? _pipelineCache->GetVkPipelineCache() : VK_NULL_HANDLE;
+    }
+
     void VulkanInstance::TerminateLogicalDevice()
     {
+        // Child controllers are already terminated, so none of them still holds an allocation
+        delete _memoryAllocator;
+        _memoryAllocator = nullptr;
+
         vkDestroyDevice(_logicalDevice, nullptr);
     }
 
     bool VulkanInstance::TryAddQueueToCreate(const VkQueueFlagBits p_requiredFeatures, const bool p_needSurfaceSupport,
-                                             const QueueInstance ** p_outputInstance)
+                                             const QueueInstance ** p_outputInstance, const VkQueueFlags p_excludedFeatures)
     {
         for (uint32_t i = 0; i < _availableQueueFamilies.size(); i++)
         {
-            VkBool32 supportSurfaces;
-            vkGetPhysicalDeviceSurfaceSupportKHR(_physicalDevice, i, _surface, &supportSurfaces);
+            if (_availableQueueFamilies[i].queueFlags & p_excludedFeatures)
+            {
+                continue;
+            }
+
+            // Only one queue per family is created, device create info can not list the same family twice
+            bool isFamilyUsed = false;
+            for (const VkDeviceQueueCreateInfo& queueCreateInfo : _queuesCreateInfo)
+            {
+                isFamilyUsed |= queueCreateInfo.queueFamilyIndex == i;
+            }
+            if (isFamilyUsed)
+            {
+                continue;
+            }
+
+            // Headless instance has no surface to present to
+            VkBool32 supportSurfaces = VK_FALSE;
+            if (_surface != VK_NULL_HANDLE)
+            {
+                vkGetPhysicalDeviceSurfaceSupportKHR(_physicalDevice, i, _surface, &supportSurfaces);
+            }
 
             if (p_needSurfaceSupport && !supportSurfaces)
             {
@@ -113,7 +193,7 @@ namespace DeepEngine::Engine::Renderer::Vulkan
             }
         }
         
-        p_outputInstance = nullptr;
+        *p_outputInstance = nullptr;
         return false;
     }
 }
@@ -96,6 +96,13 @@ namespace DeepEngine::Engine::Renderer::Vulkan
                 _physicalDevice = device;
                 vkGetPhysicalDeviceProperties(_physicalDevice, &_physicalDeviceProperties);
                 vkGetPhysicalDeviceFeatures(_physicalDevice, &_physicalDeviceFeatures);
+
+                _physicalDeviceVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+                VkPhysicalDeviceFeatures2 features2 { };
+                features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+                features2.pNext = &_physicalDeviceVulkan12Features;
+                vkGetPhysicalDeviceFeatures2(_physicalDevice, &features2);
+                _physicalDeviceVulkan12Features.pNext = nullptr;
                 return true;
             }
         }
@@ -93,7 +93,13 @@ namespace DeepEngine::Engine::Renderer::Vulkan
             vkDestroyImageView(_logicalDevice, _swapChainImageViews[i], nullptr);
         }
 
-        vkDestroySwapchainKHR(_logicalDevice, _swapchain, nullptr);
+        _swapChainImageViews.clear();
+
+        if (_swapchain != VK_NULL_HANDLE)
+        {
+            vkDestroySwapchainKHR(_logicalDevice, _swapchain, nullptr);
+            _swapchain = VK_NULL_HANDLE;
+        }
     }
 
     void VulkanInstance::RecreateSwapChain()
@@ -0,0 +1,573 @@
+#include "DeviceMemoryAllocator.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "Engine/Renderer/Vulkan/Debug/VulkanDebug.h"
+
+namespace DeepEngine::Engine::Renderer::Vulkan
+{
+    DeviceMemoryAllocator::DeviceMemoryAllocator(VkPhysicalDevice p_physicalDevice, VkDevice p_logicalDevice,
+        VkDeviceSize p_preferredBlockSize)
+        : _logicalDevice(p_logicalDevice)
+    {
+        vkGetPhysicalDeviceMemoryProperties(p_physicalDevice, &_memoryProperties);
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(p_physicalDevice, &properties);
+        _nonCoherentAtomSize = properties.limits.nonCoherentAtomSize;
+
+        _pools.resize(_memoryProperties.memoryTypeCount * 4);
+        _dedicatedStatistics.resize(_memoryProperties.memoryTypeCount);
+
+        for (uint32_t typeIndex = 0; typeIndex < _memoryProperties.memoryTypeCount; typeIndex++)
+        {
+            // Small heaps (e.g. 256MB host visible device local) would be eaten by a few blocks
+            const VkDeviceSize heapSize = _memoryProperties.memoryHeaps[_memoryProperties.memoryTypes[typeIndex].heapIndex].size;
+            const VkDeviceSize blockSize = std::min(p_preferredBlockSize, heapSize / 8);
+
+            for (uint32_t linear = 0; linear < 2; linear++)
+            {
+                for (AllocationStrategy strategy : { AllocationStrategy::GENERAL, AllocationStrategy::LINEAR })
+                {
+                    MemoryPool& pool = _pools[GetPoolIndex(typeIndex, linear == 1, strategy)];
+                    pool.MemoryTypeIndex = typeIndex;
+                    pool.ForLinearResources = linear == 1;
+                    pool.Strategy = strategy;
+                    pool.BlockSize = blockSize;
+                }
+            }
+        }
+    }
+
+    DeviceMemoryAllocator::~DeviceMemoryAllocator()
+    {
+        for (MemoryPool& pool : _pools)
+        {
+            for (auto& block : pool.Blocks)
+            {
+                if (!block->IsEmpty())
+                {
+                    VULKAN_WARN("Destroying device memory block with {} allocations still alive (memory type {})",
+                        block->GetAllocationsCount(), pool.MemoryTypeIndex);
+                }
+                DestroyBlock(*block);
+            }
+        }
+
+        for (uint32_t i = 0; i < _dedicatedStatistics.size(); i++)
+        {
+            if (_dedicatedStatistics[i].Count > 0)
+            {
+                VULKAN_WARN("{} dedicated allocations of memory type {} were never freed",
+                    _dedicatedStatistics[i].Count, i);
+            }
+        }
+    }
+
+    bool DeviceMemoryAllocator::AllocateForImage(VkImage p_image, MemoryUsage p_usage,
+        DeviceAllocation* p_outAllocation, AllocationStrategy p_strategy)
+    {
+        VkImageMemoryRequirementsInfo2 requirementsInfo { };
+        requirementsInfo.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+        requirementsInfo.image = p_image;
+
+        VkMemoryDedicatedRequirements dedicatedRequirements { };
+        dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+        VkMemoryRequirements2 requirements { };
+        requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+        requirements.pNext = &dedicatedRequirements;
+
+        vkGetImageMemoryRequirements2(_logicalDevice, &requirementsInfo, &requirements);
+
+        VkMemoryDedicatedAllocateInfo dedicatedInfo { };
+        dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+        dedicatedInfo.image = p_image;
+
+        const bool prefersDedicated = dedicatedRequirements.prefersDedicatedAllocation
+                                   || dedicatedRequirements.requiresDedicatedAllocation;
+
+        if (!Allocate(requirements.memoryRequirements, prefersDedicated, dedicatedInfo, p_usage, false, p_strategy,
+            p_outAllocation))
+        {
+            return false;
+        }
+
+        const VkResult result = vkBindImageMemory(_logicalDevice, p_image, p_outAllocation->Memory,
+            p_outAllocation->Offset);
+        if (result != VK_SUCCESS)
+        {
+            VULKAN_ERR("Failed to bind image memory with returned result {}", string_VkResult(result));
+            Free(*p_outAllocation);
+            return false;
+        }
+        return true;
+    }
+
+    bool DeviceMemoryAllocator::AllocateForBuffer(VkBuffer p_buffer, MemoryUsage p_usage,
+        DeviceAllocation* p_outAllocation, AllocationStrategy p_strategy)
+    {
+        VkBufferMemoryRequirementsInfo2 requirementsInfo { };
+        requirementsInfo.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+        requirementsInfo.buffer = p_buffer;
+
+        VkMemoryDedicatedRequirements dedicatedRequirements { };
+        dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+        VkMemoryRequirements2 requirements { };
+        requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+        requirements.pNext = &dedicatedRequirements;
+
+        vkGetBufferMemoryRequirements2(_logicalDevice, &requirementsInfo, &requirements);
+
+        VkMemoryDedicatedAllocateInfo dedicatedInfo { };
+        dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+        dedicatedInfo.buffer = p_buffer;
+
+        const bool prefersDedicated = dedicatedRequirements.prefersDedicatedAllocation
+                                   || dedicatedRequirements.requiresDedicatedAllocation;
+
+        if (!Allocate(requirements.memoryRequirements, prefersDedicated, dedicatedInfo, p_usage, true, p_strategy,
+            p_outAllocation))
+        {
+            return false;
+        }
+
+        const VkResult result = vkBindBufferMemory(_logicalDevice, p_buffer, p_outAllocation->Memory,
+            p_outAllocation->Offset);
+        if (result != VK_SUCCESS)
+        {
+            VULKAN_ERR("Failed to bind buffer memory with returned result {}", string_VkResult(result));
+            Free(*p_outAllocation);
+            return false;
+        }
+        return true;
+    }
+
+    bool DeviceMemoryAllocator::AllocateForImages(const VkMemoryRequirements& p_requirements, MemoryUsage p_usage,
+        DeviceAllocation* p_outAllocation)
+    {
+        // Not dedicated to any of the images
+        VkMemoryDedicatedAllocateInfo dedicatedInfo { };
+        dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+
+        return Allocate(p_requirements, false, dedicatedInfo, p_usage, false, AllocationStrategy::GENERAL,
+            p_outAllocation);
+    }
+
+    bool DeviceMemoryAllocator::HasLazilyAllocatedMemory(uint32_t p_typeBits) const
+    {
+        for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++)
+        {
+            if ((p_typeBits & (1u << i))
+                && (_memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void DeviceMemoryAllocator::InvalidateMappedMemory(const DeviceAllocation& p_allocation) const
+    {
+        if (!p_allocation.IsValid() || p_allocation.MappedData == nullptr
+            || (_memoryProperties.memoryTypes[p_allocation.MemoryTypeIndex].propertyFlags
+                & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+        {
+            return;
+        }
+
+        // Range has to be aligned to the atom size, or reach the end of the memory
+        VkMappedMemoryRange range { };
+        range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+        range.memory = p_allocation.Memory;
+        range.offset = p_allocation.Offset / _nonCoherentAtomSize * _nonCoherentAtomSize;
+        if (p_allocation.IsDedicated())
+        {
+            range.size = VK_WHOLE_SIZE;
+        }
+        else
+        {
+            const VkDeviceSize end = (p_allocation.Offset + p_allocation.Size + _nonCoherentAtomSize - 1)
+                / _nonCoherentAtomSize * _nonCoherentAtomSize;
+            range.size = std::min(end, p_allocation._block->GetSize()) - range.offset;
+        }
+
+        vkInvalidateMappedMemoryRanges(_logicalDevice, 1, &range);
+    }
+
+    void DeviceMemoryAllocator::Free(DeviceAllocation& p_allocation)
+    {
+        if (!p_allocation.IsValid())
+        {
+            return;
+        }
+
+        std::lock_guard lock(_mutex);
+        FreeLocked(p_allocation);
+    }
+
+    bool DeviceMemoryAllocator::FindMemoryType(uint32_t p_typeBits, MemoryUsage p_usage, uint32_t* p_outTypeIndex) const
+    {
+        VkMemoryPropertyFlags requiredFlags = 0;
+        VkMemoryPropertyFlags preferredFlags = 0;
+
+        switch (p_usage)
+        {
+        case MemoryUsage::GPU_ONLY:
+            preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            break;
+        case MemoryUsage::CPU_TO_GPU:
+            requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            break;
+        case MemoryUsage::GPU_TO_CPU:
+            requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+            preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+            break;
+        case MemoryUsage::GPU_LAZILY_ALLOCATED:
+            preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+            break;
+        }
+
+        // Among types with all required flags pick the one missing the fewest preferred flags and, for GPU only
+        // memory, having the fewest unneeded ones (host visible device local memory is scarce)
+        uint32_t bestType = UINT32_MAX;
+        int bestCost = INT32_MAX;
+
+        for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++)
+        {
+            const VkMemoryPropertyFlags flags = _memoryProperties.memoryTypes[i].propertyFlags;
+            if (!(p_typeBits & (1u << i)) || (flags & requiredFlags) != requiredFlags)
+            {
+                continue;
+            }
+
+            int cost = std::popcount(preferredFlags & ~flags) * 16;
+            if (p_usage == MemoryUsage::GPU_ONLY || p_usage == MemoryUsage::GPU_LAZILY_ALLOCATED)
+            {
+                cost += std::popcount(flags & ~preferredFlags);
+            }
+
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestType = i;
+            }
+        }
+
+        if (bestType == UINT32_MAX)
+        {
+            return false;
+        }
+
+        *p_outTypeIndex = bestType;
+        return true;
+    }
+
+    std::vector<DefragmentationMove> DeviceMemoryAllocator::BeginDefragmentation(uint32_t p_maxMoves)
+    {
+        std::lock_guard lock(_mutex);
+        std::vector<DefragmentationMove> moves;
+
+        for (MemoryPool& pool : _pools)
+        {
+            if (pool.Strategy != AllocationStrategy::GENERAL || pool.Blocks.size() < 2)
+            {
+                continue;
+            }
+
+            // Least used blocks are emptied into the most used ones
+            std::vector<MemoryBlock*> blocks;
+            for (auto& block : pool.Blocks)
+            {
+                blocks.push_back(block.get());
+            }
+            std::sort(blocks.begin(), blocks.end(), [](const MemoryBlock* p_left, const MemoryBlock* p_right)
+            {
+                return p_left->GetUsedBytes() < p_right->GetUsedBytes();
+            });
+
+            // Block which received any allocation can not be emptied anymore
+            size_t firstDestination = blocks.size();
+
+            for (size_t sourceIndex = 0; sourceIndex + 1 < firstDestination && moves.size() < p_maxMoves; sourceIndex++)
+            {
+                MemoryBlock& source = *blocks[sourceIndex];
+
+                source.Tlsf->ForEachAllocation([&](uint32_t p_node, uint64_t p_offset, uint64_t p_size)
+                {
+                    if (moves.size() >= p_maxMoves)
+                    {
+                        return;
+                    }
+
+                    DefragmentationMove move;
+                    move.Source.Memory = source.Memory;
+                    move.Source.Offset = p_offset;
+                    move.Source.Size = p_size;
+                    move.Source.MappedData = source.MappedData != nullptr ? source.MappedData + p_offset : nullptr;
+                    move.Source.MemoryTypeIndex = pool.MemoryTypeIndex;
+                    move.Source._block = &source;
+                    move.Source._node = p_node;
+
+                    // Alignment of the original request is not stored, but the source offset satisfied it
+                    const VkDeviceSize alignment = p_offset != 0
+                        ? std::min<VkDeviceSize>(p_offset & ~(p_offset - 1), MAX_DEFRAGMENTATION_ALIGNMENT)
+                        : MAX_DEFRAGMENTATION_ALIGNMENT;
+
+                    for (size_t i = blocks.size() - 1; i > sourceIndex; i--)
+                    {
+                        if (AllocateFromBlock(*blocks[i], p_size, alignment, pool.MemoryTypeIndex, &move.Destination))
+                        {
+                            firstDestination = std::min(firstDestination, i);
+                            moves.push_back(move);
+                            break;
+                        }
+                    }
+                });
+            }
+        }
+
+        return moves;
+    }
+
+    void DeviceMemoryAllocator::EndDefragmentation(std::vector<DefragmentationMove>& p_moves)
+    {
+        std::lock_guard lock(_mutex);
+
+        for (DefragmentationMove& move : p_moves)
+        {
+            FreeLocked(move.Source);
+        }
+        p_moves.clear();
+    }
+
+    MemoryTypeStatistics DeviceMemoryAllocator::GetStatistics(uint32_t p_memoryTypeIndex) const
+    {
+        std::lock_guard lock(_mutex);
+        MemoryTypeStatistics statistics;
+
+        for (bool linear : { false, true })
+        {
+            for (AllocationStrategy strategy : { AllocationStrategy::GENERAL, AllocationStrategy::LINEAR })
+            {
+                const MemoryPool& pool = _pools[GetPoolIndex(p_memoryTypeIndex, linear, strategy)];
+                for (const auto& block : pool.Blocks)
+                {
+                    statistics.BlocksCount++;
+                    statistics.BlocksBytes += block->GetSize();
+                    statistics.UsedBytes += block->GetUsedBytes();
+                    statistics.AllocationsCount += block->GetAllocationsCount();
+                }
+            }
+        }
+
+        statistics.DedicatedAllocationsCount = _dedicatedStatistics[p_memoryTypeIndex].Count;
+        statistics.DedicatedBytes = _dedicatedStatistics[p_memoryTypeIndex].Bytes;
+        return statistics;
+    }
+
+    bool DeviceMemoryAllocator::Allocate(const VkMemoryRequirements& p_requirements, bool p_prefersDedicated,
+        const VkMemoryDedicatedAllocateInfo& p_dedicatedInfo, MemoryUsage p_usage, bool p_isLinearResource,
+        AllocationStrategy p_strategy, DeviceAllocation* p_outAllocation)
+    {
+        uint32_t memoryTypeIndex;
+        if (!FindMemoryType(p_requirements.memoryTypeBits, p_usage, &memoryTypeIndex))
+        {
+            VULKAN_ERR("No memory type supports requested usage (type bits: {:#x})", p_requirements.memoryTypeBits);
+            return false;
+        }
+
+        std::lock_guard lock(_mutex);
+
+        const uint32_t poolIndex = GetPoolIndex(memoryTypeIndex, p_isLinearResource, p_strategy);
+        MemoryPool& pool = _pools[poolIndex];
+
+        if (p_prefersDedicated || p_requirements.size > pool.BlockSize / 2)
+        {
+            return AllocateDedicated(p_requirements.size, memoryTypeIndex, &p_dedicatedInfo, p_outAllocation);
+        }
+
+        for (auto& block : pool.Blocks)
+        {
+            if (AllocateFromBlock(*block, p_requirements.size, p_requirements.alignment, memoryTypeIndex,
+                p_outAllocation))
+            {
+                return true;
+            }
+        }
+
+        if (MemoryBlock* block = CreateBlock(poolIndex))
+        {
+            if (AllocateFromBlock(*block, p_requirements.size, p_requirements.alignment, memoryTypeIndex,
+                p_outAllocation))
+            {
+                return true;
+            }
+        }
+
+        // Heap is too full for another block, exact size allocation may still fit
+        return AllocateDedicated(p_requirements.size, memoryTypeIndex, nullptr, p_outAllocation);
+    }
+
+    bool DeviceMemoryAllocator::AllocateFromBlock(MemoryBlock& p_block, VkDeviceSize p_size, VkDeviceSize p_alignment,
+        uint32_t p_memoryTypeIndex, DeviceAllocation* p_outAllocation) const
+    {
+        uint64_t offset;
+        uint32_t node = 0;
+
+        if (p_block.Tlsf)
+        {
+            node = p_block.Tlsf->Allocate(p_size, p_alignment, &offset);
+            if (node == TlsfBlockMetadata::INVALID_NODE)
+            {
+                return false;
+            }
+        }
+        else if (!p_block.Linear->Allocate(p_size, p_alignment, &offset))
+        {
+            return false;
+        }
+
+        *p_outAllocation = DeviceAllocation { };
+        p_outAllocation->Memory = p_block.Memory;
+        p_outAllocation->Offset = offset;
+        p_outAllocation->Size = p_size;
+        p_outAllocation->MappedData = p_block.MappedData != nullptr ? p_block.MappedData + offset : nullptr;
+        p_outAllocation->MemoryTypeIndex = p_memoryTypeIndex;
+        p_outAllocation->_block = &p_block;
+        p_outAllocation->_node = node;
+        return true;
+    }
+
+    bool DeviceMemoryAllocator::AllocateDedicated(VkDeviceSize p_size, uint32_t p_memoryTypeIndex,
+        const VkMemoryDedicatedAllocateInfo* p_dedicatedInfo, DeviceAllocation* p_outAllocation)
+    {
+        VkMemoryAllocateInfo allocateInfo { };
+        allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocateInfo.pNext = p_dedicatedInfo;
+        allocateInfo.allocationSize = p_size;
+        allocateInfo.memoryTypeIndex = p_memoryTypeIndex;
+
+        VkDeviceMemory memory;
+        const VkResult result = vkAllocateMemory(_logicalDevice, &allocateInfo, nullptr, &memory);
+        if (result != VK_SUCCESS)
+        {
+            VULKAN_ERR("Failed to allocate {} bytes of device memory with returned result {}",
+                p_size, string_VkResult(result));
+            return false;
+        }
+
+        void* mappedData = nullptr;
+        if (IsHostVisible(p_memoryTypeIndex))
+        {
+            vkMapMemory(_logicalDevice, memory, 0, VK_WHOLE_SIZE, 0, &mappedData);
+        }
+
+        *p_outAllocation = DeviceAllocation { };
+        p_outAllocation->Memory = memory;
+        p_outAllocation->Size = p_size;
+        p_outAllocation->MappedData = mappedData;
+        p_outAllocation->MemoryTypeIndex = p_memoryTypeIndex;
+
+        _dedicatedStatistics[p_memoryTypeIndex].Count++;
+        _dedicatedStatistics[p_memoryTypeIndex].Bytes += p_size;
+        return true;
+    }
+
+    MemoryBlock* DeviceMemoryAllocator::CreateBlock(uint32_t p_poolIndex)
+    {
+        MemoryPool& pool = _pools[p_poolIndex];
+
+        VkMemoryAllocateInfo allocateInfo { };
+        allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocateInfo.allocationSize = pool.BlockSize;
+        allocateInfo.memoryTypeIndex = pool.MemoryTypeIndex;
+
+        auto block = std::make_unique<MemoryBlock>();
+        const VkResult result = vkAllocateMemory(_logicalDevice, &allocateInfo, nullptr, &block->Memory);
+        if (result != VK_SUCCESS)
+        {
+            VULKAN_WARN("Failed to allocate {} bytes memory block (memory type {}) with returned result {}",
+                pool.BlockSize, pool.MemoryTypeIndex, string_VkResult(result));
+            return nullptr;
+        }
+
+        if (IsHostVisible(pool.MemoryTypeIndex))
+        {
+            void* mappedData;
+            vkMapMemory(_logicalDevice, block->Memory, 0, VK_WHOLE_SIZE, 0, &mappedData);
+            block->MappedData = static_cast<uint8_t*>(mappedData);
+        }
+
+        block->PoolIndex = p_poolIndex;
+        if (pool.Strategy == AllocationStrategy::GENERAL)
+        {
+            block->Tlsf.emplace(pool.BlockSize);
+        }
+        else
+        {
+            block->Linear.emplace(pool.BlockSize);
+        }
+
+        VULKAN_TRACE("Created {} bytes memory block (memory type {})", pool.BlockSize, pool.MemoryTypeIndex);
+        return pool.Blocks.emplace_back(std::move(block)).get();
+    }
+
+    void DeviceMemoryAllocator::DestroyBlock(MemoryBlock& p_block) const
+    {
+        // Freeing memory implicitly unmaps it
+        vkFreeMemory(_logicalDevice, p_block.Memory, nullptr);
+    }
+
+    void DeviceMemoryAllocator::ReleaseEmptyBlocks(MemoryPool& p_pool)
+    {
+        bool keptEmptyBlock = false;
+        std::erase_if(p_pool.Blocks, [&](const std::unique_ptr<MemoryBlock>& p_block)
+        {
+            if (!p_block->IsEmpty())
+            {
+                return false;
+            }
+
+            if (!keptEmptyBlock)
+            {
+                keptEmptyBlock = true;
+                return false;
+            }
+
+            DestroyBlock(*p_block);
+            return true;
+        });
+    }
+
+    void DeviceMemoryAllocator::FreeLocked(DeviceAllocation& p_allocation)
+    {
+        if (p_allocation.IsDedicated())
+        {
+            vkFreeMemory(_logicalDevice, p_allocation.Memory, nullptr);
+            _dedicatedStatistics[p_allocation.MemoryTypeIndex].Count--;
+            _dedicatedStatistics[p_allocation.MemoryTypeIndex].Bytes -= p_allocation.Size;
+        }
+        else
+        {
+            MemoryBlock& block = *p_allocation._block;
+            if (block.Tlsf)
+            {
+                block.Tlsf->Free(p_allocation._node);
+            }
+            else
+            {
+                block.Linear->Free(p_allocation.Size);
+            }
+
+            if (block.IsEmpty())
+            {
+                ReleaseEmptyBlocks(_pools[block.PoolIndex]);
+            }
+        }
+
+        p_allocation = DeviceAllocation { };
+    }
+}
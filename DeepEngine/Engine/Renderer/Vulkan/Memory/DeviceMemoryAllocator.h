@@ -0,0 +1,204 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "Engine/Renderer/Vulkan/VulkanPCH.h"
+#include "LinearBlockMetadata.h"
+#include "TlsfBlockMetadata.h"
+
+namespace DeepEngine::Engine::Renderer::Vulkan
+{
+
+    enum class MemoryUsage
+    {
+        // Device local, not visible from the host (render targets, static geometry)
+        GPU_ONLY,
+        // Host visible and coherent, written by CPU and read by GPU (staging, per frame data)
+        CPU_TO_GPU,
+        // Host visible, preferably cached, written by GPU and read back by CPU
+        GPU_TO_CPU,
+        // Lazily allocated when available, backed only when tile memory does not suffice (transient attachments).
+        // Same as GPU_ONLY on devices without such memory
+        GPU_LAZILY_ALLOCATED,
+    };
+
+    enum class AllocationStrategy
+    {
+        // TLSF sub-allocation, any allocation can be freed at any time
+        GENERAL,
+        // Bump allocation, block is reclaimed only when all its allocations are freed
+        LINEAR,
+    };
+
+    struct MemoryBlock;
+
+    struct DeviceAllocation
+    {
+        VkDeviceMemory Memory = VK_NULL_HANDLE;
+        VkDeviceSize Offset = 0;
+        VkDeviceSize Size = 0;
+        // Points at Offset, block is mapped for its whole life. nullptr if memory is not host visible
+        void* MappedData = nullptr;
+        uint32_t MemoryTypeIndex = UINT32_MAX;
+
+        bool IsValid() const
+        { return Memory != VK_NULL_HANDLE; }
+
+        bool IsDedicated() const
+        { return IsValid() && _block == nullptr; }
+
+    private:
+        friend class DeviceMemoryAllocator;
+
+        MemoryBlock* _block = nullptr;
+        uint32_t _node = 0;
+    };
+
+    struct MemoryTypeStatistics
+    {
+        uint32_t BlocksCount = 0;
+        VkDeviceSize BlocksBytes = 0;
+        VkDeviceSize UsedBytes = 0;
+        uint32_t AllocationsCount = 0;
+        uint32_t DedicatedAllocationsCount = 0;
+        VkDeviceSize DedicatedBytes = 0;
+    };
+
+    // Destination is already allocated, owner has to copy the data, rebind (recreate) the resource and
+    // pass the move to EndDefragmentation, which frees the source
+    struct DefragmentationMove
+    {
+        DeviceAllocation Source;
+        DeviceAllocation Destination;
+    };
+
+    struct MemoryBlock
+    {
+        VkDeviceMemory Memory = VK_NULL_HANDLE;
+        uint8_t* MappedData = nullptr;
+        uint32_t PoolIndex = 0;
+
+        std::optional<TlsfBlockMetadata> Tlsf;
+        std::optional<LinearBlockMetadata> Linear;
+
+        VkDeviceSize GetSize() const
+        { return Tlsf ? Tlsf->GetSize() : Linear->GetSize(); }
+
+        VkDeviceSize GetUsedBytes() const
+        { return Tlsf ? Tlsf->GetUsedBytes() : Linear->GetUsedBytes(); }
+
+        uint32_t GetAllocationsCount() const
+        { return Tlsf ? Tlsf->GetAllocationsCount() : Linear->GetAllocationsCount(); }
+
+        bool IsEmpty() const
+        { return GetAllocationsCount() == 0; }
+    };
+
+    // Sub-allocates resources from big VkDeviceMemory blocks, one set of blocks per memory type.
+    // Linear (buffers) and optimal (images) resources never share a block, so bufferImageGranularity never has
+    // to be respected between neighbours. Allocations the driver prefers to be dedicated, and those bigger than
+    // half of a block, get their own VkDeviceMemory.
+    // Allocator is owned by VulkanInstance and destroyed right before the logical device, after every controller.
+    // All methods are thread safe.
+    class DeviceMemoryAllocator
+    {
+    public:
+        static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+        DeviceMemoryAllocator(VkPhysicalDevice p_physicalDevice, VkDevice p_logicalDevice,
+            VkDeviceSize p_preferredBlockSize = DEFAULT_BLOCK_SIZE);
+        ~DeviceMemoryAllocator();
+
+        DeviceMemoryAllocator(const DeviceMemoryAllocator&) = delete;
+        DeviceMemoryAllocator& operator=(const DeviceMemoryAllocator&) = delete;
+
+        // Allocates and binds memory
+        bool AllocateForImage(VkImage p_image, MemoryUsage p_usage, DeviceAllocation* p_outAllocation,
+            AllocationStrategy p_strategy = AllocationStrategy::GENERAL);
+        bool AllocateForBuffer(VkBuffer p_buffer, MemoryUsage p_usage, DeviceAllocation* p_outAllocation,
+            AllocationStrategy p_strategy = AllocationStrategy::GENERAL);
+        // Memory for optimal tiling images the caller binds itself, e.g. several images aliasing one allocation
+        bool AllocateForImages(const VkMemoryRequirements& p_requirements, MemoryUsage p_usage,
+            DeviceAllocation* p_outAllocation);
+
+        // True when one of p_typeBits is lazily allocated memory
+        bool HasLazilyAllocatedMemory(uint32_t p_typeBits) const;
+
+        // Makes device writes to mapped memory visible to the host, needed after GPU_TO_CPU memory was written
+        // (it is preferably cached, so it may not be coherent). Does nothing for coherent memory
+        void InvalidateMappedMemory(const DeviceAllocation& p_allocation) const;
+
+        // Resets the allocation to invalid one, freeing invalid allocation does nothing
+        void Free(DeviceAllocation& p_allocation);
+
+        // Returns false if none of p_typeBits supports the usage
+        bool FindMemoryType(uint32_t p_typeBits, MemoryUsage p_usage, uint32_t* p_outTypeIndex) const;
+
+        // Plans moving allocations out of the least used general blocks into the most used blocks of the same
+        // pool, so the emptied blocks can be released. Heavy fragmentation is expected to be rare (render targets
+        // are recreated in bulk on resize), so this is meant to be called at most once in a while
+        std::vector<DefragmentationMove> BeginDefragmentation(uint32_t p_maxMoves);
+        void EndDefragmentation(std::vector<DefragmentationMove>& p_moves);
+
+        MemoryTypeStatistics GetStatistics(uint32_t p_memoryTypeIndex) const;
+
+        const VkPhysicalDeviceMemoryProperties& GetMemoryProperties() const
+        { return _memoryProperties; }
+
+    private:
+        struct MemoryPool
+        {
+            uint32_t MemoryTypeIndex;
+            bool ForLinearResources;
+            AllocationStrategy Strategy;
+            VkDeviceSize BlockSize;
+            std::vector<std::unique_ptr<MemoryBlock>> Blocks;
+        };
+
+        // Biggest alignment any resource realistically requires (sparse/64KB texture pages)
+        static constexpr VkDeviceSize MAX_DEFRAGMENTATION_ALIGNMENT = 64 * 1024;
+
+        struct DedicatedStatistics
+        {
+            uint32_t Count = 0;
+            VkDeviceSize Bytes = 0;
+        };
+
+        bool Allocate(const VkMemoryRequirements& p_requirements, bool p_prefersDedicated,
+            const VkMemoryDedicatedAllocateInfo& p_dedicatedInfo, MemoryUsage p_usage, bool p_isLinearResource,
+            AllocationStrategy p_strategy, DeviceAllocation* p_outAllocation);
+
+        bool AllocateFromBlock(MemoryBlock& p_block, VkDeviceSize p_size, VkDeviceSize p_alignment,
+            uint32_t p_memoryTypeIndex, DeviceAllocation* p_outAllocation) const;
+        bool AllocateDedicated(VkDeviceSize p_size, uint32_t p_memoryTypeIndex,
+            const VkMemoryDedicatedAllocateInfo* p_dedicatedInfo, DeviceAllocation* p_outAllocation);
+
+        MemoryBlock* CreateBlock(uint32_t p_poolIndex);
+        void DestroyBlock(MemoryBlock& p_block) const;
+        // Keeps at most one empty block per pool, so alloc/free at block boundary does not hit the driver each time
+        void ReleaseEmptyBlocks(MemoryPool& p_pool);
+        void FreeLocked(DeviceAllocation& p_allocation);
+
+        uint32_t GetPoolIndex(uint32_t p_memoryTypeIndex, bool p_isLinearResource, AllocationStrategy p_strategy) const
+        {
+            return (p_memoryTypeIndex * 2 + (p_isLinearResource ? 1 : 0)) * 2
+                + (p_strategy == AllocationStrategy::LINEAR ? 1 : 0);
+        }
+
+        bool IsHostVisible(uint32_t p_memoryTypeIndex) const
+        {
+            return _memoryProperties.memoryTypes[p_memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+        }
+
+    private:
+        const VkDevice _logicalDevice;
+        VkPhysicalDeviceMemoryProperties _memoryProperties;
+        VkDeviceSize _nonCoherentAtomSize;
+
+        mutable std::mutex _mutex;
+        std::vector<MemoryPool> _pools;
+        std::vector<DedicatedStatistics> _dedicatedStatistics;
+    };
+
+}
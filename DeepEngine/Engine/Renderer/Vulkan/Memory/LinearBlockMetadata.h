@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+
+namespace DeepEngine::Engine::Renderer::Vulkan
+{
+
+    // Bump allocator for short living resources (per frame uploads, transient targets).
+    // Individual frees only count down, range is reclaimed when the last allocation of the block is freed.
+    class LinearBlockMetadata
+    {
+    public:
+        explicit LinearBlockMetadata(uint64_t p_size)
+            : _size(p_size)
+        { }
+
+        bool Allocate(uint64_t p_size, uint64_t p_alignment, uint64_t* p_outOffset)
+        {
+            p_alignment = p_alignment > 0 ? p_alignment : 1;
+            const uint64_t offset = (_offset + p_alignment - 1) / p_alignment * p_alignment;
+            if (p_size == 0 || offset + p_size > _size)
+            {
+                return false;
+            }
+
+            *p_outOffset = offset;
+            _offset = offset + p_size;
+            _usedBytes += p_size;
+            _allocationsCount++;
+            return true;
+        }
+
+        void Free(uint64_t p_size)
+        {
+            _usedBytes -= p_size;
+            if (--_allocationsCount == 0)
+            {
+                _offset = 0;
+            }
+        }
+
+        uint64_t GetSize() const
+        { return _size; }
+
+        uint64_t GetUsedBytes() const
+        { return _usedBytes; }
+
+        uint32_t GetAllocationsCount() const
+        { return _allocationsCount; }
+
+        bool IsEmpty() const
+        { return _allocationsCount == 0; }
+
+    private:
+        const uint64_t _size;
+        uint64_t _offset = 0;
+        uint64_t _usedBytes = 0;
+        uint32_t _allocationsCount = 0;
+    };
+
+}
@@ -0,0 +1,282 @@
+#include "TlsfBlockMetadata.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace DeepEngine::Engine::Renderer::Vulkan
+{
+    TlsfBlockMetadata::TlsfBlockMetadata(uint64_t p_size)
+        : _size(p_size)
+    {
+        for (auto& firstLevel : _freeLists)
+        {
+            for (uint32_t& list : firstLevel)
+            {
+                list = INVALID_NODE;
+            }
+        }
+
+        _firstPhysical = CreateNode();
+        Node& node = _nodes[_firstPhysical];
+        node.Offset = 0;
+        node.Size = p_size;
+        InsertFree(_firstPhysical);
+    }
+
+    uint32_t TlsfBlockMetadata::Allocate(uint64_t p_size, uint64_t p_alignment, uint64_t* p_outOffset)
+    {
+        if (p_size == 0 || p_size > _size - _usedBytes)
+        {
+            return INVALID_NODE;
+        }
+
+        p_alignment = std::max<uint64_t>(p_alignment, 1);
+        // Any range from the found list fits the request regardless of where its offset lies
+        const uint64_t searchSize = p_size + p_alignment - 1;
+
+        uint32_t firstLevel, secondLevel;
+        if (!FindSuitableList(searchSize, &firstLevel, &secondLevel))
+        {
+            return INVALID_NODE;
+        }
+
+        uint32_t node = _freeLists[firstLevel][secondLevel];
+        RemoveFree(node);
+
+        const uint64_t offset = _nodes[node].Offset;
+        const uint64_t alignedOffset = (offset + p_alignment - 1) / p_alignment * p_alignment;
+
+        // Alignment padding goes back to the free lists as its own range
+        if (alignedOffset != offset)
+        {
+            SplitFront(node, alignedOffset - offset);
+            const uint32_t padding = node;
+            node = _nodes[node].NextPhysical;
+
+            // Padding may be mergeable with preceding free range
+            const uint32_t previous = _nodes[padding].PrevPhysical;
+            if (previous != INVALID_NODE && _nodes[previous].IsFree)
+            {
+                RemoveFree(previous);
+                MergeWithNext(previous);
+                InsertFree(previous);
+            }
+            else
+            {
+                InsertFree(padding);
+            }
+        }
+
+        if (_nodes[node].Size > p_size)
+        {
+            SplitFront(node, p_size);
+            InsertFree(_nodes[node].NextPhysical);
+        }
+
+        _nodes[node].IsFree = false;
+        _usedBytes += p_size;
+        _allocationsCount++;
+
+        *p_outOffset = alignedOffset;
+        return node;
+    }
+
+    void TlsfBlockMetadata::Free(uint32_t p_node)
+    {
+        _usedBytes -= _nodes[p_node].Size;
+        _allocationsCount--;
+
+        const uint32_t next = _nodes[p_node].NextPhysical;
+        if (next != INVALID_NODE && _nodes[next].IsFree)
+        {
+            RemoveFree(next);
+            MergeWithNext(p_node);
+        }
+
+        const uint32_t previous = _nodes[p_node].PrevPhysical;
+        if (previous != INVALID_NODE && _nodes[previous].IsFree)
+        {
+            RemoveFree(previous);
+            MergeWithNext(previous);
+            p_node = previous;
+        }
+
+        InsertFree(p_node);
+    }
+
+    void TlsfBlockMetadata::ForEachAllocation(const std::function<void(uint32_t, uint64_t, uint64_t)>& p_callback) const
+    {
+        for (uint32_t node = _firstPhysical; node != INVALID_NODE; node = _nodes[node].NextPhysical)
+        {
+            if (!_nodes[node].IsFree)
+            {
+                p_callback(node, _nodes[node].Offset, _nodes[node].Size);
+            }
+        }
+    }
+
+    void TlsfBlockMetadata::MapSize(uint64_t p_size, uint32_t* p_firstLevel, uint32_t* p_secondLevel)
+    {
+        if (p_size < (1ull << SMALL_SIZE_BITS))
+        {
+            *p_firstLevel = 0;
+            *p_secondLevel = static_cast<uint32_t>(p_size >> (SMALL_SIZE_BITS - SECOND_LEVEL_BITS));
+            return;
+        }
+
+        const uint32_t mostSignificantBit = 63 - std::countl_zero(p_size);
+        *p_firstLevel = mostSignificantBit - SMALL_SIZE_BITS + 1;
+        *p_secondLevel = static_cast<uint32_t>(p_size >> (mostSignificantBit - SECOND_LEVEL_BITS)) & (SECOND_LEVEL_COUNT - 1);
+    }
+
+    bool TlsfBlockMetadata::FindSuitableList(uint64_t p_size, uint32_t* p_firstLevel, uint32_t* p_secondLevel) const
+    {
+        // Round up to the next size class, so every range of the list is big enough
+        if (p_size >= (1ull << SMALL_SIZE_BITS))
+        {
+            const uint32_t mostSignificantBit = 63 - std::countl_zero(p_size);
+            const uint64_t classSize = 1ull << (mostSignificantBit - SECOND_LEVEL_BITS);
+            p_size += classSize - 1;
+        }
+        else
+        {
+            p_size += (1ull << (SMALL_SIZE_BITS - SECOND_LEVEL_BITS)) - 1;
+        }
+
+        uint32_t firstLevel, secondLevel;
+        MapSize(p_size, &firstLevel, &secondLevel);
+        if (firstLevel >= FIRST_LEVEL_COUNT)
+        {
+            return false;
+        }
+
+        uint32_t secondLevelMap = _secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+        if (secondLevelMap == 0)
+        {
+            const uint64_t firstLevelMap = firstLevel + 1 < 64 ? _firstLevelBitmap & (~0ull << (firstLevel + 1)) : 0;
+            if (firstLevelMap == 0)
+            {
+                return false;
+            }
+
+            firstLevel = std::countr_zero(firstLevelMap);
+            secondLevelMap = _secondLevelBitmaps[firstLevel];
+        }
+
+        *p_firstLevel = firstLevel;
+        *p_secondLevel = std::countr_zero(secondLevelMap);
+        return true;
+    }
+
+    uint32_t TlsfBlockMetadata::CreateNode()
+    {
+        uint32_t node;
+        if (!_unusedNodes.empty())
+        {
+            node = _unusedNodes.back();
+            _unusedNodes.pop_back();
+        }
+        else
+        {
+            node = static_cast<uint32_t>(_nodes.size());
+            _nodes.emplace_back();
+        }
+
+        _nodes[node] = Node { 0, 0, INVALID_NODE, INVALID_NODE, INVALID_NODE, INVALID_NODE, false };
+        return node;
+    }
+
+    void TlsfBlockMetadata::ReleaseNode(uint32_t p_node)
+    {
+        _unusedNodes.push_back(p_node);
+    }
+
+    void TlsfBlockMetadata::InsertFree(uint32_t p_node)
+    {
+        uint32_t firstLevel, secondLevel;
+        MapSize(_nodes[p_node].Size, &firstLevel, &secondLevel);
+
+        Node& node = _nodes[p_node];
+        node.IsFree = true;
+        node.PrevFree = INVALID_NODE;
+        node.NextFree = _freeLists[firstLevel][secondLevel];
+        if (node.NextFree != INVALID_NODE)
+        {
+            _nodes[node.NextFree].PrevFree = p_node;
+        }
+
+        _freeLists[firstLevel][secondLevel] = p_node;
+        _firstLevelBitmap |= 1ull << firstLevel;
+        _secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+    }
+
+    void TlsfBlockMetadata::RemoveFree(uint32_t p_node)
+    {
+        Node& node = _nodes[p_node];
+
+        if (node.NextFree != INVALID_NODE)
+        {
+            _nodes[node.NextFree].PrevFree = node.PrevFree;
+        }
+
+        if (node.PrevFree != INVALID_NODE)
+        {
+            _nodes[node.PrevFree].NextFree = node.NextFree;
+        }
+        else
+        {
+            uint32_t firstLevel, secondLevel;
+            MapSize(node.Size, &firstLevel, &secondLevel);
+
+            _freeLists[firstLevel][secondLevel] = node.NextFree;
+            if (node.NextFree == INVALID_NODE)
+            {
+                _secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+                if (_secondLevelBitmaps[firstLevel] == 0)
+                {
+                    _firstLevelBitmap &= ~(1ull << firstLevel);
+                }
+            }
+        }
+
+        node.IsFree = false;
+        node.PrevFree = INVALID_NODE;
+        node.NextFree = INVALID_NODE;
+    }
+
+    void TlsfBlockMetadata::SplitFront(uint32_t p_node, uint64_t p_size)
+    {
+        const uint32_t remainder = CreateNode();
+        Node& node = _nodes[p_node];
+        Node& remainderNode = _nodes[remainder];
+
+        remainderNode.Offset = node.Offset + p_size;
+        remainderNode.Size = node.Size - p_size;
+        remainderNode.PrevPhysical = p_node;
+        remainderNode.NextPhysical = node.NextPhysical;
+
+        if (node.NextPhysical != INVALID_NODE)
+        {
+            _nodes[node.NextPhysical].PrevPhysical = remainder;
+        }
+
+        node.Size = p_size;
+        node.NextPhysical = remainder;
+    }
+
+    void TlsfBlockMetadata::MergeWithNext(uint32_t p_node)
+    {
+        const uint32_t next = _nodes[p_node].NextPhysical;
+        Node& node = _nodes[p_node];
+        const Node& nextNode = _nodes[next];
+
+        node.Size += nextNode.Size;
+        node.NextPhysical = nextNode.NextPhysical;
+        if (node.NextPhysical != INVALID_NODE)
+        {
+            _nodes[node.NextPhysical].PrevPhysical = p_node;
+        }
+
+        ReleaseNode(next);
+    }
+}
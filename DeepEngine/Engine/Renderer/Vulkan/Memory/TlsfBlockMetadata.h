@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace DeepEngine::Engine::Renderer::Vulkan
+{
+
+    // Two-level segregated fit sub-allocator of a single device memory block.
+    // Free ranges are kept in lists indexed by size class (first level - power of two, second level - linear
+    // subdivision of it) with bitmaps of non-empty lists, so both allocation and free are O(1). Neighbouring
+    // free ranges are merged on free. Metadata lives on CPU only, the block memory is never touched.
+    class TlsfBlockMetadata
+    {
+    public:
+        static constexpr uint32_t INVALID_NODE = UINT32_MAX;
+
+        explicit TlsfBlockMetadata(uint64_t p_size);
+
+        // Returns node identifying the allocation (INVALID_NODE if there is no free range big enough)
+        uint32_t Allocate(uint64_t p_size, uint64_t p_alignment, uint64_t* p_outOffset);
+        void Free(uint32_t p_node);
+
+        // Calls p_callback(node, offset, size) for every allocation, in offset order
+        void ForEachAllocation(const std::function<void(uint32_t, uint64_t, uint64_t)>& p_callback) const;
+
+        uint64_t GetSize() const
+        { return _size; }
+
+        uint64_t GetUsedBytes() const
+        { return _usedBytes; }
+
+        uint32_t GetAllocationsCount() const
+        { return _allocationsCount; }
+
+        bool IsEmpty() const
+        { return _allocationsCount == 0; }
+
+    private:
+        static constexpr uint32_t SECOND_LEVEL_BITS = 4;
+        static constexpr uint32_t SECOND_LEVEL_COUNT = 1 << SECOND_LEVEL_BITS;
+        // Sizes below 2^SMALL_SIZE_BITS share the first list level and are split linearly
+        static constexpr uint32_t SMALL_SIZE_BITS = 8;
+        static constexpr uint32_t FIRST_LEVEL_COUNT = 64 - SMALL_SIZE_BITS + 1;
+
+        struct Node
+        {
+            uint64_t Offset;
+            uint64_t Size;
+            uint32_t PrevPhysical;
+            uint32_t NextPhysical;
+            uint32_t PrevFree;
+            uint32_t NextFree;
+            bool IsFree;
+        };
+
+        static void MapSize(uint64_t p_size, uint32_t* p_firstLevel, uint32_t* p_secondLevel);
+        // Finds non-empty list whose every range is at least p_size big
+        bool FindSuitableList(uint64_t p_size, uint32_t* p_firstLevel, uint32_t* p_secondLevel) const;
+
+        uint32_t CreateNode();
+        void ReleaseNode(uint32_t p_node);
+
+        void InsertFree(uint32_t p_node);
+        void RemoveFree(uint32_t p_node);
+        // Splits p_size bytes off the front of the node, the rest becomes a new free node
+        void SplitFront(uint32_t p_node, uint64_t p_size);
+        void MergeWithNext(uint32_t p_node);
+
+    private:
+        const uint64_t _size;
+        uint64_t _usedBytes = 0;
+        uint32_t _allocationsCount = 0;
+
+        std::vector<Node> _nodes;
+        std::vector<uint32_t> _unusedNodes;
+        uint32_t _firstPhysical;
+
+        uint64_t _firstLevelBitmap = 0;
+        uint32_t _secondLevelBitmaps[FIRST_LEVEL_COUNT] { };
+        uint32_t _freeLists[FIRST_LEVEL_COUNT][SECOND_LEVEL_COUNT];
+    };
+
+}
@@ -0,0 +1,192 @@
+#include "PipelineCache.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "Debug/Timing.h"
+
+namespace DeepEngine::Engine::Renderer::Vulkan
+{
+    PipelineCache::PipelineCache(std::string p_filepath)
+        : _filepath(std::move(p_filepath))
+    { }
+
+    bool PipelineCache::OnInitialize()
+    {
+        TIMER("Load pipeline cache");
+        
+        const std::vector<char> cacheData = LoadCacheData();
+        _wasLoadedFromDisk = !cacheData.empty();
+
+        VkPipelineCacheCreateInfo createInfo { };
+        createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        createInfo.initialDataSize = cacheData.size();
+        createInfo.pInitialData = cacheData.empty() ? nullptr : cacheData.data();
+
+        VULKAN_CHECK_CREATE(
+            vkCreatePipelineCache(
+                GetVulkanInstanceController()->GetLogicalDevice(),
+                &createInfo,
+                nullptr,
+                &_pipelineCache),
+            "Failed to create pipeline cache!")
+
+        if (_wasLoadedFromDisk)
+        {
+            VULKAN_INFO("Loaded pipeline cache \"{}\" ({} bytes)", _filepath, cacheData.size());
+        }
+        else
+        {
+            VULKAN_INFO("Starting with empty pipeline cache, it will be saved to \"{}\"", _filepath);
+        }
+        return true;
+    }
+
+    void PipelineCache::OnTerminate()
+    {
+        if (_pipelineCache == VK_NULL_HANDLE)
+        {
+            return;
+        }
+        
+        Save();
+        vkDestroyPipelineCache(GetVulkanInstanceController()->GetLogicalDevice(), _pipelineCache, nullptr);
+    }
+
+    bool PipelineCache::Save() const
+    {
+        const VkDevice device = GetVulkanInstanceController()->GetLogicalDevice();
+
+        size_t dataSize = 0;
+        if (vkGetPipelineCacheData(device, _pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+        {
+            VULKAN_WARN("Failed to get pipeline cache data, cache will not be saved");
+            return false;
+        }
+
+        std::vector<char> data(dataSize);
+        const VkResult result = vkGetPipelineCacheData(device, _pipelineCache, &dataSize, data.data());
+        if (result != VK_SUCCESS)
+        {
+            VULKAN_WARN("Failed to get pipeline cache data with returned result {}", string_VkResult(result));
+            return false;
+        }
+
+        FileHeader header = CreateDeviceHeader();
+        header.DataSize = dataSize;
+        header.DataHash = HashData(data.data(), dataSize);
+
+        const std::filesystem::path path(_filepath);
+        const std::filesystem::path temporaryPath = std::filesystem::path(path).concat(".tmp");
+
+        std::error_code error;
+        if (path.has_parent_path())
+        {
+            std::filesystem::create_directories(path.parent_path(), error);
+        }
+
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+            file.write(data.data(), static_cast<std::streamsize>(dataSize));
+
+            if (!file.good())
+            {
+                VULKAN_WARN("Failed to write pipeline cache to \"{}\"", temporaryPath.string());
+                return false;
+            }
+        }
+
+        // Replaces existing cache in one step
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error)
+        {
+            VULKAN_WARN("Failed to replace pipeline cache \"{}\": {}", _filepath, error.message());
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+
+        VULKAN_INFO("Saved pipeline cache \"{}\" ({} bytes)", _filepath, dataSize);
+        return true;
+    }
+
+    PipelineCache::FileHeader PipelineCache::CreateDeviceHeader() const
+    {
+        const VkPhysicalDeviceProperties& properties = GetVulkanInstanceController()->GetPhysicalDeviceProperties();
+
+        FileHeader header { };
+        header.Magic = FILE_MAGIC;
+        header.Version = FILE_VERSION;
+        header.VendorID = properties.vendorID;
+        header.DeviceID = properties.deviceID;
+        header.DriverVersion = properties.driverVersion;
+        memcpy(header.PipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+        return header;
+    }
+
+    std::vector<char> PipelineCache::LoadCacheData() const
+    {
+        std::ifstream file(_filepath, std::ios::binary);
+        if (!file.is_open())
+        {
+            return { };
+        }
+
+        FileHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(FileHeader));
+        if (!file.good())
+        {
+            VULKAN_WARN("Pipeline cache \"{}\" is truncated, ignoring it", _filepath);
+            return { };
+        }
+
+        const FileHeader deviceHeader = CreateDeviceHeader();
+        if (header.Magic != FILE_MAGIC || header.Version != FILE_VERSION)
+        {
+            VULKAN_WARN("Pipeline cache \"{}\" has unknown format, ignoring it", _filepath);
+            return { };
+        }
+
+        // Driver would reject mismatching UUID on its own, but driver update can keep the UUID and still
+        // make old binaries useless or harmful
+        if (header.VendorID != deviceHeader.VendorID
+            || header.DeviceID != deviceHeader.DeviceID
+            || header.DriverVersion != deviceHeader.DriverVersion
+            || memcmp(header.PipelineCacheUUID, deviceHeader.PipelineCacheUUID, VK_UUID_SIZE) != 0)
+        {
+            VULKAN_INFO("Pipeline cache \"{}\" was created for different device or driver, ignoring it", _filepath);
+            return { };
+        }
+
+        // Size field of a damaged file can be anything, it must not decide how much is allocated
+        std::error_code error;
+        const uintmax_t fileSize = std::filesystem::file_size(_filepath, error);
+        if (error || fileSize < sizeof(FileHeader) || header.DataSize != fileSize - sizeof(FileHeader))
+        {
+            VULKAN_WARN("Pipeline cache \"{}\" size does not match its header, ignoring it", _filepath);
+            return { };
+        }
+
+        std::vector<char> data(header.DataSize);
+        file.read(data.data(), static_cast<std::streamsize>(header.DataSize));
+        if (!file.good() || HashData(data.data(), data.size()) != header.DataHash)
+        {
+            VULKAN_WARN("Pipeline cache \"{}\" is corrupted, ignoring it", _filepath);
+            return { };
+        }
+
+        return data;
+    }
+
+    uint64_t PipelineCache::HashData(const char* p_data, size_t p_size)
+    {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < p_size; i++)
+        {
+            hash ^= static_cast<uint8_t>(p_data[i]);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "Controller/BaseVulkanController.h"
+#include "Instance/VulkanInstance.h"
+
+namespace DeepEngine::Engine::Renderer::Vulkan
+{
+
+    // VkPipelineCache persisted between launches.
+    // Cache file starts with our own header, so data saved by a different GPU or driver version is dropped before
+    // it reaches the driver. Saving writes to a temporary file and renames it over the old one, so crash
+    // in the middle of saving never leaves a truncated cache behind.
+    // Vulkan pipeline cache is internally synchronized, it can be shared by pipelines created on many threads.
+    class PipelineCache final : public BaseVulkanController
+    {
+    public:
+        PipelineCache(std::string p_filepath);
+        ~PipelineCache() override = default;
+
+        VkPipelineCache GetVkPipelineCache() const
+        { return _pipelineCache; }
+
+        // False on first launch or when the saved cache did not match the device
+        bool WasLoadedFromDisk() const
+        { return _wasLoadedFromDisk; }
+
+        bool Save() const;
+
+    protected:
+        bool OnInitialize() override;
+        void OnTerminate() override;
+
+    private:
+        struct FileHeader
+        {
+            uint32_t Magic;
+            uint32_t Version;
+            uint32_t VendorID;
+            uint32_t DeviceID;
+            uint32_t DriverVersion;
+            uint8_t PipelineCacheUUID[VK_UUID_SIZE];
+            uint64_t DataSize;
+            uint64_t DataHash;
+        };
+
+        static constexpr uint32_t FILE_MAGIC = 0x43505044; // "DPPC"
+        static constexpr uint32_t FILE_VERSION = 1;
+
+        FileHeader CreateDeviceHeader() const;
+        std::vector<char> LoadCacheData() const;
+
+        static uint64_t HashData(const char* p_data, size_t p_size);
+
+    private:
+        const std::string _filepath;
+
+        VkPipelineCache _pipelineCache = VK_NULL_HANDLE;
+        bool _wasLoadedFromDisk = false;
+    };
+    
+}
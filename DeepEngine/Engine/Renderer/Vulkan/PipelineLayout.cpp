@@ -2,18 +2,79 @@
 
 namespace DeepEngine::Engine::Renderer::Vulkan
 {
-    PipelineLayout::PipelineLayout(RenderPass* p_renderPass, uint32_t p_subPassIndex)
-        : _renderPass(p_renderPass), _subPassIndex(p_subPassIndex)
+    PipelineLayout::PipelineLayout(RenderPass* p_renderPass, uint32_t p_subPassIndex,
+        const std::vector<const DescriptorSetLayout*>& p_setLayouts,
+        const std::vector<VkPushConstantRange>& p_pushConstantRanges)
+        : _subPassIndex(p_subPassIndex), _renderPass(p_renderPass), _setLayouts(p_setLayouts),
+        _pushConstantRanges(p_pushConstantRanges)
     { }
 
+    bool PipelineLayout::HasSamePushConstantRanges(const PipelineLayout* p_other) const
+    {
+        if (p_other == this)
+        {
+            return true;
+        }
+
+        if (p_other == nullptr || p_other->_pushConstantRanges.size() != _pushConstantRanges.size())
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < _pushConstantRanges.size(); i++)
+        {
+            const VkPushConstantRange& range = _pushConstantRanges[i];
+            const VkPushConstantRange& otherRange = p_other->_pushConstantRanges[i];
+
+            if (range.stageFlags != otherRange.stageFlags
+                || range.offset != otherRange.offset
+                || range.size != otherRange.size)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool PipelineLayout::IsCompatibleForSet(const PipelineLayout* p_other, uint32_t p_setIndex) const
+    {
+        if (p_other == this)
+        {
+            return p_setIndex < _setLayouts.size();
+        }
+
+        if (p_other == nullptr
+            || p_setIndex >= _setLayouts.size()
+            || p_setIndex >= p_other->_setLayouts.size()
+            || !HasSamePushConstantRanges(p_other))
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i <= p_setIndex; i++)
+        {
+            if (!_setLayouts[i]->IsDefinedSameAs(p_other->_setLayouts[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
     bool PipelineLayout::OnInitialize()
     {
+        std::vector<VkDescriptorSetLayout> setLayouts(_setLayouts.size());
+        for (uint32_t i = 0; i < _setLayouts.size(); i++)
+        {
+            setLayouts[i] = _setLayouts[i]->GetVkDescriptorSetLayout();
+        }
+
         VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo { };
         pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutCreateInfo.setLayoutCount = 0;
-        pipelineLayoutCreateInfo.pSetLayouts = nullptr;
-        pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-        pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
+        pipelineLayoutCreateInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+        pipelineLayoutCreateInfo.pSetLayouts = setLayouts.data();
+        pipelineLayoutCreateInfo.pushConstantRangeCount = static_cast<uint32_t>(_pushConstantRanges.size());
+        pipelineLayoutCreateInfo.pPushConstantRanges = _pushConstantRanges.data();
 
         VULKAN_CHECK_CREATE(
             vkCreatePipelineLayout(
@@ -1,5 +1,6 @@
 #pragma once
 #include "Controller/BaseVulkanController.h"
+#include "DescriptorSetLayout.h"
 #include "RenderPass.h"
 
 namespace DeepEngine::Engine::Renderer::Vulkan
@@ -7,10 +8,15 @@ namespace DeepEngine::Engine::Renderer::Vulkan
 
     class RenderPass;
 
+    // Render pass is nullptr for compute pipelines. Set layouts are referenced, they have to outlive the layout.
+    // Pipelines sharing a layout (or using compatible ones) keep bound descriptor sets and push constants
+    // when switched between, so share one layout per kind of pipelines whenever possible.
     class PipelineLayout : public BaseVulkanController
     {
     public:
-        PipelineLayout(RenderPass* p_renderPass, uint32_t p_subPassIndex);
+        PipelineLayout(RenderPass* p_renderPass, uint32_t p_subPassIndex,
+            const std::vector<const DescriptorSetLayout*>& p_setLayouts = { },
+            const std::vector<VkPushConstantRange>& p_pushConstantRanges = { });
         ~PipelineLayout() override = default;
 
         RenderPass* GetRenderPass() const
@@ -22,6 +28,18 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         VkPipelineLayout GetVkPipelineLayout() const
         { return _pipelineLayout; }
 
+        const std::vector<const DescriptorSetLayout*>& GetSetLayouts() const
+        { return _setLayouts; }
+
+        const std::vector<VkPushConstantRange>& GetPushConstantRanges() const
+        { return _pushConstantRanges; }
+
+        // Push constants stay valid across pipelines with layouts of identical ranges
+        bool HasSamePushConstantRanges(const PipelineLayout* p_other) const;
+
+        // Sets [0, p_setIndex] bound with one layout stay valid for the other one (Vulkan layout compatibility)
+        bool IsCompatibleForSet(const PipelineLayout* p_other, uint32_t p_setIndex) const;
+
     protected:
         bool OnInitialize() final;
         void OnTerminate() final;
@@ -30,6 +48,8 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         VkPipelineLayout _pipelineLayout = VK_NULL_HANDLE;
         const uint32_t _subPassIndex;
         RenderPass* _renderPass;
+        const std::vector<const DescriptorSetLayout*> _setLayouts;
+        const std::vector<VkPushConstantRange> _pushConstantRanges;
     };
     
 }
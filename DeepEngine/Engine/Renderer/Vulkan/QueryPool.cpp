@@ -0,0 +1,217 @@
+#include "QueryPool.h"
+
+namespace DeepEngine::Engine::Renderer::Vulkan
+{
+    QueryPool::QueryPool(const VulkanInstance::QueueInstance* p_queue, uint32_t p_framesCount,
+        uint32_t p_maxScopesPerFrame, bool p_enablePipelineStatistics)
+        : _queue(p_queue), _framesCount(p_framesCount), _maxScopesPerFrame(p_maxScopesPerFrame),
+        _enablePipelineStatistics(p_enablePipelineStatistics)
+    { }
+
+    bool QueryPool::OnInitialize()
+    {
+        VulkanInstance* vulkanInstance = GetVulkanInstanceController();
+
+        _frames.resize(_framesCount);
+        for (FrameScopes& frame : _frames)
+        {
+            frame.Names.reserve(_maxScopesPerFrame);
+        }
+        _results.reserve(_maxScopesPerFrame);
+        _readbackBuffer.resize(_maxScopesPerFrame * std::max(2u, STATISTICS_COUNT));
+
+        const uint32_t validBits = _queue->Family[_queue->FamilyIndex].timestampValidBits;
+        if (validBits == 0)
+        {
+            VULKAN_WARN("Queue family {} does not support timestamps, GPU scopes will not be measured", _queue->FamilyIndex);
+            return true;
+        }
+
+        _timestampMask = validBits >= 64 ? UINT64_MAX : (1ull << validBits) - 1;
+        _timestampPeriod = vulkanInstance->GetPhysicalDeviceProperties().limits.timestampPeriod;
+
+        VkQueryPoolCreateInfo timestampCreateInfo { };
+        timestampCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        timestampCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        timestampCreateInfo.queryCount = _framesCount * _maxScopesPerFrame * 2;
+
+        VULKAN_CHECK_CREATE(
+            vkCreateQueryPool(
+                vulkanInstance->GetLogicalDevice(),
+                &timestampCreateInfo,
+                nullptr,
+                &_timestampPool),
+            "Failed to create timestamp query pool!")
+
+        if (!_enablePipelineStatistics)
+        {
+            return true;
+        }
+
+        if (!vulkanInstance->GetPhysicalDeviceFeatures().pipelineStatisticsQuery)
+        {
+            VULKAN_WARN("Pipeline statistics queries are not supported by the device, GPU scopes will contain only timings");
+            return true;
+        }
+
+        VkQueryPoolCreateInfo statisticsCreateInfo { };
+        statisticsCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        statisticsCreateInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        statisticsCreateInfo.queryCount = _framesCount * _maxScopesPerFrame;
+        statisticsCreateInfo.pipelineStatistics = STATISTICS_FLAGS;
+
+        VULKAN_CHECK_CREATE(
+            vkCreateQueryPool(
+                vulkanInstance->GetLogicalDevice(),
+                &statisticsCreateInfo,
+                nullptr,
+                &_statisticsPool),
+            "Failed to create pipeline statistics query pool!")
+
+        return true;
+    }
+
+    void QueryPool::OnTerminate()
+    {
+        if (_statisticsPool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(GetVulkanInstanceController()->GetLogicalDevice(), _statisticsPool, nullptr);
+        }
+        if (_timestampPool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(GetVulkanInstanceController()->GetLogicalDevice(), _timestampPool, nullptr);
+        }
+    }
+
+    void QueryPool::BeginFrame(VkCommandBuffer p_commandBuffer, uint32_t p_frameIndex)
+    {
+        _currentFrameSlot = p_frameIndex % _framesCount;
+
+        if (_timestampPool == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        // Queries of this slot were submitted framesCount frames ago
+        CollectFrameResults(_currentFrameSlot);
+
+        FrameScopes& frame = _frames[_currentFrameSlot];
+        frame.Names.clear();
+        frame.WasRecorded = true;
+
+        vkCmdResetQueryPool(p_commandBuffer, _timestampPool,
+            _currentFrameSlot * _maxScopesPerFrame * 2, _maxScopesPerFrame * 2);
+
+        if (_statisticsPool != VK_NULL_HANDLE)
+        {
+            vkCmdResetQueryPool(p_commandBuffer, _statisticsPool,
+                _currentFrameSlot * _maxScopesPerFrame, _maxScopesPerFrame);
+        }
+    }
+
+    uint32_t QueryPool::BeginScope(VkCommandBuffer p_commandBuffer, const char* p_name)
+    {
+        if (_timestampPool == VK_NULL_HANDLE)
+        {
+            return UINT32_MAX;
+        }
+
+        FrameScopes& frame = _frames[_currentFrameSlot];
+        if (frame.Names.size() >= _maxScopesPerFrame)
+        {
+            VULKAN_WARN("Exceeded limit of {} GPU scopes per frame, \"{}\" will not be measured", _maxScopesPerFrame, p_name);
+            return UINT32_MAX;
+        }
+
+        const uint32_t scopeID = static_cast<uint32_t>(frame.Names.size());
+        frame.Names.push_back(p_name);
+
+        vkCmdWriteTimestamp(p_commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _timestampPool,
+            (_currentFrameSlot * _maxScopesPerFrame + scopeID) * 2);
+
+        if (_statisticsPool != VK_NULL_HANDLE)
+        {
+            vkCmdBeginQuery(p_commandBuffer, _statisticsPool, _currentFrameSlot * _maxScopesPerFrame + scopeID, 0);
+        }
+
+        return scopeID;
+    }
+
+    void QueryPool::EndScope(VkCommandBuffer p_commandBuffer, uint32_t p_scopeID)
+    {
+        if (p_scopeID == UINT32_MAX)
+        {
+            return;
+        }
+
+        if (_statisticsPool != VK_NULL_HANDLE)
+        {
+            vkCmdEndQuery(p_commandBuffer, _statisticsPool, _currentFrameSlot * _maxScopesPerFrame + p_scopeID);
+        }
+
+        vkCmdWriteTimestamp(p_commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _timestampPool,
+            (_currentFrameSlot * _maxScopesPerFrame + p_scopeID) * 2 + 1);
+    }
+
+    void QueryPool::CollectFrameResults(uint32_t p_frameSlot)
+    {
+        const FrameScopes& frame = _frames[p_frameSlot];
+        const uint32_t scopesCount = static_cast<uint32_t>(frame.Names.size());
+
+        if (!frame.WasRecorded || scopesCount == 0)
+        {
+            return;
+        }
+
+        const VkDevice device = GetVulkanInstanceController()->GetLogicalDevice();
+
+        // No WAIT flag, VK_NOT_READY just keeps the previous results
+        VkResult result = vkGetQueryPoolResults(device, _timestampPool,
+            p_frameSlot * _maxScopesPerFrame * 2, scopesCount * 2,
+            scopesCount * 2 * sizeof(uint64_t), _readbackBuffer.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+        if (result != VK_SUCCESS)
+        {
+            return;
+        }
+
+        _results.resize(scopesCount);
+        for (uint32_t i = 0; i < scopesCount; i++)
+        {
+            _results[i] = GpuScopeResult { };
+            _results[i].Name = frame.Names[i];
+            _results[i].Milliseconds = TimestampsToMilliseconds(_readbackBuffer[i * 2], _readbackBuffer[i * 2 + 1]);
+        }
+
+        if (_statisticsPool == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        result = vkGetQueryPoolResults(device, _statisticsPool,
+            p_frameSlot * _maxScopesPerFrame, scopesCount,
+            scopesCount * STATISTICS_COUNT * sizeof(uint64_t), _readbackBuffer.data(),
+            STATISTICS_COUNT * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+        if (result != VK_SUCCESS)
+        {
+            return;
+        }
+
+        for (uint32_t i = 0; i < scopesCount; i++)
+        {
+            const uint64_t* statistics = &_readbackBuffer[i * STATISTICS_COUNT];
+            _results[i].HasStatistics = true;
+            _results[i].InputAssemblyVertices = statistics[0];
+            _results[i].VertexShaderInvocations = statistics[1];
+            _results[i].ClippingPrimitives = statistics[2];
+            _results[i].FragmentShaderInvocations = statistics[3];
+        }
+    }
+
+    float QueryPool::TimestampsToMilliseconds(uint64_t p_begin, uint64_t p_end) const
+    {
+        const uint64_t ticks = ((p_end & _timestampMask) - (p_begin & _timestampMask)) & _timestampMask;
+        return static_cast<float>(static_cast<double>(ticks) * _timestampPeriod / 1000000.0);
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include "Controller/BaseVulkanController.h"
+#include "Instance/VulkanInstance.h"
+
+#define GPU_SCOPE(QueryPoolPtr, CommandBuffer, Name)                                                \
+    DeepEngine::Engine::Renderer::Vulkan::GpuScope __gpuScope(QueryPoolPtr, CommandBuffer, Name)
+
+namespace DeepEngine::Engine::Renderer::Vulkan
+{
+
+    struct GpuScopeResult
+    {
+        const char* Name;
+        float Milliseconds;
+
+        bool HasStatistics;
+        uint64_t InputAssemblyVertices;
+        uint64_t VertexShaderInvocations;
+        uint64_t ClippingPrimitives;
+        uint64_t FragmentShaderInvocations;
+    };
+
+    // Named GPU scopes measured with timestamp (and optionally pipeline statistics) queries.
+    // Every frame slot owns its own range of queries. Results of a slot are read back without waiting when the slot
+    // is reused (framesCount frames later), so collecting never stalls the CPU - if GPU is not done yet, previous
+    // results are kept.
+    class QueryPool final : public BaseVulkanController
+    {
+    public:
+        QueryPool(const VulkanInstance::QueueInstance* p_queue, uint32_t p_framesCount, uint32_t p_maxScopesPerFrame,
+            bool p_enablePipelineStatistics);
+        ~QueryPool() override = default;
+
+        // Has to be recorded outside of render pass, before any scope of given frame (in submission order)
+        void BeginFrame(VkCommandBuffer p_commandBuffer, uint32_t p_frameIndex);
+
+        // Name has to outlive the results (string literal), returns UINT32_MAX if scope could not be opened
+        // (EndScope ignores such ID). Statistics query is active for the whole scope, so scope has to begin and end
+        // either outside of render pass or inside the same subpass
+        uint32_t BeginScope(VkCommandBuffer p_commandBuffer, const char* p_name);
+        void EndScope(VkCommandBuffer p_commandBuffer, uint32_t p_scopeID);
+
+        bool IsTimestampSupported() const
+        { return _timestampPool != VK_NULL_HANDLE; }
+
+        bool IsPipelineStatisticsSupported() const
+        { return _statisticsPool != VK_NULL_HANDLE; }
+
+        // Statistics which may be active while executing secondary command buffers,
+        // has to be passed in their inheritance info (requires inheritedQueries feature)
+        VkQueryPipelineStatisticFlags GetActivePipelineStatistics() const
+        { return IsPipelineStatisticsSupported() ? STATISTICS_FLAGS : 0; }
+
+        // Results of the most recent frame which was fully available
+        const std::vector<GpuScopeResult>& GetResults() const
+        { return _results; }
+
+    protected:
+        bool OnInitialize() override;
+        void OnTerminate() override;
+
+    private:
+        struct FrameScopes
+        {
+            std::vector<const char*> Names;
+            bool WasRecorded = false;
+        };
+
+        void CollectFrameResults(uint32_t p_frameSlot);
+
+        float TimestampsToMilliseconds(uint64_t p_begin, uint64_t p_end) const;
+
+    private:
+        static constexpr uint32_t STATISTICS_COUNT = 4;
+        // Results are written in bit order, has to match STATISTICS_COUNT and CollectFrameResults
+        static constexpr VkQueryPipelineStatisticFlags STATISTICS_FLAGS =
+            VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT
+            | VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT
+            | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT
+            | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+        const VulkanInstance::QueueInstance* _queue;
+        const uint32_t _framesCount;
+        const uint32_t _maxScopesPerFrame;
+        const bool _enablePipelineStatistics;
+
+        VkQueryPool _timestampPool = VK_NULL_HANDLE;
+        VkQueryPool _statisticsPool = VK_NULL_HANDLE;
+        uint64_t _timestampMask = UINT64_MAX;
+        double _timestampPeriod = 1.0;
+
+        uint32_t _currentFrameSlot = 0;
+        std::vector<FrameScopes> _frames;
+        std::vector<GpuScopeResult> _results;
+        std::vector<uint64_t> _readbackBuffer;
+    };
+
+    class GpuScope
+    {
+    public:
+        GpuScope(QueryPool* p_queryPool, VkCommandBuffer p_commandBuffer, const char* p_name)
+            : _queryPool(p_queryPool), _commandBuffer(p_commandBuffer)
+        {
+            _scopeID = _queryPool != nullptr ? _queryPool->BeginScope(_commandBuffer, p_name) : UINT32_MAX;
+        }
+
+        ~GpuScope()
+        {
+            if (_queryPool != nullptr)
+            {
+                _queryPool->EndScope(_commandBuffer, _scopeID);
+            }
+        }
+
+        GpuScope(const GpuScope&) = delete;
+        GpuScope& operator=(const GpuScope&) = delete;
+
+    private:
+        QueryPool* _queryPool;
+        VkCommandBuffer _commandBuffer;
+        uint32_t _scopeID;
+    };
+
+}
@@ -1,35 +1,33 @@
 #include "ShaderModule.h"
 
-#include <fstream>
-
 namespace DeepEngine::Engine::Renderer::Vulkan
 {
-    ShaderModule::ShaderModule(const std::string& p_filepath, VkShaderStageFlagBits p_shaderStage)
-        : _filepath(p_filepath), _shaderStageFlags(p_shaderStage)
+    ShaderModule::ShaderModule(const std::string& p_name, std::span<const uint32_t> p_code,
+        VkShaderStageFlagBits p_shaderStage)
+        : _name(p_name), _code(p_code), _shaderStageFlags(p_shaderStage)
     { }
 
     bool ShaderModule::OnInitialize()
     {
-        const auto shaderCode = ReadFile();
-
-        if (shaderCode.empty())
+        if (_code.empty())
         {
-            VULKAN_ERR("Failed to load shader from filepath: \"{}\". Loaded files size {}", _filepath, shaderCode.size());
+            VULKAN_ERR("Failed to create shader module \"{}\", it has no code", _name);
             return false;
         }
             
         VkShaderModuleCreateInfo createInfo { };
         createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = shaderCode.size();
-        createInfo.pCode = reinterpret_cast<const uint32_t*>(shaderCode.data());
+        createInfo.codeSize = _code.size_bytes();
+        createInfo.pCode = _code.data();
+
+        const VkResult result = vkCreateShaderModule(
+            GetVulkanInstanceController()->GetLogicalDevice(),
+            &createInfo,
+            nullptr,
+            &_shaderModule);
+        _code = { };
 
-        VULKAN_CHECK_CREATE(
-            vkCreateShaderModule(
-                GetVulkanInstanceController()->GetLogicalDevice(),
-                &createInfo,
-                nullptr,
-                &_shaderModule),
-            "Failed to create Vulkan Shader Module!")
+        VULKAN_CHECK_CREATE(result, "Failed to create Vulkan Shader Module!")
             
         return true;
     }
@@ -38,23 +36,4 @@ namespace DeepEngine::Engine::Renderer::Vulkan
     {
         vkDestroyShaderModule(GetVulkanInstanceController()->GetLogicalDevice(), _shaderModule, nullptr);
     }
-
-    std::vector<char> ShaderModule::ReadFile() const
-    {
-        std::ifstream file(_filepath, std::ios::ate | std::ios::binary);
-
-        if (!file.is_open())
-        {
-            return std::vector<char> { };
-        }
-
-        size_t fileSize = file.tellg();
-        std::vector<char> buffer(fileSize);
-
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
-        file.close();
-
-        return buffer;
-    }
 }
@@ -1,4 +1,6 @@
 #pragma once
+#include <span>
+
 #include "Controller/BaseVulkanController.h"
 #include "Instance/VulkanInstance.h"
 
@@ -9,7 +11,8 @@ namespace DeepEngine::Engine::Renderer::Vulkan
     class ShaderModule final : public BaseVulkanController
     {
     public:
-        ShaderModule(const std::string& p_filepath, VkShaderStageFlagBits p_shaderStage);
+        // Code is only read while initializing, it does not have to outlive it (see ShaderLibrary)
+        ShaderModule(const std::string& p_name, std::span<const uint32_t> p_code, VkShaderStageFlagBits p_shaderStage);
         ~ShaderModule() override = default;
 
         VkPipelineShaderStageCreateInfo GetShaderStageCreateInfo() const
@@ -25,6 +28,9 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         VkShaderModule GetShaderModule() const
         { return  _shaderModule; }
 
+        const std::string& GetName() const
+        { return  _name; }
+
         const std::string& GetShaderFuncName() const
         { return  _shaderFuncName; }
 
@@ -36,10 +42,8 @@ namespace DeepEngine::Engine::Renderer::Vulkan
         void OnTerminate() final;
 
     private:
-        std::vector<char> ReadFile() const;
-
-    private:
-        const std::string _filepath;
+        const std::string _name;
+        std::span<const uint32_t> _code;
         const VkShaderStageFlagBits _shaderStageFlags;
         
         const std::string _shaderFuncName = "main";
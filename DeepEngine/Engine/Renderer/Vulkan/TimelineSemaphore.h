@@ -0,0 +1,78 @@
+#pragma once
+#include "Controller/BaseVulkanController.h"
+#include "Debug/VulkanDebug.h"
+#include "Instance/VulkanInstance.h"
+
+namespace DeepEngine::Engine::Renderer::Vulkan
+{
+
+    // Semaphore with a monotonically growing 64 bit counter, signaled and waited by value from both
+    // queue submissions (VkTimelineSemaphoreSubmitInfo) and the host
+    class TimelineSemaphore final : public BaseVulkanController
+    {
+    public:
+        TimelineSemaphore(uint64_t p_initialValue = 0) : _initialValue(p_initialValue)
+        { }
+        ~TimelineSemaphore() override = default;
+
+        VkSemaphore GetVkSemaphore() const
+        { return _semaphore; }
+
+        const VkSemaphore* GetVkSemaphorePtr() const
+        { return &_semaphore; }
+
+        // Last value signaled on the GPU, does not block
+        uint64_t GetCompletedValue() const
+        {
+            uint64_t value = 0;
+            vkGetSemaphoreCounterValue(GetVulkanInstanceController()->GetLogicalDevice(), _semaphore, &value);
+            return value;
+        }
+
+        // Returns false on timeout
+        bool Wait(uint64_t p_value, uint64_t p_timeout = UINT64_MAX) const
+        {
+            VkSemaphoreWaitInfo waitInfo { };
+            waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+            waitInfo.semaphoreCount = 1;
+            waitInfo.pSemaphores = &_semaphore;
+            waitInfo.pValues = &p_value;
+
+            return vkWaitSemaphores(GetVulkanInstanceController()->GetLogicalDevice(), &waitInfo, p_timeout) == VK_SUCCESS;
+        }
+
+    protected:
+        bool OnInitialize() override
+        {
+            VkSemaphoreTypeCreateInfo typeCreateInfo { };
+            typeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+            typeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+            typeCreateInfo.initialValue = _initialValue;
+
+            VkSemaphoreCreateInfo createInfo { };
+            createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            createInfo.pNext = &typeCreateInfo;
+            createInfo.flags = 0;
+
+            VULKAN_CHECK_CREATE(
+                vkCreateSemaphore(
+                    GetVulkanInstanceController()->GetLogicalDevice(),
+                    &createInfo,
+                    nullptr,
+                    &_semaphore),
+                "Failed to create Vulkan timeline Semaphore!")
+
+            return true;
+        }
+
+        void OnTerminate() override
+        {
+            vkDestroySemaphore(GetVulkanInstanceController()->GetLogicalDevice(), _semaphore, nullptr);
+        }
+
+    private:
+        const uint64_t _initialValue;
+        VkSemaphore _semaphore = VK_NULL_HANDLE;
+    };
+
+}
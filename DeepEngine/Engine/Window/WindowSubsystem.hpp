@@ -30,6 +30,8 @@ namespace DeepEngine
         { return _wantToExit; }
         
     protected:
+        static constexpr int LogLevelFloor = DEEP_LOG_LEVEL_WINDOW;
+
         bool Init() override;
         void Destroy() override {}
         void Tick(const Core::Scene::Scene& p_scene) override;
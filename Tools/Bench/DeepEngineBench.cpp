@@ -0,0 +1,407 @@
+// Renderer benchmark, runs deterministic scenarios on the headless renderer and writes frame time statistics as JSON.
+// Usage: DeepEngineBench [--frames N] [--scenario name]... [--output results.json] [--list]
+// Every scenario gets its own renderer. Frames are measured only after all pipelines are compiled, GPU time is the
+// sum of render graph pass scopes (read back framesInFlight frames later, so it trails the CPU samples).
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+
+#include "Core/EngineSystem.h"
+#include "Core/Events/EventBus.h"
+#include "Core/Scene/Scene.h"
+#include "Debug/Logger.h"
+#include "Engine/Renderer/RendererSubsystem.h"
+
+using namespace DeepEngine;
+using Engine::Renderer::RendererSubsystem;
+using Engine::Renderer::RendererWorkload;
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchSceneElement final : Core::Scene::SceneElement
+{
+    constexpr const char* GetTypeName() const override
+    { return "BenchSceneElement"; }
+};
+
+struct Scenario
+{
+    const char* Name;
+    RendererWorkload Workload;
+    // Scene has fixed 64KB storage, it fits about 900 elements
+    uint32_t SceneElements = 0;
+    // Quads covering the middle of the screen on top of the scene elements, each one nearer than the previous
+    uint32_t SceneLayers = 0;
+    uint32_t FramesInFlight = RendererSubsystem::DEFAULT_FRAMES_IN_FLIGHT;
+    // Pipeline cache file is deleted before the run, so startup compiles every pipeline from scratch
+    bool IsColdStart = false;
+};
+
+struct SampleStatistics
+{
+    double Mean = 0.0;
+    double P50 = 0.0;
+    double P95 = 0.0;
+    double P99 = 0.0;
+    double Max = 0.0;
+};
+
+struct ScenarioResult
+{
+    const Scenario* Source;
+    bool Succeeded = false;
+    double StartupMilliseconds = 0.0;
+    double PipelinesReadyMilliseconds = 0.0;
+    uint32_t WarmupFrames = 0;
+    std::vector<double> CpuMilliseconds;
+    std::vector<double> GpuMilliseconds;
+    uint64_t FragmentInvocations = 0;
+    uint64_t FailedAllocations = 0;
+    Engine::Renderer::DrawListStatistics Draws;
+    Engine::Renderer::UploadQueueStatistics Uploads;
+};
+
+// Frames ticked while pipelines compile before the scenario gives up on them
+static constexpr uint32_t MAX_WARMUP_FRAMES = 10'000;
+static constexpr const char* PIPELINE_CACHE_FILEPATH = "Cache/PipelineCache.bin";
+
+static std::vector<Scenario> CreateScenarios()
+{
+    std::vector<Scenario> scenarios;
+
+    // Demo scene: three renderers, 10k instance grid culled on the GPU
+    scenarios.push_back({ .Name = "baseline" });
+
+    RendererWorkload triangles { };
+    triangles.InstancesGridSize = 0;
+    triangles.TriangleDraws = 1'000;
+    scenarios.push_back({ .Name = "triangles_1k", .Workload = triangles });
+    triangles.TriangleDraws = 10'000;
+    scenarios.push_back({ .Name = "triangles_10k", .Workload = triangles });
+
+    // Scaling of parallel draw recording, names count every recording thread. With one the render thread records
+    // inline, the single-threaded baseline
+    triangles.RecordingThreads = 1;
+    scenarios.push_back({ .Name = "triangles_10k_threads_1", .Workload = triangles });
+    triangles.RecordingThreads = 2;
+    scenarios.push_back({ .Name = "triangles_10k_threads_2", .Workload = triangles });
+    triangles.RecordingThreads = 4;
+    scenarios.push_back({ .Name = "triangles_10k_threads_4", .Workload = triangles });
+    triangles.RecordingThreads = 8;
+    scenarios.push_back({ .Name = "triangles_10k_threads_8", .Workload = triangles });
+
+    // CPU ahead of the GPU by more frames hides more latency
+    triangles.TriangleDraws = 1'000;
+    triangles.RecordingThreads = 0;
+    scenarios.push_back({ .Name = "frames_in_flight_1", .Workload = triangles, .FramesInFlight = 1 });
+    scenarios.push_back({ .Name = "frames_in_flight_2", .Workload = triangles, .FramesInFlight = 2 });
+    scenarios.push_back({ .Name = "frames_in_flight_3", .Workload = triangles, .FramesInFlight = 3 });
+
+    // Startup with empty and with filled pipeline cache, the warm run reuses what the cold one saved
+    RendererWorkload pipelines { };
+    pipelines.InstancesGridSize = 0;
+    pipelines.PipelineVariants = 64;
+    scenarios.push_back({ .Name = "pipelines_64_cold", .Workload = pipelines, .IsColdStart = true });
+    scenarios.push_back({ .Name = "pipelines_64_warm", .Workload = pipelines });
+
+    RendererWorkload sceneElements { };
+    sceneElements.InstancesGridSize = 0;
+    scenarios.push_back({ .Name = "scene_elements_512", .Workload = sceneElements, .SceneElements = 512 });
+
+    // Layers are drawn back to front, without the pre-pass every one of them is shaded
+    RendererWorkload depthPrePass { };
+    depthPrePass.InstancesGridSize = 0;
+    depthPrePass.DepthPrePass = true;
+    scenarios.push_back({ .Name = "depth_prepass_on", .Workload = depthPrePass, .SceneLayers = 16 });
+    depthPrePass.DepthPrePass = false;
+    scenarios.push_back({ .Name = "depth_prepass_off", .Workload = depthPrePass, .SceneLayers = 16 });
+
+    RendererWorkload instances { };
+    instances.InstancesGridSize = 316;
+    instances.MaxInstances = 100'000;
+    scenarios.push_back({ .Name = "instances_100k", .Workload = instances });
+
+    RendererWorkload culling { };
+    culling.InstancesGridSize = 1'000;
+    culling.MaxInstances = 1'000'000;
+    culling.CullingMode = Engine::Renderer::InstanceCullingMode::CPU;
+    scenarios.push_back({ .Name = "culling_cpu_1m", .Workload = culling });
+    culling.CullingMode = Engine::Renderer::InstanceCullingMode::GPU;
+    scenarios.push_back({ .Name = "culling_gpu_1m", .Workload = culling });
+
+    RendererWorkload uploads { };
+    uploads.InstancesGridSize = 0;
+    uploads.UploadBytesPerFrame = 16ull * 1024 * 1024;
+    scenarios.push_back({ .Name = "uploads_16mb", .Workload = uploads });
+
+    RendererWorkload allocations { };
+    allocations.InstancesGridSize = 0;
+    allocations.BufferAllocationsPerFrame = 256;
+    scenarios.push_back({ .Name = "allocations_256", .Workload = allocations });
+
+    return scenarios;
+}
+
+static double MillisecondsSince(Clock::time_point p_start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - p_start).count();
+}
+
+static void FillScene(Core::Scene::Scene& p_scene, uint32_t p_elementsCount, uint32_t p_layersCount)
+{
+    // Small quads in rows over the lower left quarter, the same layout every run
+    constexpr uint32_t elementsPerRow = 32;
+    for (uint32_t i = 0; i < p_elementsCount; i++)
+    {
+        Core::Scene::Transform& transform = p_scene.CreateSceneElement<BenchSceneElement>().GetTransform();
+        transform.Position = { -0.9f * static_cast<float>(i % elementsPerRow) / elementsPerRow,
+            -0.9f * static_cast<float>(i / elementsPerRow) / elementsPerRow, 0.0f };
+        transform.Rotation = { 0.0f, 0.0f, 0.0f };
+        transform.Scale = { 0.05f, 0.05f, 1.0f };
+    }
+
+    // Quad mesh spans [-0.9, -0.5], scaled four times and moved back it covers [-0.8, 0.8]
+    for (uint32_t i = 0; i < p_layersCount; i++)
+    {
+        Core::Scene::Transform& transform = p_scene.CreateSceneElement<BenchSceneElement>().GetTransform();
+        transform.Position = { 2.8f, 2.8f, 0.9f - 0.8f * static_cast<float>(i) / static_cast<float>(p_layersCount) };
+        transform.Rotation = { 0.0f, 0.0f, 0.0f };
+        transform.Scale = { 4.0f, 4.0f, 1.0f };
+    }
+}
+
+static bool RunScenario(const Scenario& p_scenario, uint32_t p_framesCount, ScenarioResult& p_result)
+{
+    p_result.Source = &p_scenario;
+
+    if (p_scenario.IsColdStart)
+    {
+        std::error_code error;
+        std::filesystem::remove(PIPELINE_CACHE_FILEPATH, error);
+    }
+
+    Core::Scene::Scene scene;
+    FillScene(scene, p_scenario.SceneElements, p_scenario.SceneLayers);
+
+    auto engineEventBus = Core::Events::EventBus();
+    auto subsystemsManager = Core::EngineSubsystemsManager(engineEventBus);
+    auto renderer = subsystemsManager.CreateSubsystem<RendererSubsystem>(
+        Engine::Renderer::HeadlessSettings { }, p_scenario.FramesInFlight);
+    renderer->SetWorkload(p_scenario.Workload);
+
+    const Clock::time_point startupBegin = Clock::now();
+    if (!subsystemsManager.Init())
+    {
+        ENGINE_ERR("Scenario \"{}\" failed to initialize the renderer", p_scenario.Name);
+        return false;
+    }
+    p_result.StartupMilliseconds = MillisecondsSince(startupBegin);
+
+    while (renderer->GetPendingPipelinesCount() > 0)
+    {
+        if (p_result.WarmupFrames == MAX_WARMUP_FRAMES)
+        {
+            ENGINE_ERR("Scenario \"{}\" still compiles {} pipelines after {} frames", p_scenario.Name,
+                renderer->GetPendingPipelinesCount(), MAX_WARMUP_FRAMES);
+            return false;
+        }
+        subsystemsManager.Tick(scene);
+        p_result.WarmupFrames++;
+    }
+    p_result.PipelinesReadyMilliseconds = MillisecondsSince(startupBegin);
+
+    p_result.CpuMilliseconds.reserve(p_framesCount);
+    p_result.GpuMilliseconds.reserve(p_framesCount);
+    for (uint32_t i = 0; i < p_framesCount; i++)
+    {
+        const Clock::time_point frameBegin = Clock::now();
+        subsystemsManager.Tick(scene);
+        p_result.CpuMilliseconds.push_back(MillisecondsSince(frameBegin));
+        p_result.GpuMilliseconds.push_back(renderer->GetGpuFrameMilliseconds());
+    }
+
+    // Same every frame, scenes do not move
+    p_result.FragmentInvocations = renderer->GetGpuFragmentInvocations();
+    p_result.Draws = renderer->GetDrawStatistics();
+    p_result.Uploads = renderer->GetUploadStatistics();
+
+    // Failed allocations are cheaper than real ones, frame times would look better than they are
+    p_result.FailedAllocations = renderer->GetFailedWorkloadAllocationsCount();
+    if (p_result.FailedAllocations > 0)
+    {
+        ENGINE_ERR("Scenario \"{}\" failed {} buffer allocations", p_scenario.Name, p_result.FailedAllocations);
+        return false;
+    }
+
+    p_result.Succeeded = true;
+    return true;
+}
+
+static SampleStatistics ComputeStatistics(std::vector<double> p_samples)
+{
+    SampleStatistics statistics { };
+    if (p_samples.empty())
+    {
+        return statistics;
+    }
+
+    std::sort(p_samples.begin(), p_samples.end());
+
+    // Nearest rank
+    const auto percentile = [&p_samples](double p_percent)
+    {
+        const size_t rank = static_cast<size_t>(std::ceil(p_percent / 100.0 * static_cast<double>(p_samples.size())));
+        return p_samples[std::clamp<size_t>(rank, 1, p_samples.size()) - 1];
+    };
+
+    double sum = 0.0;
+    for (double sample : p_samples)
+    {
+        sum += sample;
+    }
+
+    statistics.Mean = sum / static_cast<double>(p_samples.size());
+    statistics.P50 = percentile(50.0);
+    statistics.P95 = percentile(95.0);
+    statistics.P99 = percentile(99.0);
+    statistics.Max = p_samples.back();
+    return statistics;
+}
+
+static std::string StatisticsToJson(const SampleStatistics& p_statistics)
+{
+    return fmt::format(R"({{ "mean": {:.4f}, "p50": {:.4f}, "p95": {:.4f}, "p99": {:.4f}, "max": {:.4f} }})",
+        p_statistics.Mean, p_statistics.P50, p_statistics.P95, p_statistics.P99, p_statistics.Max);
+}
+
+static std::string ResultToJson(const ScenarioResult& p_result)
+{
+    const Scenario& scenario = *p_result.Source;
+    std::string json = fmt::format(R"(    {{
+      "name": "{}",
+      "succeeded": {},
+      "frames_in_flight": {},
+      "startup_ms": {:.4f},
+      "pipelines_ready_ms": {:.4f},
+      "warmup_frames": {},
+      "measured_frames": {},
+      "cpu_frame_ms": {},
+      "gpu_frame_ms": {},
+      "fragment_invocations": {},
+      "draws": {},
+      "pipeline_binds": {},
+      "uploaded_bytes": {},
+      "staging_stalls": {},
+      "failed_allocations": {}
+    }})",
+        scenario.Name,
+        p_result.Succeeded,
+        scenario.FramesInFlight,
+        p_result.StartupMilliseconds,
+        p_result.PipelinesReadyMilliseconds,
+        p_result.WarmupFrames,
+        p_result.CpuMilliseconds.size(),
+        StatisticsToJson(ComputeStatistics(p_result.CpuMilliseconds)),
+        StatisticsToJson(ComputeStatistics(p_result.GpuMilliseconds)),
+        p_result.FragmentInvocations,
+        p_result.Draws.Draws,
+        p_result.Draws.PipelineBinds,
+        p_result.Uploads.UploadedBytes,
+        p_result.Uploads.StagingStalls,
+        p_result.FailedAllocations);
+    return json;
+}
+
+int main(int p_argc, char* p_argv[])
+{
+    uint32_t framesCount = 300;
+    std::string outputFilepath = "BenchResults.json";
+    std::vector<std::string> selectedScenarios;
+    bool listScenarios = false;
+
+    for (int i = 1; i < p_argc; i++)
+    {
+        const bool hasValue = i + 1 < p_argc;
+        if (std::strcmp(p_argv[i], "--frames") == 0 && hasValue)
+        {
+            framesCount = std::max(static_cast<uint32_t>(std::stoul(p_argv[++i])), 1u);
+        }
+        else if (std::strcmp(p_argv[i], "--scenario") == 0 && hasValue)
+        {
+            selectedScenarios.emplace_back(p_argv[++i]);
+        }
+        else if (std::strcmp(p_argv[i], "--output") == 0 && hasValue)
+        {
+            outputFilepath = p_argv[++i];
+        }
+        else if (std::strcmp(p_argv[i], "--list") == 0)
+        {
+            listScenarios = true;
+        }
+        else
+        {
+            fmt::print(stderr, "Usage: DeepEngineBench [--frames N] [--scenario name]... [--output results.json] [--list]\n");
+            return 1;
+        }
+    }
+
+    const std::vector<Scenario> scenarios = CreateScenarios();
+    if (listScenarios)
+    {
+        for (const Scenario& scenario : scenarios)
+        {
+            fmt::print("{}\n", scenario.Name);
+        }
+        return 0;
+    }
+
+    Debug::Logger::Initialize("Logs/bench.log");
+
+    std::vector<ScenarioResult> results;
+    bool hasFailed = false;
+    for (const Scenario& scenario : scenarios)
+    {
+        if (!selectedScenarios.empty()
+            && std::find(selectedScenarios.begin(), selectedScenarios.end(), scenario.Name) == selectedScenarios.end())
+        {
+            continue;
+        }
+
+        ENGINE_INFO("Running scenario \"{}\" for {} frames", scenario.Name, framesCount);
+        ScenarioResult& result = results.emplace_back();
+        if (!RunScenario(scenario, framesCount, result))
+        {
+            hasFailed = true;
+            continue;
+        }
+
+        const SampleStatistics cpu = ComputeStatistics(result.CpuMilliseconds);
+        ENGINE_INFO("Scenario \"{}\": CPU frame p50 {:.3f} ms, p99 {:.3f} ms", scenario.Name, cpu.P50, cpu.P99);
+    }
+
+    std::string json = fmt::format("{{\n  \"frames\": {},\n  \"scenarios\": [\n", framesCount);
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        json += ResultToJson(results[i]);
+        json += i + 1 < results.size() ? ",\n" : "\n";
+    }
+    json += "  ]\n}\n";
+
+    std::ofstream file(outputFilepath, std::ios::out | std::ios::trunc);
+    file << json;
+    if (!file.good())
+    {
+        ENGINE_ERR("Failed to write results to \"{}\"", outputFilepath);
+        return 1;
+    }
+
+    ENGINE_INFO("Results of {} scenarios written to \"{}\"", results.size(), outputFilepath);
+    return hasFailed ? 1 : 0;
+}
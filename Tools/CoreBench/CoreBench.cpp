@@ -0,0 +1,52 @@
+// Microbenchmarks of Core systems (EventBus, Scene, SerializerContainer) built on Google Benchmark.
+// Usage: DeepCoreBench [google benchmark flags], e.g. --benchmark_filter=EventBus
+// Results are written as JSON to CoreBenchResults.json unless --benchmark_out is given. Two result files can be
+// compared with tools/compare.py from Google Benchmark: compare.py benchmarks before.json after.json
+
+#include <cstring>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "Debug/Logger.h"
+
+using namespace DeepEngine;
+
+static bool HasArgument(int p_argc, char* p_argv[], const char* p_prefix)
+{
+    for (int i = 1; i < p_argc; i++)
+    {
+        if (std::strncmp(p_argv[i], p_prefix, std::strlen(p_prefix)) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int p_argc, char* p_argv[])
+{
+    // Engine logs of benchmarked code are compiled out below WARN (see CMakeLists.txt)
+    Debug::Logger::Initialize("Logs/core_bench.log");
+
+    std::vector<char*> arguments(p_argv, p_argv + p_argc);
+    char defaultOutput[] = "--benchmark_out=CoreBenchResults.json";
+    char defaultOutputFormat[] = "--benchmark_out_format=json";
+    if (!HasArgument(p_argc, p_argv, "--benchmark_out="))
+    {
+        arguments.push_back(defaultOutput);
+        arguments.push_back(defaultOutputFormat);
+    }
+
+    int argumentsCount = static_cast<int>(arguments.size());
+    benchmark::Initialize(&argumentsCount, arguments.data());
+    if (benchmark::ReportUnrecognizedArguments(argumentsCount, arguments.data()))
+    {
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    Debug::Logger::Flush();
+    return 0;
+}
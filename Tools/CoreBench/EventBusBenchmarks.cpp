@@ -0,0 +1,137 @@
+// EventBus::Publish cost with growing listener counts and bus trees
+
+#include <memory>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "Core/Events/EventBus.h"
+
+using namespace DeepEngine;
+using Core::Events::EventBus;
+using Core::Events::EventListener;
+using Core::Events::EventResult;
+
+BEGIN_LOCAL_EVENT_DEFINITION(BenchLocalEvent)
+    int Value = 0;
+END_EVENT_DEFINITION
+
+BEGIN_GLOBAL_EVENT_DEFINITION(BenchGlobalEvent)
+    int Value = 0;
+END_EVENT_DEFINITION
+
+// Never published, its listeners only cost the type filtering
+BEGIN_LOCAL_EVENT_DEFINITION(BenchOtherEvent)
+END_EVENT_DEFINITION
+
+// Bus keeps 32 children without moving them (see Core/Bus/Bus.h)
+static constexpr int64_t MAX_FAN_OUT = 32;
+
+template <typename TEvent>
+static std::shared_ptr<EventListener<TEvent>> CreateCountingListener(EventBus& p_bus, int64_t& p_counter)
+{
+    std::shared_ptr<EventListener<TEvent>> listener = p_bus.CreateListener<TEvent>();
+    listener->BindCallback([&p_counter](const TEvent& p_event)
+        {
+            p_counter += p_event.Value;
+            return EventResult::PASS;
+        });
+    return listener;
+}
+
+// Every bus of the tree gets one listener, returns the last created (deepest) bus
+template <typename TEvent>
+static EventBus& BuildBusTree(EventBus& p_bus, int64_t p_fanOut, int64_t p_depth, int64_t& p_counter,
+    std::vector<std::shared_ptr<EventListener<TEvent>>>& p_listeners)
+{
+    p_listeners.push_back(CreateCountingListener<TEvent>(p_bus, p_counter));
+
+    EventBus* lastBus = &p_bus;
+    if (p_depth > 1)
+    {
+        for (int64_t i = 0; i < p_fanOut; i++)
+        {
+            lastBus = &BuildBusTree<TEvent>(p_bus.CreateChildEventBus(), p_fanOut, p_depth - 1, p_counter, p_listeners);
+        }
+    }
+    return *lastBus;
+}
+
+// Args: listeners of the published event, listeners of another event on the same bus
+static void BM_EventBus_PublishListeners(benchmark::State& p_state)
+{
+    EventBus bus;
+    int64_t counter = 0;
+
+    std::vector<std::shared_ptr<EventListener<BenchLocalEvent>>> listeners;
+    for (int64_t i = 0; i < p_state.range(0); i++)
+    {
+        listeners.push_back(CreateCountingListener<BenchLocalEvent>(bus, counter));
+    }
+
+    std::vector<std::shared_ptr<EventListener<BenchOtherEvent>>> otherListeners;
+    for (int64_t i = 0; i < p_state.range(1); i++)
+    {
+        otherListeners.push_back(bus.CreateListener<BenchOtherEvent>());
+    }
+
+    BenchLocalEvent event;
+    event.Value = 1;
+    for (auto _ : p_state)
+    {
+        bus.Publish(event);
+    }
+
+    benchmark::DoNotOptimize(counter);
+    p_state.SetItemsProcessed(p_state.iterations() * p_state.range(0));
+}
+BENCHMARK(BM_EventBus_PublishListeners)
+    ->ArgNames({ "listeners", "other" })
+    ->ArgsProduct({ { 0, 1, 8, 64, 512 }, { 0 } })
+    ->Args({ 8, 64 })
+    ->Args({ 8, 512 });
+
+// Args: children of every bus, depth of the tree (root alone is depth 1). Local event is published on the root,
+// global one on the deepest bus so it first walks up to the root. Both reach every bus of the tree
+template <typename TEvent>
+static void BM_EventBus_PublishTree(benchmark::State& p_state)
+{
+    const int64_t fanOut = p_state.range(0);
+    const int64_t depth = p_state.range(1);
+    if (fanOut > MAX_FAN_OUT)
+    {
+        p_state.SkipWithError("Fan out is above the child buses capacity");
+        return;
+    }
+
+    EventBus rootBus;
+    int64_t counter = 0;
+    std::vector<std::shared_ptr<EventListener<TEvent>>> listeners;
+    EventBus& deepestBus = BuildBusTree<TEvent>(rootBus, fanOut, depth, counter, listeners);
+
+    TEvent event;
+    event.Value = 1;
+    EventBus& publishingBus = event.GetPublishingScope() == Core::Events::EventScope::GLOBAL ? deepestBus : rootBus;
+
+    for (auto _ : p_state)
+    {
+        publishingBus.Publish(event);
+    }
+
+    benchmark::DoNotOptimize(counter);
+    p_state.counters["buses"] = static_cast<double>(listeners.size());
+    p_state.SetItemsProcessed(p_state.iterations() * static_cast<int64_t>(listeners.size()));
+}
+BENCHMARK_TEMPLATE(BM_EventBus_PublishTree, BenchLocalEvent)
+    ->ArgNames({ "fan_out", "depth" })
+    ->Args({ 1, 1 })
+    ->Args({ 1, 64 })
+    ->Args({ 2, 10 })
+    ->Args({ 8, 4 })
+    ->Args({ 32, 3 });
+BENCHMARK_TEMPLATE(BM_EventBus_PublishTree, BenchGlobalEvent)
+    ->ArgNames({ "fan_out", "depth" })
+    ->Args({ 1, 1 })
+    ->Args({ 1, 64 })
+    ->Args({ 2, 10 })
+    ->Args({ 8, 4 })
+    ->Args({ 32, 3 });
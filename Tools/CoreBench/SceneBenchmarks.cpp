@@ -0,0 +1,124 @@
+// Scene::CreateSceneElement and Scene::Iterator over scenes mixing three element types
+
+#include <memory>
+#include <benchmark/benchmark.h>
+
+#include "Debug/Logger.h"
+#include "Core/Scene/Scene.h"
+
+using namespace DeepEngine;
+using Core::Scene::Scene;
+using Core::Scene::SceneElement;
+
+struct BenchEmptyElement final : SceneElement
+{
+    constexpr const char* GetTypeName() const override
+    { return "BenchEmptyElement"; }
+};
+
+struct BenchMeshElement final : SceneElement
+{
+    constexpr const char* GetTypeName() const override
+    { return "BenchMeshElement"; }
+
+    glm::mat4 Model;
+    glm::vec4 Color;
+};
+
+struct BenchLightElement final : SceneElement
+{
+    constexpr const char* GetTypeName() const override
+    { return "BenchLightElement"; }
+
+    glm::vec3 Color;
+    float Intensity;
+};
+
+// Scene storage is fixed (64KB) and not bounds checked, mixed scenes have to fit in it
+static constexpr int64_t MAX_ELEMENTS = 512;
+static_assert((sizeof(BenchEmptyElement) + sizeof(BenchMeshElement) + sizeof(BenchLightElement)) * (MAX_ELEMENTS / 3 + 1)
+    <= 64 * 1024);
+
+// Types repeat in order empty, mesh, light
+static void FillMixedScene(Scene& p_scene, int64_t p_elementsCount)
+{
+    for (int64_t i = 0; i < p_elementsCount; i++)
+    {
+        switch (i % 3)
+        {
+        case 0:
+            p_scene.CreateSceneElement<BenchEmptyElement>();
+            break;
+        case 1:
+            p_scene.CreateSceneElement<BenchMeshElement>();
+            break;
+        default:
+            p_scene.CreateSceneElement<BenchLightElement>();
+            break;
+        }
+    }
+}
+
+// Arg: elements created in a fresh scene, allocating and freeing the scene is not measured
+static void BM_Scene_CreateSceneElement(benchmark::State& p_state)
+{
+    const int64_t elementsCount = p_state.range(0);
+
+    for (auto _ : p_state)
+    {
+        p_state.PauseTiming();
+        auto scene = std::make_unique<Scene>();
+        p_state.ResumeTiming();
+
+        FillMixedScene(*scene, elementsCount);
+        benchmark::ClobberMemory();
+
+        p_state.PauseTiming();
+        scene.reset();
+        p_state.ResumeTiming();
+    }
+
+    p_state.SetItemsProcessed(p_state.iterations() * elementsCount);
+}
+BENCHMARK(BM_Scene_CreateSceneElement)
+    ->ArgName("elements")
+    ->Arg(16)
+    ->Arg(128)
+    ->Arg(MAX_ELEMENTS);
+
+// Arg: elements of the scene. SceneElement iterates all of them, other types skip the ones of different type
+template <typename T>
+static void BM_Scene_Iterate(benchmark::State& p_state)
+{
+    auto scene = std::make_unique<Scene>();
+    FillMixedScene(*scene, p_state.range(0));
+
+    int64_t visitedElements = 0;
+    for (auto _ : p_state)
+    {
+        float positionsSum = 0.f;
+        for (auto it = scene->Begin<T>(); it != scene->End<T>(); ++it)
+        {
+            positionsSum += it->GetTransform().Position.x;
+            visitedElements++;
+        }
+        benchmark::DoNotOptimize(positionsSum);
+    }
+
+    p_state.SetItemsProcessed(visitedElements);
+}
+BENCHMARK_TEMPLATE(BM_Scene_Iterate, SceneElement)
+    ->ArgName("elements")
+    ->Arg(16)
+    ->Arg(128)
+    ->Arg(MAX_ELEMENTS);
+BENCHMARK_TEMPLATE(BM_Scene_Iterate, BenchMeshElement)
+    ->ArgName("elements")
+    ->Arg(16)
+    ->Arg(128)
+    ->Arg(MAX_ELEMENTS);
+BENCHMARK_TEMPLATE(BM_Scene_Iterate, BenchLightElement)
+    ->ArgName("elements")
+    ->Arg(16)
+    ->Arg(128)
+    ->Arg(MAX_ELEMENTS);
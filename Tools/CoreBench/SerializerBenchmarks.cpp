@@ -0,0 +1,96 @@
+// SerializerContainer round trips of glm types, through YAML nodes only and through YAML text
+
+#include <benchmark/benchmark.h>
+#include <glm/glm.hpp>
+#include <yaml-cpp/yaml.h>
+
+#include "Core/Serialize/SerializersContainer.h"
+#include "Core/Serialize/DefaultImplementations/GlmSerializers.h"
+
+using namespace DeepEngine;
+using Core::Serialize::SerializerContainer;
+
+template <typename T>
+static T CreateValue();
+
+template <>
+glm::vec2 CreateValue<glm::vec2>()
+{ return { 1.f, 1.25f }; }
+
+template <>
+glm::vec3 CreateValue<glm::vec3>()
+{ return { 1.f, 1.25f, 1.5f }; }
+
+template <>
+glm::vec4 CreateValue<glm::vec4>()
+{ return { 1.f, 1.25f, 1.5f, 1.75f }; }
+
+template <>
+glm::mat4x4 CreateValue<glm::mat4x4>()
+{
+    glm::mat4x4 value;
+    for (int column = 0; column < 4; column++)
+    {
+        value[column] = CreateValue<glm::vec4>() + static_cast<float>(column);
+    }
+    return value;
+}
+
+// Serialize into a node and deserialize it back
+template <typename T>
+static void BM_Serializer_NodeRoundTrip(benchmark::State& p_state)
+{
+    SerializerContainer container;
+    Core::Serialize::Internal::BindGlmSerializers(container);
+
+    const T value = CreateValue<T>();
+    T result { };
+    for (auto _ : p_state)
+    {
+        const YAML::Node node = container.InvokeSerializeFunc(value);
+        container.InvokeDeserializeFunc(node, result);
+        benchmark::DoNotOptimize(result);
+    }
+
+    if (result != value)
+    {
+        p_state.SkipWithError("Deserialized value differs from the serialized one");
+    }
+    p_state.SetItemsProcessed(p_state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_Serializer_NodeRoundTrip, glm::vec2);
+BENCHMARK_TEMPLATE(BM_Serializer_NodeRoundTrip, glm::vec3);
+BENCHMARK_TEMPLATE(BM_Serializer_NodeRoundTrip, glm::vec4);
+BENCHMARK_TEMPLATE(BM_Serializer_NodeRoundTrip, glm::mat4x4);
+
+// Same as saving and loading a file: node is emitted as text, text is parsed back and deserialized
+template <typename T>
+static void BM_Serializer_TextRoundTrip(benchmark::State& p_state)
+{
+    SerializerContainer container;
+    Core::Serialize::Internal::BindGlmSerializers(container);
+
+    const T value = CreateValue<T>();
+    T result { };
+    int64_t textBytes = 0;
+    for (auto _ : p_state)
+    {
+        YAML::Emitter emitter;
+        emitter << container.InvokeSerializeFunc(value);
+        textBytes += static_cast<int64_t>(emitter.size());
+
+        container.InvokeDeserializeFunc(YAML::Load(emitter.c_str()), result);
+        benchmark::DoNotOptimize(result);
+    }
+
+    if (result != value)
+    {
+        p_state.SkipWithError("Deserialized value differs from the serialized one");
+    }
+    p_state.SetItemsProcessed(p_state.iterations());
+    p_state.SetBytesProcessed(textBytes);
+}
+BENCHMARK_TEMPLATE(BM_Serializer_TextRoundTrip, glm::vec2);
+BENCHMARK_TEMPLATE(BM_Serializer_TextRoundTrip, glm::vec3);
+BENCHMARK_TEMPLATE(BM_Serializer_TextRoundTrip, glm::vec4);
+BENCHMARK_TEMPLATE(BM_Serializer_TextRoundTrip, glm::mat4x4);
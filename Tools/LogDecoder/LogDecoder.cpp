@@ -0,0 +1,249 @@
+// Offline decoder of binary logs produced by engine built with DEEP_LOG_BINARY.
+// Usage: DeepLogDecoder <input.dlog> [output.log]
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fmt/format.h>
+#include <fmt/args.h>
+
+#include "Debug/BinaryLogFormat.h"
+
+using namespace DeepEngine::Debug;
+
+struct LogSite
+{
+    uint8_t Level;
+    uint32_t Line;
+    std::string File;
+    std::string Format;
+};
+
+class BinaryReader
+{
+public:
+    BinaryReader(std::ifstream& p_stream) : _stream(p_stream)
+    { }
+
+    template <typename T>
+    bool Read(T& p_value)
+    {
+        _stream.read(reinterpret_cast<char*>(&p_value), sizeof(T));
+        return _stream.good();
+    }
+
+    bool ReadString(std::string& p_value)
+    {
+        uint32_t length;
+        if (!Read(length))
+        {
+            return false;
+        }
+
+        p_value.resize(length);
+        _stream.read(p_value.data(), length);
+        return _stream.good();
+    }
+
+private:
+    std::ifstream& _stream;
+};
+
+static const char* LevelName(uint8_t p_level)
+{
+    constexpr const char* names[] { "trace", "debug", "info", "warning", "error", "critical", "off" };
+    return p_level < std::size(names) ? names[p_level] : "unknown";
+}
+
+static bool ReadArgument(BinaryReader& p_reader, fmt::dynamic_format_arg_store<fmt::format_context>& p_store)
+{
+    using Tag = BinaryLogFormat::ArgumentTag;
+
+    Tag tag;
+    if (!p_reader.Read(tag))
+    {
+        return false;
+    }
+
+    switch (tag)
+    {
+    case Tag::INT64:
+        {
+            int64_t value;
+            p_reader.Read(value);
+            p_store.push_back(value);
+            return true;
+        }
+    case Tag::UINT64:
+        {
+            uint64_t value;
+            p_reader.Read(value);
+            p_store.push_back(value);
+            return true;
+        }
+    case Tag::DOUBLE:
+        {
+            double value;
+            p_reader.Read(value);
+            p_store.push_back(value);
+            return true;
+        }
+    case Tag::BOOL:
+        {
+            uint8_t value;
+            p_reader.Read(value);
+            p_store.push_back(value != 0);
+            return true;
+        }
+    case Tag::CHAR:
+        {
+            char value;
+            p_reader.Read(value);
+            p_store.push_back(value);
+            return true;
+        }
+    case Tag::STRING:
+        {
+            std::string value;
+            p_reader.ReadString(value);
+            p_store.push_back(value);
+            return true;
+        }
+    case Tag::POINTER:
+        {
+            uint64_t value;
+            p_reader.Read(value);
+            p_store.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(value)));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int main(int p_argc, char* p_argv[])
+{
+    if (p_argc < 2)
+    {
+        fmt::print(stderr, "Usage: {} <input.dlog> [output.log]\n", p_argv[0]);
+        return 1;
+    }
+
+    std::ifstream input(p_argv[1], std::ios::binary);
+    if (!input.is_open())
+    {
+        fmt::print(stderr, "Failed to open \"{}\"\n", p_argv[1]);
+        return 1;
+    }
+
+    FILE* output = stdout;
+    if (p_argc >= 3)
+    {
+        output = fopen(p_argv[2], "w");
+        if (output == nullptr)
+        {
+            fmt::print(stderr, "Failed to open \"{}\" for writing\n", p_argv[2]);
+            return 1;
+        }
+    }
+
+    BinaryReader reader(input);
+
+    BinaryLogFormat::FileHeader header;
+    if (!reader.Read(header) || header.Magic != BinaryLogFormat::MAGIC)
+    {
+        fmt::print(stderr, "\"{}\" is not a binary log file\n", p_argv[1]);
+        return 1;
+    }
+    if (header.Version != BinaryLogFormat::VERSION)
+    {
+        fmt::print(stderr, "Unsupported binary log version {} (expected {})\n", header.Version, BinaryLogFormat::VERSION);
+        return 1;
+    }
+
+    std::unordered_map<uint32_t, LogSite> sites;
+    std::unordered_map<uint16_t, std::string> channels;
+    uint64_t entriesCount = 0;
+
+    BinaryLogFormat::RecordType recordType;
+    while (reader.Read(recordType))
+    {
+        switch (recordType)
+        {
+        case BinaryLogFormat::RecordType::SITE_DEFINITION:
+            {
+                uint32_t id;
+                LogSite site;
+                reader.Read(id);
+                reader.Read(site.Level);
+                reader.Read(site.Line);
+                reader.ReadString(site.File);
+                reader.ReadString(site.Format);
+                sites[id] = std::move(site);
+                break;
+            }
+        case BinaryLogFormat::RecordType::CHANNEL_DEFINITION:
+            {
+                uint16_t id;
+                std::string name;
+                reader.Read(id);
+                reader.ReadString(name);
+                channels[id] = std::move(name);
+                break;
+            }
+        case BinaryLogFormat::RecordType::ENTRY:
+            {
+                uint32_t siteId;
+                uint16_t channelId;
+                uint64_t timestamp;
+                uint8_t argsCount;
+                reader.Read(siteId);
+                reader.Read(channelId);
+                reader.Read(timestamp);
+                reader.Read(argsCount);
+
+                fmt::dynamic_format_arg_store<fmt::format_context> store;
+                for (uint8_t i = 0; i < argsCount; i++)
+                {
+                    if (!ReadArgument(reader, store))
+                    {
+                        fmt::print(stderr, "Corrupted argument in entry {}\n", entriesCount);
+                        return 1;
+                    }
+                }
+
+                const LogSite& site = sites[siteId];
+                std::string message;
+                try
+                {
+                    message = fmt::vformat(site.Format, store);
+                }
+                catch (const fmt::format_error& p_error)
+                {
+                    message = fmt::format("{} <format error: {}>", site.Format, p_error.what());
+                }
+
+                // Entries recorded before the file was opened precede StartTimestamp, they are shown at 0
+                const uint64_t sinceStart = timestamp > header.StartTimestamp ? timestamp - header.StartTimestamp : 0;
+                const double seconds = static_cast<double>(sinceStart) / 1e9;
+                fmt::print(output, "[{:>12.6f}] [{:^22}][{:^8}]: {} ({}:{})\n",
+                    seconds, channels[channelId], LevelName(site.Level), message, site.File, site.Line);
+                entriesCount++;
+                break;
+            }
+        default:
+            fmt::print(stderr, "Unknown record type {}, stopping\n", static_cast<uint32_t>(recordType));
+            return 1;
+        }
+    }
+
+    if (output != stdout)
+    {
+        fclose(output);
+    }
+
+    fmt::print(stderr, "Decoded {} entries\n", entriesCount);
+    return 0;
+}
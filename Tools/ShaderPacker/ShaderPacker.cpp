@@ -0,0 +1,137 @@
+// Packs compiled SPIR-V shaders into one archive read by the engine's ShaderLibrary.
+// Usage: DeepShaderPacker <output.dsa> <input.spv>...
+// Shaders are stored under the file names of their inputs, see Engine/Renderer/ShaderArchiveFormat.h
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Engine/Renderer/ShaderArchiveFormat.h"
+
+using namespace DeepEngine::Engine::Renderer;
+
+constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+
+struct PackedShader
+{
+    std::string Name;
+    std::vector<char> Code;
+};
+
+static bool ReadShader(const std::filesystem::path& p_filepath, PackedShader& p_shader)
+{
+    std::ifstream file(p_filepath, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        std::fprintf(stderr, "Failed to open \"%s\"\n", p_filepath.string().c_str());
+        return false;
+    }
+
+    p_shader.Name = p_filepath.filename().string();
+    if (p_shader.Name.size() >= ShaderArchiveFormat::MAX_NAME_LENGTH)
+    {
+        std::fprintf(stderr, "Name of \"%s\" is longer than %u characters\n", p_filepath.string().c_str(),
+            ShaderArchiveFormat::MAX_NAME_LENGTH - 1);
+        return false;
+    }
+
+    p_shader.Code.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(p_shader.Code.data(), static_cast<std::streamsize>(p_shader.Code.size()));
+
+    uint32_t magic = 0;
+    if (p_shader.Code.size() >= sizeof(magic))
+    {
+        std::memcpy(&magic, p_shader.Code.data(), sizeof(magic));
+    }
+
+    if (!file.good() || p_shader.Code.size() % sizeof(uint32_t) != 0 || magic != SPIRV_MAGIC)
+    {
+        std::fprintf(stderr, "\"%s\" is not a SPIR-V module\n", p_filepath.string().c_str());
+        return false;
+    }
+    return true;
+}
+
+static uint64_t AlignCodeOffset(uint64_t p_offset)
+{
+    const uint64_t alignment = ShaderArchiveFormat::CODE_ALIGNMENT;
+    return (p_offset + alignment - 1) / alignment * alignment;
+}
+
+int main(int p_argc, char* p_argv[])
+{
+    if (p_argc < 3)
+    {
+        std::fprintf(stderr, "Usage: DeepShaderPacker <output.dsa> <input.spv>...\n");
+        return 1;
+    }
+
+    std::vector<PackedShader> shaders(p_argc - 2);
+    for (int i = 2; i < p_argc; i++)
+    {
+        if (!ReadShader(p_argv[i], shaders[i - 2]))
+        {
+            return 1;
+        }
+
+        for (int j = 0; j < i - 2; j++)
+        {
+            if (shaders[j].Name == shaders[i - 2].Name)
+            {
+                std::fprintf(stderr, "Shader \"%s\" is packed twice\n", shaders[j].Name.c_str());
+                return 1;
+            }
+        }
+    }
+
+    ShaderArchiveFormat::FileHeader header { };
+    header.Magic = ShaderArchiveFormat::MAGIC;
+    header.Version = ShaderArchiveFormat::VERSION;
+    header.EntriesCount = static_cast<uint32_t>(shaders.size());
+
+    std::vector<ShaderArchiveFormat::Entry> entries(shaders.size());
+    uint64_t offset = sizeof(header) + entries.size() * sizeof(ShaderArchiveFormat::Entry);
+    for (size_t i = 0; i < shaders.size(); i++)
+    {
+        std::memset(&entries[i], 0, sizeof(ShaderArchiveFormat::Entry));
+        std::memcpy(entries[i].Name, shaders[i].Name.c_str(), shaders[i].Name.size());
+
+        offset = AlignCodeOffset(offset);
+        entries[i].CodeOffset = offset;
+        entries[i].CodeSize = shaders[i].Code.size();
+        offset += shaders[i].Code.size();
+    }
+
+    std::ofstream output(p_argv[1], std::ios::binary | std::ios::trunc);
+    if (!output.is_open())
+    {
+        std::fprintf(stderr, "Failed to create \"%s\"\n", p_argv[1]);
+        return 1;
+    }
+
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(entries.data()),
+        static_cast<std::streamsize>(entries.size() * sizeof(ShaderArchiveFormat::Entry)));
+
+    const char padding[ShaderArchiveFormat::CODE_ALIGNMENT] = { };
+    for (size_t i = 0; i < shaders.size(); i++)
+    {
+        const uint64_t position = static_cast<uint64_t>(output.tellp());
+        output.write(padding, static_cast<std::streamsize>(entries[i].CodeOffset - position));
+        output.write(shaders[i].Code.data(), static_cast<std::streamsize>(shaders[i].Code.size()));
+    }
+
+    if (!output.good())
+    {
+        std::fprintf(stderr, "Failed to write \"%s\"\n", p_argv[1]);
+        return 1;
+    }
+
+    std::printf("Packed %zu shaders into \"%s\" (%llu bytes)\n", shaders.size(), p_argv[1],
+        static_cast<unsigned long long>(offset));
+    return 0;
+}